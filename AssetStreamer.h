@@ -0,0 +1,774 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <aio.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace StreamHelper
+{
+	// ֿԴļʽļͷ +  + ݣÿԵѹ
+	enum class ChunkCodec : uint32_t
+	{
+		Raw = 0,
+		Lz4 = 1,
+	};
+
+	struct ChunkFileHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t chunk_count;
+		uint32_t reserved;
+		uint64_t raw_size;
+	};
+
+	struct ChunkEntry
+	{
+		uint64_t offset;
+		uint32_t stored_size;
+		uint32_t raw_size;
+		ChunkCodec codec;
+		uint32_t reserved;
+	};
+
+	static const char m_chunk_file_magic[4] = {'D', 'X', 'S', 'C'};
+	static const uint32_t m_chunk_file_version = 1;
+
+	// ѹLZ4ʽݣдֽʱSIZE_MAX
+	inline size_t Lz4Decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t dst_capacity)
+	{
+		const uint8_t* ip = src;
+		const uint8_t* const ip_end = src + src_size;
+		uint8_t* op = dst;
+		uint8_t* const op_end = dst + dst_capacity;
+
+		while (ip < ip_end)
+		{
+			// 4λΪȣ4λΪƥ䳤
+			uint8_t token = *ip++;
+			size_t literal_length = token >> 4;
+			if (literal_length == 15)
+			{
+				uint8_t extra;
+				do
+				{
+					if (ip >= ip_end) return SIZE_MAX;
+					extra = *ip++;
+					literal_length += extra;
+				} while (extra == 255);
+			}
+			if (literal_length > static_cast<size_t>(ip_end - ip) || literal_length > static_cast<size_t>(op_end - op)) return SIZE_MAX;
+			std::memcpy(op, ip, literal_length);
+			ip += literal_length;
+			op += literal_length;
+
+			// һֻ
+			if (ip >= ip_end) break;
+
+			if (ip_end - ip < 2) return SIZE_MAX;
+			size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+			ip += 2;
+			if (offset == 0 || offset > static_cast<size_t>(op - dst)) return SIZE_MAX;
+
+			size_t match_length = token & 15;
+			if (match_length == 15)
+			{
+				uint8_t extra;
+				do
+				{
+					if (ip >= ip_end) return SIZE_MAX;
+					extra = *ip++;
+					match_length += extra;
+				} while (extra == 255);
+			}
+			match_length += 4;
+			if (match_length > static_cast<size_t>(op_end - op)) return SIZE_MAX;
+
+			// ƥصֻֽڸ
+			const uint8_t* match = op - offset;
+			for (size_t i = 0; i < match_length; ++i)
+			{
+				op[i] = match[i];
+			}
+			op += match_length;
+		}
+		return static_cast<size_t>(op - dst);
+	}
+
+	static inline uint8_t* Lz4WriteLength(uint8_t* op, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			*op++ = 255;
+		}
+		*op++ = static_cast<uint8_t>(length);
+		return op;
+	}
+
+	// ѹ󳤶ȣԤȷ
+	inline size_t Lz4CompressBound(size_t src_size)
+	{
+		return src_size + src_size / 255 + 16;
+	}
+
+	// ̰ĵLZ4ѹڴֿԴļdstҪLz4CompressBound(src_size)ֽ
+	// ʽҪ5ֽһƥĩβ12ֽ֮ǰʼ
+	inline size_t Lz4Compress(const uint8_t* src, size_t src_size, uint8_t* dst)
+	{
+		static const uint32_t hash_bits = 12;
+		std::vector<uint32_t> table(size_t(1) << hash_bits, 0);
+		uint8_t* op = dst;
+		size_t anchor = 0;
+		size_t ip = 0;
+		while (src_size > 12 && ip < src_size - 12)
+		{
+			uint32_t sequence;
+			std::memcpy(&sequence, src + ip, 4);
+			uint32_t hash = (sequence * 2654435761u) >> (32 - hash_bits);
+			// дλüһ0ʾ
+			size_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(ip + 1);
+			if (candidate == 0 || ip - (candidate - 1) > 65535 || std::memcmp(src + candidate - 1, src + ip, 4) != 0)
+			{
+				++ip;
+				continue;
+			}
+			size_t match = candidate - 1;
+			size_t match_length = 4;
+			while (ip + match_length < src_size - 5 && src[match + match_length] == src[ip + match_length])
+			{
+				++match_length;
+			}
+
+			size_t literal_length = ip - anchor;
+			uint8_t* token = op++;
+			*token = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_length - 4, 15));
+			if (literal_length >= 15) op = Lz4WriteLength(op, literal_length - 15);
+			std::memcpy(op, src + anchor, literal_length);
+			op += literal_length;
+			size_t offset = ip - match;
+			*op++ = static_cast<uint8_t>(offset);
+			*op++ = static_cast<uint8_t>(offset >> 8);
+			if (match_length - 4 >= 15) op = Lz4WriteLength(op, match_length - 4 - 15);
+			ip += match_length;
+			anchor = ip;
+		}
+
+		// һֻ
+		size_t literal_length = src_size - anchor;
+		*op++ = static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4);
+		if (literal_length >= 15) op = Lz4WriteLength(op, literal_length - 15);
+		std::memcpy(op, src + anchor, literal_length);
+		op += literal_length;
+		return static_cast<size_t>(op - dst);
+	}
+
+	// ݰchunk_sizeпɷֿԴļѹûбСĿ鰴ԭ洢
+	inline std::vector<uint8_t> BuildChunkFile(const uint8_t* data, size_t size, size_t chunk_size)
+	{
+		size_t chunk_count = chunk_size ? (size + chunk_size - 1) / chunk_size : 0;
+		ChunkFileHeader header{};
+		std::memcpy(header.magic, m_chunk_file_magic, sizeof(header.magic));
+		header.version = m_chunk_file_version;
+		header.chunk_count = static_cast<uint32_t>(chunk_count);
+		header.raw_size = size;
+		std::vector<ChunkEntry> chunks(chunk_count);
+		std::vector<uint8_t> file(sizeof(header) + sizeof(ChunkEntry) * chunk_count);
+		std::vector<uint8_t> compressed(Lz4CompressBound(chunk_size));
+		for (size_t i = 0; i < chunk_count; ++i)
+		{
+			const uint8_t* raw = data + i * chunk_size;
+			uint32_t raw_size = static_cast<uint32_t>(std::min(chunk_size, size - i * chunk_size));
+			size_t compressed_size = Lz4Compress(raw, raw_size, compressed.data());
+			bool keep_raw = compressed_size >= raw_size;
+			chunks[i] = {file.size(), keep_raw ? raw_size : static_cast<uint32_t>(compressed_size), raw_size, keep_raw ? ChunkCodec::Raw : ChunkCodec::Lz4, 0};
+			const uint8_t* stored = keep_raw ? raw : compressed.data();
+			file.insert(file.end(), stored, stored + chunks[i].stored_size);
+		}
+		std::memcpy(file.data(), &header, sizeof(header));
+		if (chunk_count) std::memcpy(file.data() + sizeof(header), chunks.data(), sizeof(ChunkEntry) * chunk_count);
+		return file;
+	}
+
+	// ʽȡĴӳͳ
+	struct StreamStats
+	{
+		uint64_t bytes_read = 0;
+		uint64_t bytes_decompressed = 0;
+		uint64_t requests_completed = 0;
+		uint64_t requests_failed = 0;
+		// I/O̴߳ʱ䣬Լ߳̽ѹʱ֮֮ͣʹǽʱ˵ȡѹص
+		double io_seconds = 0.0;
+		double decompress_seconds = 0.0;
+		double total_latency_ms = 0.0;
+		double max_latency_ms = 0.0;
+
+		double ReadBandwidthMBps() const { return io_seconds > 0.0 ? bytes_read / io_seconds / (1024.0 * 1024.0) : 0.0; }
+		double AverageLatencyMs() const { return requests_completed ? total_latency_ms / requests_completed : 0.0; }
+	};
+
+	// 첽ֿԴȼI/O̷ֿ߳ȡ̲߳нѹ
+	class AssetStreamer
+	{
+	public:
+		// Ŀڴɵ÷ṩӳõϴѣΪѹܴС
+		using AllocateDestination = std::function<uint8_t*(size_t)>;
+
+		~AssetStreamer()
+		{
+			Shutdown();
+		}
+
+		void Initial(uint32_t worker_count = 0, size_t chunk_size = 256 * 1024, uint32_t max_reads_in_flight = 8)
+		{
+			if (worker_count == 0)
+			{
+				worker_count = std::max(1u, std::thread::hardware_concurrency() - 1);
+			}
+			m_chunk_size = chunk_size;
+			m_max_reads_in_flight = std::max(1u, max_reads_in_flight);
+			m_running = true;
+			m_workers_running = true;
+			m_io_thread = std::thread([this] { IoThread(); });
+			for (uint32_t i = 0; i < worker_count; ++i)
+			{
+				m_workers.emplace_back([this] { WorkerThread(); });
+			}
+		}
+
+		// ȴеֹͣѹ߳
+		void Shutdown()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_running) return;
+				m_running = false;
+			}
+			m_request_cv.notify_all();
+			m_io_thread.join();
+
+			{
+				std::lock_guard<std::mutex> lock(m_task_mutex);
+				m_workers_running = false;
+			}
+			m_task_cv.notify_all();
+			for (std::thread& worker : m_workers)
+			{
+				worker.join();
+			}
+			m_workers.clear();
+		}
+
+		// ѹֽInitial֮ǰãļĴСʱʧܣ÷ڴ
+		void SetMaxRequestSize(uint64_t max_bytes)
+		{
+			m_max_request_size = max_bytes;
+		}
+
+		// ύȡpriorityԽԽȴfutureؽѹֽ
+		// ûInitialѾShutdownʱʧܣfuture
+		std::future<size_t> Request(const std::filesystem::path& path, int priority, AllocateDestination allocate)
+		{
+			auto request = std::make_shared<AssetRequest>();
+			request->path = path;
+			request->priority = priority;
+			request->allocate = std::move(allocate);
+			request->submit_time = std::chrono::steady_clock::now();
+			std::future<size_t> future = request->promise.get_future();
+			bool accepted = false;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				accepted = m_running;
+				if (accepted)
+				{
+					request->sequence = m_sequence++;
+					m_requests.push(request);
+				}
+			}
+			if (!accepted)
+			{
+				Fail(request);
+				return future;
+			}
+			m_request_cv.notify_one();
+			return future;
+		}
+
+		// ȡ÷vectorУfutureǰvector뱣Ч
+		std::future<size_t> Request(const std::filesystem::path& path, int priority, std::vector<uint8_t>& destination)
+		{
+			return Request(path, priority, [&destination](size_t size) { destination.resize(size); return destination.data(); });
+		}
+
+		StreamStats Stats() const
+		{
+			std::lock_guard<std::mutex> lock(m_stats_mutex);
+			return m_stats;
+		}
+
+		void ResetStats()
+		{
+			std::lock_guard<std::mutex> lock(m_stats_mutex);
+			m_stats = StreamStats{};
+		}
+
+	private:
+		struct AssetRequest
+		{
+			std::filesystem::path path;
+			int priority = 0;
+			uint64_t sequence = 0;
+			AllocateDestination allocate;
+			std::promise<size_t> promise;
+			std::chrono::steady_clock::time_point submit_time;
+			uint8_t* destination = nullptr;
+			size_t raw_size = 0;
+			// δɵĿһI/O߳ڷȫȡͷ
+			std::atomic<uint32_t> pending{0};
+			std::atomic<bool> failed{false};
+		};
+
+		struct RequestOrder
+		{
+			bool operator()(const std::shared_ptr<AssetRequest>& a, const std::shared_ptr<AssetRequest>& b) const
+			{
+				return a->priority != b->priority ? a->priority < b->priority : a->sequence > b->sequence;
+			}
+		};
+
+		struct ReadOp
+		{
+			uint64_t offset;
+			uint32_t size;
+			uint8_t* target;
+		};
+
+		// ƽ̨صļWindowsʹصI/Oƽ̨ʹPOSIX AIO
+		class ChunkFile
+		{
+		public:
+			~ChunkFile()
+			{
+#if defined(_WIN32)
+				if (m_handle != INVALID_HANDLE_VALUE) CloseHandle(m_handle);
+#else
+				if (m_fd >= 0) close(m_fd);
+#endif
+			}
+
+			bool Open(const std::filesystem::path& path)
+			{
+#if defined(_WIN32)
+				m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+				LARGE_INTEGER size{};
+				if (m_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_handle, &size)) return false;
+				m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+				m_fd = open(path.c_str(), O_RDONLY);
+				struct stat st{};
+				if (m_fd < 0 || fstat(m_fd, &st) != 0) return false;
+				m_size = static_cast<uint64_t>(st.st_size);
+				posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+				return true;
+			}
+
+			uint64_t Size() const { return m_size; }
+
+			// ˳򷢳һȡmax_in_flightͬʱУÿһصһ
+			template <typename OnComplete>
+			bool ReadBatch(const std::vector<ReadOp>& ops, uint32_t max_in_flight, OnComplete on_complete)
+			{
+#if defined(_WIN32)
+				struct Slot
+				{
+					OVERLAPPED overlapped;
+					size_t index;
+				};
+				std::vector<Slot> slots(std::min<size_t>(max_in_flight, ops.size()));
+				for (Slot& slot : slots)
+				{
+					slot.overlapped = {};
+					slot.overlapped.hEvent = CreateEventW(nullptr, true, false, nullptr);
+				}
+
+				bool ok = true;
+				size_t issued = 0;
+				size_t completed = 0;
+				std::deque<Slot*> in_flight;
+				std::vector<Slot*> free_slots;
+				for (Slot& slot : slots) free_slots.push_back(&slot);
+
+				while (completed < ops.size())
+				{
+					// ͬʱеĶȡ
+					while (ok && issued < ops.size() && !free_slots.empty())
+					{
+						Slot* slot = free_slots.back();
+						free_slots.pop_back();
+						const ReadOp& op = ops[issued];
+						ResetEvent(slot->overlapped.hEvent);
+						slot->overlapped.Offset = static_cast<DWORD>(op.offset);
+						slot->overlapped.OffsetHigh = static_cast<DWORD>(op.offset >> 32);
+						slot->index = issued++;
+						if (!ReadFile(m_handle, op.target, op.size, nullptr, &slot->overlapped) && GetLastError() != ERROR_IO_PENDING)
+						{
+							ok = false;
+							free_slots.push_back(slot);
+							break;
+						}
+						in_flight.push_back(slot);
+					}
+					if (in_flight.empty()) break;
+
+					Slot* slot = in_flight.front();
+					in_flight.pop_front();
+					DWORD bytes = 0;
+					bool read_ok = GetOverlappedResult(m_handle, &slot->overlapped, &bytes, true) && bytes == ops[slot->index].size;
+					ok = ok && read_ok;
+					on_complete(slot->index, read_ok);
+					free_slots.push_back(slot);
+					++completed;
+				}
+
+				for (Slot& slot : slots)
+				{
+					CloseHandle(slot.overlapped.hEvent);
+				}
+				return ok && completed == ops.size();
+#else
+				// Windows·Ľṹͬaio_readȡ˳ȴ
+				struct Slot
+				{
+					aiocb control;
+					size_t index;
+				};
+				std::vector<Slot> slots(std::min<size_t>(max_in_flight, ops.size()));
+
+				bool ok = true;
+				size_t issued = 0;
+				size_t completed = 0;
+				std::deque<Slot*> in_flight;
+				std::vector<Slot*> free_slots;
+				for (Slot& slot : slots) free_slots.push_back(&slot);
+
+				while (completed < ops.size())
+				{
+					while (ok && issued < ops.size() && !free_slots.empty())
+					{
+						Slot* slot = free_slots.back();
+						free_slots.pop_back();
+						const ReadOp& op = ops[issued];
+						slot->control = aiocb{};
+						slot->control.aio_fildes = m_fd;
+						slot->control.aio_buf = op.target;
+						slot->control.aio_nbytes = op.size;
+						slot->control.aio_offset = static_cast<off_t>(op.offset);
+						slot->index = issued++;
+						if (aio_read(&slot->control) != 0)
+						{
+							ok = false;
+							free_slots.push_back(slot);
+							break;
+						}
+						in_flight.push_back(slot);
+					}
+					if (in_flight.empty()) break;
+
+					Slot* slot = in_flight.front();
+					in_flight.pop_front();
+					const aiocb* wait_list[] = {&slot->control};
+					int error;
+					while ((error = aio_error(&slot->control)) == EINPROGRESS)
+					{
+						aio_suspend(wait_list, 1, nullptr);
+					}
+					ssize_t bytes = aio_return(&slot->control);
+					bool read_ok = error == 0 && bytes == static_cast<ssize_t>(ops[slot->index].size);
+					ok = ok && read_ok;
+					on_complete(slot->index, read_ok);
+					free_slots.push_back(slot);
+					++completed;
+				}
+				return ok && completed == ops.size();
+#endif
+			}
+
+		private:
+#if defined(_WIN32)
+			HANDLE m_handle = INVALID_HANDLE_VALUE;
+#else
+			int m_fd = -1;
+#endif
+			uint64_t m_size = 0;
+		};
+
+		void IoThread()
+		{
+			for (;;)
+			{
+				std::shared_ptr<AssetRequest> request;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_request_cv.wait(lock, [this] { return !m_running || !m_requests.empty(); });
+					if (!m_running && m_requests.empty()) return;
+					request = m_requests.top();
+					m_requests.pop();
+				}
+				ProcessRequest(request);
+			}
+		}
+
+		void ProcessRequest(const std::shared_ptr<AssetRequest>& request)
+		{
+			auto io_begin = std::chrono::steady_clock::now();
+			uint64_t bytes_read = 0;
+
+			ChunkFile file;
+			std::vector<ChunkEntry> chunks;
+			if (!file.Open(request->path) || !ReadChunkTable(file, chunks, bytes_read))
+			{
+				Fail(request);
+				return;
+			}
+
+			// ֪ѹС÷Ŀڴ棬ܴСޱȽ
+			uint64_t total_raw_size = 0;
+			for (const ChunkEntry& chunk : chunks)
+			{
+				total_raw_size += chunk.raw_size;
+			}
+			if (total_raw_size > m_max_request_size || total_raw_size > SIZE_MAX)
+			{
+				Fail(request);
+				return;
+			}
+			size_t raw_size = static_cast<size_t>(total_raw_size);
+			request->raw_size = raw_size;
+			request->destination = request->allocate(raw_size);
+			if (raw_size > 0 && !request->destination)
+			{
+				Fail(request);
+				return;
+			}
+
+			// δѹĿֱӶĿڴ棬ѹݴ󽻸߳̽ѹ
+			std::vector<ReadOp> ops(chunks.size());
+			std::vector<std::vector<uint8_t>> staging(chunks.size());
+			std::vector<size_t> raw_offsets(chunks.size());
+			size_t raw_offset = 0;
+			for (size_t i = 0; i < chunks.size(); ++i)
+			{
+				raw_offsets[i] = raw_offset;
+				raw_offset += chunks[i].raw_size;
+				uint8_t* target = request->destination + raw_offsets[i];
+				if (chunks[i].codec != ChunkCodec::Raw)
+				{
+					staging[i].resize(chunks[i].stored_size);
+					target = staging[i].data();
+				}
+				ops[i] = {chunks[i].offset, chunks[i].stored_size, target};
+			}
+
+			request->pending = static_cast<uint32_t>(chunks.size()) + 1;
+			size_t completed_reads = 0;
+			bool ok = file.ReadBatch(ops, m_max_reads_in_flight, [&](size_t index, bool read_ok)
+			{
+				++completed_reads;
+				bytes_read += read_ok ? ops[index].size : 0;
+				if (!read_ok)
+				{
+					request->failed = true;
+					ChunkDone(request);
+				}
+				else if (chunks[index].codec == ChunkCodec::Raw)
+				{
+					ChunkDone(request);
+				}
+				else
+				{
+					auto chunk_data = std::make_shared<std::vector<uint8_t>>(std::move(staging[index]));
+					ChunkEntry chunk = chunks[index];
+					uint8_t* target = request->destination + raw_offsets[index];
+					PushTask([this, request, chunk_data, chunk, target]
+					{
+						Decompress(*request, chunk, *chunk_data, target);
+						ChunkDone(request);
+					});
+				}
+			});
+
+			// ȡ;ʧʱ֮Ŀ鲻ٻصֱӽ
+			if (!ok)
+			{
+				request->failed = true;
+				for (size_t i = completed_reads; i < ops.size(); ++i)
+				{
+					ChunkDone(request);
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_stats_mutex);
+				m_stats.bytes_read += bytes_read;
+				m_stats.io_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - io_begin).count();
+			}
+			ChunkDone(request);
+		}
+
+		bool ReadChunkTable(ChunkFile& file, std::vector<ChunkEntry>& chunks, uint64_t& bytes_read)
+		{
+			ChunkFileHeader header{};
+			bool is_chunk_file = false;
+			if (file.Size() >= sizeof(header))
+			{
+				if (!file.ReadBatch({{0, sizeof(header), reinterpret_cast<uint8_t*>(&header)}}, 1, [](size_t, bool) {})) return false;
+				bytes_read += sizeof(header);
+				is_chunk_file = std::memcmp(header.magic, m_chunk_file_magic, sizeof(header.magic)) == 0;
+			}
+
+			if (is_chunk_file)
+			{
+				if (header.version != m_chunk_file_version) return false;
+				// ļڣⰴ𻵵Ŀڴ
+				uint64_t table_size = sizeof(ChunkEntry) * static_cast<uint64_t>(header.chunk_count);
+				if (table_size > file.Size() - sizeof(header) || table_size > UINT32_MAX) return false;
+				chunks.resize(header.chunk_count);
+				if (table_size > 0 && !file.ReadBatch({{sizeof(header), static_cast<uint32_t>(table_size), reinterpret_cast<uint8_t*>(chunks.data())}}, 1, [](size_t, bool) {})) return false;
+				bytes_read += table_size;
+				uint64_t raw_size = 0;
+				for (const ChunkEntry& chunk : chunks)
+				{
+					// дɼoffset + stored_sizeδѹĿֱӶĿڴ棬Сͬ
+					if (chunk.stored_size > file.Size() || chunk.offset > file.Size() - chunk.stored_size) return false;
+					if (chunk.codec != ChunkCodec::Raw && chunk.codec != ChunkCodec::Lz4) return false;
+					if (chunk.codec == ChunkCodec::Raw && chunk.stored_size != chunk.raw_size) return false;
+					raw_size += chunk.raw_size;
+				}
+				return raw_size == header.raw_size;
+			}
+
+			// ͨļ̶СгδѹĿ
+			for (uint64_t offset = 0; offset < file.Size(); offset += m_chunk_size)
+			{
+				uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(m_chunk_size, file.Size() - offset));
+				chunks.push_back({offset, size, size, ChunkCodec::Raw, 0});
+			}
+			return true;
+		}
+
+		void Decompress(AssetRequest& request, const ChunkEntry& chunk, const std::vector<uint8_t>& data, uint8_t* target)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			size_t written = SIZE_MAX;
+			if (chunk.codec == ChunkCodec::Lz4)
+			{
+				written = Lz4Decompress(data.data(), data.size(), target, chunk.raw_size);
+			}
+			if (written != chunk.raw_size)
+			{
+				request.failed = true;
+				return;
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			std::lock_guard<std::mutex> lock(m_stats_mutex);
+			m_stats.bytes_decompressed += written;
+			m_stats.decompress_seconds += seconds;
+		}
+
+		void ChunkDone(const std::shared_ptr<AssetRequest>& request)
+		{
+			if (request->pending.fetch_sub(1) != 1) return;
+
+			if (request->failed)
+			{
+				Fail(request);
+				return;
+			}
+			double latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - request->submit_time).count();
+			{
+				std::lock_guard<std::mutex> lock(m_stats_mutex);
+				++m_stats.requests_completed;
+				m_stats.total_latency_ms += latency_ms;
+				m_stats.max_latency_ms = std::max(m_stats.max_latency_ms, latency_ms);
+			}
+			request->promise.set_value(request->raw_size);
+		}
+
+		void Fail(const std::shared_ptr<AssetRequest>& request)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_stats_mutex);
+				++m_stats.requests_failed;
+			}
+			request->promise.set_exception(std::make_exception_ptr(std::runtime_error("failed to stream " + request->path.string())));
+		}
+
+		void PushTask(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_task_mutex);
+				m_tasks.push_back(std::move(task));
+			}
+			m_task_cv.notify_one();
+		}
+
+		void WorkerThread()
+		{
+			for (;;)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_task_mutex);
+					m_task_cv.wait(lock, [this] { return !m_workers_running || !m_tasks.empty(); });
+					if (!m_workers_running && m_tasks.empty()) return;
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+		size_t m_chunk_size = 256 * 1024;
+		uint32_t m_max_reads_in_flight = 8;
+		uint64_t m_max_request_size = uint64_t(1) << 30;
+		bool m_running = false;
+		bool m_workers_running = false;
+
+		std::mutex m_mutex;
+		std::condition_variable m_request_cv;
+		std::priority_queue<std::shared_ptr<AssetRequest>, std::vector<std::shared_ptr<AssetRequest>>, RequestOrder> m_requests;
+		uint64_t m_sequence = 0;
+		std::thread m_io_thread;
+
+		std::mutex m_task_mutex;
+		std::condition_variable m_task_cv;
+		std::deque<std::function<void()>> m_tasks;
+		std::vector<std::thread> m_workers;
+
+		mutable std::mutex m_stats_mutex;
+		StreamStats m_stats;
+	};
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace BundleHelper
+{
+	// ̬ĻƲߺװ״̬¼bundleÿ֡ظ¼
+	struct StaticMesh
+	{
+		uint32_t mesh_id;
+		ID3D12Resource* vertex_buffer;
+		ID3D12Resource* index_buffer;
+		D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view;
+		D3D12_INDEX_BUFFER_VIEW index_buffer_view;
+		D3D12_PRIMITIVE_TOPOLOGY topology;
+		UINT index_count;
+		// Թһͬһģ͵ĸLOD
+		UINT start_index;
+	};
+
+	// ͹״̬ΪbundleԴͼ仯ʱԶ¼
+	class BundleCache
+	{
+	public:
+		// ÿ¼һbundleһΣΪbundle񡢹״̬͸ǩ
+		using RecordCallback = std::function<void(ID3D12GraphicsCommandList*, const StaticMesh&, ID3D12PipelineState*, ID3D12RootSignature*)>;
+
+		void Initial(Microsoft::WRL::ComPtr<ID3D12Device10> device)
+		{
+			m_device = device;
+		}
+
+		void SetRecordCallback(RecordCallback callback)
+		{
+			m_record_callback = std::move(callback);
+		}
+
+		// bundleебģͬbundle
+		// ǩ÷һ£bundleֻ״ִ̬к״ֱ̬бϣ
+		// ÿ֡仯ʵɵ÷ֱбϻ
+		template <typename CommandList>
+		static void RecordCommands(CommandList* list, const StaticMesh& mesh, ID3D12RootSignature* root_signature)
+		{
+			list->SetGraphicsRootSignature(root_signature);
+			list->IASetPrimitiveTopology(mesh.topology);
+			list->IASetVertexBuffers(0, 1, &mesh.vertex_buffer_view);
+			list->IASetIndexBuffer(&mesh.index_buffer_view);
+		}
+
+		// öӦbundlefence_valueΪ֡ύҪĸֵ
+		ID3D12GraphicsCommandList* GetBundle(const StaticMesh& mesh, ID3D12PipelineState* pipeline_state, ID3D12RootSignature* root_signature, uint64_t fence_value)
+		{
+			EntryKey key{mesh.mesh_id, pipeline_state};
+			auto it = m_entries.find(key);
+			if (it != m_entries.end() && !IsStale(it->second, mesh, root_signature))
+			{
+				it->second.last_used_fence = fence_value;
+				return it->second.bundle.Get();
+			}
+
+			// ɵbundleGPUִУȴɺͷ
+			if (it != m_entries.end())
+			{
+				Retire(std::move(it->second));
+				m_entries.erase(it);
+			}
+
+			Entry entry = Record(mesh, pipeline_state, root_signature);
+			entry.last_used_fence = fence_value;
+			ID3D12GraphicsCommandList* bundle = entry.bundle.Get();
+			m_entries.emplace(key, std::move(entry));
+			++m_record_count;
+			return bundle;
+		}
+
+		// ʹĳbundleʧЧ
+		void Invalidate(uint32_t mesh_id)
+		{
+			for (auto it = m_entries.begin(); it != m_entries.end();)
+			{
+				if (it->second.mesh.mesh_id == mesh_id)
+				{
+					Retire(std::move(it->second));
+					it = m_entries.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		// ͷGPUѾִϵĹbundle
+		void ReleaseRetired(uint64_t completed_fence_value)
+		{
+			m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+				[completed_fence_value](const Entry& entry) { return entry.last_used_fence <= completed_fence_value; }),
+				m_retired.end());
+		}
+
+		// ջ棬ǰȷGPUѿ
+		void Clear()
+		{
+			m_entries.clear();
+			m_retired.clear();
+		}
+
+		uint64_t RecordCount() const { return m_record_count; }
+		size_t Size() const { return m_entries.size(); }
+
+	private:
+		// ͹״̬ԣʱȽϣͬĻƲ䵽ͬһbundle
+		struct EntryKey
+		{
+			uint32_t mesh_id;
+			ID3D12PipelineState* pipeline_state;
+
+			bool operator==(const EntryKey& other) const
+			{
+				return mesh_id == other.mesh_id && pipeline_state == other.pipeline_state;
+			}
+		};
+
+		struct EntryKeyHash
+		{
+			size_t operator()(const EntryKey& key) const
+			{
+				return std::hash<uint64_t>()((static_cast<uint64_t>(key.mesh_id) << 32) ^ reinterpret_cast<uintptr_t>(key.pipeline_state));
+			}
+		};
+
+		struct Entry
+		{
+			StaticMesh mesh;
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> pipeline_state;
+			Microsoft::WRL::ComPtr<ID3D12RootSignature> root_signature;
+			// лã֤GPUַbundleڼ䲻ᱻ
+			Microsoft::WRL::ComPtr<ID3D12Resource> vertex_buffer;
+			Microsoft::WRL::ComPtr<ID3D12Resource> index_buffer;
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> bundle;
+			uint64_t last_used_fence = 0;
+		};
+
+		static bool IsStale(const Entry& entry, const StaticMesh& mesh, ID3D12RootSignature* root_signature)
+		{
+			return entry.root_signature.Get() != root_signature ||
+				entry.vertex_buffer.Get() != mesh.vertex_buffer ||
+				entry.index_buffer.Get() != mesh.index_buffer ||
+				entry.mesh.topology != mesh.topology ||
+				std::memcmp(&entry.mesh.vertex_buffer_view, &mesh.vertex_buffer_view, sizeof(D3D12_VERTEX_BUFFER_VIEW)) != 0 ||
+				std::memcmp(&entry.mesh.index_buffer_view, &mesh.index_buffer_view, sizeof(D3D12_INDEX_BUFFER_VIEW)) != 0;
+		}
+
+		Entry Record(const StaticMesh& mesh, ID3D12PipelineState* pipeline_state, ID3D12RootSignature* root_signature)
+		{
+			Entry entry{};
+			entry.mesh = mesh;
+			entry.pipeline_state = pipeline_state;
+			entry.root_signature = root_signature;
+			entry.vertex_buffer = mesh.vertex_buffer;
+			entry.index_buffer = mesh.index_buffer;
+
+			// bundleʹöķ¼ʱ滻
+			DxDebug::ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(entry.allocator.GetAddressOf())));
+			DxDebug::ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, entry.allocator.Get(), pipeline_state, IID_PPV_ARGS(entry.bundle.GetAddressOf())));
+
+			RecordCommands(entry.bundle.Get(), mesh, root_signature);
+			DxDebug::ThrowIfFailed(entry.bundle->Close());
+			if (m_record_callback) m_record_callback(entry.bundle.Get(), mesh, pipeline_state, root_signature);
+
+			return entry;
+		}
+
+		void Retire(Entry&& entry)
+		{
+			m_retired.push_back(std::move(entry));
+		}
+
+		Microsoft::WRL::ComPtr<ID3D12Device10> m_device;
+		std::unordered_map<EntryKey, Entry, EntryKeyHash> m_entries;
+		std::vector<Entry> m_retired;
+		uint64_t m_record_count = 0;
+		RecordCallback m_record_callback;
+	};
+}
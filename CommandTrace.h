@@ -0,0 +1,2730 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace TraceHelper
+{
+	// ---------------------------------------------------------------
+	// ٸʽļͷ + ¼ÿ¼Ϊ  | س | 
+	// еLEB128䳤룬зzigzagԭʼ4ֽڴ
+	// ԴбжӵȣòʱĵűʾGPUַ +ƫ
+	// ȡسʶĲ룬ɵĻطԶµĸ
+	// ---------------------------------------------------------------
+
+	static const char m_trace_magic[4] = {'D', 'X', 'T', 'R'};
+	static const uint32_t m_trace_version = 1;
+
+	enum class Op : uint8_t
+	{
+		// 󴴽ͷ
+		CreateBuffer = 1,
+		CreateTexture,
+		CreateDescriptorHeap,
+		CreateRenderTargetView,
+		CreateDepthStencilView,
+		CreateRootSignature,
+		CreateGraphicsPipeline,
+		CreateComputePipeline,
+		CreateCommandQueue,
+		CreateCommandList,
+		CreateFence,
+		Release,
+		// CPUдϴѵ
+		WriteBuffer,
+		// б¼
+		Reset,
+		Close,
+		ResourceBarrier,
+		CopyBufferRegion,
+		ClearRenderTargetView,
+		ClearDepthStencilView,
+		SetViewports,
+		SetScissorRects,
+		SetRenderTargets,
+		SetPipelineState,
+		SetRootSignature,
+		SetRoot32BitConstants,
+		SetRootDescriptor,
+		SetPrimitiveTopology,
+		SetVertexBuffers,
+		SetIndexBuffer,
+		DrawIndexedInstanced,
+		Dispatch,
+		ExecuteBundle,
+		// жӺͬ
+		ExecuteCommandLists,
+		Signal,
+		Wait,
+		WaitForFence,
+		// ߽֡
+		FrameBegin,
+		FrameEnd,
+	};
+
+	// D3D12ȡֵһµĳߺ˲d3d12.hҲܽ͸еֵ
+	static const uint32_t m_heap_type_default = 1;
+	static const uint32_t m_heap_type_upload = 2;
+	static const uint32_t m_heap_type_readback = 3;
+
+	static const uint32_t m_list_type_direct = 0;
+	static const uint32_t m_list_type_bundle = 1;
+	static const uint32_t m_list_type_compute = 2;
+	static const uint32_t m_list_type_copy = 3;
+
+	static const uint32_t m_state_common = 0;
+	static const uint32_t m_state_render_target = 0x4;
+	static const uint32_t m_state_unordered_access = 0x8;
+	static const uint32_t m_state_depth_write = 0x10;
+	static const uint32_t m_state_copy_dest = 0x400;
+	static const uint32_t m_state_copy_source = 0x800;
+
+	static const uint32_t m_barrier_transition = 0;
+	static const uint32_t m_barrier_uav = 2;
+
+	static const uint32_t m_dimension_buffer = 1;
+	static const uint32_t m_index_format_r16 = 57;
+	static const uint32_t m_index_format_r32 = 42;
+
+	// 
+	enum class RootDescriptor : uint32_t
+	{
+		Cbv,
+		Srv,
+		Uav,
+	};
+
+	struct ByteSpan
+	{
+		const uint8_t* data;
+		size_t size;
+	};
+
+	struct GpuAddress
+	{
+		uint32_t resource;
+		uint64_t offset;
+	};
+
+	struct DescriptorHandle
+	{
+		uint32_t heap;
+		uint32_t index;
+	};
+
+	struct BufferDesc
+	{
+		uint32_t heap_type;
+		uint64_t size;
+		uint32_t flags;
+		uint32_t state;
+	};
+
+	struct TextureDesc
+	{
+		uint32_t heap_type;
+		uint32_t dimension;
+		uint64_t width;
+		uint32_t height;
+		uint32_t depth_or_array_size;
+		uint32_t mip_levels;
+		uint32_t format;
+		uint32_t flags;
+		uint32_t state;
+	};
+
+	struct InputElement
+	{
+		std::string semantic;
+		uint32_t semantic_index;
+		uint32_t format;
+		uint32_t slot;
+		uint32_t offset;
+		uint32_t classification;
+		uint32_t step_rate;
+	};
+
+	struct GraphicsPipelineDesc
+	{
+		uint32_t root_signature;
+		uint32_t topology_type;
+		uint32_t rtv_format;
+		uint32_t dsv_format;
+		ByteSpan vs;
+		ByteSpan ps;
+		std::vector<InputElement> input_layout;
+	};
+
+	struct Barrier
+	{
+		uint32_t type;
+		uint32_t resource;
+		uint32_t subresource;
+		uint32_t before;
+		uint32_t after;
+	};
+
+	struct Viewport
+	{
+		float x, y, width, height, min_depth, max_depth;
+	};
+
+	struct Rect
+	{
+		int32_t left, top, right, bottom;
+	};
+
+	struct VertexBufferView
+	{
+		GpuAddress location;
+		uint32_t size;
+		uint32_t stride;
+	};
+
+	struct IndexBufferView
+	{
+		GpuAddress location;
+		uint32_t size;
+		uint32_t format;
+	};
+
+	// ˣڴƴӼ¼ʱһд̣֡ѭвļIO
+	class TraceWriter
+	{
+	public:
+		TraceWriter()
+		{
+			Clear();
+		}
+
+		void Clear()
+		{
+			m_data.clear();
+			m_data.insert(m_data.end(), m_trace_magic, m_trace_magic + 4);
+			for (uint32_t i = 0; i < 4; ++i) m_data.push_back(static_cast<uint8_t>(m_trace_version >> (i * 8)));
+			m_record_count = 0;
+		}
+
+		TraceWriter& Begin(Op op)
+		{
+			m_op = op;
+			m_payload.clear();
+			return *this;
+		}
+
+		TraceWriter& U(uint64_t value)
+		{
+			PutVarint(m_payload, value);
+			return *this;
+		}
+
+		TraceWriter& I(int64_t value)
+		{
+			PutVarint(m_payload, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+			return *this;
+		}
+
+		TraceWriter& F(float value)
+		{
+			uint8_t bytes[4];
+			std::memcpy(bytes, &value, 4);
+			m_payload.insert(m_payload.end(), bytes, bytes + 4);
+			return *this;
+		}
+
+		TraceWriter& Bytes(const void* data, size_t size)
+		{
+			PutVarint(m_payload, size);
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			m_payload.insert(m_payload.end(), bytes, bytes + size);
+			return *this;
+		}
+
+		TraceWriter& String(const char* text)
+		{
+			return Bytes(text, std::strlen(text));
+		}
+
+		void End()
+		{
+			m_data.push_back(static_cast<uint8_t>(m_op));
+			PutVarint(m_data, m_payload.size());
+			m_data.insert(m_data.end(), m_payload.begin(), m_payload.end());
+			++m_record_count;
+		}
+
+		// дʱļٸ;ʧܲ°
+		bool Save(const std::filesystem::path& path) const
+		{
+			std::filesystem::path temporary = path;
+			temporary += ".tmp";
+			FILE* file = nullptr;
+#if defined(_WIN32)
+			_wfopen_s(&file, temporary.c_str(), L"wb");
+#else
+			file = std::fopen(temporary.c_str(), "wb");
+#endif
+			if (!file) return false;
+			bool written = std::fwrite(m_data.data(), 1, m_data.size(), file) == m_data.size();
+			written = std::fclose(file) == 0 && written;
+			std::error_code error;
+			if (written) std::filesystem::rename(temporary, path, error);
+			if (!written || error)
+			{
+				std::filesystem::remove(temporary, error);
+				return false;
+			}
+			return true;
+		}
+
+		size_t Size() const { return m_data.size(); }
+		uint64_t RecordCount() const { return m_record_count; }
+		const std::vector<uint8_t>& Data() const { return m_data; }
+
+	private:
+		static void PutVarint(std::vector<uint8_t>& out, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		std::vector<uint8_t> m_data;
+		std::vector<uint8_t> m_payload;
+		Op m_op = Op::FrameEnd;
+		uint64_t m_record_count = 0;
+	};
+
+	// һ¼ĸα꣬Խʱʧܱ־0÷ڼ¼ͳһ
+	class RecordReader
+	{
+	public:
+		RecordReader() = default;
+		RecordReader(const uint8_t* begin, const uint8_t* end) : m_cursor(begin), m_end(end)
+		{
+		}
+
+		uint64_t U()
+		{
+			uint64_t value = 0;
+			for (uint32_t shift = 0; shift < 64; shift += 7)
+			{
+				if (m_cursor >= m_end) break;
+				uint8_t byte = *m_cursor++;
+				value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) return value;
+			}
+			m_failed = true;
+			return 0;
+		}
+
+		uint32_t U32()
+		{
+			uint64_t value = U();
+			if (value > UINT32_MAX) m_failed = true;
+			return static_cast<uint32_t>(value);
+		}
+
+		int64_t I()
+		{
+			uint64_t value = U();
+			return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+		}
+
+		float F()
+		{
+			float value = 0.0f;
+			if (m_end - m_cursor < 4)
+			{
+				m_failed = true;
+				return value;
+			}
+			std::memcpy(&value, m_cursor, 4);
+			m_cursor += 4;
+			return value;
+		}
+
+		ByteSpan Bytes()
+		{
+			uint64_t size = U();
+			if (size > static_cast<uint64_t>(m_end - m_cursor))
+			{
+				m_failed = true;
+				return {nullptr, 0};
+			}
+			ByteSpan span{m_cursor, static_cast<size_t>(size)};
+			m_cursor += size;
+			return span;
+		}
+
+		const uint8_t* Position() const { return m_cursor; }
+		bool Failed() const { return m_failed; }
+
+	private:
+		const uint8_t* m_cursor = nullptr;
+		const uint8_t* m_end = nullptr;
+		bool m_failed = false;
+	};
+
+	// ȡļļͷ
+	class TraceReader
+	{
+	public:
+		bool Open(const std::filesystem::path& path)
+		{
+			m_data.clear();
+			std::error_code error;
+			uintmax_t size = std::filesystem::file_size(path, error);
+			if (error || size < 8) return false;
+			FILE* file = nullptr;
+#if defined(_WIN32)
+			_wfopen_s(&file, path.c_str(), L"rb");
+#else
+			file = std::fopen(path.c_str(), "rb");
+#endif
+			if (!file) return false;
+			m_data.resize(static_cast<size_t>(size));
+			bool read = std::fread(m_data.data(), 1, m_data.size(), file) == m_data.size();
+			std::fclose(file);
+			return read && Validate();
+		}
+
+		bool Load(std::vector<uint8_t> data)
+		{
+			m_data = std::move(data);
+			return Validate();
+		}
+
+		// ¼ֹλ
+		const uint8_t* Begin() const { return m_data.data() + 8; }
+		const uint8_t* End() const { return m_data.data() + m_data.size(); }
+		size_t Size() const { return m_data.size(); }
+
+	private:
+		bool Validate()
+		{
+			uint32_t version = 0;
+			if (m_data.size() < 8 || std::memcmp(m_data.data(), m_trace_magic, 4) != 0)
+			{
+				m_data.clear();
+				return false;
+			}
+			for (uint32_t i = 0; i < 4; ++i) version |= static_cast<uint32_t>(m_data[4 + i]) << (i * 8);
+			if (version != m_trace_version)
+			{
+				m_data.clear();
+				return false;
+			}
+			return true;
+		}
+
+		std::vector<uint8_t> m_data;
+	};
+
+	// ¼¼ͷ𻵻Խʱfalseʧܱ־
+	class RecordCursor
+	{
+	public:
+		RecordCursor(const uint8_t* begin, const uint8_t* end) : m_cursor(begin), m_end(end)
+		{
+		}
+
+		bool Next(Op& op, RecordReader& record)
+		{
+			if (m_cursor >= m_end) return false;
+			const uint8_t* position = m_cursor;
+			op = static_cast<Op>(*m_cursor++);
+			RecordReader header(m_cursor, m_end);
+			uint64_t size = header.U();
+			m_cursor = header.Position();
+			if (header.Failed() || size > static_cast<uint64_t>(m_end - m_cursor))
+			{
+				m_cursor = position;
+				m_failed = true;
+				return false;
+			}
+			record = RecordReader(m_cursor, m_cursor + size);
+			m_cursor += size;
+			return true;
+		}
+
+		const uint8_t* Position() const { return m_cursor; }
+		void Seek(const uint8_t* position) { m_cursor = position; }
+		bool Failed() const { return m_failed; }
+
+	private:
+		const uint8_t* m_cursor;
+		const uint8_t* m_end;
+		bool m_failed = false;
+	};
+
+	// طͳƣؽ׶Σһ֮֡ǰĴϴʱ֮֡¼CPUʱ
+	struct ReplayStats
+	{
+		double load_ms = 0.0;
+		std::vector<double> frame_ms;
+		uint64_t records = 0;
+		uint64_t frame_records = 0;
+		uint64_t frame_bytes = 0;
+		uint64_t skipped_records = 0;
+
+		uint32_t Frames() const { return static_cast<uint32_t>(frame_ms.size()); }
+
+		double MeanMs() const
+		{
+			double sum = 0.0;
+			for (double ms : frame_ms) sum += ms;
+			return frame_ms.empty() ? 0.0 : sum / frame_ms.size();
+		}
+
+		// pΪ[0, 1]ȡֵ
+		double PercentileMs(double p) const
+		{
+			if (frame_ms.empty()) return 0.0;
+			std::vector<double> sorted = frame_ms;
+			size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+			rank = std::min(std::max<size_t>(rank, 1), sorted.size()) - 1;
+			std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+			return sorted[rank];
+		}
+
+		double MaxMs() const
+		{
+			return frame_ms.empty() ? 0.0 : *std::max_element(frame_ms.begin(), frame_ms.end());
+		}
+	};
+
+	// ˳ÿ¼󽻸ˣṩͬͣ豸˻CPUˣ
+	// loops1ʱؽ׶ִֻһΣ֡ظִУֵÿƽƣ֤
+	template <typename Backend>
+	bool Replay(const TraceReader& trace, Backend& backend, uint32_t loops, ReplayStats& stats)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		// ɨһ飬ҵֵ֡Լÿ֮֡ǰеźֵ
+		const uint8_t* frames_begin = nullptr;
+		std::vector<uint64_t> fence_base;
+		std::vector<uint64_t> fence_max;
+		{
+			RecordCursor cursor(trace.Begin(), trace.End());
+			const uint8_t* position = cursor.Position();
+			Op op;
+			RecordReader record;
+			while (cursor.Next(op, record))
+			{
+				if (op == Op::FrameBegin && !frames_begin)
+				{
+					frames_begin = position;
+				}
+				if (op == Op::CreateFence || op == Op::Signal)
+				{
+					if (op == Op::Signal) record.U32();
+					uint32_t fence = record.U32();
+					uint64_t value = record.U();
+					if (fence >= fence_max.size())
+					{
+						fence_base.resize(fence + 1, 0);
+						fence_max.resize(fence + 1, 0);
+					}
+					fence_max[fence] = std::max(fence_max[fence], value);
+					if (!frames_begin) fence_base[fence] = fence_max[fence];
+				}
+				position = cursor.Position();
+			}
+			if (cursor.Failed()) return false;
+		}
+
+		std::vector<uint64_t> fence_offset(fence_max.size(), 0);
+		// õʱطиãطű֡ڷڴ
+		std::vector<Barrier> barriers;
+		std::vector<Viewport> viewports;
+		std::vector<Rect> rects;
+		std::vector<DescriptorHandle> render_targets;
+		std::vector<VertexBufferView> vertex_buffers;
+		std::vector<uint32_t> lists;
+		GraphicsPipelineDesc pipeline_desc{};
+
+		auto fence_value = [&](uint32_t fence, uint64_t value)
+		{
+			return fence < fence_offset.size() ? value + fence_offset[fence] : value;
+		};
+
+		Clock::time_point load_begin = Clock::now();
+		Clock::time_point frame_begin = load_begin;
+		bool in_frame = false;
+		bool loaded = false;
+		for (uint32_t loop = 0; loop < std::max(loops, 1u); ++loop)
+		{
+			RecordCursor cursor(loop == 0 || !frames_begin ? trace.Begin() : frames_begin, trace.End());
+			if (loop > 0)
+			{
+				if (!frames_begin) break;
+				for (size_t fence = 0; fence < fence_offset.size(); ++fence)
+				{
+					fence_offset[fence] += fence_max[fence] - fence_base[fence];
+				}
+			}
+			Op op;
+			RecordReader r;
+			const uint8_t* record_begin = cursor.Position();
+			while (cursor.Next(op, r))
+			{
+				++stats.records;
+				if (in_frame)
+				{
+					++stats.frame_records;
+					stats.frame_bytes += cursor.Position() - record_begin;
+				}
+				switch (op)
+				{
+				case Op::CreateBuffer:
+				{
+					uint32_t id = r.U32();
+					BufferDesc desc{};
+					desc.heap_type = r.U32();
+					desc.size = r.U();
+					desc.flags = r.U32();
+					desc.state = r.U32();
+					if (!r.Failed()) backend.CreateBuffer(id, desc);
+					break;
+				}
+				case Op::CreateTexture:
+				{
+					uint32_t id = r.U32();
+					TextureDesc desc{};
+					desc.heap_type = r.U32();
+					desc.dimension = r.U32();
+					desc.width = r.U();
+					desc.height = r.U32();
+					desc.depth_or_array_size = r.U32();
+					desc.mip_levels = r.U32();
+					desc.format = r.U32();
+					desc.flags = r.U32();
+					desc.state = r.U32();
+					if (!r.Failed()) backend.CreateTexture(id, desc);
+					break;
+				}
+				case Op::CreateDescriptorHeap:
+				{
+					uint32_t id = r.U32();
+					uint32_t type = r.U32();
+					uint32_t count = r.U32();
+					if (!r.Failed()) backend.CreateDescriptorHeap(id, type, count);
+					break;
+				}
+				case Op::CreateRenderTargetView:
+				{
+					DescriptorHandle handle{r.U32(), r.U32()};
+					uint32_t resource = r.U32();
+					if (!r.Failed()) backend.CreateRenderTargetView(handle, resource);
+					break;
+				}
+				case Op::CreateDepthStencilView:
+				{
+					DescriptorHandle handle{r.U32(), r.U32()};
+					uint32_t resource = r.U32();
+					uint32_t format = r.U32();
+					if (!r.Failed()) backend.CreateDepthStencilView(handle, resource, format);
+					break;
+				}
+				case Op::CreateRootSignature:
+				{
+					uint32_t id = r.U32();
+					ByteSpan blob = r.Bytes();
+					if (!r.Failed()) backend.CreateRootSignature(id, blob);
+					break;
+				}
+				case Op::CreateGraphicsPipeline:
+				{
+					uint32_t id = r.U32();
+					pipeline_desc.root_signature = r.U32();
+					pipeline_desc.topology_type = r.U32();
+					pipeline_desc.rtv_format = r.U32();
+					pipeline_desc.dsv_format = r.U32();
+					pipeline_desc.vs = r.Bytes();
+					pipeline_desc.ps = r.Bytes();
+					uint32_t element_count = r.U32();
+					pipeline_desc.input_layout.clear();
+					for (uint32_t i = 0; i < element_count && !r.Failed(); ++i)
+					{
+						InputElement element{};
+						ByteSpan semantic = r.Bytes();
+						element.semantic.assign(reinterpret_cast<const char*>(semantic.data), semantic.size);
+						element.semantic_index = r.U32();
+						element.format = r.U32();
+						element.slot = r.U32();
+						element.offset = r.U32();
+						element.classification = r.U32();
+						element.step_rate = r.U32();
+						pipeline_desc.input_layout.push_back(std::move(element));
+					}
+					if (!r.Failed()) backend.CreateGraphicsPipeline(id, pipeline_desc);
+					break;
+				}
+				case Op::CreateComputePipeline:
+				{
+					uint32_t id = r.U32();
+					uint32_t root_signature = r.U32();
+					ByteSpan cs = r.Bytes();
+					if (!r.Failed()) backend.CreateComputePipeline(id, root_signature, cs);
+					break;
+				}
+				case Op::CreateCommandQueue:
+				case Op::CreateCommandList:
+				{
+					uint32_t id = r.U32();
+					uint32_t type = r.U32();
+					if (r.Failed()) break;
+					if (op == Op::CreateCommandQueue) backend.CreateCommandQueue(id, type);
+					else backend.CreateCommandList(id, type);
+					break;
+				}
+				case Op::CreateFence:
+				{
+					uint32_t id = r.U32();
+					uint64_t value = r.U();
+					if (!r.Failed()) backend.CreateFence(id, value);
+					break;
+				}
+				case Op::Release:
+				{
+					uint32_t id = r.U32();
+					if (!r.Failed()) backend.Release(id);
+					break;
+				}
+				case Op::WriteBuffer:
+				{
+					uint32_t resource = r.U32();
+					uint64_t offset = r.U();
+					ByteSpan data = r.Bytes();
+					if (!r.Failed()) backend.WriteBuffer(resource, offset, data);
+					break;
+				}
+				case Op::Reset:
+				{
+					uint32_t list = r.U32();
+					uint32_t pipeline_state = r.U32();
+					if (!r.Failed()) backend.Reset(list, pipeline_state);
+					break;
+				}
+				case Op::Close:
+				{
+					uint32_t list = r.U32();
+					if (!r.Failed()) backend.Close(list);
+					break;
+				}
+				case Op::ResourceBarrier:
+				{
+					uint32_t list = r.U32();
+					uint32_t count = r.U32();
+					barriers.clear();
+					for (uint32_t i = 0; i < count && !r.Failed(); ++i)
+					{
+						Barrier barrier{};
+						barrier.type = r.U32();
+						barrier.resource = r.U32();
+						barrier.subresource = r.U32();
+						barrier.before = r.U32();
+						barrier.after = r.U32();
+						barriers.push_back(barrier);
+					}
+					if (!r.Failed()) backend.ResourceBarrier(list, barriers.data(), count);
+					break;
+				}
+				case Op::CopyBufferRegion:
+				{
+					uint32_t list = r.U32();
+					GpuAddress destination{r.U32(), r.U()};
+					GpuAddress source{r.U32(), r.U()};
+					uint64_t size = r.U();
+					if (!r.Failed()) backend.CopyBufferRegion(list, destination, source, size);
+					break;
+				}
+				case Op::ClearRenderTargetView:
+				{
+					uint32_t list = r.U32();
+					DescriptorHandle handle{r.U32(), r.U32()};
+					float color[4];
+					for (float& channel : color) channel = r.F();
+					if (!r.Failed()) backend.ClearRenderTargetView(list, handle, color);
+					break;
+				}
+				case Op::ClearDepthStencilView:
+				{
+					uint32_t list = r.U32();
+					DescriptorHandle handle{r.U32(), r.U32()};
+					uint32_t flags = r.U32();
+					float depth = r.F();
+					uint32_t stencil = r.U32();
+					if (!r.Failed()) backend.ClearDepthStencilView(list, handle, flags, depth, stencil);
+					break;
+				}
+				case Op::SetViewports:
+				{
+					uint32_t list = r.U32();
+					uint32_t count = r.U32();
+					viewports.clear();
+					for (uint32_t i = 0; i < count && !r.Failed(); ++i)
+					{
+						Viewport viewport{};
+						viewport.x = r.F();
+						viewport.y = r.F();
+						viewport.width = r.F();
+						viewport.height = r.F();
+						viewport.min_depth = r.F();
+						viewport.max_depth = r.F();
+						viewports.push_back(viewport);
+					}
+					if (!r.Failed()) backend.SetViewports(list, viewports.data(), count);
+					break;
+				}
+				case Op::SetScissorRects:
+				{
+					uint32_t list = r.U32();
+					uint32_t count = r.U32();
+					rects.clear();
+					for (uint32_t i = 0; i < count && !r.Failed(); ++i)
+					{
+						Rect rect{};
+						rect.left = static_cast<int32_t>(r.I());
+						rect.top = static_cast<int32_t>(r.I());
+						rect.right = static_cast<int32_t>(r.I());
+						rect.bottom = static_cast<int32_t>(r.I());
+						rects.push_back(rect);
+					}
+					if (!r.Failed()) backend.SetScissorRects(list, rects.data(), count);
+					break;
+				}
+				case Op::SetRenderTargets:
+				{
+					uint32_t list = r.U32();
+					uint32_t count = r.U32();
+					render_targets.clear();
+					for (uint32_t i = 0; i < count && !r.Failed(); ++i)
+					{
+						render_targets.push_back({r.U32(), r.U32()});
+					}
+					bool has_depth_stencil = r.U() != 0;
+					DescriptorHandle depth_stencil{};
+					if (has_depth_stencil) depth_stencil = {r.U32(), r.U32()};
+					if (!r.Failed()) backend.SetRenderTargets(list, render_targets.data(), count, has_depth_stencil ? &depth_stencil : nullptr);
+					break;
+				}
+				case Op::SetPipelineState:
+				{
+					uint32_t list = r.U32();
+					uint32_t pipeline_state = r.U32();
+					if (!r.Failed()) backend.SetPipelineState(list, pipeline_state);
+					break;
+				}
+				case Op::SetRootSignature:
+				{
+					uint32_t list = r.U32();
+					bool compute = r.U() != 0;
+					uint32_t root_signature = r.U32();
+					if (!r.Failed()) backend.SetRootSignature(list, compute, root_signature);
+					break;
+				}
+				case Op::SetRoot32BitConstants:
+				{
+					uint32_t list = r.U32();
+					bool compute = r.U() != 0;
+					uint32_t parameter = r.U32();
+					uint32_t destination_offset = r.U32();
+					ByteSpan values = r.Bytes();
+					if (!r.Failed()) backend.SetRoot32BitConstants(list, compute, parameter, values, destination_offset);
+					break;
+				}
+				case Op::SetRootDescriptor:
+				{
+					uint32_t list = r.U32();
+					bool compute = r.U() != 0;
+					RootDescriptor kind = static_cast<RootDescriptor>(r.U32());
+					uint32_t parameter = r.U32();
+					GpuAddress location{r.U32(), r.U()};
+					if (!r.Failed()) backend.SetRootDescriptor(list, compute, kind, parameter, location);
+					break;
+				}
+				case Op::SetPrimitiveTopology:
+				{
+					uint32_t list = r.U32();
+					uint32_t topology = r.U32();
+					if (!r.Failed()) backend.SetPrimitiveTopology(list, topology);
+					break;
+				}
+				case Op::SetVertexBuffers:
+				{
+					uint32_t list = r.U32();
+					uint32_t start_slot = r.U32();
+					uint32_t count = r.U32();
+					vertex_buffers.clear();
+					for (uint32_t i = 0; i < count && !r.Failed(); ++i)
+					{
+						VertexBufferView view{};
+						view.location = {r.U32(), r.U()};
+						view.size = r.U32();
+						view.stride = r.U32();
+						vertex_buffers.push_back(view);
+					}
+					if (!r.Failed()) backend.SetVertexBuffers(list, start_slot, vertex_buffers.data(), count);
+					break;
+				}
+				case Op::SetIndexBuffer:
+				{
+					uint32_t list = r.U32();
+					IndexBufferView view{};
+					view.location = {r.U32(), r.U()};
+					view.size = r.U32();
+					view.format = r.U32();
+					if (!r.Failed()) backend.SetIndexBuffer(list, view);
+					break;
+				}
+				case Op::DrawIndexedInstanced:
+				{
+					uint32_t list = r.U32();
+					uint32_t index_count = r.U32();
+					uint32_t instance_count = r.U32();
+					uint32_t start_index = r.U32();
+					int32_t base_vertex = static_cast<int32_t>(r.I());
+					uint32_t start_instance = r.U32();
+					if (!r.Failed()) backend.DrawIndexedInstanced(list, index_count, instance_count, start_index, base_vertex, start_instance);
+					break;
+				}
+				case Op::Dispatch:
+				{
+					uint32_t list = r.U32();
+					uint32_t x = r.U32();
+					uint32_t y = r.U32();
+					uint32_t z = r.U32();
+					if (!r.Failed()) backend.Dispatch(list, x, y, z);
+					break;
+				}
+				case Op::ExecuteBundle:
+				{
+					uint32_t list = r.U32();
+					uint32_t bundle = r.U32();
+					if (!r.Failed()) backend.ExecuteBundle(list, bundle);
+					break;
+				}
+				case Op::ExecuteCommandLists:
+				{
+					uint32_t queue = r.U32();
+					uint32_t count = r.U32();
+					lists.clear();
+					for (uint32_t i = 0; i < count && !r.Failed(); ++i) lists.push_back(r.U32());
+					if (!r.Failed()) backend.ExecuteCommandLists(queue, lists.data(), count);
+					break;
+				}
+				case Op::Signal:
+				case Op::Wait:
+				{
+					uint32_t queue = r.U32();
+					uint32_t fence = r.U32();
+					uint64_t value = r.U();
+					if (r.Failed()) break;
+					if (op == Op::Signal) backend.Signal(queue, fence, fence_value(fence, value));
+					else backend.Wait(queue, fence, fence_value(fence, value));
+					break;
+				}
+				case Op::WaitForFence:
+				{
+					uint32_t fence = r.U32();
+					uint64_t value = r.U();
+					if (!r.Failed()) backend.WaitForFence(fence, fence_value(fence, value));
+					break;
+				}
+				case Op::FrameBegin:
+				{
+					uint32_t frame = r.U32();
+					if (r.Failed()) break;
+					Clock::time_point now = Clock::now();
+					if (!loaded)
+					{
+						stats.load_ms = std::chrono::duration<double, std::milli>(now - load_begin).count();
+						loaded = true;
+					}
+					backend.FrameBegin(frame);
+					frame_begin = Clock::now();
+					in_frame = true;
+					break;
+				}
+				case Op::FrameEnd:
+				{
+					backend.FrameEnd();
+					if (in_frame)
+					{
+						stats.frame_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frame_begin).count());
+					}
+					in_frame = false;
+					break;
+				}
+				default:
+					++stats.skipped_records;
+					break;
+				}
+				if (r.Failed()) return false;
+				record_begin = cursor.Position();
+			}
+			if (cursor.Failed()) return false;
+		}
+		return true;
+	}
+
+	// ߻طŵͳƣvalidation_errors˵ΥԴ״̬󶨹
+	struct CpuReplayStats
+	{
+		uint64_t commands = 0;
+		uint64_t submissions = 0;
+		uint64_t draws = 0;
+		uint64_t indices = 0;
+		uint64_t dispatches = 0;
+		uint64_t barriers = 0;
+		uint64_t copies = 0;
+		uint64_t bytes_copied = 0;
+		uint64_t bytes_written = 0;
+		uint64_t validation_errors = 0;
+	};
+
+	// CPUˣGPUd3d12LinuxҲܻط
+	// ¼ʱÿбԼ飬ύʱGPU˳ִУԴ״̬Ͱ󶨣ִлд͸ƣͳƻƺɷ
+	// ύɣSignalʱʹﵽӦֵȴһδֵʵ豸ϻΪ
+	class CpuBackend
+	{
+	public:
+		void CreateBuffer(uint32_t id, const BufferDesc& desc)
+		{
+			Object& object = Create(id, Kind::Buffer);
+			object.heap_type = desc.heap_type;
+			object.state = desc.state;
+			object.memory.assign(static_cast<size_t>(desc.size), 0);
+		}
+
+		void CreateTexture(uint32_t id, const TextureDesc& desc)
+		{
+			Object& object = Create(id, Kind::Texture);
+			object.heap_type = desc.heap_type;
+			object.state = desc.state;
+		}
+
+		void CreateDescriptorHeap(uint32_t id, uint32_t, uint32_t count)
+		{
+			Create(id, Kind::DescriptorHeap).views.assign(count, 0);
+		}
+
+		void CreateRenderTargetView(DescriptorHandle handle, uint32_t resource)
+		{
+			if (uint32_t* view = View(handle)) *view = resource;
+		}
+
+		void CreateDepthStencilView(DescriptorHandle handle, uint32_t resource, uint32_t)
+		{
+			if (uint32_t* view = View(handle)) *view = resource;
+		}
+
+		void CreateRootSignature(uint32_t id, ByteSpan)
+		{
+			Create(id, Kind::RootSignature);
+		}
+
+		void CreateGraphicsPipeline(uint32_t id, const GraphicsPipelineDesc& desc)
+		{
+			Object& object = Create(id, Kind::Pipeline);
+			object.root_signature = desc.root_signature;
+			object.compute = false;
+		}
+
+		void CreateComputePipeline(uint32_t id, uint32_t root_signature, ByteSpan)
+		{
+			Object& object = Create(id, Kind::Pipeline);
+			object.root_signature = root_signature;
+			object.compute = true;
+		}
+
+		void CreateCommandQueue(uint32_t id, uint32_t)
+		{
+			Create(id, Kind::Queue);
+		}
+
+		void CreateCommandList(uint32_t id, uint32_t type)
+		{
+			Create(id, Kind::List).list_type = type;
+		}
+
+		void CreateFence(uint32_t id, uint64_t value)
+		{
+			Create(id, Kind::Fence).fence_value = value;
+		}
+
+		void Release(uint32_t id)
+		{
+			if (id < m_objects.size()) m_objects[id] = Object{};
+		}
+
+		void WriteBuffer(uint32_t resource, uint64_t offset, ByteSpan data)
+		{
+			Object* buffer = Find(resource, Kind::Buffer);
+			if (!buffer || buffer->heap_type != m_heap_type_upload || offset + data.size > buffer->memory.size())
+			{
+				Error("WriteBuffer outside an upload buffer", resource);
+				return;
+			}
+			std::memcpy(buffer->memory.data() + offset, data.data, data.size);
+			m_stats.bytes_written += data.size;
+		}
+
+		void Reset(uint32_t list, uint32_t pipeline_state)
+		{
+			Object* object = Find(list, Kind::List);
+			if (!object || object->open)
+			{
+				Error("Reset on a missing or open command list", list);
+				return;
+			}
+			object->open = true;
+			object->initial_pipeline = pipeline_state;
+			object->commands.clear();
+			object->constants.clear();
+		}
+
+		void Close(uint32_t list)
+		{
+			if (Object* object = Recording(list)) object->open = false;
+		}
+
+		void ResourceBarrier(uint32_t list, const Barrier* barriers, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Record(list, {Op::ResourceBarrier, barriers[i].type, barriers[i].resource, barriers[i].before, barriers[i].after});
+			}
+		}
+
+		void CopyBufferRegion(uint32_t list, GpuAddress destination, GpuAddress source, uint64_t size)
+		{
+			Record(list, {Op::CopyBufferRegion, destination.resource, source.resource, 0, 0, destination.offset, source.offset, size});
+		}
+
+		void ClearRenderTargetView(uint32_t list, DescriptorHandle handle, const float*)
+		{
+			Record(list, {Op::ClearRenderTargetView, handle.heap, handle.index});
+		}
+
+		void ClearDepthStencilView(uint32_t list, DescriptorHandle handle, uint32_t, float, uint32_t)
+		{
+			Record(list, {Op::ClearDepthStencilView, handle.heap, handle.index});
+		}
+
+		void SetViewports(uint32_t list, const Viewport*, uint32_t count)
+		{
+			Record(list, {Op::SetViewports, count});
+		}
+
+		void SetScissorRects(uint32_t list, const Rect*, uint32_t count)
+		{
+			Record(list, {Op::SetScissorRects, count});
+		}
+
+		void SetRenderTargets(uint32_t list, const DescriptorHandle* render_targets, uint32_t count, const DescriptorHandle* depth_stencil)
+		{
+			DescriptorHandle first = count ? render_targets[0] : DescriptorHandle{0, 0};
+			uint64_t depth = depth_stencil ? (static_cast<uint64_t>(depth_stencil->heap) << 32 | depth_stencil->index) : 0;
+			Record(list, {Op::SetRenderTargets, count, first.heap, first.index, depth_stencil != nullptr, depth});
+		}
+
+		void SetPipelineState(uint32_t list, uint32_t pipeline_state)
+		{
+			Record(list, {Op::SetPipelineState, pipeline_state});
+		}
+
+		void SetRootSignature(uint32_t list, bool compute, uint32_t root_signature)
+		{
+			Record(list, {Op::SetRootSignature, root_signature, compute});
+		}
+
+		// ֵƵбԼĴ洢У¼ʱΪһ
+		void SetRoot32BitConstants(uint32_t list, bool compute, uint32_t parameter, ByteSpan values, uint32_t)
+		{
+			Object* object = Recording(list);
+			if (!object) return;
+			uint32_t offset = static_cast<uint32_t>(object->constants.size());
+			object->constants.insert(object->constants.end(), values.data, values.data + values.size);
+			object->commands.push_back({Op::SetRoot32BitConstants, compute, parameter, offset, static_cast<uint32_t>(values.size)});
+		}
+
+		void SetRootDescriptor(uint32_t list, bool compute, RootDescriptor kind, uint32_t parameter, GpuAddress location)
+		{
+			Record(list, {Op::SetRootDescriptor, compute, static_cast<uint32_t>(kind), parameter, location.resource, location.offset});
+		}
+
+		void SetPrimitiveTopology(uint32_t list, uint32_t topology)
+		{
+			Record(list, {Op::SetPrimitiveTopology, topology});
+		}
+
+		void SetVertexBuffers(uint32_t list, uint32_t start_slot, const VertexBufferView* views, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Record(list, {Op::SetVertexBuffers, start_slot + i, views[i].stride, 0, views[i].location.resource, views[i].location.offset, views[i].size});
+			}
+		}
+
+		void SetIndexBuffer(uint32_t list, const IndexBufferView& view)
+		{
+			Record(list, {Op::SetIndexBuffer, view.format, 0, 0, view.location.resource, view.location.offset, view.size});
+		}
+
+		void DrawIndexedInstanced(uint32_t list, uint32_t index_count, uint32_t instance_count, uint32_t start_index, int32_t, uint32_t)
+		{
+			Record(list, {Op::DrawIndexedInstanced, index_count, instance_count, start_index});
+		}
+
+		void Dispatch(uint32_t list, uint32_t x, uint32_t y, uint32_t z)
+		{
+			Record(list, {Op::Dispatch, x, y, z});
+		}
+
+		void ExecuteBundle(uint32_t list, uint32_t bundle)
+		{
+			Record(list, {Op::ExecuteBundle, bundle});
+		}
+
+		void ExecuteCommandLists(uint32_t queue, const uint32_t* lists, uint32_t count)
+		{
+			if (!Find(queue, Kind::Queue)) Error("ExecuteCommandLists on a missing queue", queue);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Object* list = Find(lists[i], Kind::List);
+				if (!list || list->open || list->list_type == m_list_type_bundle)
+				{
+					Error("ExecuteCommandLists with a missing, open or bundle list", lists[i]);
+					continue;
+				}
+				ExecutionState state{};
+				Execute(*list, state);
+				++m_stats.submissions;
+			}
+			// Ĭ϶еĻύʱ˥commonϴѺͻضѱ̶ֹ״̬
+			for (uint32_t resource : m_touched_buffers)
+			{
+				Object& buffer = m_objects[resource];
+				if (buffer.kind == Kind::Buffer && buffer.heap_type == m_heap_type_default) buffer.state = m_state_common;
+			}
+			m_touched_buffers.clear();
+		}
+
+		void Signal(uint32_t, uint32_t fence, uint64_t value)
+		{
+			Object* object = Find(fence, Kind::Fence);
+			if (!object)
+			{
+				Error("Signal on a missing fence", fence);
+				return;
+			}
+			object->fence_value = std::max(object->fence_value, value);
+		}
+
+		void Wait(uint32_t, uint32_t fence, uint64_t value)
+		{
+			WaitForFence(fence, value);
+		}
+
+		void WaitForFence(uint32_t fence, uint64_t value)
+		{
+			Object* object = Find(fence, Kind::Fence);
+			if (!object || object->fence_value < value) Error("wait on a fence value that is never signaled", fence);
+		}
+
+		void FrameBegin(uint32_t frame)
+		{
+			m_frame = frame;
+		}
+
+		void FrameEnd()
+		{
+		}
+
+		const CpuReplayStats& Stats() const { return m_stats; }
+		const std::string& FirstError() const { return m_first_error; }
+
+		// лݵĹϣͬһٶλطŵĽӦһ
+		uint64_t Checksum() const
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (const Object& object : m_objects)
+			{
+				for (uint8_t byte : object.memory)
+				{
+					hash = (hash ^ byte) * 1099511628211ull;
+				}
+			}
+			return hash;
+		}
+
+	private:
+		enum class Kind : uint8_t
+		{
+			None,
+			Buffer,
+			Texture,
+			DescriptorHeap,
+			RootSignature,
+			Pipeline,
+			Queue,
+			List,
+			Fence,
+		};
+
+		// ֶεĺɲ
+		struct Command
+		{
+			Op op;
+			uint32_t a = 0, b = 0, c = 0, d = 0;
+			uint64_t x = 0, y = 0, z = 0;
+		};
+
+		struct Object
+		{
+			Kind kind = Kind::None;
+			uint32_t heap_type = 0;
+			uint32_t state = 0;
+			std::vector<uint8_t> memory;
+			std::vector<uint32_t> views;
+			uint32_t root_signature = 0;
+			bool compute = false;
+			uint32_t list_type = 0;
+			bool open = false;
+			uint32_t initial_pipeline = 0;
+			std::vector<Command> commands;
+			std::vector<uint8_t> constants;
+			uint64_t fence_value = 0;
+		};
+
+		// һִеİ״̬bundleڵ÷״ִ̬УõĹߺװ״̬÷
+		struct ExecutionState
+		{
+			uint32_t pipeline = 0;
+			uint32_t root_signature[2] = {0, 0};
+			uint32_t topology = 0;
+			bool has_vertex_buffer = false;
+			uint32_t index_buffer = 0;
+			uint64_t index_offset = 0;
+			uint64_t index_size = 0;
+			uint32_t index_format = 0;
+			uint32_t render_target = 0;
+		};
+
+		Object& Create(uint32_t id, Kind kind)
+		{
+			if (id >= m_objects.size()) m_objects.resize(id + 1);
+			Object& object = m_objects[id];
+			object = Object{};
+			object.kind = kind;
+			return object;
+		}
+
+		Object* Find(uint32_t id, Kind kind)
+		{
+			return id && id < m_objects.size() && m_objects[id].kind == kind ? &m_objects[id] : nullptr;
+		}
+
+		uint32_t* View(DescriptorHandle handle)
+		{
+			Object* heap = Find(handle.heap, Kind::DescriptorHeap);
+			if (!heap || handle.index >= heap->views.size())
+			{
+				Error("descriptor handle outside its heap", handle.heap);
+				return nullptr;
+			}
+			return &heap->views[handle.index];
+		}
+
+		Object* Recording(uint32_t list)
+		{
+			Object* object = Find(list, Kind::List);
+			if (!object || !object->open)
+			{
+				Error("command recorded on a closed or missing list", list);
+				return nullptr;
+			}
+			return object;
+		}
+
+		void Record(uint32_t list, const Command& command)
+		{
+			if (Object* object = Recording(list)) object->commands.push_back(command);
+		}
+
+		void Error(const char* message, uint32_t id)
+		{
+			if (m_stats.validation_errors++ == 0)
+			{
+				char buffer[160];
+				std::snprintf(buffer, sizeof(buffer), "frame %u: %s (object %u)", m_frame, message, id);
+				m_first_error = buffer;
+			}
+		}
+
+		// commonʽ״̬ύʱͳһ˥
+		bool UseBuffer(uint32_t resource, uint32_t required_state, uint64_t offset, uint64_t size)
+		{
+			Object* buffer = Find(resource, Kind::Buffer);
+			if (!buffer || offset + size > buffer->memory.size())
+			{
+				Error("buffer access out of range", resource);
+				return false;
+			}
+			if (buffer->state == m_state_common && buffer->heap_type == m_heap_type_default)
+			{
+				buffer->state = required_state;
+			}
+			else if ((buffer->state & required_state) != required_state)
+			{
+				Error("buffer is not in the state required by the copy", resource);
+				return false;
+			}
+			m_touched_buffers.push_back(resource);
+			return true;
+		}
+
+		void RequireViewState(uint32_t heap, uint32_t index, uint32_t state)
+		{
+			uint32_t* view = View({heap, index});
+			Object* resource = view ? Find(*view, Kind::Texture) : nullptr;
+			if (!resource || resource->state != state) Error("clear on a view whose resource is in the wrong state", view ? *view : 0);
+		}
+
+		void Execute(const Object& list, ExecutionState& state)
+		{
+			state.pipeline = list.initial_pipeline;
+			for (const Command& command : list.commands)
+			{
+				++m_stats.commands;
+				switch (command.op)
+				{
+				case Op::ResourceBarrier:
+				{
+					++m_stats.barriers;
+					if (command.a != m_barrier_transition) break;
+					Object* resource = Find(command.b, Kind::Buffer);
+					if (!resource) resource = Find(command.b, Kind::Texture);
+					if (!resource)
+					{
+						Error("barrier on a missing resource", command.b);
+					}
+					else if (resource->state != command.c)
+					{
+						Error("barrier state before does not match the tracked state", command.b);
+					}
+					else
+					{
+						resource->state = command.d;
+						if (resource->kind == Kind::Buffer) m_touched_buffers.push_back(command.b);
+					}
+					break;
+				}
+				case Op::CopyBufferRegion:
+				{
+					if (!UseBuffer(command.a, m_state_copy_dest, command.x, command.z) || !UseBuffer(command.b, m_state_copy_source, command.y, command.z)) break;
+					std::memmove(m_objects[command.a].memory.data() + command.x, m_objects[command.b].memory.data() + command.y, static_cast<size_t>(command.z));
+					++m_stats.copies;
+					m_stats.bytes_copied += command.z;
+					break;
+				}
+				case Op::ClearRenderTargetView:
+					RequireViewState(command.a, command.b, m_state_render_target);
+					break;
+				case Op::ClearDepthStencilView:
+					RequireViewState(command.a, command.b, m_state_depth_write);
+					break;
+				case Op::SetRenderTargets:
+				{
+					uint32_t* view = command.a ? View({command.b, command.c}) : nullptr;
+					state.render_target = view ? *view : 0;
+					break;
+				}
+				case Op::SetPipelineState:
+					state.pipeline = command.a;
+					break;
+				case Op::SetRootSignature:
+					state.root_signature[command.b ? 1 : 0] = command.a;
+					break;
+				case Op::SetRootDescriptor:
+				{
+					Object* buffer = Find(command.d, Kind::Buffer);
+					if (!buffer || command.x >= buffer->memory.size()) Error("root descriptor outside its buffer", command.d);
+					break;
+				}
+				case Op::SetPrimitiveTopology:
+					state.topology = command.a;
+					break;
+				case Op::SetVertexBuffers:
+				{
+					Object* buffer = Find(command.d, Kind::Buffer);
+					if (!buffer || command.x + command.y > buffer->memory.size()) Error("vertex buffer view outside its buffer", command.d);
+					state.has_vertex_buffer = true;
+					break;
+				}
+				case Op::SetIndexBuffer:
+				{
+					Object* buffer = Find(command.d, Kind::Buffer);
+					if (!buffer || command.x + command.y > buffer->memory.size()) Error("index buffer view outside its buffer", command.d);
+					state.index_buffer = command.d;
+					state.index_offset = command.x;
+					state.index_size = command.y;
+					state.index_format = command.a;
+					break;
+				}
+				case Op::DrawIndexedInstanced:
+				{
+					Object* pipeline = Find(state.pipeline, Kind::Pipeline);
+					uint64_t index_size = state.index_format == m_index_format_r32 ? 4 : 2;
+					if (!pipeline || pipeline->compute || pipeline->root_signature != state.root_signature[0])
+					{
+						Error("draw without a matching graphics pipeline and root signature", state.pipeline);
+					}
+					else if (!state.topology || !state.has_vertex_buffer || !state.index_buffer || (static_cast<uint64_t>(command.c) + command.a) * index_size > state.index_size)
+					{
+						Error("draw with missing input assembler state or indices out of range", state.index_buffer);
+					}
+					else if (list.list_type != m_list_type_bundle && !state.render_target)
+					{
+						Error("draw without a render target", 0);
+					}
+					++m_stats.draws;
+					m_stats.indices += static_cast<uint64_t>(command.a) * command.b;
+					break;
+				}
+				case Op::Dispatch:
+				{
+					Object* pipeline = Find(state.pipeline, Kind::Pipeline);
+					if (!pipeline || !pipeline->compute || pipeline->root_signature != state.root_signature[1])
+					{
+						Error("dispatch without a matching compute pipeline and root signature", state.pipeline);
+					}
+					++m_stats.dispatches;
+					break;
+				}
+				case Op::ExecuteBundle:
+				{
+					Object* bundle = Find(command.a, Kind::List);
+					if (!bundle || bundle->open || bundle->list_type != m_list_type_bundle)
+					{
+						Error("ExecuteBundle with a missing or open bundle", command.a);
+						break;
+					}
+					// bundleĳʼԼReset
+					Execute(*bundle, state);
+					break;
+				}
+				default:
+					break;
+				}
+			}
+		}
+
+		std::vector<Object> m_objects;
+		std::vector<uint32_t> m_touched_buffers;
+		CpuReplayStats m_stats;
+		std::string m_first_error;
+		uint32_t m_frame = 0;
+	};
+}
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#include <Windows.h>
+#include <wrl.h>
+#include <climits>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+namespace TraceHelper
+{
+	static_assert(m_heap_type_upload == D3D12_HEAP_TYPE_UPLOAD && m_heap_type_readback == D3D12_HEAP_TYPE_READBACK, "heap types must match D3D12.");
+	static_assert(m_list_type_bundle == D3D12_COMMAND_LIST_TYPE_BUNDLE && m_list_type_compute == D3D12_COMMAND_LIST_TYPE_COMPUTE, "list types must match D3D12.");
+	static_assert(m_state_copy_dest == D3D12_RESOURCE_STATE_COPY_DEST && m_state_depth_write == D3D12_RESOURCE_STATE_DEPTH_WRITE, "resource states must match D3D12.");
+	static_assert(m_barrier_uav == D3D12_RESOURCE_BARRIER_TYPE_UAV && m_index_format_r16 == DXGI_FORMAT_R16_UINT, "barrier types and formats must match D3D12.");
+
+	class CaptureList;
+
+	// ͳƣunknown_referencesΪδǼǶĴЩڸмΪն
+	struct CaptureStats
+	{
+		uint32_t frames = 0;
+		uint64_t records = 0;
+		size_t bytes = 0;
+		uint64_t unknown_references = 0;
+	};
+
+	// 񣺼¼󴴽CPUдϴѵݡб¼ƺжύ
+	// ǩߡѺͼҪڴǼǣбжӺ͸ڵһαʱ¼
+	// ڼеǼǶãָ뱻¶öϴ
+	class CommandCapture
+	{
+	public:
+		void Begin(Microsoft::WRL::ComPtr<ID3D12Device10> device, uint32_t frame_count)
+		{
+			End();
+			m_writer.Clear();
+			m_stats = CaptureStats{};
+			m_device = device;
+			m_frame_limit = frame_count;
+			m_active = true;
+		}
+
+		// ֹͣͷųеж
+		void End()
+		{
+			m_active = false;
+			m_ids.clear();
+			m_objects.clear();
+			m_objects.emplace_back();
+			m_gpu_ranges.clear();
+			m_heaps.clear();
+			m_uploads.clear();
+		}
+
+		bool Active() const { return m_active; }
+
+		void FrameBegin()
+		{
+			if (!m_active) return;
+			m_writer.Begin(Op::FrameBegin).U(m_stats.frames).End();
+		}
+
+		// ﵽ֡ʱֹͣ񲢷true÷д
+		bool FrameEnd()
+		{
+			if (!m_active) return false;
+			m_writer.Begin(Op::FrameEnd).End();
+			if (++m_stats.frames < m_frame_limit) return false;
+			End();
+			return true;
+		}
+
+		bool Save(const std::filesystem::path& path) const
+		{
+			return m_writer.Save(path);
+		}
+
+		CaptureStats Stats() const
+		{
+			CaptureStats stats = m_stats;
+			stats.records = m_writer.RecordCount();
+			stats.bytes = m_writer.Size();
+			return stats;
+		}
+
+		// ָĳʼ״̬ǼԴڵһʱ޷ƶ״̬ԴȻ
+		void Resource(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+		{
+			if (m_active && resource) ResourceId(resource, state);
+		}
+
+		void DescriptorHeap(ID3D12DescriptorHeap* heap)
+		{
+			if (!m_active || !heap || Find(heap)) return;
+			D3D12_DESCRIPTOR_HEAP_DESC desc = heap->GetDesc();
+			uint32_t id = Register(heap);
+			m_writer.Begin(Op::CreateDescriptorHeap).U(id).U(desc.Type).U(desc.NumDescriptors).End();
+			UINT increment = m_device->GetDescriptorHandleIncrementSize(desc.Type);
+			SIZE_T start = heap->GetCPUDescriptorHandleForHeapStart().ptr;
+			m_heaps.push_back({start, start + static_cast<SIZE_T>(increment) * desc.NumDescriptors, increment, id});
+		}
+
+		void RenderTargetView(ID3D12Resource* resource, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			if (!m_active) return;
+			uint32_t id = ResourceId(resource);
+			WriteHandle(m_writer.Begin(Op::CreateRenderTargetView), handle).U(id).End();
+		}
+
+		void DepthStencilView(ID3D12Resource* resource, DXGI_FORMAT format, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			if (!m_active) return;
+			uint32_t id = ResourceId(resource);
+			WriteHandle(m_writer.Begin(Op::CreateDepthStencilView), handle).U(id).U(format).End();
+		}
+
+		void RootSignature(ID3D12RootSignature* root_signature, const void* blob, size_t size)
+		{
+			if (!m_active || Find(root_signature)) return;
+			m_writer.Begin(Op::CreateRootSignature).U(Register(root_signature)).Bytes(blob, size).End();
+		}
+
+		// ֻ¼ĹõֶΣդϺģ״̬ȡĬֵ
+		void GraphicsPipeline(ID3D12PipelineState* pipeline_state, ID3D12RootSignature* root_signature, const D3D12_INPUT_ELEMENT_DESC* input_layout, UINT element_count,
+			D3D12_PRIMITIVE_TOPOLOGY_TYPE topology_type, D3D12_SHADER_BYTECODE vs, D3D12_SHADER_BYTECODE ps, DXGI_FORMAT rtv_format, DXGI_FORMAT dsv_format)
+		{
+			if (!m_active || Find(pipeline_state)) return;
+			uint32_t root_signature_id = ObjectId(root_signature);
+			m_writer.Begin(Op::CreateGraphicsPipeline).U(Register(pipeline_state)).U(root_signature_id).U(topology_type).U(rtv_format).U(dsv_format)
+				.Bytes(vs.pShaderBytecode, vs.BytecodeLength).Bytes(ps.pShaderBytecode, ps.BytecodeLength).U(element_count);
+			for (UINT i = 0; i < element_count; ++i)
+			{
+				const D3D12_INPUT_ELEMENT_DESC& element = input_layout[i];
+				m_writer.String(element.SemanticName).U(element.SemanticIndex).U(element.Format).U(element.InputSlot)
+					.U(element.AlignedByteOffset).U(element.InputSlotClass).U(element.InstanceDataStepRate);
+			}
+			m_writer.End();
+		}
+
+		void ComputePipeline(ID3D12PipelineState* pipeline_state, ID3D12RootSignature* root_signature, D3D12_SHADER_BYTECODE cs)
+		{
+			if (!m_active || Find(pipeline_state)) return;
+			uint32_t root_signature_id = ObjectId(root_signature);
+			m_writer.Begin(Op::CreateComputePipeline).U(Register(pipeline_state)).U(root_signature_id).Bytes(cs.pShaderBytecode, cs.BytecodeLength).End();
+		}
+
+		// 󼴽ͷţڴСʱĺ󻺳ͷò¼֮ͬһָᱻ¶
+		void Release(IUnknown* object)
+		{
+			if (!m_active || !object) return;
+			auto it = m_ids.find(object);
+			if (it == m_ids.end()) return;
+			uint32_t id = it->second;
+			m_writer.Begin(Op::Release).U(id).End();
+			m_ids.erase(it);
+			m_objects[id].Reset();
+			for (auto range = m_gpu_ranges.begin(); range != m_gpu_ranges.end();)
+			{
+				range = range->second.id == id ? m_gpu_ranges.erase(range) : std::next(range);
+			}
+			m_heaps.erase(std::remove_if(m_heaps.begin(), m_heaps.end(), [id](const HeapRange& heap) { return heap.id == id; }), m_heaps.end());
+		}
+
+		// CPUֱдϴ
+		void WriteBuffer(ID3D12Resource* resource, uint64_t offset, const void* data, size_t size)
+		{
+			if (!m_active) return;
+			uint32_t id = ResourceId(resource);
+			m_writer.Begin(Op::WriteBuffer).U(id).U(offset).Bytes(data, size).End();
+		}
+
+		// Ǽһ֮Żᱻдϴڴ棬һύǰ
+		void TrackUpload(ID3D12Resource* resource, uint64_t offset, const void* cpu_address, size_t size)
+		{
+			if (!m_active) return;
+			m_uploads.push_back({ResourceId(resource), offset, static_cast<const uint8_t*>(cpu_address), size});
+		}
+
+		CaptureList Wrap(ID3D12GraphicsCommandList* list);
+		CaptureList Describe(ID3D12GraphicsCommandList* list);
+
+		void ExecuteCommandLists(ID3D12CommandQueue* queue, UINT count, ID3D12CommandList* const* lists)
+		{
+			queue->ExecuteCommandLists(count, lists);
+			if (!m_active) return;
+			FlushUploads();
+			uint32_t queue_id = QueueId(queue);
+			m_writer.Begin(Op::ExecuteCommandLists).U(queue_id).U(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				m_writer.U(Find(lists[i]));
+			}
+			m_writer.End();
+		}
+
+		HRESULT Signal(ID3D12CommandQueue* queue, ID3D12Fence* fence, uint64_t value)
+		{
+			HRESULT result = queue->Signal(fence, value);
+			if (m_active)
+			{
+				uint32_t queue_id = QueueId(queue);
+				uint32_t fence_id = FenceId(fence);
+				m_writer.Begin(Op::Signal).U(queue_id).U(fence_id).U(value).End();
+			}
+			return result;
+		}
+
+		HRESULT Wait(ID3D12CommandQueue* queue, ID3D12Fence* fence, uint64_t value)
+		{
+			HRESULT result = queue->Wait(fence, value);
+			if (m_active)
+			{
+				uint32_t queue_id = QueueId(queue);
+				uint32_t fence_id = FenceId(fence);
+				m_writer.Begin(Op::Wait).U(queue_id).U(fence_id).U(value).End();
+			}
+			return result;
+		}
+
+		// ֻ¼CPUȴȴɵ÷ɣطʱͬ֡ӳ
+		void WaitForFence(ID3D12Fence* fence, uint64_t value)
+		{
+			if (!m_active) return;
+			uint32_t fence_id = FenceId(fence);
+			m_writer.Begin(Op::WaitForFence).U(fence_id).U(value).End();
+		}
+
+	private:
+		friend class CaptureList;
+
+		struct GpuRange
+		{
+			uint32_t id;
+			uint64_t size;
+		};
+
+		struct HeapRange
+		{
+			SIZE_T begin;
+			SIZE_T end;
+			UINT increment;
+			uint32_t id;
+		};
+
+		struct Upload
+		{
+			uint32_t resource;
+			uint64_t offset;
+			const uint8_t* cpu_address;
+			size_t size;
+		};
+
+		static const uint32_t m_unknown_state = UINT32_MAX;
+
+		uint32_t Find(const void* object) const
+		{
+			auto it = m_ids.find(object);
+			return it == m_ids.end() ? 0 : it->second;
+		}
+
+		uint32_t Register(IUnknown* object)
+		{
+			uint32_t id = static_cast<uint32_t>(m_objects.size());
+			m_objects.emplace_back(object);
+			m_ids.emplace(object, id);
+			return id;
+		}
+
+		// ڴǼǵĶûеǼǵļΪն
+		uint32_t ObjectId(const void* object)
+		{
+			uint32_t id = object ? Find(object) : 0;
+			if (object && !id) ++m_stats.unknown_references;
+			return id;
+		}
+
+		// һʱԴ¼ûи״̬ʱȡʼ״̬
+		uint32_t ResourceId(ID3D12Resource* resource, uint32_t state = m_unknown_state)
+		{
+			if (!resource) return 0;
+			if (uint32_t id = Find(resource)) return id;
+			D3D12_RESOURCE_DESC desc = resource->GetDesc();
+			D3D12_HEAP_PROPERTIES heap{};
+			D3D12_HEAP_FLAGS heap_flags;
+			// ԴƬԴûжԣĬ϶Ѵ
+			if (FAILED(resource->GetHeapProperties(&heap, &heap_flags)) || heap.Type == D3D12_HEAP_TYPE_CUSTOM)
+			{
+				heap.Type = D3D12_HEAP_TYPE_DEFAULT;
+			}
+			if (state == m_unknown_state)
+			{
+				state = heap.Type == D3D12_HEAP_TYPE_UPLOAD ? D3D12_RESOURCE_STATE_GENERIC_READ :
+					heap.Type == D3D12_HEAP_TYPE_READBACK ? D3D12_RESOURCE_STATE_COPY_DEST : D3D12_RESOURCE_STATE_COMMON;
+			}
+			uint32_t id = Register(resource);
+			if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			{
+				m_writer.Begin(Op::CreateBuffer).U(id).U(heap.Type).U(desc.Width).U(desc.Flags).U(state).End();
+				m_gpu_ranges[resource->GetGPUVirtualAddress()] = {id, desc.Width};
+			}
+			else
+			{
+				m_writer.Begin(Op::CreateTexture).U(id).U(heap.Type).U(desc.Dimension).U(desc.Width).U(desc.Height)
+					.U(desc.DepthOrArraySize).U(desc.MipLevels).U(desc.Format).U(desc.Flags).U(state).End();
+			}
+			return id;
+		}
+
+		uint32_t ListId(ID3D12GraphicsCommandList* list)
+		{
+			if (uint32_t id = Find(list)) return id;
+			uint32_t id = Register(list);
+			m_writer.Begin(Op::CreateCommandList).U(id).U(list->GetType()).End();
+			return id;
+		}
+
+		uint32_t QueueId(ID3D12CommandQueue* queue)
+		{
+			if (uint32_t id = Find(queue)) return id;
+			uint32_t id = Register(queue);
+			m_writer.Begin(Op::CreateCommandQueue).U(id).U(queue->GetDesc().Type).End();
+			return id;
+		}
+
+		// ԵһʱɵֵΪʼֵ
+		uint32_t FenceId(ID3D12Fence* fence)
+		{
+			if (uint32_t id = Find(fence)) return id;
+			uint32_t id = Register(fence);
+			m_writer.Begin(Op::CreateFence).U(id).U(fence->GetCompletedValue()).End();
+			return id;
+		}
+
+		// GPUַ +ƫ
+		TraceWriter& WriteAddress(TraceWriter& writer, D3D12_GPU_VIRTUAL_ADDRESS address)
+		{
+			auto it = m_gpu_ranges.upper_bound(address);
+			if (it != m_gpu_ranges.begin())
+			{
+				--it;
+				if (address < it->first + it->second.size) return writer.U(it->second.id).U(address - it->first);
+			}
+			++m_stats.unknown_references;
+			return writer.U(0).U(0);
+		}
+
+		//  ѱ+
+		TraceWriter& WriteHandle(TraceWriter& writer, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			for (const HeapRange& heap : m_heaps)
+			{
+				if (handle.ptr >= heap.begin && handle.ptr < heap.end) return writer.U(heap.id).U((handle.ptr - heap.begin) / heap.increment);
+			}
+			++m_stats.unknown_references;
+			return writer.U(0).U(0);
+		}
+
+		// ϲͬһβӵ䣬ÿдһ¼
+		void FlushUploads()
+		{
+			std::sort(m_uploads.begin(), m_uploads.end(), [](const Upload& a, const Upload& b)
+				{
+					return a.resource != b.resource ? a.resource < b.resource : a.offset < b.offset;
+				});
+			for (size_t i = 0; i < m_uploads.size();)
+			{
+				const Upload& first = m_uploads[i];
+				size_t size = first.size;
+				size_t j = i + 1;
+				while (j < m_uploads.size() && m_uploads[j].resource == first.resource && m_uploads[j].offset == first.offset + size)
+				{
+					size += m_uploads[j++].size;
+				}
+				m_writer.Begin(Op::WriteBuffer).U(first.resource).U(first.offset).Bytes(first.cpu_address, size).End();
+				i = j;
+			}
+			m_uploads.clear();
+		}
+
+		Microsoft::WRL::ComPtr<ID3D12Device10> m_device;
+		TraceWriter m_writer;
+		bool m_active = false;
+		uint32_t m_frame_limit = 0;
+		CaptureStats m_stats;
+		// 0ʾն
+		std::unordered_map<const void*, uint32_t> m_ids;
+		std::vector<Microsoft::WRL::ComPtr<IUnknown>> m_objects{1};
+		std::map<D3D12_GPU_VIRTUAL_ADDRESS, GpuRange> m_gpu_ranges;
+		std::vector<HeapRange> m_heaps;
+		std::vector<Upload> m_uploads;
+		std::vector<uint32_t> m_barrier_ids;
+	};
+
+	// бĲװID3D12GraphicsCommandListֱͬΪStateFilterб
+	// Wrapõİװתʵбʱдһ¼DescribeõİװתֻѾͨ;¼Ƶ
+	class CaptureList
+	{
+	public:
+		// бڹʱȡãһòĴ¼ܲڱļ¼м
+		CaptureList(ID3D12GraphicsCommandList* list, CommandCapture* capture, bool forward) :
+			m_list(list), m_capture(capture->Active() ? capture : nullptr), m_forward(forward)
+		{
+			if (m_capture) m_id = m_capture->ListId(list);
+		}
+
+		ID3D12GraphicsCommandList* Get() const { return m_list; }
+
+		HRESULT Reset(ID3D12CommandAllocator* allocator, ID3D12PipelineState* pipeline_state)
+		{
+			HRESULT result = m_forward ? m_list->Reset(allocator, pipeline_state) : S_OK;
+			if (m_capture)
+			{
+				uint32_t pipeline_id = m_capture->ObjectId(pipeline_state);
+				m_capture->m_writer.Begin(Op::Reset).U(Id()).U(pipeline_id).End();
+			}
+			return result;
+		}
+
+		HRESULT Close()
+		{
+			HRESULT result = m_forward ? m_list->Close() : S_OK;
+			if (m_capture) m_capture->m_writer.Begin(Op::Close).U(Id()).End();
+			return result;
+		}
+
+		void ResourceBarrier(UINT count, const D3D12_RESOURCE_BARRIER* barriers)
+		{
+			if (m_forward) m_list->ResourceBarrier(count, barriers);
+			if (!m_capture) return;
+			// ȵǼԴ¼Ҫϼ¼֮ǰϵǰ״̬Դһγʱ״̬
+			std::vector<uint32_t>& ids = m_capture->m_barrier_ids;
+			ids.resize(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				const D3D12_RESOURCE_BARRIER& barrier = barriers[i];
+				ids[i] = barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ? m_capture->ResourceId(barrier.Transition.pResource, barrier.Transition.StateBefore) :
+					barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_UAV ? m_capture->ResourceId(barrier.UAV.pResource) : 0;
+			}
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::ResourceBarrier).U(Id()).U(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				const D3D12_RESOURCE_BARRIER& barrier = barriers[i];
+				bool transition = barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+				writer.U(barrier.Type).U(ids[i]).U(transition ? barrier.Transition.Subresource : 0)
+					.U(transition ? barrier.Transition.StateBefore : 0).U(transition ? barrier.Transition.StateAfter : 0);
+			}
+			writer.End();
+		}
+
+		void CopyBufferRegion(ID3D12Resource* destination, UINT64 destination_offset, ID3D12Resource* source, UINT64 source_offset, UINT64 size)
+		{
+			if (m_forward) m_list->CopyBufferRegion(destination, destination_offset, source, source_offset, size);
+			if (!m_capture) return;
+			uint32_t destination_id = m_capture->ResourceId(destination);
+			uint32_t source_id = m_capture->ResourceId(source);
+			m_capture->m_writer.Begin(Op::CopyBufferRegion).U(Id()).U(destination_id).U(destination_offset).U(source_id).U(source_offset).U(size).End();
+		}
+
+		void ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE handle, const FLOAT color[4], UINT rect_count, const D3D12_RECT* rects)
+		{
+			if (m_forward) m_list->ClearRenderTargetView(handle, color, rect_count, rects);
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->WriteHandle(m_capture->m_writer.Begin(Op::ClearRenderTargetView).U(Id()), handle);
+			writer.F(color[0]).F(color[1]).F(color[2]).F(color[3]).End();
+		}
+
+		void ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE handle, D3D12_CLEAR_FLAGS flags, FLOAT depth, UINT8 stencil, UINT rect_count, const D3D12_RECT* rects)
+		{
+			if (m_forward) m_list->ClearDepthStencilView(handle, flags, depth, stencil, rect_count, rects);
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->WriteHandle(m_capture->m_writer.Begin(Op::ClearDepthStencilView).U(Id()), handle);
+			writer.U(flags).F(depth).U(stencil).End();
+		}
+
+		void RSSetViewports(UINT count, const D3D12_VIEWPORT* viewports)
+		{
+			if (m_forward) m_list->RSSetViewports(count, viewports);
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::SetViewports).U(Id()).U(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				writer.F(viewports[i].TopLeftX).F(viewports[i].TopLeftY).F(viewports[i].Width).F(viewports[i].Height).F(viewports[i].MinDepth).F(viewports[i].MaxDepth);
+			}
+			writer.End();
+		}
+
+		void RSSetScissorRects(UINT count, const D3D12_RECT* rects)
+		{
+			if (m_forward) m_list->RSSetScissorRects(count, rects);
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::SetScissorRects).U(Id()).U(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				writer.I(rects[i].left).I(rects[i].top).I(rects[i].right).I(rects[i].bottom);
+			}
+			writer.End();
+		}
+
+		// ȾĿֵ֧д
+		void OMSetRenderTargets(UINT count, const D3D12_CPU_DESCRIPTOR_HANDLE* render_targets, BOOL single_handle, const D3D12_CPU_DESCRIPTOR_HANDLE* depth_stencil)
+		{
+			if (m_forward) m_list->OMSetRenderTargets(count, render_targets, single_handle, depth_stencil);
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::SetRenderTargets).U(Id()).U(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				m_capture->WriteHandle(writer, render_targets[i]);
+			}
+			writer.U(depth_stencil != nullptr);
+			if (depth_stencil) m_capture->WriteHandle(writer, *depth_stencil);
+			writer.End();
+		}
+
+		void SetPipelineState(ID3D12PipelineState* pipeline_state)
+		{
+			if (m_forward) m_list->SetPipelineState(pipeline_state);
+			if (!m_capture) return;
+			uint32_t pipeline_id = m_capture->ObjectId(pipeline_state);
+			m_capture->m_writer.Begin(Op::SetPipelineState).U(Id()).U(pipeline_id).End();
+		}
+
+		void SetGraphicsRootSignature(ID3D12RootSignature* root_signature)
+		{
+			if (m_forward) m_list->SetGraphicsRootSignature(root_signature);
+			RecordRootSignature(false, root_signature);
+		}
+
+		void SetComputeRootSignature(ID3D12RootSignature* root_signature)
+		{
+			if (m_forward) m_list->SetComputeRootSignature(root_signature);
+			RecordRootSignature(true, root_signature);
+		}
+
+		void SetGraphicsRoot32BitConstants(UINT parameter, UINT count, const void* values, UINT destination_offset)
+		{
+			if (m_forward) m_list->SetGraphicsRoot32BitConstants(parameter, count, values, destination_offset);
+			RecordConstants(false, parameter, count, values, destination_offset);
+		}
+
+		void SetComputeRoot32BitConstants(UINT parameter, UINT count, const void* values, UINT destination_offset)
+		{
+			if (m_forward) m_list->SetComputeRoot32BitConstants(parameter, count, values, destination_offset);
+			RecordConstants(true, parameter, count, values, destination_offset);
+		}
+
+		void SetGraphicsRootConstantBufferView(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+		{
+			if (m_forward) m_list->SetGraphicsRootConstantBufferView(parameter, address);
+			RecordDescriptor(false, RootDescriptor::Cbv, parameter, address);
+		}
+
+		void SetGraphicsRootShaderResourceView(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+		{
+			if (m_forward) m_list->SetGraphicsRootShaderResourceView(parameter, address);
+			RecordDescriptor(false, RootDescriptor::Srv, parameter, address);
+		}
+
+		void SetComputeRootShaderResourceView(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+		{
+			if (m_forward) m_list->SetComputeRootShaderResourceView(parameter, address);
+			RecordDescriptor(true, RootDescriptor::Srv, parameter, address);
+		}
+
+		void SetComputeRootUnorderedAccessView(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+		{
+			if (m_forward) m_list->SetComputeRootUnorderedAccessView(parameter, address);
+			RecordDescriptor(true, RootDescriptor::Uav, parameter, address);
+		}
+
+		void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+		{
+			if (m_forward) m_list->IASetPrimitiveTopology(topology);
+			if (m_capture) m_capture->m_writer.Begin(Op::SetPrimitiveTopology).U(Id()).U(topology).End();
+		}
+
+		void IASetVertexBuffers(UINT start_slot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views)
+		{
+			if (m_forward) m_list->IASetVertexBuffers(start_slot, count, views);
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::SetVertexBuffers).U(Id()).U(start_slot).U(count);
+			for (UINT i = 0; i < count; ++i)
+			{
+				m_capture->WriteAddress(writer, views[i].BufferLocation).U(views[i].SizeInBytes).U(views[i].StrideInBytes);
+			}
+			writer.End();
+		}
+
+		void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+		{
+			if (m_forward) m_list->IASetIndexBuffer(view);
+			if (!m_capture || !view) return;
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::SetIndexBuffer).U(Id());
+			m_capture->WriteAddress(writer, view->BufferLocation).U(view->SizeInBytes).U(view->Format).End();
+		}
+
+		void DrawIndexedInstanced(UINT index_count, UINT instance_count, UINT start_index, INT base_vertex, UINT start_instance)
+		{
+			if (m_forward) m_list->DrawIndexedInstanced(index_count, instance_count, start_index, base_vertex, start_instance);
+			if (m_capture) m_capture->m_writer.Begin(Op::DrawIndexedInstanced).U(Id()).U(index_count).U(instance_count).U(start_index).I(base_vertex).U(start_instance).End();
+		}
+
+		void Dispatch(UINT x, UINT y, UINT z)
+		{
+			if (m_forward) m_list->Dispatch(x, y, z);
+			if (m_capture) m_capture->m_writer.Begin(Op::Dispatch).U(Id()).U(x).U(y).U(z).End();
+		}
+
+		void ExecuteBundle(ID3D12GraphicsCommandList* bundle)
+		{
+			if (m_forward) m_list->ExecuteBundle(bundle);
+			if (!m_capture) return;
+			uint32_t bundle_id = m_capture->ListId(bundle);
+			m_capture->m_writer.Begin(Op::ExecuteBundle).U(Id()).U(bundle_id).End();
+		}
+
+	private:
+		uint32_t Id() const
+		{
+			return m_id;
+		}
+
+		void RecordRootSignature(bool compute, ID3D12RootSignature* root_signature)
+		{
+			if (!m_capture) return;
+			uint32_t root_signature_id = m_capture->ObjectId(root_signature);
+			m_capture->m_writer.Begin(Op::SetRootSignature).U(Id()).U(compute).U(root_signature_id).End();
+		}
+
+		void RecordConstants(bool compute, UINT parameter, UINT count, const void* values, UINT destination_offset)
+		{
+			if (m_capture) m_capture->m_writer.Begin(Op::SetRoot32BitConstants).U(Id()).U(compute).U(parameter).U(destination_offset).Bytes(values, count * sizeof(uint32_t)).End();
+		}
+
+		void RecordDescriptor(bool compute, RootDescriptor kind, UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+		{
+			if (!m_capture) return;
+			TraceWriter& writer = m_capture->m_writer.Begin(Op::SetRootDescriptor).U(Id()).U(compute).U(static_cast<uint32_t>(kind)).U(parameter);
+			m_capture->WriteAddress(writer, address).End();
+		}
+
+		ID3D12GraphicsCommandList* m_list;
+		CommandCapture* m_capture;
+		bool m_forward;
+		uint32_t m_id = 0;
+	};
+
+	inline CaptureList CommandCapture::Wrap(ID3D12GraphicsCommandList* list)
+	{
+		return CaptureList(list, this, true);
+	}
+
+	inline CaptureList CommandCapture::Describe(ID3D12GraphicsCommandList* list)
+	{
+		return CaptureList(list, this, false);
+	}
+
+	// 豸ˣʵ豸WARPؽеĶ󲢰ԭ˳ύ
+	// ԴύԴϴѳפӳ䣻ÿбύʱڲշbundleÿö·طŽǰ
+	class DeviceBackend
+	{
+	public:
+		explicit DeviceBackend(Microsoft::WRL::ComPtr<ID3D12Device10> device) :
+			m_device(device)
+		{
+			m_event = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+		}
+
+		~DeviceBackend()
+		{
+			Finish();
+			::CloseHandle(m_event);
+		}
+
+		DeviceBackend(const DeviceBackend&) = delete;
+		DeviceBackend& operator=(const DeviceBackend&) = delete;
+
+		// ȴжִ
+		void Finish()
+		{
+			for (Object& object : m_objects)
+			{
+				if (!object.queue) continue;
+				DxDebug::ThrowIfFailed(object.queue->Signal(object.fence.Get(), ++object.fence_value));
+				WaitFor(object.fence.Get(), object.fence_value);
+			}
+		}
+
+		void CreateBuffer(uint32_t id, const BufferDesc& desc)
+		{
+			D3D12_HEAP_PROPERTIES heap{};
+			heap.Type = static_cast<D3D12_HEAP_TYPE>(desc.heap_type);
+			D3D12_RESOURCE_DESC resource_desc{};
+			resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+			resource_desc.Width = desc.size;
+			resource_desc.Height = 1;
+			resource_desc.DepthOrArraySize = 1;
+			resource_desc.MipLevels = 1;
+			resource_desc.SampleDesc.Count = 1;
+			resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+			resource_desc.Flags = static_cast<D3D12_RESOURCE_FLAGS>(desc.flags);
+			Object& object = Create(id);
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &resource_desc,
+				static_cast<D3D12_RESOURCE_STATES>(desc.state), nullptr, IID_PPV_ARGS(&object.resource)));
+			object.gpu_address = object.resource->GetGPUVirtualAddress();
+			if (desc.heap_type != m_heap_type_default)
+			{
+				D3D12_RANGE read_range{0, 0};
+				DxDebug::ThrowIfFailed(object.resource->Map(0, &read_range, reinterpret_cast<void**>(&object.mapped)));
+				object.mapped_size = desc.size;
+			}
+		}
+
+		void CreateTexture(uint32_t id, const TextureDesc& desc)
+		{
+			D3D12_HEAP_PROPERTIES heap{};
+			heap.Type = static_cast<D3D12_HEAP_TYPE>(desc.heap_type);
+			D3D12_RESOURCE_DESC resource_desc{};
+			resource_desc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(desc.dimension);
+			resource_desc.Width = desc.width;
+			resource_desc.Height = desc.height;
+			resource_desc.DepthOrArraySize = static_cast<UINT16>(desc.depth_or_array_size);
+			resource_desc.MipLevels = static_cast<UINT16>(desc.mip_levels);
+			resource_desc.Format = static_cast<DXGI_FORMAT>(desc.format);
+			resource_desc.SampleDesc.Count = 1;
+			resource_desc.Flags = static_cast<D3D12_RESOURCE_FLAGS>(desc.flags);
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &resource_desc,
+				static_cast<D3D12_RESOURCE_STATES>(desc.state), nullptr, IID_PPV_ARGS(&Create(id).resource)));
+		}
+
+		void CreateDescriptorHeap(uint32_t id, uint32_t type, uint32_t count)
+		{
+			D3D12_DESCRIPTOR_HEAP_DESC desc{};
+			desc.Type = static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(type);
+			desc.NumDescriptors = count;
+			Object& object = Create(id);
+			DxDebug::ThrowIfFailed(m_device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&object.heap)));
+			object.heap_start = object.heap->GetCPUDescriptorHandleForHeapStart();
+			object.descriptor_size = m_device->GetDescriptorHandleIncrementSize(desc.Type);
+		}
+
+		void CreateRenderTargetView(DescriptorHandle handle, uint32_t resource)
+		{
+			if (ID3D12Resource* target = Resource(resource)) m_device->CreateRenderTargetView(target, nullptr, Handle(handle));
+		}
+
+		void CreateDepthStencilView(DescriptorHandle handle, uint32_t resource, uint32_t format)
+		{
+			ID3D12Resource* target = Resource(resource);
+			if (!target) return;
+			D3D12_DEPTH_STENCIL_VIEW_DESC desc{};
+			desc.Format = static_cast<DXGI_FORMAT>(format);
+			desc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
+			m_device->CreateDepthStencilView(target, &desc, Handle(handle));
+		}
+
+		void CreateRootSignature(uint32_t id, ByteSpan blob)
+		{
+			DxDebug::ThrowIfFailed(m_device->CreateRootSignature(0, blob.data, blob.size, IID_PPV_ARGS(&Create(id).root_signature)));
+		}
+
+		// դϺģ״̬ȡĬֵ벶˵Լһ
+		void CreateGraphicsPipeline(uint32_t id, const GraphicsPipelineDesc& desc)
+		{
+			m_input_layout.clear();
+			for (const InputElement& element : desc.input_layout)
+			{
+				m_input_layout.push_back({element.semantic.c_str(), element.semantic_index, static_cast<DXGI_FORMAT>(element.format), element.slot,
+					element.offset, static_cast<D3D12_INPUT_CLASSIFICATION>(element.classification), element.step_rate});
+			}
+			D3D12_GRAPHICS_PIPELINE_STATE_DESC pipeline_desc{};
+			pipeline_desc.pRootSignature = At(desc.root_signature).root_signature.Get();
+			pipeline_desc.VS = {desc.vs.data, desc.vs.size};
+			pipeline_desc.PS = {desc.ps.data, desc.ps.size};
+			pipeline_desc.BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
+			pipeline_desc.BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_ZERO;
+			pipeline_desc.BlendState.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+			pipeline_desc.BlendState.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+			pipeline_desc.BlendState.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
+			pipeline_desc.BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+			pipeline_desc.BlendState.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
+			pipeline_desc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+			pipeline_desc.SampleMask = UINT_MAX;
+			pipeline_desc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+			pipeline_desc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+			pipeline_desc.RasterizerState.DepthClipEnable = TRUE;
+			pipeline_desc.DepthStencilState.DepthEnable = desc.dsv_format != DXGI_FORMAT_UNKNOWN;
+			pipeline_desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+			pipeline_desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+			pipeline_desc.InputLayout = {m_input_layout.data(), static_cast<UINT>(m_input_layout.size())};
+			pipeline_desc.PrimitiveTopologyType = static_cast<D3D12_PRIMITIVE_TOPOLOGY_TYPE>(desc.topology_type);
+			pipeline_desc.NumRenderTargets = desc.rtv_format != DXGI_FORMAT_UNKNOWN ? 1 : 0;
+			pipeline_desc.RTVFormats[0] = static_cast<DXGI_FORMAT>(desc.rtv_format);
+			pipeline_desc.DSVFormat = static_cast<DXGI_FORMAT>(desc.dsv_format);
+			pipeline_desc.SampleDesc.Count = 1;
+			DxDebug::ThrowIfFailed(m_device->CreateGraphicsPipelineState(&pipeline_desc, IID_PPV_ARGS(&Create(id).pipeline_state)));
+		}
+
+		void CreateComputePipeline(uint32_t id, uint32_t root_signature, ByteSpan cs)
+		{
+			D3D12_COMPUTE_PIPELINE_STATE_DESC pipeline_desc{};
+			pipeline_desc.pRootSignature = At(root_signature).root_signature.Get();
+			pipeline_desc.CS = {cs.data, cs.size};
+			DxDebug::ThrowIfFailed(m_device->CreateComputePipelineState(&pipeline_desc, IID_PPV_ARGS(&Create(id).pipeline_state)));
+		}
+
+		// ÿжӴһڲбķڽʱȴ
+		void CreateCommandQueue(uint32_t id, uint32_t type)
+		{
+			D3D12_COMMAND_QUEUE_DESC desc{};
+			desc.Type = static_cast<D3D12_COMMAND_LIST_TYPE>(type);
+			Object& object = Create(id);
+			DxDebug::ThrowIfFailed(m_device->CreateCommandQueue(&desc, IID_PPV_ARGS(&object.queue)));
+			DxDebug::ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&object.fence)));
+		}
+
+		// бԹر״̬ȸеResetٴ
+		void CreateCommandList(uint32_t id, uint32_t type)
+		{
+			Object& object = Create(id);
+			object.list_type = static_cast<D3D12_COMMAND_LIST_TYPE>(type);
+			DxDebug::ThrowIfFailed(m_device->CreateCommandList1(0, object.list_type, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(&object.list)));
+		}
+
+		void CreateFence(uint32_t id, uint64_t value)
+		{
+			DxDebug::ThrowIfFailed(m_device->CreateFence(value, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&Create(id).fence)));
+		}
+
+		// GPUܻʹãӳٵطŽͷ
+		void Release(uint32_t id)
+		{
+			if (id < m_objects.size()) m_retired.push_back(std::move(m_objects[id]));
+		}
+
+		void WriteBuffer(uint32_t resource, uint64_t offset, ByteSpan data)
+		{
+			Object& object = At(resource);
+			if (object.mapped && offset <= object.mapped_size && data.size <= object.mapped_size - offset)
+			{
+				std::memcpy(object.mapped + offset, data.data, data.size);
+			}
+		}
+
+		void Reset(uint32_t list, uint32_t pipeline_state)
+		{
+			Object& object = At(list);
+			if (!object.list) return;
+			// bundleķãбûύķֱӸãύִϵķ
+			if (object.list_type == D3D12_COMMAND_LIST_TYPE_BUNDLE)
+			{
+				if (object.allocator) object.pending.push_back({std::move(object.allocator), nullptr, 0});
+			}
+			else if (!object.allocator && !object.pending.empty())
+			{
+				Allocator& oldest = object.pending.front();
+				if (oldest.fence->GetCompletedValue() >= oldest.fence_value)
+				{
+					object.allocator = std::move(oldest.allocator);
+					object.pending.pop_front();
+				}
+			}
+			if (object.allocator) DxDebug::ThrowIfFailed(object.allocator->Reset());
+			else DxDebug::ThrowIfFailed(m_device->CreateCommandAllocator(object.list_type, IID_PPV_ARGS(&object.allocator)));
+			DxDebug::ThrowIfFailed(object.list->Reset(object.allocator.Get(), At(pipeline_state).pipeline_state.Get()));
+			object.closed = false;
+		}
+
+		void Close(uint32_t list)
+		{
+			Object& object = At(list);
+			if (!object.list || object.closed) return;
+			DxDebug::ThrowIfFailed(object.list->Close());
+			object.closed = true;
+		}
+
+		void ResourceBarrier(uint32_t list, const Barrier* barriers, uint32_t count)
+		{
+			m_barriers.clear();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				D3D12_RESOURCE_BARRIER barrier{};
+				barrier.Type = static_cast<D3D12_RESOURCE_BARRIER_TYPE>(barriers[i].type);
+				if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION)
+				{
+					barrier.Transition = {Resource(barriers[i].resource), barriers[i].subresource,
+						static_cast<D3D12_RESOURCE_STATES>(barriers[i].before), static_cast<D3D12_RESOURCE_STATES>(barriers[i].after)};
+				}
+				else
+				{
+					barrier.UAV.pResource = Resource(barriers[i].resource);
+				}
+				m_barriers.push_back(barrier);
+			}
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->ResourceBarrier(count, m_barriers.data());
+		}
+
+		void CopyBufferRegion(uint32_t list, GpuAddress destination, GpuAddress source, uint64_t size)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			ID3D12Resource* destination_resource = Resource(destination.resource);
+			ID3D12Resource* source_resource = Resource(source.resource);
+			if (command_list && destination_resource && source_resource)
+			{
+				command_list->CopyBufferRegion(destination_resource, destination.offset, source_resource, source.offset, size);
+			}
+		}
+
+		void ClearRenderTargetView(uint32_t list, DescriptorHandle handle, const float* color)
+		{
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->ClearRenderTargetView(Handle(handle), color, 0, nullptr);
+		}
+
+		void ClearDepthStencilView(uint32_t list, DescriptorHandle handle, uint32_t flags, float depth, uint32_t stencil)
+		{
+			if (ID3D12GraphicsCommandList* command_list = List(list))
+			{
+				command_list->ClearDepthStencilView(Handle(handle), static_cast<D3D12_CLEAR_FLAGS>(flags), depth, static_cast<UINT8>(stencil), 0, nullptr);
+			}
+		}
+
+		void SetViewports(uint32_t list, const Viewport* viewports, uint32_t count)
+		{
+			static_assert(sizeof(Viewport) == sizeof(D3D12_VIEWPORT), "Viewport must match D3D12_VIEWPORT.");
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->RSSetViewports(count, reinterpret_cast<const D3D12_VIEWPORT*>(viewports));
+		}
+
+		void SetScissorRects(uint32_t list, const Rect* rects, uint32_t count)
+		{
+			static_assert(sizeof(Rect) == sizeof(D3D12_RECT), "Rect must match D3D12_RECT.");
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->RSSetScissorRects(count, reinterpret_cast<const D3D12_RECT*>(rects));
+		}
+
+		void SetRenderTargets(uint32_t list, const DescriptorHandle* render_targets, uint32_t count, const DescriptorHandle* depth_stencil)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			if (!command_list) return;
+			D3D12_CPU_DESCRIPTOR_HANDLE handles[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+			count = std::min<uint32_t>(count, D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				handles[i] = Handle(render_targets[i]);
+			}
+			D3D12_CPU_DESCRIPTOR_HANDLE depth_stencil_handle = depth_stencil ? Handle(*depth_stencil) : D3D12_CPU_DESCRIPTOR_HANDLE{};
+			command_list->OMSetRenderTargets(count, handles, FALSE, depth_stencil ? &depth_stencil_handle : nullptr);
+		}
+
+		void SetPipelineState(uint32_t list, uint32_t pipeline_state)
+		{
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->SetPipelineState(At(pipeline_state).pipeline_state.Get());
+		}
+
+		void SetRootSignature(uint32_t list, bool compute, uint32_t root_signature)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			if (!command_list) return;
+			ID3D12RootSignature* signature = At(root_signature).root_signature.Get();
+			if (compute) command_list->SetComputeRootSignature(signature);
+			else command_list->SetGraphicsRootSignature(signature);
+		}
+
+		void SetRoot32BitConstants(uint32_t list, bool compute, uint32_t parameter, ByteSpan values, uint32_t destination_offset)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			if (!command_list) return;
+			// ֽڱڸ֤룬ȿ
+			m_constants.resize(values.size / sizeof(uint32_t));
+			std::memcpy(m_constants.data(), values.data, m_constants.size() * sizeof(uint32_t));
+			UINT count = static_cast<UINT>(m_constants.size());
+			if (compute) command_list->SetComputeRoot32BitConstants(parameter, count, m_constants.data(), destination_offset);
+			else command_list->SetGraphicsRoot32BitConstants(parameter, count, m_constants.data(), destination_offset);
+		}
+
+		void SetRootDescriptor(uint32_t list, bool compute, RootDescriptor kind, uint32_t parameter, GpuAddress location)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			if (!command_list) return;
+			D3D12_GPU_VIRTUAL_ADDRESS address = Address(location);
+			switch (kind)
+			{
+			case RootDescriptor::Cbv:
+				if (compute) command_list->SetComputeRootConstantBufferView(parameter, address);
+				else command_list->SetGraphicsRootConstantBufferView(parameter, address);
+				break;
+			case RootDescriptor::Srv:
+				if (compute) command_list->SetComputeRootShaderResourceView(parameter, address);
+				else command_list->SetGraphicsRootShaderResourceView(parameter, address);
+				break;
+			case RootDescriptor::Uav:
+				if (compute) command_list->SetComputeRootUnorderedAccessView(parameter, address);
+				else command_list->SetGraphicsRootUnorderedAccessView(parameter, address);
+				break;
+			}
+		}
+
+		void SetPrimitiveTopology(uint32_t list, uint32_t topology)
+		{
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(topology));
+		}
+
+		void SetVertexBuffers(uint32_t list, uint32_t start_slot, const VertexBufferView* views, uint32_t count)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			if (!command_list) return;
+			D3D12_VERTEX_BUFFER_VIEW buffer_views[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+			count = std::min<uint32_t>(count, D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				buffer_views[i] = {Address(views[i].location), views[i].size, views[i].stride};
+			}
+			command_list->IASetVertexBuffers(start_slot, count, buffer_views);
+		}
+
+		void SetIndexBuffer(uint32_t list, const IndexBufferView& view)
+		{
+			D3D12_INDEX_BUFFER_VIEW index_view{Address(view.location), view.size, static_cast<DXGI_FORMAT>(view.format)};
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->IASetIndexBuffer(&index_view);
+		}
+
+		void DrawIndexedInstanced(uint32_t list, uint32_t index_count, uint32_t instance_count, uint32_t start_index, int32_t base_vertex, uint32_t start_instance)
+		{
+			if (ID3D12GraphicsCommandList* command_list = List(list))
+			{
+				command_list->DrawIndexedInstanced(index_count, instance_count, start_index, base_vertex, start_instance);
+			}
+		}
+
+		void Dispatch(uint32_t list, uint32_t x, uint32_t y, uint32_t z)
+		{
+			if (ID3D12GraphicsCommandList* command_list = List(list)) command_list->Dispatch(x, y, z);
+		}
+
+		// û¼ݵbundleִ
+		void ExecuteBundle(uint32_t list, uint32_t bundle)
+		{
+			ID3D12GraphicsCommandList* command_list = List(list);
+			Object& bundle_object = At(bundle);
+			if (command_list && bundle_object.list && bundle_object.closed && bundle_object.allocator)
+			{
+				command_list->ExecuteBundle(bundle_object.list.Get());
+			}
+		}
+
+		void ExecuteCommandLists(uint32_t queue, const uint32_t* lists, uint32_t count)
+		{
+			Object& queue_object = At(queue);
+			if (!queue_object.queue) return;
+			m_submissions.clear();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Object& list = At(lists[i]);
+				if (list.list && list.closed) m_submissions.push_back(list.list.Get());
+			}
+			if (m_submissions.empty()) return;
+			queue_object.queue->ExecuteCommandLists(static_cast<UINT>(m_submissions.size()), m_submissions.data());
+			// ڲύб´ʱݴжϾɷܷ
+			DxDebug::ThrowIfFailed(queue_object.queue->Signal(queue_object.fence.Get(), ++queue_object.fence_value));
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Object& list = At(lists[i]);
+				if (!list.list || !list.closed || !list.allocator) continue;
+				list.pending.push_back({std::move(list.allocator), queue_object.fence, queue_object.fence_value});
+			}
+		}
+
+		void Signal(uint32_t queue, uint32_t fence, uint64_t value)
+		{
+			Object& queue_object = At(queue);
+			ID3D12Fence* fence_object = At(fence).fence.Get();
+			if (queue_object.queue && fence_object) DxDebug::ThrowIfFailed(queue_object.queue->Signal(fence_object, value));
+		}
+
+		void Wait(uint32_t queue, uint32_t fence, uint64_t value)
+		{
+			Object& queue_object = At(queue);
+			ID3D12Fence* fence_object = At(fence).fence.Get();
+			if (queue_object.queue && fence_object) DxDebug::ThrowIfFailed(queue_object.queue->Wait(fence_object, value));
+		}
+
+		void WaitForFence(uint32_t fence, uint64_t value)
+		{
+			if (ID3D12Fence* fence_object = At(fence).fence.Get()) WaitFor(fence_object, value);
+		}
+
+		void FrameBegin(uint32_t)
+		{
+		}
+
+		void FrameEnd()
+		{
+		}
+
+	private:
+		struct Allocator
+		{
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+			Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+			uint64_t fence_value;
+		};
+
+		// еһ󣬰ֻõмԱ
+		struct Object
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			D3D12_GPU_VIRTUAL_ADDRESS gpu_address = 0;
+			uint8_t* mapped = nullptr;
+			uint64_t mapped_size = 0;
+			Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap;
+			D3D12_CPU_DESCRIPTOR_HANDLE heap_start{};
+			UINT descriptor_size = 0;
+			Microsoft::WRL::ComPtr<ID3D12RootSignature> root_signature;
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> pipeline_state;
+			Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+			Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+			uint64_t fence_value = 0;
+			Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> list;
+			D3D12_COMMAND_LIST_TYPE list_type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+			std::deque<Allocator> pending;
+			bool closed = true;
+		};
+
+		// ظʹõıȰѾɶͷб
+		Object& Create(uint32_t id)
+		{
+			if (id >= m_objects.size()) m_objects.resize(static_cast<size_t>(id) + 1);
+			if (m_objects[id].resource || m_objects[id].heap || m_objects[id].list || m_objects[id].queue || m_objects[id].fence)
+			{
+				m_retired.push_back(std::move(m_objects[id]));
+			}
+			m_objects[id] = Object{};
+			return m_objects[id];
+		}
+
+		// Խձŷһն
+		Object& At(uint32_t id)
+		{
+			if (id == 0 || id >= m_objects.size())
+			{
+				m_empty = Object{};
+				return m_empty;
+			}
+			return m_objects[id];
+		}
+
+		ID3D12Resource* Resource(uint32_t id)
+		{
+			return At(id).resource.Get();
+		}
+
+		// ֻд򿪵б
+		ID3D12GraphicsCommandList* List(uint32_t id)
+		{
+			Object& object = At(id);
+			return object.closed ? nullptr : object.list.Get();
+		}
+
+		D3D12_CPU_DESCRIPTOR_HANDLE Handle(DescriptorHandle handle)
+		{
+			const Object& heap = At(handle.heap);
+			return {heap.heap_start.ptr + static_cast<SIZE_T>(handle.index) * heap.descriptor_size};
+		}
+
+		D3D12_GPU_VIRTUAL_ADDRESS Address(GpuAddress address)
+		{
+			const Object& buffer = At(address.resource);
+			return buffer.gpu_address ? buffer.gpu_address + address.offset : 0;
+		}
+
+		void WaitFor(ID3D12Fence* fence, uint64_t value)
+		{
+			if (fence->GetCompletedValue() >= value) return;
+			DxDebug::ThrowIfFailed(fence->SetEventOnCompletion(value, m_event));
+			::WaitForSingleObject(m_event, INFINITE);
+		}
+
+		Microsoft::WRL::ComPtr<ID3D12Device10> m_device;
+		HANDLE m_event = NULL;
+		std::vector<Object> m_objects;
+		std::vector<Object> m_retired;
+		Object m_empty;
+		std::vector<D3D12_INPUT_ELEMENT_DESC> m_input_layout;
+		std::vector<D3D12_RESOURCE_BARRIER> m_barriers;
+		std::vector<uint32_t> m_constants;
+		std::vector<ID3D12CommandList*> m_submissions;
+	};
+}
+#endif
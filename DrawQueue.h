@@ -0,0 +1,425 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "WorkerPool.h"
+
+namespace DrawHelper
+{
+	// ---------------------------------------------------------------
+	// 64λӸλλͨ 8 |  12 |  20 |  24
+	// ύȰͨ飬پϲߺͲлͬһɽԶ
+	// ---------------------------------------------------------------
+
+	enum class DrawPass : uint32_t
+	{
+		DepthPrepass = 0,
+		Opaque = 1,
+		Transparent = 2,
+	};
+
+	static const uint32_t m_pass_bits = 8;
+	static const uint32_t m_pipeline_bits = 12;
+	static const uint32_t m_material_bits = 20;
+	static const uint32_t m_depth_bits = 24;
+
+	static const uint32_t m_depth_shift = 0;
+	static const uint32_t m_material_shift = m_depth_shift + m_depth_bits;
+	static const uint32_t m_pipeline_shift = m_material_shift + m_material_bits;
+	static const uint32_t m_pass_shift = m_pipeline_shift + m_pipeline_bits;
+
+	// Ϊ[0, 1]Ĺһͼȣ͸ҪԶȡ
+	inline uint32_t QuantizeDepth(float depth, bool back_to_front = false)
+	{
+		const uint32_t depth_max = (1u << m_depth_bits) - 1;
+		depth = std::min(std::max(depth, 0.0f), 1.0f);
+		uint32_t quantized = static_cast<uint32_t>(depth * depth_max);
+		return back_to_front ? depth_max - quantized : quantized;
+	}
+
+	inline uint64_t MakeSortKey(DrawPass pass, uint32_t pipeline, uint32_t material, uint32_t depth)
+	{
+		return (static_cast<uint64_t>(pass) << m_pass_shift) |
+			(static_cast<uint64_t>(pipeline & ((1u << m_pipeline_bits) - 1)) << m_pipeline_shift) |
+			(static_cast<uint64_t>(material & ((1u << m_material_bits) - 1)) << m_material_shift) |
+			(static_cast<uint64_t>(depth & ((1u << m_depth_bits) - 1)) << m_depth_shift);
+	}
+
+	inline DrawPass KeyPass(uint64_t key) { return static_cast<DrawPass>(key >> m_pass_shift); }
+	inline uint32_t KeyPipeline(uint64_t key) { return static_cast<uint32_t>(key >> m_pipeline_shift) & ((1u << m_pipeline_bits) - 1); }
+	inline uint32_t KeyMaterial(uint64_t key) { return static_cast<uint32_t>(key >> m_material_shift) & ((1u << m_material_bits) - 1); }
+
+	// ֻƶͻݵݱ
+	struct DrawPacket
+	{
+		uint64_t key;
+		uint32_t command;
+	};
+
+	// ---------------------------------------------------------------
+	// LSDÿ8λмĳһֽͬʱ
+	// ϶ʱֿ鲢Уÿȸͳֱͼٰ(Ͱ, ߳)ǰ׺ȶطɢд
+	// ߳ڵһβʱפֻ֮
+	// ---------------------------------------------------------------
+
+	class RadixSorter
+	{
+	public:
+		static const uint32_t m_parallel_threshold = 65536;
+
+		// thread_countΪ0ʱʹӲ߳
+		void Sort(std::vector<DrawPacket>& packets, uint32_t thread_count = 0)
+		{
+			size_t count = packets.size();
+			if (count < 2) return;
+			if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+			if (count < m_parallel_threshold) thread_count = 1;
+			thread_count = static_cast<uint32_t>(std::min<size_t>(thread_count, std::max<size_t>(1, count / (m_parallel_threshold / 4))));
+			// ̳߳زʱ߳Ҳһ
+			if (thread_count > m_pool.ThreadCount()) m_pool.Start(std::max(thread_count, std::max(1u, std::thread::hardware_concurrency())) - 1);
+			m_thread_count = thread_count;
+			m_scratch.resize(count);
+			m_histograms.assign(size_t(thread_count) * 256, 0);
+			m_differing_bits.store(0, std::memory_order_relaxed);
+			m_barrier.Reset(thread_count);
+			m_source = packets.data();
+			m_destination = m_scratch.data();
+			m_count = count;
+
+			// ߳ʱֱڵ߳ɣڳפִ߳Уųֱ߳߳ӷ
+			if (thread_count == 1)
+			{
+				SortRange(0);
+			}
+			else
+			{
+				m_pool.Run([](void* pointer, uint32_t worker)
+					{
+						RadixSorter& sorter = *static_cast<RadixSorter*>(pointer);
+						if (worker < sorter.m_thread_count) sorter.SortRange(worker);
+					}, this);
+			}
+
+			// ʱʱУ´ٷ
+			if (m_source != packets.data()) packets.swap(m_scratch);
+		}
+
+		// һʵִе
+		uint32_t PassCount() const { return m_pass_count; }
+
+	private:
+		// ϣÿֻҪͬȴʱܶ
+		class SpinBarrier
+		{
+		public:
+			void Reset(uint32_t thread_count)
+			{
+				m_thread_count = thread_count;
+				m_arrived.store(0);
+			}
+
+			void Wait()
+			{
+				if (m_thread_count == 1) return;
+				uint32_t generation = m_generation.load(std::memory_order_acquire);
+				if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_thread_count)
+				{
+					m_arrived.store(0, std::memory_order_relaxed);
+					m_generation.fetch_add(1, std::memory_order_release);
+					return;
+				}
+				while (m_generation.load(std::memory_order_acquire) == generation)
+				{
+					std::this_thread::yield();
+				}
+			}
+
+		private:
+			uint32_t m_thread_count = 1;
+			std::atomic<uint32_t> m_arrived{0};
+			std::atomic<uint32_t> m_generation{0};
+		};
+
+		void SortRange(uint32_t thread)
+		{
+			size_t begin = m_count * thread / m_thread_count;
+			size_t end = m_count * (thread + 1) / m_thread_count;
+			DrawPacket* source = m_source;
+			DrawPacket* destination = m_destination;
+
+			// ͳмһͬλֵȫֽͬڲҪ
+			uint64_t first_key = source[0].key;
+			uint64_t differing = 0;
+			for (size_t i = begin; i < end; ++i) differing |= source[i].key ^ first_key;
+			m_differing_bits.fetch_or(differing, std::memory_order_relaxed);
+			m_barrier.Wait();
+			differing = m_differing_bits.load(std::memory_order_relaxed);
+
+			uint32_t pass_count = 0;
+			uint32_t* histogram = &m_histograms[size_t(thread) * 256];
+			for (uint32_t shift = 0; shift < 64; shift += 8)
+			{
+				if (((differing >> shift) & 0xff) == 0) continue;
+				++pass_count;
+
+				std::memset(histogram, 0, 256 * sizeof(uint32_t));
+				for (size_t i = begin; i < end; ++i) ++histogram[(source[i].key >> shift) & 0xff];
+				m_barrier.Wait();
+
+				// ÿ̶߳ԼÿͰд㣺ǰͰǰ߳ڱͰ
+				uint32_t offsets[256];
+				uint32_t running = 0;
+				for (uint32_t bucket = 0; bucket < 256; ++bucket)
+				{
+					for (uint32_t other = 0; other < m_thread_count; ++other)
+					{
+						if (other == thread) offsets[bucket] = running;
+						running += m_histograms[size_t(other) * 256 + bucket];
+					}
+				}
+				for (size_t i = begin; i < end; ++i)
+				{
+					destination[offsets[(source[i].key >> shift) & 0xff]++] = source[i];
+				}
+				// ߳дܿʼһ֣ͬʱֱ֤ͼڱ̶߳ȡʱ
+				m_barrier.Wait();
+				std::swap(source, destination);
+			}
+			if (thread == 0)
+			{
+				m_source = source;
+				m_pass_count = pass_count;
+			}
+		}
+
+		std::vector<DrawPacket> m_scratch;
+		std::vector<uint32_t> m_histograms;
+		std::atomic<uint64_t> m_differing_bits{0};
+		SpinBarrier m_barrier;
+		DrawPacket* m_source = nullptr;
+		DrawPacket* m_destination = nullptr;
+		size_t m_count = 0;
+		uint32_t m_thread_count = 1;
+		uint32_t m_pass_count = 0;
+		ThreadHelper::WorkerPool m_pool;
+	};
+
+	// ---------------------------------------------------------------
+	// ƶУÿ֡ռư˳ύ
+	// ---------------------------------------------------------------
+
+	// һλҪݣpipelinematerialеıһ
+	struct DrawCommand
+	{
+		uint32_t pipeline;
+		uint32_t material;
+		uint32_t mesh_id;
+		uint32_t object;
+	};
+
+	class DrawQueue
+	{
+	public:
+		// ֡ʼʱգ
+		void Reset()
+		{
+			m_packets.clear();
+			m_commands.clear();
+		}
+
+		void Submit(uint64_t key, const DrawCommand& command)
+		{
+			m_packets.push_back({key, static_cast<uint32_t>(m_commands.size())});
+			m_commands.push_back(command);
+		}
+
+		// Ա֡Ļư򲢼¼ʱ
+		void Sort(uint32_t thread_count = 0)
+		{
+			auto sort_begin = std::chrono::high_resolution_clock::now();
+			m_sorter.Sort(m_packets, thread_count);
+			m_sort_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - sort_begin).count();
+		}
+
+		const std::vector<DrawPacket>& Packets() const { return m_packets; }
+		const DrawCommand& Command(const DrawPacket& packet) const { return m_commands[packet.command]; }
+		size_t Size() const { return m_packets.size(); }
+		double SortSeconds() const { return m_sort_seconds; }
+		uint32_t SortPassCount() const { return m_sorter.PassCount(); }
+
+	private:
+		std::vector<DrawPacket> m_packets;
+		std::vector<DrawCommand> m_commands;
+		RadixSorter m_sorter;
+		double m_sort_seconds = 0.0;
+	};
+
+	// ύ˳ͳڻ֮ߡʺı仯Ҫ豸ɱȽǰл
+	struct DrawOrderStats
+	{
+		uint32_t pipeline_changes = 0;
+		uint32_t material_changes = 0;
+		uint32_t mesh_changes = 0;
+	};
+
+	inline DrawOrderStats MeasureDrawOrder(const DrawQueue& queue, const std::vector<DrawPacket>& packets)
+	{
+		DrawOrderStats stats;
+		const DrawCommand* previous = nullptr;
+		for (const DrawPacket& packet : packets)
+		{
+			const DrawCommand& command = queue.Command(packet);
+			stats.pipeline_changes += !previous || command.pipeline != previous->pipeline ? 1 : 0;
+			stats.material_changes += !previous || command.material != previous->material ? 1 : 0;
+			stats.mesh_changes += !previous || command.mesh_id != previous->mesh_id ? 1 : 0;
+			previous = &command;
+		}
+		return stats;
+	}
+}
+
+#if defined(_WIN32)
+#include <d3d12.h>
+
+namespace DrawHelper
+{
+	// еĹ߱ŶӦĹ״̬͸ǩ
+	struct PipelineBinding
+	{
+		ID3D12PipelineState* pipeline_state;
+		ID3D12RootSignature* root_signature;
+	};
+
+	// ---------------------------------------------------------------
+	// ״̬ˣסбϵǰ״̬ͬòظ¼
+	// ---------------------------------------------------------------
+
+	// bundleõĹߺװ״ֱ̬õ״̬һл
+	struct DrawStateStats
+	{
+		uint32_t draws = 0;
+		uint32_t bundles = 0;
+		uint32_t pipeline_changes = 0;
+		uint32_t root_signature_changes = 0;
+		uint32_t input_assembler_changes = 0;
+		uint32_t redundant_skipped = 0;
+	};
+
+	template <typename CommandList>
+	class StateFilter
+	{
+	public:
+		explicit StateFilter(CommandList* command_list) : m_command_list(command_list)
+		{
+		}
+
+		void SetPipelineState(ID3D12PipelineState* pipeline_state)
+		{
+			if (pipeline_state == m_pipeline_state)
+			{
+				++m_stats.redundant_skipped;
+				return;
+			}
+			m_command_list->SetPipelineState(pipeline_state);
+			m_pipeline_state = pipeline_state;
+			++m_stats.pipeline_changes;
+		}
+
+		// лǩʹиʧЧ
+		void SetGraphicsRootSignature(ID3D12RootSignature* root_signature)
+		{
+			if (root_signature == m_root_signature)
+			{
+				++m_stats.redundant_skipped;
+				return;
+			}
+			m_command_list->SetGraphicsRootSignature(root_signature);
+			m_root_signature = root_signature;
+			++m_stats.root_signature_changes;
+		}
+
+		void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+		{
+			if (m_has_topology && topology == m_topology)
+			{
+				++m_stats.redundant_skipped;
+				return;
+			}
+			m_command_list->IASetPrimitiveTopology(topology);
+			m_topology = topology;
+			m_has_topology = true;
+			++m_stats.input_assembler_changes;
+		}
+
+		void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+		{
+			if (m_has_vertex_buffer && std::memcmp(&view, &m_vertex_buffer, sizeof(view)) == 0)
+			{
+				++m_stats.redundant_skipped;
+				return;
+			}
+			m_command_list->IASetVertexBuffers(0, 1, &view);
+			m_vertex_buffer = view;
+			m_has_vertex_buffer = true;
+			++m_stats.input_assembler_changes;
+		}
+
+		void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+		{
+			if (m_has_index_buffer && std::memcmp(&view, &m_index_buffer, sizeof(view)) == 0)
+			{
+				++m_stats.redundant_skipped;
+				return;
+			}
+			m_command_list->IASetIndexBuffer(&view);
+			m_index_buffer = view;
+			m_has_index_buffer = true;
+			++m_stats.input_assembler_changes;
+		}
+
+		void DrawIndexedInstanced(UINT index_count, UINT instance_count, UINT start_index, INT base_vertex, UINT start_instance)
+		{
+			m_command_list->DrawIndexedInstanced(index_count, instance_count, start_index, base_vertex, start_instance);
+			++m_stats.draws;
+		}
+
+		// bundleõĹ״̬װ״ִ̬кбϣ÷bundle¼Ƶ״̬
+		// 뵱ǰ״̬ͬļΪлֱ֮Ƚϣbundleûлƣɵ÷֮¼
+		void ExecuteBundle(ID3D12GraphicsCommandList* bundle, ID3D12PipelineState* pipeline_state, D3D12_PRIMITIVE_TOPOLOGY topology,
+			const D3D12_VERTEX_BUFFER_VIEW& vertex_buffer, const D3D12_INDEX_BUFFER_VIEW& index_buffer)
+		{
+			m_command_list->ExecuteBundle(bundle);
+			m_stats.pipeline_changes += pipeline_state != m_pipeline_state ? 1 : 0;
+			m_stats.input_assembler_changes += !m_has_topology || topology != m_topology ? 1 : 0;
+			m_stats.input_assembler_changes += !m_has_vertex_buffer || std::memcmp(&vertex_buffer, &m_vertex_buffer, sizeof(vertex_buffer)) != 0 ? 1 : 0;
+			m_stats.input_assembler_changes += !m_has_index_buffer || std::memcmp(&index_buffer, &m_index_buffer, sizeof(index_buffer)) != 0 ? 1 : 0;
+			m_pipeline_state = pipeline_state;
+			m_topology = topology;
+			m_vertex_buffer = vertex_buffer;
+			m_index_buffer = index_buffer;
+			m_has_topology = true;
+			m_has_vertex_buffer = true;
+			m_has_index_buffer = true;
+			++m_stats.bundles;
+		}
+
+		const DrawStateStats& Stats() const { return m_stats; }
+
+	private:
+		CommandList* m_command_list;
+		ID3D12PipelineState* m_pipeline_state = nullptr;
+		ID3D12RootSignature* m_root_signature = nullptr;
+		D3D12_PRIMITIVE_TOPOLOGY m_topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+		D3D12_VERTEX_BUFFER_VIEW m_vertex_buffer{};
+		D3D12_INDEX_BUFFER_VIEW m_index_buffer{};
+		bool m_has_topology = false;
+		bool m_has_vertex_buffer = false;
+		bool m_has_index_buffer = false;
+		DrawStateStats m_stats;
+	};
+}
+#endif
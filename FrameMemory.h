@@ -0,0 +1,616 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace MemoryHelper
+{
+	// ---------------------------------------------------------------
+	// ȫoperator new/deleteTrackedAllocate/TrackedFreeǰ̵߳ıǩۼƴֽ
+	// ǩʱǼǣsteadyΪfalseıǩʾż̨ؽڴС仯ȣ̬
+	// ״̬ǳʼģoperator newκξ̬֮ǰҲǰȫ
+	// ---------------------------------------------------------------
+
+	static const uint32_t m_max_tags = 32;
+
+	struct AllocationTags
+	{
+		std::atomic<uint32_t> count{1};
+		const char* names[m_max_tags] = {"untagged"};
+		bool steady[m_max_tags] = {};
+		std::atomic<uint64_t> allocations[m_max_tags] = {};
+		std::atomic<uint64_t> bytes[m_max_tags] = {};
+		std::atomic<uint64_t> frees{0};
+	};
+
+	inline AllocationTags& Tags()
+	{
+		static AllocationTags tags;
+		return tags;
+	}
+
+	// ǰ̵߳ıǩûʱΪ0untagged̬飩߳Ĭ
+	inline uint32_t& CurrentTag()
+	{
+		thread_local uint32_t tag = 0;
+		return tag;
+	}
+
+	// Ǽһǩرţǩʱ0
+	inline uint32_t RegisterTag(const char* name, bool steady = true)
+	{
+		AllocationTags& tags = Tags();
+		uint32_t tag = tags.count.fetch_add(1, std::memory_order_relaxed);
+		if (tag >= m_max_tags) return 0;
+		tags.names[tag] = name;
+		tags.steady[tag] = steady;
+		return tag;
+	}
+
+	inline uint32_t TagCount() { return std::min(Tags().count.load(std::memory_order_relaxed), m_max_tags); }
+	inline const char* TagName(uint32_t tag) { return Tags().names[tag]; }
+	inline bool IsSteadyTag(uint32_t tag) { return Tags().steady[tag]; }
+
+	// ڵǰ̵߳ķtag£뿪ʱָ֮ǰıǩ
+	class AllocationScope
+	{
+	public:
+		explicit AllocationScope(uint32_t tag) : m_previous(CurrentTag())
+		{
+			CurrentTag() = tag;
+		}
+
+		~AllocationScope()
+		{
+			CurrentTag() = m_previous;
+		}
+
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+	private:
+		uint32_t m_previous;
+	};
+
+	inline void CountAllocation(size_t size)
+	{
+		AllocationTags& tags = Tags();
+		uint32_t tag = CurrentTag();
+		tags.allocations[tag].fetch_add(1, std::memory_order_relaxed);
+		tags.bytes[tag].fetch_add(size, std::memory_order_relaxed);
+	}
+
+	inline void* TrackedAllocate(size_t size)
+	{
+		void* pointer = std::malloc(size ? size : 1);
+		if (pointer) CountAllocation(size);
+		return pointer;
+	}
+
+	inline void TrackedFree(void* pointer)
+	{
+		if (!pointer) return;
+		Tags().frees.fetch_add(1, std::memory_order_relaxed);
+		std::free(pointer);
+	}
+
+	inline void* TrackedAllocateAligned(size_t size, size_t alignment)
+	{
+#if defined(_WIN32)
+		void* pointer = _aligned_malloc(size ? size : 1, alignment);
+#else
+		void* pointer = std::aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment);
+#endif
+		if (pointer) CountAllocation(size);
+		return pointer;
+	}
+
+	inline void TrackedFreeAligned(void* pointer)
+	{
+		if (!pointer) return;
+		Tags().frees.fetch_add(1, std::memory_order_relaxed);
+#if defined(_WIN32)
+		_aligned_free(pointer);
+#else
+		std::free(pointer);
+#endif
+	}
+
+	// һ֡ڵͨöѷ䣬ʱ̵߳ķ䣬ǩ
+	struct FrameAllocationStats
+	{
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+		// ̬ǩϵķ䣬֡ѭ̬ӦΪ0
+		uint64_t steady_allocations = 0;
+		uint64_t tag_allocations[m_max_tags] = {};
+	};
+
+	// ÿ֡ʼͽʱȡһμգֵǱ֡ķ
+	class AllocationTracker
+	{
+	public:
+		void BeginFrame()
+		{
+			AllocationTags& tags = Tags();
+			for (uint32_t tag = 0; tag < m_max_tags; ++tag)
+			{
+				m_begin_allocations[tag] = tags.allocations[tag].load(std::memory_order_relaxed);
+				m_begin_bytes[tag] = tags.bytes[tag].load(std::memory_order_relaxed);
+			}
+		}
+
+		const FrameAllocationStats& EndFrame()
+		{
+			AllocationTags& tags = Tags();
+			m_last = FrameAllocationStats{};
+			for (uint32_t tag = 0; tag < m_max_tags; ++tag)
+			{
+				uint64_t allocations = tags.allocations[tag].load(std::memory_order_relaxed) - m_begin_allocations[tag];
+				m_last.tag_allocations[tag] = allocations;
+				m_last.allocations += allocations;
+				m_last.bytes += tags.bytes[tag].load(std::memory_order_relaxed) - m_begin_bytes[tag];
+				if (tags.steady[tag]) m_last.steady_allocations += allocations;
+			}
+			++m_frame_count;
+			m_total_allocations += m_last.allocations;
+			return m_last;
+		}
+
+		const FrameAllocationStats& LastFrame() const { return m_last; }
+		uint64_t FrameCount() const { return m_frame_count; }
+		uint64_t TotalAllocations() const { return m_total_allocations; }
+
+	private:
+		uint64_t m_begin_allocations[m_max_tags] = {};
+		uint64_t m_begin_bytes[m_max_tags] = {};
+		FrameAllocationStats m_last;
+		uint64_t m_frame_count = 0;
+		uint64_t m_total_allocations = 0;
+	};
+
+	// ---------------------------------------------------------------
+	// ÿ֡ԷCPUڴ棬볣һ֡ɺտ
+	// ڿСʹöĴ飬պͬСãԤ֮ͨö
+	// ---------------------------------------------------------------
+
+	struct FrameArenaStats
+	{
+		size_t used_bytes = 0;
+		size_t peak_bytes = 0;
+		size_t reserved_bytes = 0;
+		uint32_t block_count = 0;
+	};
+
+	class FrameArena
+	{
+	public:
+		static const size_t m_default_block_size = 1024 * 1024;
+
+		explicit FrameArena(size_t block_size = m_default_block_size) : m_block_size(block_size) {}
+
+		~FrameArena()
+		{
+			for (std::vector<Block>* blocks : {&m_used, &m_retired, &m_free})
+			{
+				for (Block& block : *blocks) ::operator delete(block.data);
+			}
+			if (m_current.data) ::operator delete(m_current.data);
+		}
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		// ֡ʼʱGPUѾʹϵĿ
+		void BeginFrame(uint64_t completed_fence_value)
+		{
+			size_t kept = 0;
+			for (Block& block : m_retired)
+			{
+				if (block.fence_value <= completed_fence_value) m_free.push_back(block);
+				else m_retired[kept++] = block;
+			}
+			m_retired.resize(kept);
+		}
+
+		// Ҫ䣬þʱŽ·
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+		{
+			size_t offset = AlignOffset(m_current, alignment);
+			if (!m_current.data || offset + size > m_current.size)
+			{
+				NewBlock(size + alignment);
+				offset = AlignOffset(m_current, alignment);
+			}
+			void* pointer = m_current.data + offset;
+			m_offset = offset + size;
+			m_stats.used_bytes = m_used_before_current + m_offset;
+			m_stats.peak_bytes = std::max(m_stats.peak_bytes, m_stats.used_bytes);
+			return pointer;
+		}
+
+		template <typename T>
+		T* Allocate(size_t count)
+		{
+			return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+		}
+
+		// ֡ùĿڸøɺܸ
+		void EndFrame(uint64_t fence_value)
+		{
+			if (m_current.data) m_used.push_back(m_current);
+			for (Block& block : m_used)
+			{
+				block.fence_value = fence_value;
+				m_retired.push_back(block);
+			}
+			m_used.clear();
+			m_current = Block{};
+			m_offset = 0;
+			m_used_before_current = 0;
+			m_stats.used_bytes = 0;
+		}
+
+		const FrameArenaStats& Stats() const { return m_stats; }
+
+	private:
+		struct Block
+		{
+			uint8_t* data;
+			size_t size;
+			uint64_t fence_value;
+		};
+
+		size_t AlignOffset(const Block& block, size_t alignment) const
+		{
+			uintptr_t address = reinterpret_cast<uintptr_t>(block.data) + m_offset;
+			return m_offset + ((alignment - address % alignment) % alignment);
+		}
+
+		void NewBlock(size_t size)
+		{
+			if (m_current.data)
+			{
+				m_used.push_back(m_current);
+				m_used_before_current += m_offset;
+			}
+			m_offset = 0;
+			// ȸùĿп
+			for (size_t i = 0; i < m_free.size(); ++i)
+			{
+				if (m_free[i].size >= size)
+				{
+					m_current = m_free[i];
+					m_free[i] = m_free.back();
+					m_free.pop_back();
+					return;
+				}
+			}
+			// 鰴2ȡСҲܸ֮ǰĿ
+			size_t block_size = m_block_size;
+			while (block_size < size) block_size <<= 1;
+			m_current = {static_cast<uint8_t*>(::operator new(block_size)), block_size, 0};
+			m_stats.reserved_bytes += block_size;
+			++m_stats.block_count;
+		}
+
+		size_t m_block_size;
+		Block m_current{};
+		size_t m_offset = 0;
+		size_t m_used_before_current = 0;
+		std::vector<Block> m_used;
+		std::vector<Block> m_retired;
+		std::vector<Block> m_free;
+		FrameArenaStats m_stats;
+	};
+
+	// ---------------------------------------------------------------
+	// С161024ֽڵ2ݷּÿ߳Լĳأͱ̵߳ͷŶ
+	// ҳ水64KB룬ҳͷ¼ĳأڱ߳ͷŵĿѹصԶ̲߳ʱ
+	// ҳȫʱ黹ͨöѣÿһҳⷴ룻1024ֽڵֱʹͨö
+	// ضӲ߳˳󽻸֮߳̽ӹܣ̬ʱͷŵĿҲҵĳ
+	// ---------------------------------------------------------------
+
+	class SizeClassPool
+	{
+	public:
+		static const size_t m_min_size = 16;
+		static const size_t m_max_size = 1024;
+		static const uint32_t m_class_count = 7;
+		static const size_t m_page_size = 64 * 1024;
+
+		// ǰ̵߳ĳأһʹʱӹ˳̵߳ĳػ½һ߳˳֮󷵻nullptr
+		static SizeClassPool* ForThread()
+		{
+			// ƽģ̵߳thread_local֮ȻԷ
+			thread_local SizeClassPool* pool = nullptr;
+			thread_local bool exited = false;
+			if (!pool && !exited)
+			{
+				pool = Adopt();
+				thread_local ThreadExit thread_exit{&pool, &exited};
+			}
+			return pool;
+		}
+
+		// ߳˳֮羲̬ʱķʹüĹ
+		static void* AllocateShared(size_t size)
+		{
+			Registry& registry = GlobalRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			if (!registry.shared) registry.shared = new SizeClassPool;
+			return registry.shared->Allocate(size);
+		}
+
+		// ҳͷҵĳأǰ̵߳ĳֱӻգѹصԶ
+		static void Free(void* pointer)
+		{
+			FreeBlock* block = static_cast<FreeBlock*>(pointer);
+			Page* page = PageOf(block);
+			if (page->owner == ForThread()) page->owner->Release(page, block);
+			else page->owner->PushRemote(block);
+		}
+
+		static uint32_t ClassOf(size_t size)
+		{
+			uint32_t size_class = 0;
+			for (size_t class_size = m_min_size; class_size < size; class_size <<= 1) ++size_class;
+			return size_class;
+		}
+
+		void* Allocate(size_t size)
+		{
+			uint32_t size_class = ClassOf(size);
+			if (!m_pages[size_class])
+			{
+				CollectRemote();
+				if (!m_pages[size_class]) NewPage(size_class);
+			}
+			Page* page = m_pages[size_class];
+			FreeBlock* block = page->free;
+			page->free = block->next;
+			++page->used;
+			// ҳƳпͷŻʱټ
+			if (!page->free) Unlink(page);
+			return block;
+		}
+
+		// صǰеҳҳ
+		uint32_t PageCount() const { return m_page_count; }
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		// ҳͷλҳʼӰСƫƿʼ
+		struct Page
+		{
+			SizeClassPool* owner;
+			Page* next;
+			Page* previous;
+			FreeBlock* free;
+			uint32_t size_class;
+			uint32_t used;
+		};
+
+		struct Registry
+		{
+			std::mutex mutex;
+			SizeClassPool* abandoned = nullptr;
+			SizeClassPool* shared = nullptr;
+		};
+
+		struct ThreadExit
+		{
+			SizeClassPool** pool;
+			bool* exited;
+			~ThreadExit()
+			{
+				Abandon(*pool);
+				*pool = nullptr;
+				*exited = true;
+			}
+		};
+
+		SizeClassPool() = default;
+		SizeClassPool(const SizeClassPool&) = delete;
+		SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+		// עҲӲ̬ڼȻ
+		static Registry& GlobalRegistry()
+		{
+			static Registry* registry = new Registry;
+			return *registry;
+		}
+
+		static SizeClassPool* Adopt()
+		{
+			{
+				Registry& registry = GlobalRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				if (SizeClassPool* pool = registry.abandoned)
+				{
+					registry.abandoned = pool->m_next_abandoned;
+					return pool;
+				}
+			}
+			return new SizeClassPool;
+		}
+
+		static void Abandon(SizeClassPool* pool)
+		{
+			Registry& registry = GlobalRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			pool->m_next_abandoned = registry.abandoned;
+			registry.abandoned = pool;
+		}
+
+		static Page* PageOf(FreeBlock* block)
+		{
+			return reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(block) & ~uintptr_t(m_page_size - 1));
+		}
+
+		void Link(Page* page)
+		{
+			page->previous = nullptr;
+			page->next = m_pages[page->size_class];
+			if (page->next) page->next->previous = page;
+			m_pages[page->size_class] = page;
+		}
+
+		void Unlink(Page* page)
+		{
+			if (page->previous) page->previous->next = page->next;
+			else m_pages[page->size_class] = page->next;
+			if (page->next) page->next->previous = page->previous;
+		}
+
+		// ʹñҳ棬ûʱͨöһҳ沢з
+		void NewPage(uint32_t size_class)
+		{
+			Page* page = m_spare[size_class];
+			if (page)
+			{
+				m_spare[size_class] = nullptr;
+			}
+			else
+			{
+				page = static_cast<Page*>(::operator new(m_page_size, std::align_val_t(m_page_size)));
+				*page = {this, nullptr, nullptr, nullptr, size_class, 0};
+				size_t block_size = m_min_size << size_class;
+				size_t first = (sizeof(Page) + block_size - 1) / block_size * block_size;
+				uint8_t* data = reinterpret_cast<uint8_t*>(page);
+				for (size_t offset = m_page_size; offset - block_size >= first; offset -= block_size)
+				{
+					FreeBlock* block = reinterpret_cast<FreeBlock*>(data + offset - block_size);
+					block->next = page->free;
+					page->free = block;
+				}
+				++m_page_count;
+			}
+			Link(page);
+		}
+
+		void Release(Page* page, FreeBlock* block)
+		{
+			if (!page->free) Link(page);
+			block->next = page->free;
+			page->free = block;
+			if (--page->used) return;
+			// ҳȫУûбҳʱã黹ͨö
+			Unlink(page);
+			if (!m_spare[page->size_class])
+			{
+				m_spare[page->size_class] = page;
+			}
+			else
+			{
+				::operator delete(page, std::align_val_t(m_page_size));
+				--m_page_count;
+			}
+		}
+
+		void PushRemote(FreeBlock* block)
+		{
+			FreeBlock* head = m_remote.load(std::memory_order_relaxed);
+			do
+			{
+				block->next = head;
+			} while (!m_remote.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		// ձ߳ͷŵĿ飬̵ֻ߳
+		void CollectRemote()
+		{
+			FreeBlock* block = m_remote.exchange(nullptr, std::memory_order_acquire);
+			while (block)
+			{
+				FreeBlock* next = block->next;
+				Release(PageOf(block), block);
+				block = next;
+			}
+		}
+
+		Page* m_pages[m_class_count] = {};
+		Page* m_spare[m_class_count] = {};
+		std::atomic<FreeBlock*> m_remote{nullptr};
+		SizeClassPool* m_next_abandoned = nullptr;
+		uint32_t m_page_count = 0;
+	};
+
+	inline void* PoolAllocate(size_t size)
+	{
+		if (size > SizeClassPool::m_max_size) return ::operator new(size);
+		if (SizeClassPool* pool = SizeClassPool::ForThread()) return pool->Allocate(size);
+		return SizeClassPool::AllocateShared(size);
+	}
+
+	inline void PoolFree(void* pointer, size_t size)
+	{
+		if (size > SizeClassPool::m_max_size) ::operator delete(pointer);
+		else SizeClassPool::Free(pointer);
+	}
+
+	// ---------------------------------------------------------------
+	// STL
+	// ---------------------------------------------------------------
+
+	// ֡ڴ䣬ͷǿղڷ֡ʹ
+	template <typename T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit ArenaAllocator(FrameArena* arena) noexcept : m_arena(arena) {}
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.m_arena) {}
+
+		T* allocate(size_t count) { return m_arena->Allocate<T>(count); }
+		void deallocate(T*, size_t) noexcept {}
+
+		template <typename U>
+		bool operator==(const ArenaAllocator<U>& other) const noexcept { return m_arena == other.m_arena; }
+		template <typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const noexcept { return m_arena != other.m_arena; }
+
+	private:
+		template <typename U>
+		friend class ArenaAllocator;
+
+		FrameArena* m_arena;
+	};
+
+	// ӵǰ̵߳ķּط䣬ʺ͹ϣĽڵ
+	template <typename T>
+	class PoolAllocator
+	{
+	public:
+		static_assert(alignof(T) <= SizeClassPool::m_min_size, "pool blocks are only 16-byte aligned");
+		using value_type = T;
+
+		PoolAllocator() noexcept = default;
+
+		template <typename U>
+		PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+		T* allocate(size_t count) { return static_cast<T*>(PoolAllocate(count * sizeof(T))); }
+		void deallocate(T* pointer, size_t count) noexcept { PoolFree(pointer, count * sizeof(T)); }
+
+		template <typename U>
+		bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+		template <typename U>
+		bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+	};
+
+	template <typename T>
+	using FrameVector = std::vector<T, ArenaAllocator<T>>;
+}
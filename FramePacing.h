@@ -0,0 +1,274 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
+namespace PresentHelper
+{
+	// ֱͬ֡˺ѣɱˢ֡֡ѹˢ
+	enum class PresentMode
+	{
+		VSync = 0,
+		Tearing = 1,
+		Vrr = 2,
+	};
+
+	inline const wchar_t* PresentModeName(PresentMode mode)
+	{
+		switch (mode)
+		{
+		case PresentMode::VSync: return L"vsync";
+		case PresentMode::Tearing: return L"tearing";
+		case PresentMode::Vrr: return L"vrr";
+		}
+		return L"unknown";
+	}
+
+	// ʵʱӣ߾ȿɵȴʱֵȴһС
+	class SystemClock
+	{
+	public:
+		using duration = std::chrono::nanoseconds;
+		using time_point = std::chrono::steady_clock::time_point;
+
+		SystemClock()
+		{
+#if defined(_WIN32)
+			m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+		}
+
+		~SystemClock()
+		{
+#if defined(_WIN32)
+			if (m_timer) CloseHandle(m_timer);
+#endif
+		}
+
+		SystemClock(const SystemClock&) = delete;
+		SystemClock& operator=(const SystemClock&) = delete;
+
+		time_point Now() const
+		{
+			return std::chrono::steady_clock::now();
+		}
+
+		void SleepUntil(time_point target)
+		{
+			const duration spin_threshold = std::chrono::microseconds(500);
+			duration remaining = target - Now();
+			if (remaining > spin_threshold)
+			{
+#if defined(_WIN32)
+				// ʱ100ΪλֵʾԵǰʱ
+				LARGE_INTEGER due_time{};
+				due_time.QuadPart = -static_cast<LONGLONG>((remaining - spin_threshold).count() / 100);
+				if (m_timer && SetWaitableTimerEx(m_timer, &due_time, 0, nullptr, nullptr, nullptr, 0))
+				{
+					WaitForSingleObject(m_timer, INFINITE);
+				}
+#else
+				std::this_thread::sleep_for(remaining - spin_threshold);
+#endif
+			}
+			while (Now() < target)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+#if defined(_WIN32)
+		HANDLE m_timer = nullptr;
+#endif
+	};
+
+	// ģʱӣûдں豸֤֡
+	class SimulatedClock
+	{
+	public:
+		using duration = std::chrono::nanoseconds;
+		using time_point = std::chrono::time_point<std::chrono::steady_clock, std::chrono::nanoseconds>;
+
+		time_point Now() const { return m_now; }
+		void SleepUntil(time_point target) { m_now = std::max(m_now, target); }
+		void Advance(duration delta) { m_now += delta; }
+
+	private:
+		time_point m_now{};
+	};
+
+	// ֡ӳٵͳ
+	struct FramePacingStats
+	{
+		uint64_t frame_count = 0;
+		double mean_interval_ms = 0.0;
+		double stddev_interval_ms = 0.0;
+		double min_interval_ms = 0.0;
+		double max_interval_ms = 0.0;
+		double p99_interval_ms = 0.0;
+		double mean_input_latency_ms = 0.0;
+		double max_input_latency_ms = 0.0;
+	};
+
+	// ֡Ԥһγʱ䣬ȥƵ֡ʱΪ֡ʼʱ
+	template <typename Clock>
+	class FrameLimiter
+	{
+	public:
+		using duration = typename Clock::duration;
+		using time_point = typename Clock::time_point;
+
+		explicit FrameLimiter(Clock& clock, size_t history_size = 256)
+			: m_clock(clock), m_intervals(history_size, 0.0), m_latencies(history_size, 0.0)
+		{
+			m_sorted_intervals.reserve(history_size);
+		}
+
+		// Ŀ֡Ϊ0ʱ֡
+		void SetTargetFps(double fps)
+		{
+			m_interval = fps > 0.0 ? std::chrono::duration_cast<duration>(std::chrono::duration<double>(1.0 / fps)) : duration::zero();
+		}
+
+		duration Interval() const { return m_interval; }
+
+		// ڲ¼֮ǰãر֡ʼʱ
+		time_point BeginFrame()
+		{
+			if (m_interval > duration::zero() && m_has_present)
+			{
+				// ֡ĹպԤĳʱɣӶ뵽ʾӳ
+				time_point target = m_predicted_present - m_work_estimate;
+				if (m_clock.Now() < target)
+				{
+					m_clock.SleepUntil(target);
+				}
+			}
+			m_frame_start = m_clock.Now();
+			m_input_time = m_frame_start;
+			return m_frame_start;
+		}
+
+		// ¼ʵʱʱ
+		void MarkInputSampled()
+		{
+			m_input_time = m_clock.Now();
+		}
+
+		// Present֮ǰã֡ʱ߹ʱС֤֡֡ʲ
+		void WaitForPresent()
+		{
+			// ֡ʱֻͳƵĵȴ
+			m_work_end = m_clock.Now();
+			m_work_measured = true;
+			if (m_interval > duration::zero() && m_has_present)
+			{
+				time_point earliest = m_last_present + m_interval;
+				if (m_clock.Now() < earliest)
+				{
+					m_clock.SleepUntil(earliest);
+				}
+			}
+		}
+
+		// Presentغ
+		void EndFrame()
+		{
+			time_point present = m_clock.Now();
+			// ֡ʱָƽƽƫΪƣʱʱǰʼ֡Ԥĳʱ
+			double work = std::chrono::duration<double>((m_work_measured ? m_work_end : present) - m_frame_start).count();
+			m_work_measured = false;
+			m_work_deviation = m_has_present ? m_work_deviation * 0.9 + std::abs(work - m_work_seconds) * 0.1 : 0.0;
+			m_work_seconds = m_has_present ? m_work_seconds * 0.9 + work * 0.1 : work;
+			m_work_estimate = std::chrono::duration_cast<duration>(std::chrono::duration<double>(m_work_seconds + 2.0 * m_work_deviation));
+
+			if (m_has_present)
+			{
+				m_intervals[m_cursor] = std::chrono::duration<double, std::milli>(present - m_last_present).count();
+				m_latencies[m_cursor] = std::chrono::duration<double, std::milli>(present - m_input_time).count();
+				m_cursor = (m_cursor + 1) % m_intervals.size();
+				m_sample_count = std::min(m_sample_count + 1, m_intervals.size());
+				++m_frame_count;
+			}
+			// Ԥʱع̶ƽǰɵ֡ģٵʱʵʳʱ¶
+			if (!m_has_present || present > m_predicted_present)
+			{
+				m_predicted_present = present + m_interval;
+			}
+			else
+			{
+				m_predicted_present += m_interval;
+			}
+			m_last_present = present;
+			m_has_present = true;
+		}
+
+		// óԤ⣬лģʽ򴰿ڴС仯֮
+		void Reset()
+		{
+			m_has_present = false;
+			m_sample_count = 0;
+			m_cursor = 0;
+		}
+
+		FramePacingStats Stats() const
+		{
+			FramePacingStats stats;
+			stats.frame_count = m_frame_count;
+			if (m_sample_count == 0) return stats;
+
+			// õĸԤȷĻÿ֡ͳʱڴ
+			std::vector<double>& intervals = m_sorted_intervals;
+			intervals.assign(m_intervals.begin(), m_intervals.begin() + m_sample_count);
+			double sum = 0.0, latency_sum = 0.0;
+			for (size_t i = 0; i < m_sample_count; ++i)
+			{
+				sum += intervals[i];
+				latency_sum += m_latencies[i];
+				stats.max_input_latency_ms = std::max(stats.max_input_latency_ms, m_latencies[i]);
+			}
+			stats.mean_interval_ms = sum / m_sample_count;
+			stats.mean_input_latency_ms = latency_sum / m_sample_count;
+			double variance = 0.0;
+			for (double interval : intervals)
+			{
+				variance += (interval - stats.mean_interval_ms) * (interval - stats.mean_interval_ms);
+			}
+			stats.stddev_interval_ms = std::sqrt(variance / m_sample_count);
+			std::sort(intervals.begin(), intervals.end());
+			stats.min_interval_ms = intervals.front();
+			stats.max_interval_ms = intervals.back();
+			stats.p99_interval_ms = intervals[std::min(intervals.size() - 1, static_cast<size_t>(intervals.size() * 0.99))];
+			return stats;
+		}
+
+	private:
+		Clock& m_clock;
+		duration m_interval = duration::zero();
+		duration m_work_estimate = duration::zero();
+		double m_work_seconds = 0.0;
+		double m_work_deviation = 0.0;
+		time_point m_frame_start{};
+		time_point m_work_end{};
+		bool m_work_measured = false;
+		time_point m_input_time{};
+		time_point m_last_present{};
+		time_point m_predicted_present{};
+		bool m_has_present = false;
+
+		std::vector<double> m_intervals;
+		std::vector<double> m_latencies;
+		mutable std::vector<double> m_sorted_intervals;
+		size_t m_cursor = 0;
+		size_t m_sample_count = 0;
+		uint64_t m_frame_count = 0;
+	};
+}
@@ -0,0 +1,402 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace LodHelper
+{
+	// ---------------------------------------------------------------
+	// ۻƽ淽ֵ̣õ㵽ЩƽƽȨ
+	// ---------------------------------------------------------------
+
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		// ƽ n*p + d = 0nΪλ
+		void AddPlane(double nx, double ny, double nz, double d, double plane_weight)
+		{
+			a00 += plane_weight * nx * nx; a01 += plane_weight * nx * ny; a02 += plane_weight * nx * nz;
+			a11 += plane_weight * ny * ny; a12 += plane_weight * ny * nz; a22 += plane_weight * nz * nz;
+			b0 += plane_weight * nx * d; b1 += plane_weight * ny * d; b2 += plane_weight * nz * d;
+			c += plane_weight * d * d;
+			weight += plane_weight;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		double Evaluate(const float* p) const
+		{
+			double x = p[0], y = p[1], z = p[2];
+			double result = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + a11 * y * y + 2.0 * a12 * y * z + a22 * z * z +
+				2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return std::max(result, 0.0);
+		}
+	};
+
+	// һLODе䣬errorΪԭʼռ
+	struct LodLevel
+	{
+		uint32_t index_offset;
+		uint32_t index_count;
+		float error;
+	};
+
+	// мͬһ㻺ƴһ
+	// first_mesh_idǵ0еıţ
+	struct LodChain
+	{
+		uint32_t first_mesh_id = 0;
+		std::vector<uint32_t> indices;
+		std::vector<LodLevel> levels;
+		double build_seconds = 0.0;
+	};
+
+	// ---------------------------------------------------------------
+	// ۵򻯣ֻ۵еڶϣ¶㣬˸Թö㻺
+	// λغϵĶ㣨ɫӷ죩Ϳű߽ϵĶ㱣ֲ
+	// ---------------------------------------------------------------
+
+	class Simplifier
+	{
+	public:
+		// positionsstrideֽУÿ㿪ͷfloat
+		Simplifier(const float* positions, size_t vertex_count, size_t stride)
+			: m_positions(positions), m_vertex_count(vertex_count), m_stride(stride)
+		{
+		}
+
+		// 򻯵target_index_count۵ﵽtarget_errorΪֹʵ
+		float Simplify(const std::vector<uint32_t>& indices, size_t target_index_count, float target_error, std::vector<uint32_t>& result)
+		{
+			result = indices;
+			ClassifyVertices(indices);
+			ComputeQuadrics(indices);
+			m_remap.resize(m_vertex_count);
+
+			float result_error = 0.0f;
+			double error_limit = double(target_error) * target_error;
+			while (result.size() > target_index_count)
+			{
+				BuildAdjacency(result);
+				CollectCollapses(result);
+				size_t triangle_count = result.size() / 3;
+				size_t target_triangles = target_index_count / 3;
+				for (uint32_t v = 0; v < m_vertex_count; ++v) m_remap[v] = v;
+				std::fill(m_touched.begin(), m_touched.end(), 0);
+
+				size_t collapse_count = 0;
+				bool reached_limit = false;
+				for (const Collapse& collapse : m_collapses)
+				{
+					if (collapse.cost > error_limit)
+					{
+						reached_limit = true;
+						break;
+					}
+					if (triangle_count <= target_triangles) break;
+					if (m_touched[collapse.from] || m_touched[collapse.to]) continue;
+					if (FlipsTriangle(result, collapse.from, collapse.to)) continue;
+
+					// һαб۵Χֻ仯һΣڽϢʧЧ
+					m_remap[collapse.from] = collapse.to;
+					m_quadrics[collapse.to].Add(m_quadrics[collapse.from]);
+					for (uint32_t i = m_adjacency_offsets[collapse.from]; i < m_adjacency_offsets[collapse.from + 1]; ++i)
+					{
+						const uint32_t* triangle = &result[m_adjacency[i] * 3];
+						m_touched[triangle[0]] = m_touched[triangle[1]] = m_touched[triangle[2]] = 1;
+						if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) --triangle_count;
+					}
+					result_error = std::max(result_error, static_cast<float>(std::sqrt(collapse.cost)));
+					++collapse_count;
+				}
+				if (collapse_count == 0) break;
+
+				// Ӧ۵ɾ˻
+				size_t write = 0;
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					uint32_t a = m_remap[result[i]], b = m_remap[result[i + 1]], c = m_remap[result[i + 2]];
+					if (a == b || b == c || a == c) continue;
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+				result.resize(write);
+				if (reached_limit) break;
+			}
+			return result_error;
+		}
+
+	private:
+		struct Collapse
+		{
+			uint32_t from;
+			uint32_t to;
+			double cost;
+		};
+
+		const float* Position(uint32_t vertex) const
+		{
+			return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(m_positions) + vertex * m_stride);
+		}
+
+		// ҳӷ춥Ϳű߽綥㲢
+		void ClassifyVertices(const std::vector<uint32_t>& indices)
+		{
+			m_locked.assign(m_vertex_count, 0);
+			m_touched.assign(m_vertex_count, 0);
+
+			struct PositionKey
+			{
+				uint32_t bits[3];
+				bool operator==(const PositionKey& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+			};
+			struct PositionHash
+			{
+				size_t operator()(const PositionKey& key) const
+				{
+					return (size_t(key.bits[0]) * 73856093u) ^ (size_t(key.bits[1]) * 19349663u) ^ (size_t(key.bits[2]) * 83492791u);
+				}
+			};
+			std::unordered_map<PositionKey, uint32_t, PositionHash> first_vertex;
+			first_vertex.reserve(m_vertex_count);
+			for (uint32_t v = 0; v < m_vertex_count; ++v)
+			{
+				PositionKey key;
+				std::memcpy(key.bits, Position(v), sizeof(key.bits));
+				auto inserted = first_vertex.emplace(key, v);
+				if (!inserted.second)
+				{
+					m_locked[v] = 1;
+					m_locked[inserted.first->second] = 1;
+				}
+			}
+
+			// ֻһλڿű߽
+			std::unordered_set<uint64_t> edges;
+			edges.reserve(indices.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (int e = 0; e < 3; ++e)
+				{
+					edges.insert((uint64_t(indices[i + e]) << 32) | indices[i + (e + 1) % 3]);
+				}
+			}
+			for (uint64_t edge : edges)
+			{
+				uint32_t a = static_cast<uint32_t>(edge >> 32), b = static_cast<uint32_t>(edge);
+				if (!edges.count((uint64_t(b) << 32) | a))
+				{
+					m_locked[a] = 1;
+					m_locked[b] = 1;
+				}
+			}
+		}
+
+		// ÿεƽ水Ȩۻ
+		void ComputeQuadrics(const std::vector<uint32_t>& indices)
+		{
+			m_quadrics.assign(m_vertex_count, Quadric());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				double nx, ny, nz, area;
+				TriangleNormal(Position(indices[i]), Position(indices[i + 1]), Position(indices[i + 2]), nx, ny, nz, area);
+				if (area <= 0.0) continue;
+				const float* p0 = Position(indices[i]);
+				double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					m_quadrics[indices[i + corner]].AddPlane(nx, ny, nz, d, area);
+				}
+			}
+		}
+
+		// ΣCSRʽ
+		void BuildAdjacency(const std::vector<uint32_t>& indices)
+		{
+			m_adjacency_offsets.assign(m_vertex_count + 1, 0);
+			for (uint32_t index : indices) ++m_adjacency_offsets[index + 1];
+			for (size_t v = 0; v < m_vertex_count; ++v) m_adjacency_offsets[v + 1] += m_adjacency_offsets[v];
+			m_adjacency.resize(indices.size());
+			m_fill.assign(m_adjacency_offsets.begin(), m_adjacency_offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				m_adjacency[m_fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// ÿѡ۽С۵򣬴ΪϲĶڱ㴦Ȩ
+		void CollectCollapses(const std::vector<uint32_t>& indices)
+		{
+			m_collapses.clear();
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (int e = 0; e < 3; ++e)
+				{
+					uint32_t a = indices[i + e], b = indices[i + (e + 1) % 3];
+					// ιͬһߣֻһռ
+					if (a > b && !IsBorderEdge(indices, a, b)) continue;
+					Collapse best{0, 0, INFINITY};
+					if (!m_locked[a]) best = {a, b, CollapseCost(a, b)};
+					if (!m_locked[b])
+					{
+						double cost = CollapseCost(b, a);
+						if (cost < best.cost) best = {b, a, cost};
+					}
+					if (best.cost < INFINITY) m_collapses.push_back(best);
+				}
+			}
+			std::sort(m_collapses.begin(), m_collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+		}
+
+		bool IsBorderEdge(const std::vector<uint32_t>& indices, uint32_t a, uint32_t b) const
+		{
+			for (uint32_t i = m_adjacency_offsets[b]; i < m_adjacency_offsets[b + 1]; ++i)
+			{
+				const uint32_t* triangle = &indices[m_adjacency[i] * 3];
+				for (int e = 0; e < 3; ++e)
+				{
+					if (triangle[e] == b && triangle[(e + 1) % 3] == a) return false;
+				}
+			}
+			return true;
+		}
+
+		double CollapseCost(uint32_t from, uint32_t to) const
+		{
+			Quadric merged = m_quadrics[from];
+			merged.Add(m_quadrics[to]);
+			return merged.weight > 0.0 ? merged.Evaluate(Position(to)) / merged.weight : 0.0;
+		}
+
+		// fromƵto֮fromΧtoη߲ܷת
+		bool FlipsTriangle(const std::vector<uint32_t>& indices, uint32_t from, uint32_t to) const
+		{
+			for (uint32_t i = m_adjacency_offsets[from]; i < m_adjacency_offsets[from + 1]; ++i)
+			{
+				const uint32_t* triangle = &indices[m_adjacency[i] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+				const float* corners[3];
+				const float* moved[3];
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					corners[corner] = Position(triangle[corner]);
+					moved[corner] = triangle[corner] == from ? Position(to) : corners[corner];
+				}
+				double nx0, ny0, nz0, area0, nx1, ny1, nz1, area1;
+				TriangleNormal(corners[0], corners[1], corners[2], nx0, ny0, nz0, area0);
+				TriangleNormal(moved[0], moved[1], moved[2], nx1, ny1, nz1, area1);
+				if (area0 > 0.0 && (area1 <= 0.0 || nx0 * nx1 + ny0 * ny1 + nz0 * nz1 < 0.25)) return true;
+			}
+			return false;
+		}
+
+		static void TriangleNormal(const float* p0, const float* p1, const float* p2, double& nx, double& ny, double& nz, double& area)
+		{
+			double e1[3] = {double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2]};
+			double e2[3] = {double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2]};
+			nx = e1[1] * e2[2] - e1[2] * e2[1];
+			ny = e1[2] * e2[0] - e1[0] * e2[2];
+			nz = e1[0] * e2[1] - e1[1] * e2[0];
+			double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+			area = length * 0.5;
+			if (length > 0.0)
+			{
+				nx /= length;
+				ny /= length;
+				nz /= length;
+			}
+		}
+
+		const float* m_positions;
+		size_t m_vertex_count;
+		size_t m_stride;
+
+		std::vector<uint8_t> m_locked;
+		std::vector<uint8_t> m_touched;
+		std::vector<Quadric> m_quadrics;
+		std::vector<uint32_t> m_remap;
+		std::vector<uint32_t> m_adjacency_offsets;
+		std::vector<uint32_t> m_adjacency;
+		std::vector<uint32_t> m_fill;
+		std::vector<Collapse> m_collapses;
+	};
+
+	// LODÿһԭʼ򻯣Ŀγreductionmax_errorټʱֹͣ
+	inline LodChain BuildLodChain(const float* positions, size_t vertex_count, size_t stride, const std::vector<uint32_t>& indices,
+		uint32_t max_levels = 6, float reduction = 0.5f, float max_error = INFINITY)
+	{
+		auto build_begin = std::chrono::high_resolution_clock::now();
+		LodChain chain;
+		chain.indices = indices;
+		chain.levels.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+
+		Simplifier simplifier(positions, vertex_count, stride);
+		std::vector<uint32_t> simplified;
+		size_t previous_count = indices.size();
+		for (uint32_t level = 1; level < max_levels; ++level)
+		{
+			size_t target = static_cast<size_t>(previous_count * reduction) / 3 * 3;
+			if (target < 3) break;
+			float error = simplifier.Simplify(indices, target, max_error, simplified);
+			// ٲһɵļֵõ
+			if (simplified.empty() || simplified.size() * 10 > previous_count * 9) break;
+			chain.levels.push_back({static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(simplified.size()), error});
+			chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+			previous_count = simplified.size();
+		}
+		chain.build_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - build_begin).count();
+		return chain;
+	}
+
+	// ---------------------------------------------------------------
+	// ʱѡ񣺰ռͶӰĻ
+	// ---------------------------------------------------------------
+
+	// pixel_scaleΪͶӰ[1][1]ӿڸ߶ȵһ룬λ봦һλȶӦ
+	inline float ProjectedError(float world_error, float distance, float pixel_scale)
+	{
+		return world_error * pixel_scale / std::max(distance, 1e-4f);
+	}
+
+	// ѡĻֵһϸִУҪֵ(1 - hysteresis)ڱ߽紦
+	inline uint32_t SelectLod(const LodChain& chain, float world_scale, float distance, float pixel_scale, uint32_t current,
+		float threshold_pixels, float hysteresis)
+	{
+		auto coarsest_within = [&](float threshold)
+		{
+			for (uint32_t level = static_cast<uint32_t>(chain.levels.size()) - 1; level > 0; --level)
+			{
+				if (ProjectedError(chain.levels[level].error * world_scale, distance, pixel_scale) <= threshold) return level;
+			}
+			return 0u;
+		};
+		current = std::min<uint32_t>(current, static_cast<uint32_t>(chain.levels.size()) - 1);
+		uint32_t level = coarsest_within(threshold_pixels);
+		if (level <= current) return level;
+		return std::max(current, coarsest_within(threshold_pixels * (1.0f - hysteresis)));
+	}
+
+	struct LodStats
+	{
+		uint64_t triangles = 0;
+		uint64_t full_triangles = 0;
+		uint32_t switches = 0;
+	};
+}
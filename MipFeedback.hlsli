@@ -0,0 +1,11 @@
+RWStructuredBuffer<uint> MipRequests : register(u0, space1);
+
+void RecordMipRequest(uint texture_id, Texture2D tex, SamplerState samp, float2 uv)
+{
+    float lod = tex.CalculateLevelOfDetailUnclamped(samp, uv);
+    uint mip = WaveActiveMin((uint)max(floor(lod), 0.0f));
+    if (WaveIsFirstLane())
+    {
+        InterlockedMin(MipRequests[texture_id], mip);
+    }
+}
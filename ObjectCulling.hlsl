@@ -0,0 +1,73 @@
+// shader: cs_6_0 main
+
+struct CullingConstants
+{
+    matrix ViewProjection;
+    float4 Planes[6];
+    uint ObjectCount;
+};
+
+ConstantBuffer<CullingConstants> CullingCB : register(b0);
+
+struct ObjectBounds
+{
+    float4 Min;
+    float4 Max;
+};
+
+StructuredBuffer<ObjectBounds> Bounds : register(t0);
+RWByteAddressBuffer VisibleCount : register(u0);
+
+struct ObjectData
+{
+    matrix World;
+    float4 Color;
+    uint Mesh;
+    uint3 Padding;
+};
+
+struct InstanceData
+{
+    matrix MVP;
+    float4 Color;
+};
+
+StructuredBuffer<ObjectData> Objects : register(t1);
+RWByteAddressBuffer DrawArguments : register(u1);
+RWStructuredBuffer<InstanceData> Instances : register(u2);
+
+static const uint DrawArgumentsStride = 24;
+static const uint InstanceCountOffset = 8;
+
+[numthreads(64, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= CullingCB.ObjectCount)
+    {
+        return;
+    }
+
+    ObjectBounds bounds = Bounds[id.x];
+    bool visible = true;
+    [unroll]
+    for (uint i = 0; i < 6; ++i)
+    {
+        float4 plane = CullingCB.Planes[i];
+        float3 positive = lerp(bounds.Min.xyz, bounds.Max.xyz, step(0.0f, plane.xyz));
+        visible = visible && dot(plane.xyz, positive) + plane.w >= 0.0f;
+    }
+
+    if (visible)
+    {
+        uint previous;
+        VisibleCount.InterlockedAdd(0, 1, previous);
+        ObjectData object = Objects[id.x];
+        uint record = object.Mesh * DrawArgumentsStride;
+        uint slot;
+        DrawArguments.InterlockedAdd(record + InstanceCountOffset, 1, slot);
+        InstanceData instance;
+        instance.MVP = mul(CullingCB.ViewProjection, object.World);
+        instance.Color = object.Color;
+        Instances[DrawArguments.Load(record) + slot] = instance;
+    }
+}
@@ -0,0 +1,630 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "WorkerPool.h"
+
+// AVX-512һμtile16еĸ룬AVX2һμһtile8Уʱ˻Ϊѭ
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define OCCLUSION_HELPER_AVX512 1
+#define OCCLUSION_HELPER_AVX2 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define OCCLUSION_HELPER_AVX2 1
+#endif
+
+namespace OcclusionHelper
+{
+	// ÿ֡ڵ޳ͳƣʱλΪ
+	struct OcclusionStats
+	{
+		uint32_t occluders = 0;
+		uint32_t triangles = 0;
+		// ͨƽ桢ĻΧ飬դ
+		uint32_t rasterized = 0;
+		uint32_t tested = 0;
+		uint32_t culled = 0;
+		double select_ms = 0.0;
+		double raster_ms = 0.0;
+		double test_ms = 0.0;
+	};
+
+	inline const char* SimdPathName()
+	{
+#if defined(OCCLUSION_HELPER_AVX512)
+		return "AVX-512";
+#elif defined(OCCLUSION_HELPER_AVX2)
+		return "AVX2";
+#else
+		return "scalar";
+#endif
+	}
+
+	// ---------------------------------------------------------------
+	// 븲ǵĵͷֱʷֲȻ
+	// Ļֳ32x8صtileÿtileÿ32λĸȣ
+	// z0tileڵıԶȣz1븲ǲֵԶȣʱϲz0
+	// ΪͶӰz/wΧ[0, 1]ԽСԽz0ʼΪ1ʾʲôûеס
+	// ---------------------------------------------------------------
+
+	class MaskedDepthBuffer
+	{
+	public:
+		static const uint32_t m_tile_width = 32;
+		static const uint32_t m_tile_height = 8;
+
+		struct Tile
+		{
+			uint32_t mask[m_tile_height];
+			float z0;
+			float z1;
+		};
+
+		// ߴȡtileĲֲĻӳ䷶Χ
+		void Resize(uint32_t width, uint32_t height)
+		{
+			m_width = std::max(1u, width);
+			m_height = std::max(1u, height);
+			m_tiles_x = (m_width + m_tile_width - 1) / m_tile_width;
+			m_tiles_y = (m_height + m_tile_height - 1) / m_tile_height;
+			m_tiles.resize(static_cast<size_t>(m_tiles_x) * m_tiles_y);
+			Clear();
+		}
+
+		void Clear()
+		{
+			for (Tile& tile : m_tiles)
+			{
+				std::memset(tile.mask, 0, sizeof(tile.mask));
+				tile.z0 = 1.0f;
+				tile.z1 = 0.0f;
+			}
+		}
+
+		uint32_t Width() const { return m_width; }
+		uint32_t Height() const { return m_height; }
+		uint32_t TilesX() const { return m_tiles_x; }
+		uint32_t TilesY() const { return m_tiles_y; }
+		const Tile& TileAt(uint32_t x, uint32_t y) const { return m_tiles[static_cast<size_t>(y) * m_tiles_x + x]; }
+
+		// դһüռΣΪ(x, y, z, w)ֻդ˳ʱ루D3DĬϵ棩
+		// һڽƽ֮ʱΣٻڵֻ޳ȻأǷդ
+		bool RasterizeTriangle(const float* v0, const float* v1, const float* v2)
+		{
+			const float* clip[3] = {v0, v1, v2};
+			float x[3], y[3], z[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				if (clip[i][2] < 0.0f || clip[i][3] <= 0.0f) return false;
+				float inv_w = 1.0f / clip[i][3];
+				x[i] = (clip[i][0] * inv_w * 0.5f + 0.5f) * m_width;
+				y[i] = (0.5f - clip[i][1] * inv_w * 0.5f) * m_height;
+				z[i] = clip[i][2] * inv_w;
+			}
+
+			// y£NDCе˳ʱΪ˻β
+			float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+			if (!(area > 0.0f)) return false;
+
+			float min_x = std::min({x[0], x[1], x[2]}), max_x = std::max({x[0], x[1], x[2]});
+			float min_y = std::min({y[0], y[1], y[2]}), max_y = std::max({y[0], y[1], y[2]});
+			// ǵķΧ
+			int px0 = std::max(0, static_cast<int>(std::ceil(min_x - 0.5f)));
+			int px1 = std::min(static_cast<int>(m_width) - 1, static_cast<int>(std::floor(max_x - 0.5f)));
+			int py0 = std::max(0, static_cast<int>(std::ceil(min_y - 0.5f)));
+			int py1 = std::min(static_cast<int>(m_height) - 1, static_cast<int>(std::floor(max_y - 0.5f)));
+			if (px0 > px1 || py0 > py1) return false;
+
+			EdgeSetup setup;
+			setup.y_first = py0 + 0.5f;
+			setup.y_last = py1 + 0.5f;
+			SetupEdges(x, y, setup);
+
+			// ƽ z = a*x + b*y + c
+			float inv_area = 1.0f / area;
+			float a = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * inv_area;
+			float b = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * inv_area;
+			float c = z[0] - a * x[0] - b * y[0];
+			float z_min = std::min({z[0], z[1], z[2]});
+			float z_max = std::max({z[0], z[1], z[2]});
+
+			uint32_t tx0 = px0 / m_tile_width, tx1 = px1 / m_tile_width;
+			uint32_t ty0 = py0 / m_tile_height, ty1 = py1 / m_tile_height;
+			alignas(64) float lane_x[m_batch_lanes];
+			alignas(64) float lane_y[m_batch_lanes];
+			alignas(64) uint32_t masks[m_batch_lanes];
+			for (uint32_t ty = ty0; ty <= ty1; ++ty)
+			{
+				float tile_y = static_cast<float>(ty * m_tile_height);
+				for (uint32_t tx = tx0; tx <= tx1; tx += m_batch_tiles)
+				{
+					for (uint32_t lane = 0; lane < m_batch_lanes; ++lane)
+					{
+						lane_x[lane] = static_cast<float>((tx + lane / m_tile_height) * m_tile_width);
+						lane_y[lane] = tile_y + (lane % m_tile_height) + 0.5f;
+					}
+					RowCoverage(setup, lane_x, lane_y, masks);
+					for (uint32_t batch = 0; batch < m_batch_tiles && tx + batch <= tx1; ++batch)
+					{
+						Tile& tile = m_tiles[static_cast<size_t>(ty) * m_tiles_x + tx + batch];
+						// tileı֮󣬲ıκζ
+						if (z_min >= tile.z0) continue;
+						// tileΧƽֵ
+						float x0 = lane_x[batch * m_tile_height], x1 = x0 + m_tile_width;
+						float plane_max = c + std::max(a * x0, a * x1) + std::max(b * tile_y, b * (tile_y + m_tile_height));
+						UpdateTile(tile, masks + batch * m_tile_height, std::max(z_min, std::min(z_max, plane_max)));
+					}
+				}
+			}
+			return true;
+		}
+
+		// ؾ[x0, x1]x[y0, y1]z_minǷܿɼ
+		// ȿtilez0øz1жϾڸtileڵĲǷѱȫס
+		bool IsRectVisible(int x0, int y0, int x1, int y1, float z_min) const
+		{
+			x0 = std::max(x0, 0);
+			y0 = std::max(y0, 0);
+			x1 = std::min(x1, static_cast<int>(m_width) - 1);
+			y1 = std::min(y1, static_cast<int>(m_height) - 1);
+			if (x0 > x1 || y0 > y1) return true;
+			uint32_t tx0 = x0 / m_tile_width, tx1 = x1 / m_tile_width;
+			uint32_t ty0 = y0 / m_tile_height, ty1 = y1 / m_tile_height;
+			for (uint32_t ty = ty0; ty <= ty1; ++ty)
+			{
+				const Tile* row = &m_tiles[static_cast<size_t>(ty) * m_tiles_x];
+				for (uint32_t tx = tx0; tx <= tx1; ++tx)
+				{
+					const Tile& tile = row[tx];
+					if (tile.z0 < z_min) continue;
+					if (!(tile.z1 < z_min)) return true;
+					// ڸtileڵк
+					int left = std::max(x0 - static_cast<int>(tx * m_tile_width), 0);
+					int right = std::min(x1 - static_cast<int>(tx * m_tile_width), static_cast<int>(m_tile_width) - 1);
+					int top = std::max(y0 - static_cast<int>(ty * m_tile_height), 0);
+					int bottom = std::min(y1 - static_cast<int>(ty * m_tile_height), static_cast<int>(m_tile_height) - 1);
+					uint32_t span = (~0u << left) & (~0u >> (m_tile_width - 1 - right));
+					for (int r = top; r <= bottom; ++r)
+					{
+						if ((tile.mask[r] & span) != span) return true;
+					}
+				}
+			}
+			return false;
+		}
+
+	private:
+#if defined(OCCLUSION_HELPER_AVX512)
+		static const uint32_t m_batch_lanes = 16;
+#else
+		static const uint32_t m_batch_lanes = 8;
+#endif
+		static const uint32_t m_batch_tiles = m_batch_lanes / m_tile_height;
+
+		// ÿһиǵ left(y) <= x <= right(y)ұ߽綼yԺ slope*y + offset
+		// ߡұߣõıȡԶˮƽֻзΧ
+		struct EdgeSetup
+		{
+			float left_slope[3];
+			float left_offset[3];
+			float right_slope[3];
+			float right_offset[3];
+			float y_first;
+			float y_last;
+		};
+
+		// ߺ E = A*x + B*y + CΪʱڲE >= 0
+		// ֻضڲ㸲ǣĴ E >= (|A| + |B|)/2ͷֱҲѲָǵصڵ
+		static void SetupEdges(const float* x, const float* y, EdgeSetup& setup)
+		{
+			const float inf = std::numeric_limits<float>::infinity();
+			for (int i = 0; i < 3; ++i)
+			{
+				setup.left_slope[i] = setup.right_slope[i] = 0.0f;
+				setup.left_offset[i] = -inf;
+				setup.right_offset[i] = inf;
+			}
+			for (int i = 0; i < 3; ++i)
+			{
+				int j = (i + 1) % 3;
+				float A = y[i] - y[j];
+				float B = x[j] - x[i];
+				float C = x[i] * y[j] - x[j] * y[i] - 0.5f * (std::fabs(A) + std::fabs(B));
+				if (A == 0.0f)
+				{
+					// ˮƽߣB*y + C >= 0 ĵзΧ
+					if (B > 0.0f) setup.y_first = std::max(setup.y_first, -C / B);
+					else setup.y_last = std::min(setup.y_last, -C / B);
+					continue;
+				}
+				// E >= 0 ȼ x >= -(B*y + C)/AA > 0 x <= -(B*y + C)/AA < 0Ļټ0.5
+				float slope = -B / A;
+				float offset = -C / A - 0.5f;
+				if (A > 0.0f)
+				{
+					setup.left_slope[i] = slope;
+					setup.left_offset[i] = offset;
+				}
+				else
+				{
+					setup.right_slope[i] = slope;
+					setup.right_offset[i] = offset;
+				}
+			}
+		}
+
+#if defined(OCCLUSION_HELPER_AVX512)
+		static void RowCoverage(const EdgeSetup& setup, const float* lane_x, const float* lane_y, uint32_t* masks)
+		{
+			__m512 y = _mm512_load_ps(lane_y);
+			__m512 tile_x = _mm512_load_ps(lane_x);
+			__m512 left = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+			__m512 right = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+			for (int i = 0; i < 3; ++i)
+			{
+				left = _mm512_max_ps(left, _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(setup.left_slope[i]), y), _mm512_set1_ps(setup.left_offset[i])));
+				right = _mm512_min_ps(right, _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(setup.right_slope[i]), y), _mm512_set1_ps(setup.right_offset[i])));
+			}
+			// tileڵкŲ[0, 32][-1, 31]λ31ʱΪ0
+			left = _mm512_min_ps(_mm512_max_ps(_mm512_roundscale_ps(_mm512_sub_ps(left, tile_x), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC), _mm512_setzero_ps()), _mm512_set1_ps(32.0f));
+			right = _mm512_min_ps(_mm512_max_ps(_mm512_roundscale_ps(_mm512_sub_ps(right, tile_x), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC), _mm512_set1_ps(-1.0f)), _mm512_set1_ps(31.0f));
+			__m512i ones = _mm512_set1_epi32(-1);
+			__m512i mask = _mm512_and_si512(_mm512_sllv_epi32(ones, _mm512_cvttps_epi32(left)),
+				_mm512_srlv_epi32(ones, _mm512_sub_epi32(_mm512_set1_epi32(31), _mm512_cvttps_epi32(right))));
+			__mmask16 rows = _mm512_cmp_ps_mask(y, _mm512_set1_ps(setup.y_first), _CMP_GE_OQ) & _mm512_cmp_ps_mask(y, _mm512_set1_ps(setup.y_last), _CMP_LE_OQ);
+			_mm512_store_si512(reinterpret_cast<__m512i*>(masks), _mm512_maskz_mov_epi32(rows, mask));
+		}
+#elif defined(OCCLUSION_HELPER_AVX2)
+		static void RowCoverage(const EdgeSetup& setup, const float* lane_x, const float* lane_y, uint32_t* masks)
+		{
+			__m256 y = _mm256_load_ps(lane_y);
+			__m256 tile_x = _mm256_load_ps(lane_x);
+			__m256 left = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+			__m256 right = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+			for (int i = 0; i < 3; ++i)
+			{
+				left = _mm256_max_ps(left, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(setup.left_slope[i]), y), _mm256_set1_ps(setup.left_offset[i])));
+				right = _mm256_min_ps(right, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(setup.right_slope[i]), y), _mm256_set1_ps(setup.right_offset[i])));
+			}
+			// tileڵкŲ[0, 32][-1, 31]λ31ʱΪ0
+			left = _mm256_min_ps(_mm256_max_ps(_mm256_ceil_ps(_mm256_sub_ps(left, tile_x)), _mm256_setzero_ps()), _mm256_set1_ps(32.0f));
+			right = _mm256_min_ps(_mm256_max_ps(_mm256_floor_ps(_mm256_sub_ps(right, tile_x)), _mm256_set1_ps(-1.0f)), _mm256_set1_ps(31.0f));
+			__m256i ones = _mm256_set1_epi32(-1);
+			__m256i mask = _mm256_and_si256(_mm256_sllv_epi32(ones, _mm256_cvttps_epi32(left)),
+				_mm256_srlv_epi32(ones, _mm256_sub_epi32(_mm256_set1_epi32(31), _mm256_cvttps_epi32(right))));
+			__m256 rows = _mm256_and_ps(_mm256_cmp_ps(y, _mm256_set1_ps(setup.y_first), _CMP_GE_OQ), _mm256_cmp_ps(y, _mm256_set1_ps(setup.y_last), _CMP_LE_OQ));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(masks), _mm256_and_si256(mask, _mm256_castps_si256(rows)));
+		}
+#else
+		static void RowCoverage(const EdgeSetup& setup, const float* lane_x, const float* lane_y, uint32_t* masks)
+		{
+			for (uint32_t lane = 0; lane < m_batch_lanes; ++lane)
+			{
+				float y = lane_y[lane];
+				if (y < setup.y_first || y > setup.y_last)
+				{
+					masks[lane] = 0;
+					continue;
+				}
+				float left = -std::numeric_limits<float>::infinity();
+				float right = std::numeric_limits<float>::infinity();
+				for (int i = 0; i < 3; ++i)
+				{
+					left = std::max(left, setup.left_slope[i] * y + setup.left_offset[i]);
+					right = std::min(right, setup.right_slope[i] * y + setup.right_offset[i]);
+				}
+				int first = static_cast<int>(std::min(std::max(std::ceil(left - lane_x[lane]), 0.0f), 32.0f));
+				int last = static_cast<int>(std::min(std::max(std::floor(right - lane_x[lane]), -1.0f), 31.0f));
+				masks[lane] = first > last ? 0u : (~0u << first) & (~0u >> (31 - last));
+			}
+		}
+#endif
+
+		// ȵĺϲ빤z0빤㻹Զʱ㣻ϲz0
+		static void UpdateTile(Tile& tile, const uint32_t* coverage, float z)
+		{
+			uint32_t any = 0;
+			for (uint32_t row = 0; row < m_tile_height; ++row) any |= coverage[row];
+			if (!any) return;
+			if (z - tile.z1 > tile.z0 - tile.z1)
+			{
+				std::memset(tile.mask, 0, sizeof(tile.mask));
+				tile.z1 = 0.0f;
+			}
+			tile.z1 = std::max(tile.z1, z);
+			uint32_t full = ~0u;
+			for (uint32_t row = 0; row < m_tile_height; ++row)
+			{
+				tile.mask[row] |= coverage[row];
+				full &= tile.mask[row];
+			}
+			if (full == ~0u)
+			{
+				tile.z0 = std::min(tile.z0, tile.z1);
+				tile.z1 = 0.0f;
+				std::memset(tile.mask, 0, sizeof(tile.mask));
+			}
+		}
+
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		uint32_t m_tiles_x = 0;
+		uint32_t m_tiles_y = 0;
+		std::vector<Tile> m_tiles;
+	};
+
+	// ---------------------------------------------------------------
+	// ڵ޳ѡڵդȻڹ߳ϲвΧ
+	// ԼDirectXMathһ£ڵMVPΪ world * view_projection
+	// ---------------------------------------------------------------
+
+	class OcclusionCuller
+	{
+	public:
+		static const uint32_t m_default_width = 320;
+		static const uint32_t m_default_height = 180;
+		// ÿ߳һȡߵ
+		static const uint32_t m_test_batch = 64;
+
+		void Initial(uint32_t width = m_default_width, uint32_t height = m_default_height, uint32_t worker_count = 0)
+		{
+			m_depth.Resize(width, height);
+			m_pool.Start(worker_count);
+		}
+
+		void Shutdown()
+		{
+			m_pool.Stop();
+		}
+
+		// ǼһڵpositionsΪֲռ꣬strideΪڶֽ֮
+		// ڵԭģڲ緽屾ڽӷ壬ܴ޳
+		uint32_t AddMesh(const float* positions, size_t stride, size_t vertex_count, const uint32_t* indices, size_t index_count)
+		{
+			Mesh mesh;
+			mesh.positions.resize(vertex_count * 3);
+			for (size_t i = 0; i < vertex_count; ++i)
+			{
+				const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + i * stride);
+				mesh.positions[i * 3] = p[0];
+				mesh.positions[i * 3 + 1] = p[1];
+				mesh.positions[i * 3 + 2] = p[2];
+			}
+			mesh.indices.assign(indices, indices + index_count);
+			m_meshes.push_back(std::move(mesh));
+			return static_cast<uint32_t>(m_meshes.size() - 1);
+		}
+
+		// ֡ʼʱȻ¼֡ͼͶӰ
+		void BeginFrame(const float view_projection[4][4])
+		{
+			std::memcpy(m_view_projection, view_projection, sizeof(m_view_projection));
+			m_stats = OcclusionStats{};
+			auto begin = Clock::now();
+			m_depth.Clear();
+			m_stats.raster_ms += Elapsed(begin);
+		}
+
+		// ÷ִӺѡѡڵ壬÷ֲ0Ĳ룬÷ִӸߵ
+		// Χпƽ屻ÿܿڲܵʵĵڵ壻boundsCullOccludedͬ
+		template <typename Container, typename ScoreFn, typename BoundsFn>
+		const std::vector<uint32_t>& SelectOccluders(const Container& objects, uint32_t max_count, ScoreFn score, BoundsFn bounds)
+		{
+			auto begin = Clock::now();
+			m_candidates.clear();
+			for (uint32_t object : objects)
+			{
+				float value = score(object);
+				if (!(value > 0.0f)) continue;
+				float box_min[3], box_max[3], min_x, min_y, max_x, max_y, min_z;
+				bounds(object, box_min, box_max);
+				if (ProjectBox(box_min, box_max, min_x, min_y, max_x, max_y, min_z)) m_candidates.push_back({value, object});
+			}
+			size_t count = std::min<size_t>(max_count, m_candidates.size());
+			std::partial_sort(m_candidates.begin(), m_candidates.begin() + count, m_candidates.end(),
+				[](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+			m_occluders.clear();
+			for (size_t i = 0; i < count; ++i) m_occluders.push_back(m_candidates[i].object);
+			m_stats.select_ms += Elapsed(begin);
+			return m_occluders;
+		}
+
+		// һڵդȻworldΪԼ
+		void RenderOccluder(uint32_t mesh_id, const float world[4][4])
+		{
+			auto begin = Clock::now();
+			const Mesh& mesh = m_meshes[mesh_id];
+			float mvp[4][4];
+			Multiply(world, m_view_projection, mvp);
+			size_t vertex_count = mesh.positions.size() / 3;
+			m_clip.resize(vertex_count * 4);
+			for (size_t i = 0; i < vertex_count; ++i)
+			{
+				const float* p = &mesh.positions[i * 3];
+				for (int column = 0; column < 4; ++column)
+				{
+					m_clip[i * 4 + column] = p[0] * mvp[0][column] + p[1] * mvp[1][column] + p[2] * mvp[2][column] + mvp[3][column];
+				}
+			}
+			for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				bool drawn = m_depth.RasterizeTriangle(&m_clip[mesh.indices[i] * 4], &m_clip[mesh.indices[i + 1] * 4], &m_clip[mesh.indices[i + 2] * 4]);
+				m_stats.rasterized += drawn ? 1 : 0;
+			}
+			m_stats.triangles += static_cast<uint32_t>(mesh.indices.size() / 3);
+			++m_stats.occluders;
+			m_stats.raster_ms += Elapsed(begin);
+		}
+
+		// ռΧǷܿɼΧпƽʱΪɼ
+		bool IsVisible(const float box_min[3], const float box_max[3]) const
+		{
+			float min_x, min_y, max_x, max_y, min_z;
+			if (!ProjectBox(box_min, box_max, min_x, min_y, max_x, max_y, min_z)) return true;
+			float width = static_cast<float>(m_depth.Width()), height = static_cast<float>(m_depth.Height());
+			// NDCλɸǵķΧĻĲֽ׶޳
+			int x0 = static_cast<int>(std::floor((min_x * 0.5f + 0.5f) * width));
+			int x1 = static_cast<int>(std::ceil((max_x * 0.5f + 0.5f) * width));
+			int y0 = static_cast<int>(std::floor((0.5f - max_y * 0.5f) * height));
+			int y1 = static_cast<int>(std::ceil((0.5f - min_y * 0.5f) * height));
+			return m_depth.IsRectVisible(x0, y0, x1, y1, min_z);
+		}
+
+		// вбڵбƳౣԭ˳
+		// bounds(object, box_min, box_max)дΧУڶ߳ͬʱ
+		template <typename Container, typename BoundsFn>
+		void CullOccluded(Container& objects, BoundsFn bounds)
+		{
+			auto begin = Clock::now();
+			m_visible.resize(objects.size());
+			struct Context
+			{
+				OcclusionCuller* culler;
+				const uint32_t* objects;
+				size_t count;
+				BoundsFn* bounds;
+			} context{this, objects.data(), objects.size(), &bounds};
+			m_next_batch.store(0, std::memory_order_relaxed);
+			m_pool.Run([](void* pointer, uint32_t)
+				{
+					Context& context = *static_cast<Context*>(pointer);
+					OcclusionCuller& culler = *context.culler;
+					const uint32_t* objects = context.objects;
+					size_t count = context.count;
+					for (;;)
+					{
+						size_t begin = culler.m_next_batch.fetch_add(m_test_batch, std::memory_order_relaxed);
+						if (begin >= count) break;
+						size_t end = std::min(count, begin + m_test_batch);
+						for (size_t i = begin; i < end; ++i)
+						{
+							float box_min[3], box_max[3];
+							(*context.bounds)(objects[i], box_min, box_max);
+							culler.m_visible[i] = culler.IsVisible(box_min, box_max) ? 1 : 0;
+						}
+					}
+				}, &context);
+			size_t kept = 0;
+			for (size_t i = 0; i < objects.size(); ++i)
+			{
+				if (m_visible[i]) objects[kept++] = objects[i];
+			}
+			m_stats.tested += static_cast<uint32_t>(objects.size());
+			m_stats.culled += static_cast<uint32_t>(objects.size() - kept);
+			objects.resize(kept);
+			m_stats.test_ms += Elapsed(begin);
+		}
+
+		const OcclusionStats& Stats() const { return m_stats; }
+		const MaskedDepthBuffer& DepthBuffer() const { return m_depth; }
+		uint32_t ThreadCount() const { return m_pool.ThreadCount(); }
+
+	private:
+		using Clock = std::chrono::high_resolution_clock;
+
+		struct Mesh
+		{
+			std::vector<float> positions;
+			std::vector<uint32_t> indices;
+		};
+
+		struct Candidate
+		{
+			float score;
+			uint32_t object;
+		};
+
+		static double Elapsed(Clock::time_point begin)
+		{
+			return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+		}
+
+		static void Multiply(const float a[4][4], const float b[4][4], float result[4][4])
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				for (int column = 0; column < 4; ++column)
+				{
+					result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column] + a[row][3] * b[3][column];
+				}
+			}
+		}
+
+		// ѰΧе8Ǳ任NDCõxyκȣнڽƽ֮ʱfalse
+#if defined(OCCLUSION_HELPER_AVX2)
+		bool ProjectBox(const float box_min[3], const float box_max[3], float& min_x, float& min_y, float& max_x, float& max_y, float& min_z) const
+		{
+			// 8ͨӦ8ǣiڸϰiλȡСֵ
+			__m256 x = _mm256_setr_ps(box_min[0], box_max[0], box_min[0], box_max[0], box_min[0], box_max[0], box_min[0], box_max[0]);
+			__m256 y = _mm256_setr_ps(box_min[1], box_min[1], box_max[1], box_max[1], box_min[1], box_min[1], box_max[1], box_max[1]);
+			__m256 z = _mm256_setr_ps(box_min[2], box_min[2], box_min[2], box_min[2], box_max[2], box_max[2], box_max[2], box_max[2]);
+			const float (*m)[4] = m_view_projection;
+			__m256 clip[4];
+			for (int column = 0; column < 4; ++column)
+			{
+				clip[column] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(m[0][column])), _mm256_mul_ps(y, _mm256_set1_ps(m[1][column]))),
+					_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(m[2][column])), _mm256_set1_ps(m[3][column])));
+			}
+			if (_mm256_movemask_ps(_mm256_or_ps(_mm256_cmp_ps(clip[2], _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_cmp_ps(clip[3], _mm256_setzero_ps(), _CMP_LE_OQ)))) return false;
+			__m256 inv_w = _mm256_div_ps(_mm256_set1_ps(1.0f), clip[3]);
+			alignas(32) float ndc[3][8];
+			_mm256_store_ps(ndc[0], _mm256_mul_ps(clip[0], inv_w));
+			_mm256_store_ps(ndc[1], _mm256_mul_ps(clip[1], inv_w));
+			_mm256_store_ps(ndc[2], _mm256_mul_ps(clip[2], inv_w));
+			min_x = max_x = ndc[0][0];
+			min_y = max_y = ndc[1][0];
+			min_z = ndc[2][0];
+			for (int i = 1; i < 8; ++i)
+			{
+				min_x = std::min(min_x, ndc[0][i]);
+				max_x = std::max(max_x, ndc[0][i]);
+				min_y = std::min(min_y, ndc[1][i]);
+				max_y = std::max(max_y, ndc[1][i]);
+				min_z = std::min(min_z, ndc[2][i]);
+			}
+			return true;
+		}
+#else
+		bool ProjectBox(const float box_min[3], const float box_max[3], float& min_x, float& min_y, float& max_x, float& max_y, float& min_z) const
+		{
+			const float (*m)[4] = m_view_projection;
+			min_x = min_y = min_z = std::numeric_limits<float>::infinity();
+			max_x = max_y = -std::numeric_limits<float>::infinity();
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				float p[3] = {corner & 1 ? box_max[0] : box_min[0], corner & 2 ? box_max[1] : box_min[1], corner & 4 ? box_max[2] : box_min[2]};
+				float clip[4];
+				for (int column = 0; column < 4; ++column)
+				{
+					clip[column] = p[0] * m[0][column] + p[1] * m[1][column] + p[2] * m[2][column] + m[3][column];
+				}
+				if (clip[2] < 0.0f || clip[3] <= 0.0f) return false;
+				float inv_w = 1.0f / clip[3];
+				min_x = std::min(min_x, clip[0] * inv_w);
+				max_x = std::max(max_x, clip[0] * inv_w);
+				min_y = std::min(min_y, clip[1] * inv_w);
+				max_y = std::max(max_y, clip[1] * inv_w);
+				min_z = std::min(min_z, clip[2] * inv_w);
+			}
+			return true;
+		}
+#endif
+
+		MaskedDepthBuffer m_depth;
+		ThreadHelper::WorkerPool m_pool;
+		std::vector<Mesh> m_meshes;
+		float m_view_projection[4][4]{};
+		std::vector<float> m_clip;
+		std::vector<Candidate> m_candidates;
+		std::vector<uint32_t> m_occluders;
+		std::vector<uint8_t> m_visible;
+		std::atomic<size_t> m_next_batch{0};
+		OcclusionStats m_stats;
+	};
+}
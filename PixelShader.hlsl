@@ -1,3 +1,5 @@
+// shader: ps_6_0 main
+
 struct PixelShaderInput
 {
 	float4 Color    : COLOR;
@@ -0,0 +1,480 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace QueueHelper
+{
+	// passִڵĶ
+	enum class QueueType : uint32_t
+	{
+		Graphics,
+		Compute,
+	};
+
+	static const uint32_t m_queue_type_count = 2;
+
+	inline const wchar_t* QueueTypeName(QueueType queue)
+	{
+		switch (queue)
+		{
+		case QueueType::Graphics: return L"graphics";
+		case QueueType::Compute: return L"compute";
+		}
+		return L"unknown";
+	}
+
+	// һpassframe_lagΪ0ʾ֡Ϊ1ʾһ֡
+	struct PassDependency
+	{
+		uint32_t pass;
+		uint32_t frame_lag;
+	};
+
+	// һ֡еһGPUֻк漰豸
+	struct PassDesc
+	{
+		const wchar_t* name;
+		QueueType queue;
+		std::vector<PassDependency> dependencies;
+	};
+
+	// ύǰڶϵȴһеĸֵ
+	struct FenceWait
+	{
+		QueueType queue;
+		uint64_t value;
+	};
+
+	// һύȵȴУִpassڱеĸϷsignal_value
+	struct Submission
+	{
+		QueueType queue;
+		const uint32_t* passes;
+		uint32_t pass_count;
+		FenceWait waits[m_queue_type_count];
+		uint32_t wait_count;
+		uint64_t signal_value;
+	};
+
+	// passͼֳɸϵΣƵٵĿеȴ
+	// ͬһϵɶе˳ִбֻ֤пҪ
+	class FrameSchedule
+	{
+	public:
+		// ͼͬ֡ɻʱfalse
+		bool Build(const std::vector<PassDesc>& passes)
+		{
+			m_passes = passes;
+			m_batches.clear();
+			m_batch_passes.clear();
+			m_frame = 0;
+			for (auto& waited : m_waited) std::fill(std::begin(waited), std::end(waited), 0);
+			uint32_t pass_count = static_cast<uint32_t>(passes.size());
+
+			// ͬ֡ͬʱ˳
+			std::vector<uint32_t> order;
+			if (!SortPasses(order)) return false;
+
+			// pass֮źţڴ˽ض
+			std::vector<uint8_t> signal_after(pass_count, 0);
+			uint32_t max_lag = 0;
+			for (uint32_t pass = 0; pass < pass_count; ++pass)
+			{
+				for (const PassDependency& dependency : passes[pass].dependencies)
+				{
+					if (passes[dependency.pass].queue != passes[pass].queue) signal_after[dependency.pass] = 1;
+					max_lag = std::max(max_lag, dependency.frame_lag);
+				}
+			}
+			m_history = max_lag + 1;
+
+			// ˳passŽڶеǰ򿪵ΣҪµĵȴʱ
+			std::vector<Pending> pending;
+			std::vector<uint32_t> batch_of(pass_count, m_invalid);
+			std::vector<uint32_t> emitted;
+			uint32_t open[m_queue_type_count];
+			uint32_t queue_batch_count[m_queue_type_count]{};
+			std::fill(std::begin(open), std::end(open), m_invalid);
+			for (uint32_t pass : order)
+			{
+				uint32_t queue = QueueIndex(passes[pass].queue);
+				Wait required[m_queue_type_count];
+				for (const PassDependency& dependency : passes[pass].dependencies)
+				{
+					uint32_t other = QueueIndex(passes[dependency.pass].queue);
+					if (other == queue || dependency.frame_lag != 0) continue;
+					Merge(required[other], MakeWait(0, pending[batch_of[dependency.pass]].index_in_queue));
+				}
+
+				bool covered = open[queue] != m_invalid;
+				for (uint32_t other = 0; covered && other < m_queue_type_count; ++other)
+				{
+					covered = !required[other].valid || Covers(pending[open[queue]].waits[other], required[other]);
+				}
+				if (!covered && open[queue] != m_invalid)
+				{
+					emitted.push_back(open[queue]);
+					open[queue] = m_invalid;
+				}
+				if (open[queue] == m_invalid)
+				{
+					open[queue] = static_cast<uint32_t>(pending.size());
+					pending.push_back({});
+					pending.back().queue = passes[pass].queue;
+					pending.back().index_in_queue = queue_batch_count[queue]++;
+				}
+				Pending& batch = pending[open[queue]];
+				for (uint32_t other = 0; other < m_queue_type_count; ++other)
+				{
+					if (required[other].valid) Merge(batch.waits[other], required[other]);
+				}
+				batch.passes.push_back(pass);
+				batch_of[pass] = open[queue];
+
+				if (signal_after[pass])
+				{
+					emitted.push_back(open[queue]);
+					open[queue] = m_invalid;
+				}
+			}
+			// ʣ򿪵ΰ׸pass˳ύ
+			std::vector<uint32_t> remaining;
+			for (uint32_t batch : open)
+			{
+				if (batch != m_invalid) remaining.push_back(batch);
+			}
+			std::sort(remaining.begin(), remaining.end());
+			emitted.insert(emitted.end(), remaining.begin(), remaining.end());
+
+			// ָ֮֡ǰ֡ѾύΣεĿͷ
+			for (uint32_t pass = 0; pass < pass_count; ++pass)
+			{
+				uint32_t queue = QueueIndex(passes[pass].queue);
+				for (const PassDependency& dependency : passes[pass].dependencies)
+				{
+					uint32_t other = QueueIndex(passes[dependency.pass].queue);
+					if (other == queue || dependency.frame_lag == 0) continue;
+					Merge(pending[batch_of[pass]].waits[other], MakeWait(dependency.frame_lag, pending[batch_of[dependency.pass]].index_in_queue));
+				}
+			}
+
+			// ύ˳չȴеαŻύ˳еı
+			std::vector<uint32_t> emitted_index_of(pending.size());
+			for (uint32_t i = 0; i < emitted.size(); ++i) emitted_index_of[emitted[i]] = i;
+			std::vector<uint32_t> emitted_by_queue[m_queue_type_count];
+			for (uint32_t batch : emitted) emitted_by_queue[QueueIndex(pending[batch].queue)].push_back(emitted_index_of[batch]);
+			for (uint32_t batch : emitted)
+			{
+				const Pending& source = pending[batch];
+				Batch result{};
+				result.queue = source.queue;
+				result.first_pass = static_cast<uint32_t>(m_batch_passes.size());
+				result.pass_count = static_cast<uint32_t>(source.passes.size());
+				for (uint32_t other = 0; other < m_queue_type_count; ++other)
+				{
+					result.waits[other] = source.waits[other];
+					if (source.waits[other].valid) result.waits[other].batch = emitted_by_queue[other][source.waits[other].batch];
+				}
+				m_batch_passes.insert(m_batch_passes.end(), source.passes.begin(), source.passes.end());
+				m_batches.push_back(result);
+			}
+			m_signals.assign(m_history * m_batches.size(), 0);
+			return true;
+		}
+
+		// һ֡ύбfence_valuesΪиĵǰֵÿϵһ
+		// ѱĵȴǵĸֵظȴ
+		void Instantiate(uint64_t* const fence_values[m_queue_type_count], std::vector<Submission>& submissions)
+		{
+			submissions.resize(m_batches.size());
+			uint64_t slot = m_frame % m_history;
+			for (size_t i = 0; i < m_batches.size(); ++i)
+			{
+				const Batch& batch = m_batches[i];
+				uint32_t queue = QueueIndex(batch.queue);
+				Submission& submission = submissions[i];
+				submission.queue = batch.queue;
+				submission.passes = m_batch_passes.data() + batch.first_pass;
+				submission.pass_count = batch.pass_count;
+				submission.wait_count = 0;
+				for (uint32_t other = 0; other < m_queue_type_count; ++other)
+				{
+					const Wait& wait = batch.waits[other];
+					if (!wait.valid || wait.frame_lag > m_frame) continue;
+					uint64_t value = m_signals[((m_frame - wait.frame_lag) % m_history) * m_batches.size() + wait.batch];
+					if (value <= m_waited[queue][other]) continue;
+					m_waited[queue][other] = value;
+					submission.waits[submission.wait_count++] = {static_cast<QueueType>(other), value};
+				}
+				submission.signal_value = ++*fence_values[queue];
+				m_signals[slot * m_batches.size() + i] = submission.signal_value;
+			}
+			++m_frame;
+		}
+
+		const std::vector<PassDesc>& Passes() const { return m_passes; }
+		size_t BatchCount() const { return m_batches.size(); }
+
+	private:
+		static constexpr uint32_t m_invalid = UINT32_MAX;
+
+		// ȴĳϵbatchΣframe_lagԽСbatchԽĵȴԽ
+		struct Wait
+		{
+			bool valid = false;
+			uint32_t frame_lag = 0;
+			uint32_t batch = 0;
+		};
+
+		struct Pending
+		{
+			QueueType queue;
+			uint32_t index_in_queue;
+			Wait waits[m_queue_type_count];
+			std::vector<uint32_t> passes;
+		};
+
+		struct Batch
+		{
+			QueueType queue;
+			uint32_t first_pass;
+			uint32_t pass_count;
+			Wait waits[m_queue_type_count];
+		};
+
+		static uint32_t QueueIndex(QueueType queue) { return static_cast<uint32_t>(queue); }
+
+		static Wait MakeWait(uint32_t frame_lag, uint32_t batch)
+		{
+			Wait wait;
+			wait.valid = true;
+			wait.frame_lag = frame_lag;
+			wait.batch = batch;
+			return wait;
+		}
+
+		static bool Covers(const Wait& existing, const Wait& required)
+		{
+			if (!existing.valid) return false;
+			if (existing.frame_lag != required.frame_lag) return existing.frame_lag < required.frame_lag;
+			return existing.batch >= required.batch;
+		}
+
+		static void Merge(Wait& existing, const Wait& required)
+		{
+			if (!Covers(existing, required)) existing = required;
+		}
+
+		bool SortPasses(std::vector<uint32_t>& order) const
+		{
+			uint32_t pass_count = static_cast<uint32_t>(m_passes.size());
+			std::vector<uint32_t> in_degree(pass_count, 0);
+			std::vector<std::vector<uint32_t>> users(pass_count);
+			for (uint32_t pass = 0; pass < pass_count; ++pass)
+			{
+				for (const PassDependency& dependency : m_passes[pass].dependencies)
+				{
+					if (dependency.pass >= pass_count) return false;
+					if (dependency.frame_lag != 0) continue;
+					++in_degree[pass];
+					users[dependency.pass].push_back(pass);
+				}
+			}
+			// ÿȡСľpass֤ȶ
+			std::vector<uint32_t> ready;
+			for (uint32_t pass = 0; pass < pass_count; ++pass)
+			{
+				if (in_degree[pass] == 0) ready.push_back(pass);
+			}
+			while (!ready.empty())
+			{
+				auto smallest = std::min_element(ready.begin(), ready.end());
+				uint32_t pass = *smallest;
+				ready.erase(smallest);
+				order.push_back(pass);
+				for (uint32_t user : users[pass])
+				{
+					if (--in_degree[user] == 0) ready.push_back(user);
+				}
+			}
+			return order.size() == pass_count;
+		}
+
+		std::vector<PassDesc> m_passes;
+		std::vector<Batch> m_batches;
+		std::vector<uint32_t> m_batch_passes;
+		// m_history֡ÿηĸֵڽ֡
+		std::vector<uint64_t> m_signals;
+		uint32_t m_history = 1;
+		uint64_t m_frame = 0;
+		// ÿѾȴеֵ
+		uint64_t m_waited[m_queue_type_count][m_queue_type_count]{};
+	};
+
+	// 豸ʱģλΪ
+	struct TimelineStats
+	{
+		double frame_ms;
+		double serialized_ms;
+		double queue_busy_ms[m_queue_type_count];
+		double queue_idle_ms[m_queue_type_count];
+	};
+
+	// ύбģеִУڶпҵȴĸɺʼ
+	// вʱ٣첽Ͻ
+	inline TimelineStats SimulateTimeline(FrameSchedule schedule, const std::vector<double>& pass_ms, uint32_t frame_count = 64)
+	{
+		TimelineStats stats{};
+		uint64_t fence_values[m_queue_type_count]{};
+		uint64_t* fence_pointers[m_queue_type_count];
+		for (uint32_t queue = 0; queue < m_queue_type_count; ++queue) fence_pointers[queue] = &fence_values[queue];
+		// ÿϵvalueֵʱ
+		std::vector<double> completion[m_queue_type_count];
+		double queue_free[m_queue_type_count]{};
+		std::vector<double> frame_end(frame_count, 0.0);
+		std::vector<Submission> submissions;
+		uint32_t first_measured = frame_count / 2;
+		for (uint32_t frame = 0; frame < frame_count; ++frame)
+		{
+			schedule.Instantiate(fence_pointers, submissions);
+			for (const Submission& submission : submissions)
+			{
+				uint32_t queue = static_cast<uint32_t>(submission.queue);
+				double start = queue_free[queue];
+				for (uint32_t i = 0; i < submission.wait_count; ++i)
+				{
+					start = std::max(start, completion[static_cast<uint32_t>(submission.waits[i].queue)][submission.waits[i].value - 1]);
+				}
+				double duration = 0.0;
+				for (uint32_t i = 0; i < submission.pass_count; ++i) duration += pass_ms[submission.passes[i]];
+				if (frame > first_measured)
+				{
+					stats.queue_busy_ms[queue] += duration;
+					stats.queue_idle_ms[queue] += start - queue_free[queue];
+				}
+				queue_free[queue] = start + duration;
+				completion[queue].resize(submission.signal_value, start + duration);
+				frame_end[frame] = std::max(frame_end[frame], start + duration);
+			}
+		}
+		uint32_t measured = frame_count - 1 - first_measured;
+		if (measured == 0) return stats;
+		stats.frame_ms = (frame_end[frame_count - 1] - frame_end[first_measured]) / measured;
+		for (uint32_t queue = 0; queue < m_queue_type_count; ++queue)
+		{
+			stats.queue_busy_ms[queue] /= measured;
+			stats.queue_idle_ms[queue] /= measured;
+		}
+		for (double ms : pass_ms) stats.serialized_ms += ms;
+		return stats;
+	}
+}
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#include <Windows.h>
+#include <wrl.h>
+
+namespace QueueHelper
+{
+	// ÿ֡һбύĶһ
+	class CommandContext
+	{
+	public:
+		void Initial(Microsoft::WRL::ComPtr<ID3D12Device10> device, D3D12_COMMAND_LIST_TYPE type, uint32_t frame_count)
+		{
+			m_allocators.resize(frame_count);
+			for (auto& allocator : m_allocators)
+			{
+				DxDebug::ThrowIfFailed(device->CreateCommandAllocator(type, IID_PPV_ARGS(allocator.GetAddressOf())));
+			}
+			DxDebug::ThrowIfFailed(device->CreateCommandList1(0, type, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(m_command_list.GetAddressOf())));
+		}
+
+		// ǰȷ֡һύѾִ
+		ID3D12GraphicsCommandList* Begin(uint32_t frame_index)
+		{
+			DxDebug::ThrowIfFailed(m_allocators[frame_index]->Reset());
+			DxDebug::ThrowIfFailed(m_command_list->Reset(m_allocators[frame_index].Get(), nullptr));
+			return m_command_list.Get();
+		}
+
+		ID3D12GraphicsCommandList* List() const { return m_command_list.Get(); }
+
+	private:
+		std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_allocators;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_command_list;
+	};
+
+	// ʱѯͳһڶϵGPUֹʱ䣬ͨʱУ׼㵽CPUʱᣬڱȽϲͬеص
+	class QueueTimer
+	{
+	public:
+		void Initial(Microsoft::WRL::ComPtr<ID3D12Device10> device, ID3D12CommandQueue* queue, uint32_t frame_count)
+		{
+			m_queue = queue;
+			D3D12_QUERY_HEAP_DESC heap_desc{};
+			heap_desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+			heap_desc.Count = frame_count * 2;
+			DxDebug::ThrowIfFailed(device->CreateQueryHeap(&heap_desc, IID_PPV_ARGS(m_query_heap.GetAddressOf())));
+
+			D3D12_HEAP_PROPERTIES readback_heap_prop = {D3D12_HEAP_TYPE_READBACK, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+			D3D12_RESOURCE_DESC readback_desc = {D3D12_RESOURCE_DIMENSION_BUFFER, 0, heap_desc.Count * sizeof(uint64_t), 1, 1, 1, DXGI_FORMAT_UNKNOWN, {1u, 0u}, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, D3D12_RESOURCE_FLAG_NONE};
+			DxDebug::ThrowIfFailed(device->CreateCommittedResource(&readback_heap_prop, D3D12_HEAP_FLAG_NONE, &readback_desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_readback.GetAddressOf())));
+			DxDebug::ThrowIfFailed(m_readback->Map(0, nullptr, reinterpret_cast<void**>(&m_timestamps)));
+			m_written.assign(frame_count, 0);
+			Calibrate();
+		}
+
+		// GPUCPUʱӻỺƯƣУ׼
+		void Calibrate()
+		{
+			DxDebug::ThrowIfFailed(m_queue->GetTimestampFrequency(&m_gpu_frequency));
+			DxDebug::ThrowIfFailed(m_queue->GetClockCalibration(&m_gpu_calibration, &m_cpu_calibration));
+			LARGE_INTEGER cpu_frequency;
+			QueryPerformanceFrequency(&cpu_frequency);
+			m_cpu_frequency = static_cast<uint64_t>(cpu_frequency.QuadPart);
+		}
+
+		void Begin(ID3D12GraphicsCommandList* command_list, uint32_t frame_index)
+		{
+			command_list->EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frame_index * 2);
+		}
+
+		void End(ID3D12GraphicsCommandList* command_list, uint32_t frame_index)
+		{
+			command_list->EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frame_index * 2 + 1);
+			command_list->ResolveQueryData(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, frame_index * 2, 2, m_readback.Get(), frame_index * 2 * sizeof(uint64_t));
+			m_written[frame_index] = 1;
+		}
+
+		// ֡ĸɺȡCPUʱϵֹʱ䣬λΪ
+		bool Read(uint32_t frame_index, double& begin_seconds, double& end_seconds)
+		{
+			if (!m_written[frame_index]) return false;
+			m_written[frame_index] = 0;
+			begin_seconds = ToCpuSeconds(m_timestamps[frame_index * 2]);
+			end_seconds = ToCpuSeconds(m_timestamps[frame_index * 2 + 1]);
+			return true;
+		}
+
+	private:
+		double ToCpuSeconds(uint64_t timestamp) const
+		{
+			double gpu_offset = (static_cast<double>(timestamp) - static_cast<double>(m_gpu_calibration)) / m_gpu_frequency;
+			return static_cast<double>(m_cpu_calibration) / m_cpu_frequency + gpu_offset;
+		}
+
+		ID3D12CommandQueue* m_queue = nullptr;
+		Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_query_heap;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_readback;
+		uint64_t* m_timestamps = nullptr;
+		std::vector<uint8_t> m_written;
+		uint64_t m_gpu_frequency = 1;
+		uint64_t m_gpu_calibration = 0;
+		uint64_t m_cpu_calibration = 0;
+		uint64_t m_cpu_frequency = 1;
+	};
+}
+#endif
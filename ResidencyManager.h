@@ -0,0 +1,624 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <vector>
+#include "FrameMemory.h"
+
+namespace ResidencyHelper
+{
+	static const uint64_t m_tile_size_in_bytes = 64 * 1024;
+
+	// ׼ƬڵmipƬ
+	struct TileCoordinate
+	{
+		uint32_t texture;
+		uint32_t mip;
+		uint32_t x;
+		uint32_t y;
+	};
+
+	// һ֡Ҫִеӳȡӳ
+	struct ResidencyUpdate
+	{
+		std::vector<TileCoordinate> loads;
+		std::vector<TileCoordinate> evictions;
+	};
+
+	struct ResidencyStats
+	{
+		uint64_t budget_bytes = 0;
+		uint64_t resident_bytes = 0;
+		uint64_t requested_tiles = 0;
+		uint64_t loaded_tiles = 0;
+		uint64_t evicted_tiles = 0;
+		// ΪԤƳٵ
+		uint64_t deferred_tiles = 0;
+	};
+
+	// CPUפԣmipƬԤ㲻ʱʹ̭
+	// 豸ֱúϳɵķв
+	class ResidencyPolicy
+	{
+	public:
+		// mip_tilesΪÿ׼mipƬߣpacked mipβʼפ
+		uint32_t RegisterTexture(const std::vector<std::pair<uint32_t, uint32_t>>& mip_tiles)
+		{
+			Texture texture;
+			uint32_t first_tile = 0;
+			for (const auto& tiles : mip_tiles)
+			{
+				texture.mips.push_back({tiles.first, tiles.second, first_tile});
+				first_tile += tiles.first * tiles.second;
+			}
+			texture.tiles.resize(first_tile);
+			texture.resident_mip = static_cast<uint32_t>(mip_tiles.size());
+			m_textures.push_back(std::move(texture));
+			return static_cast<uint32_t>(m_textures.size() - 1);
+		}
+
+		// ÿ֡صƬϴ
+		void SetMaxLoadsPerFrame(uint32_t max_loads)
+		{
+			m_max_loads_per_frame = max_loads;
+		}
+
+		// ɫдmip󣺸mipֵmipȫƬᱻʹ
+		void RequestMip(uint32_t texture_index, uint32_t mip)
+		{
+			Texture& texture = m_textures[texture_index];
+			for (uint32_t m = mip; m < texture.mips.size(); ++m)
+			{
+				const Mip& level = texture.mips[m];
+				for (uint32_t i = 0; i < level.tiles_x * level.tiles_y; ++i)
+				{
+					Touch(texture_index, level.first_tile + i);
+				}
+			}
+		}
+
+		// uvΧΪ[0,1]ͬʱmipϸǸƬ
+		void RequestRegion(uint32_t texture_index, uint32_t mip, float u0, float v0, float u1, float v1)
+		{
+			Texture& texture = m_textures[texture_index];
+			for (uint32_t m = mip; m < texture.mips.size(); ++m)
+			{
+				const Mip& level = texture.mips[m];
+				uint32_t x0 = std::min(level.tiles_x - 1, static_cast<uint32_t>(std::max(0.0f, u0) * level.tiles_x));
+				uint32_t y0 = std::min(level.tiles_y - 1, static_cast<uint32_t>(std::max(0.0f, v0) * level.tiles_y));
+				uint32_t x1 = std::min(level.tiles_x - 1, static_cast<uint32_t>(std::max(0.0f, u1) * level.tiles_x));
+				uint32_t y1 = std::min(level.tiles_y - 1, static_cast<uint32_t>(std::max(0.0f, v1) * level.tiles_y));
+				for (uint32_t y = y0; y <= y1; ++y)
+				{
+					for (uint32_t x = x0; x <= x1; ++x)
+					{
+						Touch(texture_index, level.first_tile + y * level.tiles_x + x);
+					}
+				}
+			}
+		}
+
+		// 㱾֡Ҫغ̭ƬһεǰЧб֡
+		const ResidencyUpdate& Update(uint64_t budget_bytes)
+		{
+			ResidencyUpdate& update = m_update;
+			update.loads.clear();
+			update.evictions.clear();
+			m_stats.budget_bytes = budget_bytes;
+			m_stats.requested_tiles = m_requested.size();
+			uint64_t budget_tiles = budget_bytes / m_tile_size_in_bytes;
+
+			// ȼشֵmip֤пõĵ;
+			std::sort(m_requested.begin(), m_requested.end(), [this](const TileId& a, const TileId& b)
+			{
+				uint32_t mip_a = MipOf(a), mip_b = MipOf(b);
+				return mip_a != mip_b ? mip_a > mip_b : (a.texture != b.texture ? a.texture < b.texture : a.tile < b.tile);
+			});
+
+			uint32_t loads = 0;
+			for (const TileId& id : m_requested)
+			{
+				Tile& tile = m_textures[id.texture].tiles[id.tile];
+				if (tile.resident) continue;
+
+				// Ԥʱ̭֡ûõƬ
+				while (m_resident_count >= budget_tiles && !m_lru.empty() && m_textures[m_lru.back().texture].tiles[m_lru.back().tile].last_used_frame < m_frame)
+				{
+					Evict(m_lru.back(), update);
+				}
+				if (m_resident_count >= budget_tiles || loads >= m_max_loads_per_frame)
+				{
+					++m_stats.deferred_tiles;
+					continue;
+				}
+
+				tile.resident = true;
+				m_lru.push_front(id);
+				tile.lru_position = m_lru.begin();
+				++m_resident_count;
+				++loads;
+				update.loads.push_back(CoordinateOf(id));
+			}
+
+			// ԤСʱʹûҲҪ̭Ԥ
+			while (m_resident_count > budget_tiles && !m_lru.empty())
+			{
+				Evict(m_lru.back(), update);
+			}
+
+			m_stats.loaded_tiles += update.loads.size();
+			m_stats.evicted_tiles += update.evictions.size();
+			m_stats.resident_bytes = m_resident_count * m_tile_size_in_bytes;
+			for (const TileCoordinate& tile : update.loads)
+			{
+				UpdateResidentMip(tile.texture);
+			}
+			for (const TileCoordinate& tile : update.evictions)
+			{
+				UpdateResidentMip(tile.texture);
+			}
+			for (const TileId& id : m_requested)
+			{
+				m_textures[id.texture].tiles[id.tile].requested = false;
+			}
+			m_requested.clear();
+			++m_frame;
+			return update;
+		}
+
+		// ƬפϸmipɫƲСLOD
+		uint32_t ResidentMip(uint32_t texture_index) const
+		{
+			return m_textures[texture_index].resident_mip;
+		}
+
+		bool IsResident(uint32_t texture_index, uint32_t mip, uint32_t x, uint32_t y) const
+		{
+			const Texture& texture = m_textures[texture_index];
+			const Mip& level = texture.mips[mip];
+			return texture.tiles[level.first_tile + y * level.tiles_x + x].resident;
+		}
+
+		uint32_t TextureCount() const { return static_cast<uint32_t>(m_textures.size()); }
+		uint64_t ResidentTiles() const { return m_resident_count; }
+		const ResidencyStats& Stats() const { return m_stats; }
+
+	private:
+		struct TileId
+		{
+			uint32_t texture;
+			uint32_t tile;
+		};
+
+		// ڵӶط䣬Ƭ̭ʱ߶
+		using TileList = std::list<TileId, MemoryHelper::PoolAllocator<TileId>>;
+
+		struct Tile
+		{
+			bool resident = false;
+			bool requested = false;
+			uint64_t last_used_frame = 0;
+			TileList::iterator lru_position;
+		};
+
+		struct Mip
+		{
+			uint32_t tiles_x;
+			uint32_t tiles_y;
+			uint32_t first_tile;
+		};
+
+		struct Texture
+		{
+			std::vector<Mip> mips;
+			std::vector<Tile> tiles;
+			uint32_t resident_mip = 0;
+		};
+
+		void Touch(uint32_t texture_index, uint32_t tile_index)
+		{
+			Tile& tile = m_textures[texture_index].tiles[tile_index];
+			tile.last_used_frame = m_frame;
+			if (tile.resident)
+			{
+				// ƶʹõһ
+				m_lru.splice(m_lru.begin(), m_lru, tile.lru_position);
+			}
+			else if (!tile.requested)
+			{
+				tile.requested = true;
+				m_requested.push_back({texture_index, tile_index});
+			}
+		}
+
+		void Evict(TileId id, ResidencyUpdate& update)
+		{
+			Tile& tile = m_textures[id.texture].tiles[id.tile];
+			m_lru.erase(tile.lru_position);
+			tile.resident = false;
+			--m_resident_count;
+			update.evictions.push_back(CoordinateOf(id));
+		}
+
+		uint32_t MipOf(const TileId& id) const
+		{
+			const Texture& texture = m_textures[id.texture];
+			uint32_t mip = 0;
+			while (mip + 1 < texture.mips.size() && texture.mips[mip + 1].first_tile <= id.tile)
+			{
+				++mip;
+			}
+			return mip;
+		}
+
+		TileCoordinate CoordinateOf(const TileId& id) const
+		{
+			const Mip& level = m_textures[id.texture].mips[MipOf(id)];
+			uint32_t local = id.tile - level.first_tile;
+			return {id.texture, MipOf(id), local % level.tiles_x, local / level.tiles_x};
+		}
+
+		void UpdateResidentMip(uint32_t texture_index)
+		{
+			Texture& texture = m_textures[texture_index];
+			uint32_t mip = static_cast<uint32_t>(texture.mips.size());
+			while (mip > 0)
+			{
+				const Mip& level = texture.mips[mip - 1];
+				bool complete = true;
+				for (uint32_t i = 0; i < level.tiles_x * level.tiles_y && complete; ++i)
+				{
+					complete = texture.tiles[level.first_tile + i].resident;
+				}
+				if (!complete) break;
+				--mip;
+			}
+			texture.resident_mip = mip;
+		}
+
+		std::vector<Texture> m_textures;
+		std::vector<TileId> m_requested;
+		TileList m_lru;
+		ResidencyUpdate m_update;
+		uint64_t m_resident_count = 0;
+		uint64_t m_frame = 1;
+		uint32_t m_max_loads_per_frame = 64;
+		ResidencyStats m_stats;
+	};
+}
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl.h>
+#include <cstring>
+#include <unordered_map>
+#include "TextureCompressor.h"
+#include "UploadAllocator.h"
+
+namespace ResidencyHelper
+{
+	// ϵͳıԴԤʽֽ
+	inline uint64_t StreamingBudget(IDXGIAdapter3* adapter, uint64_t streaming_bytes, float headroom = 0.9f)
+	{
+		DXGI_QUERY_VIDEO_MEMORY_INFO info{};
+		DxDebug::ThrowIfFailed(adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info));
+		// ԴռõĲֲʽ֧
+		uint64_t other_usage = info.CurrentUsage > streaming_bytes ? info.CurrentUsage - streaming_bytes : 0;
+		uint64_t budget = static_cast<uint64_t>(info.Budget * headroom);
+		return budget > other_usage ? budget - other_usage : 0;
+	}
+
+	// ԤƬԴפƬļ
+	class ResidencyManager
+	{
+	public:
+		// ƬӳͨжӸ£Ҫʹбͬһж
+		void Initial(Microsoft::WRL::ComPtr<ID3D12Device10> device, Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter, Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue, uint32_t tiles_per_heap = 64)
+		{
+			m_device = device;
+			m_adapter = adapter;
+			m_queue = queue;
+			m_tiles_per_heap = tiles_per_heap;
+		}
+
+		// ļڼ䱣ЧӳļԤpacked mipϴ
+		uint32_t RegisterTexture(const uint8_t* file_data, size_t file_size, ID3D12GraphicsCommandList* command_list, BufferHelper::LinearConstantAllocator& upload_allocator)
+		{
+			Texture texture;
+			texture.file_data = file_data;
+			if (!TextureHelper::ParseTextureFile(file_data, file_size, texture.header, texture.mips))
+			{
+				DxDebug::ThrowIfFailed(E_INVALIDARG);
+			}
+
+			D3D12_RESOURCE_DESC desc{};
+			desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+			desc.Width = texture.header.width;
+			desc.Height = texture.header.height;
+			desc.DepthOrArraySize = 1;
+			desc.MipLevels = static_cast<UINT16>(texture.header.mip_count);
+			desc.Format = BlockFormatToDxgi(texture.header.format, texture.header.srgb != 0);
+			desc.SampleDesc = {1, 0};
+			desc.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+			DxDebug::ThrowIfFailed(m_device->CreateReservedResource(&desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(texture.resource.GetAddressOf())));
+
+			// ѯÿ׼mipƬpacked mipϢ
+			UINT subresource_count = texture.header.mip_count;
+			D3D12_PACKED_MIP_INFO packed_mip_info{};
+			std::vector<D3D12_SUBRESOURCE_TILING> tilings(subresource_count);
+			m_device->GetResourceTiling(texture.resource.Get(), nullptr, &packed_mip_info, nullptr, &subresource_count, 0, tilings.data());
+			texture.packed_mip_first = packed_mip_info.NumStandardMips;
+
+			std::vector<std::pair<uint32_t, uint32_t>> mip_tiles;
+			for (uint32_t mip = 0; mip < packed_mip_info.NumStandardMips; ++mip)
+			{
+				mip_tiles.push_back({tilings[mip].WidthInTiles, tilings[mip].HeightInTiles});
+			}
+			uint32_t index = m_policy.RegisterTexture(mip_tiles);
+
+			// packed mipβӳ䵽רöѲϴ֤κʱпɲ
+			if (packed_mip_info.NumPackedMips > 0)
+			{
+				D3D12_HEAP_DESC heap_desc{};
+				heap_desc.SizeInBytes = packed_mip_info.NumTilesForPackedMips * m_tile_size_in_bytes;
+				heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+				heap_desc.Flags = D3D12_HEAP_FLAG_DENY_BUFFERS | D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES;
+				DxDebug::ThrowIfFailed(m_device->CreateHeap(&heap_desc, IID_PPV_ARGS(texture.packed_heap.GetAddressOf())));
+
+				D3D12_TILED_RESOURCE_COORDINATE coordinate{0, 0, 0, packed_mip_info.NumStandardMips};
+				D3D12_TILE_REGION_SIZE region{packed_mip_info.NumTilesForPackedMips, false, 0, 0, 0};
+				UINT heap_offset = 0;
+				UINT tile_count = packed_mip_info.NumTilesForPackedMips;
+				D3D12_TILE_RANGE_FLAGS flags = D3D12_TILE_RANGE_FLAG_NONE;
+				m_queue->UpdateTileMappings(texture.resource.Get(), 1, &coordinate, &region, texture.packed_heap.Get(), 1, &flags, &heap_offset, &tile_count, D3D12_TILE_MAPPING_FLAG_NONE);
+
+				for (uint32_t mip = packed_mip_info.NumStandardMips; mip < texture.header.mip_count; ++mip)
+				{
+					UploadPackedMip(texture, mip, command_list, upload_allocator);
+				}
+			}
+			Transition(command_list, texture.resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, m_shader_resource_state);
+
+			m_textures.push_back(std::move(texture));
+			return index;
+		}
+
+		ResidencyPolicy& Policy() { return m_policy; }
+
+		// ȡɫдÿСmip0xffffffffʾ֡ûв
+		void ReadMipFeedback(const uint32_t* min_mips, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count && i < m_policy.TextureCount(); ++i)
+			{
+				if (min_mips[i] != 0xffffffffu)
+				{
+					m_policy.RequestMip(i, std::min(min_mips[i], m_textures[i].packed_mip_first));
+				}
+			}
+		}
+
+		// ÿ֡ãѯԤ㡢󡢸Ƭӳ䲢ϴƬ
+		void Update(ID3D12GraphicsCommandList* command_list, BufferHelper::LinearConstantAllocator& upload_allocator, uint64_t completed_fence_value, uint64_t fence_value)
+		{
+			ReleaseFreedSlots(completed_fence_value);
+			m_budget_bytes = StreamingBudget(m_adapter.Get(), m_policy.ResidentTiles() * m_tile_size_in_bytes);
+			const ResidencyUpdate& update = m_policy.Update(m_budget_bytes);
+
+			// ̭Ƭӳ䵽գѲλȴGPUٸ
+			for (const TileCoordinate& tile : update.evictions)
+			{
+				Texture& texture = m_textures[tile.texture];
+				D3D12_TILED_RESOURCE_COORDINATE coordinate{tile.x, tile.y, 0, tile.mip};
+				D3D12_TILE_REGION_SIZE region{1, false, 0, 0, 0};
+				D3D12_TILE_RANGE_FLAGS flags = D3D12_TILE_RANGE_FLAG_NULL;
+				m_queue->UpdateTileMappings(texture.resource.Get(), 1, &coordinate, &region, nullptr, 1, &flags, nullptr, nullptr, D3D12_TILE_MAPPING_FLAG_NONE);
+
+				auto it = texture.slots.find(TileKey(tile));
+				m_freed_slots.push_back({it->second, fence_value});
+				texture.slots.erase(it);
+			}
+
+			// ƬתĿ״̬
+			std::vector<uint32_t>& written_textures = m_written_textures;
+			written_textures.clear();
+			for (const TileCoordinate& tile : update.loads)
+			{
+				if (std::find(written_textures.begin(), written_textures.end(), tile.texture) == written_textures.end())
+				{
+					written_textures.push_back(tile.texture);
+					Transition(command_list, m_textures[tile.texture].resource.Get(), m_shader_resource_state, D3D12_RESOURCE_STATE_COPY_DEST);
+				}
+			}
+
+			for (const TileCoordinate& tile : update.loads)
+			{
+				Texture& texture = m_textures[tile.texture];
+				HeapSlot slot = AllocateSlot();
+				texture.slots[TileKey(tile)] = slot;
+
+				D3D12_TILED_RESOURCE_COORDINATE coordinate{tile.x, tile.y, 0, tile.mip};
+				D3D12_TILE_REGION_SIZE region{1, false, 0, 0, 0};
+				D3D12_TILE_RANGE_FLAGS flags = D3D12_TILE_RANGE_FLAG_NONE;
+				UINT tile_count = 1;
+				m_queue->UpdateTileMappings(texture.resource.Get(), 1, &coordinate, &region, m_heaps[slot.heap].Get(), 1, &flags, &slot.offset, &tile_count, D3D12_TILE_MAPPING_FLAG_NONE);
+
+				// еıԵƬǽմ洢ģƬоչ64KBƬ
+				BufferHelper::ConstantAllocation staging = upload_allocator.Allocate(m_tile_size_in_bytes + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+				uint64_t aligned_gpu = (staging.gpu_address + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~uint64_t(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+				uint8_t* aligned_cpu = static_cast<uint8_t*>(staging.cpu_address) + (aligned_gpu - staging.gpu_address);
+				CopyTileData(texture, tile, aligned_cpu);
+
+				command_list->CopyTiles(texture.resource.Get(), &coordinate, &region, staging.resource, staging.offset + (aligned_gpu - staging.gpu_address), D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE);
+			}
+
+			for (uint32_t texture_index : written_textures)
+			{
+				Transition(command_list, m_textures[texture_index].resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, m_shader_resource_state);
+			}
+		}
+
+		ID3D12Resource* Resource(uint32_t texture_index) const { return m_textures[texture_index].resource.Get(); }
+		uint64_t BudgetBytes() const { return m_budget_bytes; }
+
+	private:
+		struct HeapSlot
+		{
+			uint32_t heap;
+			UINT offset;
+		};
+
+		struct FreedSlot
+		{
+			HeapSlot slot;
+			uint64_t fence_value;
+		};
+
+		struct Texture
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			Microsoft::WRL::ComPtr<ID3D12Heap> packed_heap;
+			const uint8_t* file_data;
+			TextureHelper::TextureFileHeader header;
+			std::vector<TextureHelper::TextureMipEntry> mips;
+			uint32_t packed_mip_first;
+			// ϣڵӶط䣬ͰƬȶ
+			std::unordered_map<uint64_t, HeapSlot, std::hash<uint64_t>, std::equal_to<uint64_t>, MemoryHelper::PoolAllocator<std::pair<const uint64_t, HeapSlot>>> slots;
+		};
+
+		static void Transition(ID3D12GraphicsCommandList* command_list, ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+		{
+			D3D12_RESOURCE_BARRIER barrier{};
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			barrier.Transition.pResource = resource;
+			barrier.Transition.StateBefore = before;
+			barrier.Transition.StateAfter = after;
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+			command_list->ResourceBarrier(1, &barrier);
+		}
+
+		static uint64_t TileKey(const TileCoordinate& tile)
+		{
+			return (uint64_t(tile.mip) << 48) | (uint64_t(tile.y) << 24) | tile.x;
+		}
+
+		static DXGI_FORMAT BlockFormatToDxgi(TextureHelper::BlockFormat format, bool srgb)
+		{
+			switch (format)
+			{
+			case TextureHelper::BlockFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+			case TextureHelper::BlockFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+			case TextureHelper::BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+			case TextureHelper::BlockFormat::BC7: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+			}
+			return DXGI_FORMAT_UNKNOWN;
+		}
+
+		HeapSlot AllocateSlot()
+		{
+			if (m_free_slots.empty())
+			{
+				// Թ̶ƬΪλµĶ
+				D3D12_HEAP_DESC heap_desc{};
+				heap_desc.SizeInBytes = m_tiles_per_heap * m_tile_size_in_bytes;
+				heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+				heap_desc.Flags = D3D12_HEAP_FLAG_DENY_BUFFERS | D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES;
+				Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+				DxDebug::ThrowIfFailed(m_device->CreateHeap(&heap_desc, IID_PPV_ARGS(heap.GetAddressOf())));
+				m_heaps.push_back(heap);
+				for (UINT i = m_tiles_per_heap; i-- > 0;)
+				{
+					m_free_slots.push_back({static_cast<uint32_t>(m_heaps.size() - 1), i});
+				}
+			}
+			HeapSlot slot = m_free_slots.back();
+			m_free_slots.pop_back();
+			return slot;
+		}
+
+		void ReleaseFreedSlots(uint64_t completed_fence_value)
+		{
+			for (auto it = m_freed_slots.begin(); it != m_freed_slots.end();)
+			{
+				if (it->fence_value <= completed_fence_value)
+				{
+					m_free_slots.push_back(it->slot);
+					it = m_freed_slots.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		// жλƬĽݲչ1024ֽоƬ
+		void CopyTileData(const Texture& texture, const TileCoordinate& tile, uint8_t* destination)
+		{
+			const TextureHelper::TextureMipEntry& mip = texture.mips[tile.mip];
+			uint32_t block_size = TextureHelper::BlockSize(texture.header.format);
+			uint32_t blocks_x = (mip.width + 3) / 4;
+			uint32_t blocks_y = (mip.height + 3) / 4;
+			uint32_t tile_row_pitch = mip.tile_blocks_x * block_size;
+
+			uint32_t first_block_y = tile.y * mip.tile_blocks_y;
+			uint32_t rows = std::min(mip.tile_blocks_y, blocks_y - first_block_y);
+			uint32_t columns = std::min(mip.tile_blocks_x, blocks_x - tile.x * mip.tile_blocks_x);
+			// ֮ǰƬмϱƬ
+			uint64_t offset = uint64_t(first_block_y) * blocks_x * block_size + uint64_t(tile.x) * mip.tile_blocks_x * rows * block_size;
+			const uint8_t* source = texture.file_data + mip.offset + offset;
+
+			std::memset(destination, 0, m_tile_size_in_bytes);
+			for (uint32_t row = 0; row < rows; ++row)
+			{
+				std::memcpy(destination + row * tile_row_pitch, source + size_t(row) * columns * block_size, size_t(columns) * block_size);
+			}
+		}
+
+		// packed mipСһƬΪݣ256ֽоϴ
+		void UploadPackedMip(const Texture& texture, uint32_t mip_index, ID3D12GraphicsCommandList* command_list, BufferHelper::LinearConstantAllocator& upload_allocator)
+		{
+			const TextureHelper::TextureMipEntry& mip = texture.mips[mip_index];
+			uint32_t block_size = TextureHelper::BlockSize(texture.header.format);
+			uint32_t blocks_x = (mip.width + 3) / 4;
+			uint32_t blocks_y = (mip.height + 3) / 4;
+			uint32_t row_pitch = (blocks_x * block_size + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+
+			BufferHelper::ConstantAllocation staging = upload_allocator.Allocate(size_t(row_pitch) * blocks_y + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			uint64_t aligned_gpu = (staging.gpu_address + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~uint64_t(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+			uint8_t* aligned_cpu = static_cast<uint8_t*>(staging.cpu_address) + (aligned_gpu - staging.gpu_address);
+			for (uint32_t row = 0; row < blocks_y; ++row)
+			{
+				std::memcpy(aligned_cpu + size_t(row) * row_pitch, texture.file_data + mip.offset + size_t(row) * blocks_x * block_size, size_t(blocks_x) * block_size);
+			}
+
+			D3D12_TEXTURE_COPY_LOCATION source{};
+			source.pResource = staging.resource;
+			source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+			source.PlacedFootprint.Offset = staging.offset + (aligned_gpu - staging.gpu_address);
+			source.PlacedFootprint.Footprint = {BlockFormatToDxgi(texture.header.format, texture.header.srgb != 0), blocks_x * 4, blocks_y * 4, 1, row_pitch};
+			D3D12_TEXTURE_COPY_LOCATION destination{};
+			destination.pResource = texture.resource.Get();
+			destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			destination.SubresourceIndex = mip_index;
+			command_list->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+		}
+
+		Microsoft::WRL::ComPtr<ID3D12Device10> m_device;
+		Microsoft::WRL::ComPtr<IDXGIAdapter3> m_adapter;
+		Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_queue;
+		uint32_t m_tiles_per_heap = 64;
+		uint64_t m_budget_bytes = 0;
+		// ڲʱֵ״̬
+		const D3D12_RESOURCE_STATES m_shader_resource_state = D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE;
+
+		ResidencyPolicy m_policy;
+		std::vector<Texture> m_textures;
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> m_heaps;
+		std::vector<HeapSlot> m_free_slots;
+		std::vector<FreedSlot> m_freed_slots;
+		std::vector<uint32_t> m_written_textures;
+	};
+}
+#endif
@@ -0,0 +1,689 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define SCENE_HELPER_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define SCENE_HELPER_PREFETCH(address) ((void)0)
+#endif
+
+namespace SceneHelper
+{
+	// ---------------------------------------------------------------
+	// ݣDirectXMathԼУֱӵXMFLOAT4X4ȡ
+	// ---------------------------------------------------------------
+
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	struct Quaternion
+	{
+		float x, y, z, w;
+	};
+
+	struct LocalTransform
+	{
+		Float3 position;
+		float scale;
+		Quaternion rotation;
+	};
+
+	struct WorldMatrix
+	{
+		float m[4][4];
+	};
+
+	// ʵʵе㼶ϵ¼ʵ
+	struct Parent
+	{
+		uint32_t index;
+	};
+
+	struct MeshInstance
+	{
+		uint32_t mesh_id;
+		float color[4];
+	};
+
+	// ת
+	struct Spin
+	{
+		Float3 axis;
+		float radians_per_second;
+	};
+
+	// ռеĴذΧкͿռĶ
+	struct SpatialProxy
+	{
+		Float3 local_min;
+		Float3 local_max;
+		uint32_t object;
+	};
+
+	// LODź͵ǰѡеļ𣬼гͣҪ֡
+	struct MeshLod
+	{
+		uint32_t chain;
+		uint32_t level;
+	};
+
+	using ComponentMask = uint32_t;
+
+	template <typename T> struct ComponentTraits;
+	template <> struct ComponentTraits<LocalTransform> { static const uint32_t id = 0; };
+	template <> struct ComponentTraits<WorldMatrix> { static const uint32_t id = 1; };
+	template <> struct ComponentTraits<Parent> { static const uint32_t id = 2; };
+	template <> struct ComponentTraits<MeshInstance> { static const uint32_t id = 3; };
+	template <> struct ComponentTraits<Spin> { static const uint32_t id = 4; };
+	template <> struct ComponentTraits<SpatialProxy> { static const uint32_t id = 5; };
+	template <> struct ComponentTraits<MeshLod> { static const uint32_t id = 6; };
+	static const uint32_t m_component_type_count = 7;
+
+	inline const uint32_t* ComponentSizes()
+	{
+		static const uint32_t sizes[m_component_type_count] = {
+			sizeof(LocalTransform), sizeof(WorldMatrix), sizeof(Parent), sizeof(MeshInstance), sizeof(Spin), sizeof(SpatialProxy), sizeof(MeshLod)};
+		return sizes;
+	}
+
+	template <typename... Components>
+	constexpr ComponentMask MaskOf()
+	{
+		return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentTraits<Components>::id));
+	}
+
+	// ʵʵٺɾԶʧЧ
+	struct EntityHandle
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != UINT32_MAX; }
+		bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+	};
+
+	// ---------------------------------------------------------------
+	// 任ѧ
+	// ---------------------------------------------------------------
+
+	inline Quaternion QuaternionFromAxisAngle(Float3 axis, float radians)
+	{
+		float length = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+		float s = std::sin(radians * 0.5f) / (length > 0.0f ? length : 1.0f);
+		return {axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f)};
+	}
+
+	// ӦaӦb
+	inline Quaternion QuaternionConcat(const Quaternion& a, const Quaternion& b)
+	{
+		return {
+			b.w * a.x + b.x * a.w + b.y * a.z - b.z * a.y,
+			b.w * a.y - b.x * a.z + b.y * a.w + b.z * a.x,
+			b.w * a.z + b.x * a.y - b.y * a.x + b.z * a.w,
+			b.w * a.w - b.x * a.x - b.y * a.y - b.z * a.z};
+	}
+
+	// šתƽϳ
+	inline void ComposeMatrix(const LocalTransform& local, WorldMatrix& out)
+	{
+		const Quaternion& q = local.rotation;
+		float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		float s = local.scale;
+		out.m[0][0] = (1.0f - 2.0f * (yy + zz)) * s; out.m[0][1] = 2.0f * (xy + wz) * s; out.m[0][2] = 2.0f * (xz - wy) * s; out.m[0][3] = 0.0f;
+		out.m[1][0] = 2.0f * (xy - wz) * s; out.m[1][1] = (1.0f - 2.0f * (xx + zz)) * s; out.m[1][2] = 2.0f * (yz + wx) * s; out.m[1][3] = 0.0f;
+		out.m[2][0] = 2.0f * (xz + wy) * s; out.m[2][1] = 2.0f * (yz - wx) * s; out.m[2][2] = (1.0f - 2.0f * (xx + yy)) * s; out.m[2][3] = 0.0f;
+		out.m[3][0] = local.position.x; out.m[3][1] = local.position.y; out.m[3][2] = local.position.z; out.m[3][3] = 1.0f;
+	}
+
+	inline void MultiplyMatrix(const WorldMatrix& a, const WorldMatrix& b, WorldMatrix& out)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			float a0 = a.m[row][0], a1 = a.m[row][1], a2 = a.m[row][2], a3 = a.m[row][3];
+			for (int column = 0; column < 4; ++column)
+			{
+				out.m[row][column] = a0 * b.m[0][column] + a1 * b.m[1][column] + a2 * b.m[2][column] + a3 * b.m[3][column];
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------
+	// ԭͿ飺ͬһϺͲ㼶ȵʵڹ̶СĿÿһ
+	// ---------------------------------------------------------------
+
+	static const size_t m_chunk_bytes = 16 * 1024;
+
+	struct alignas(64) ChunkStorage
+	{
+		uint8_t bytes[m_chunk_bytes];
+	};
+
+	struct Chunk
+	{
+		std::unique_ptr<ChunkStorage> storage;
+		uint32_t count = 0;
+	};
+
+	// ֻϵͳб
+	struct ChunkView
+	{
+		uint32_t count;
+		uint32_t depth;
+		uint8_t* base;
+		const uint32_t* offsets;
+		const EntityHandle* handles;
+		// д뱾ر任Ҫ
+		uint8_t* dirty;
+		// һʱİ汾SceneStore::TransformVersion()ʾָո
+		const uint32_t* versions;
+
+		template <typename T>
+		T* Column() const
+		{
+			return reinterpret_cast<T*>(base + offsets[ComponentTraits<T>::id]);
+		}
+	};
+
+	class SceneStore
+	{
+	public:
+		// ʵ壬ʼΪ㣬ر任Ϊλ任ָʵʱԶParent
+		EntityHandle Create(ComponentMask mask, EntityHandle parent = {})
+		{
+			uint32_t index;
+			if (!m_free_indices.empty())
+			{
+				index = m_free_indices.back();
+				m_free_indices.pop_back();
+			}
+			else
+			{
+				index = static_cast<uint32_t>(m_records.size());
+				m_records.emplace_back();
+			}
+
+			EntityRecord& record = m_records[index];
+			record.alive = true;
+			record.parent = UINT32_MAX;
+			record.first_child = UINT32_MAX;
+			record.next_sibling = UINT32_MAX;
+			EntityHandle handle{index, record.generation};
+
+			uint32_t depth = 0;
+			if (IsAlive(parent))
+			{
+				mask |= MaskOf<Parent>();
+				depth = m_archetypes[m_records[parent.index].archetype].depth + 1;
+				LinkChild(parent.index, index);
+			}
+			else
+			{
+				mask &= ~MaskOf<Parent>();
+			}
+
+			uint32_t archetype = FindOrCreateArchetype(mask, depth);
+			AllocateRow(archetype, index);
+			InitialRow(record);
+			if (record.parent != UINT32_MAX)
+			{
+				Get<Parent>(handle)->index = record.parent;
+			}
+			++m_alive_count;
+			return handle;
+		}
+
+		// ʵ弰ȫ
+		void Destroy(EntityHandle handle)
+		{
+			if (!IsAlive(handle)) return;
+			EntityRecord& record = m_records[handle.index];
+			while (record.first_child != UINT32_MAX)
+			{
+				uint32_t child = record.first_child;
+				Destroy({child, m_records[child].generation});
+			}
+			if (record.parent != UINT32_MAX)
+			{
+				UnlinkChild(record.parent, handle.index);
+			}
+			RemoveRow(record.archetype, record.chunk, record.row);
+			record.alive = false;
+			++record.generation;
+			m_free_indices.push_back(handle.index);
+			--m_alive_count;
+		}
+
+		bool IsAlive(EntityHandle handle) const
+		{
+			return handle.index < m_records.size() && m_records[handle.index].alive && m_records[handle.index].generation == handle.generation;
+		}
+
+		// ȡָ룬ʵ岻ڻûиʱؿ
+		template <typename T>
+		T* Get(EntityHandle handle)
+		{
+			if (!IsAlive(handle)) return nullptr;
+			const EntityRecord& record = m_records[handle.index];
+			const Archetype& archetype = m_archetypes[record.archetype];
+			if ((archetype.mask & MaskOf<T>()) == 0) return nullptr;
+			return reinterpret_cast<T*>(archetype.chunks[record.chunk].storage->bytes + archetype.offsets[ComponentTraits<T>::id]) + record.row;
+		}
+
+		// ޸ıر任࣬´UpdateTransformsʱ
+		void SetLocalTransform(EntityHandle handle, const LocalTransform& local)
+		{
+			LocalTransform* target = Get<LocalTransform>(handle);
+			if (!target) return;
+			*target = local;
+			const EntityRecord& record = m_records[handle.index];
+			const Archetype& archetype = m_archetypes[record.archetype];
+			DirtyColumn(archetype, archetype.chunks[record.chunk])[record.row] = 1;
+		}
+
+		// ʵ壬ʵﰴµĲ㼶ǨƵӦԭ
+		void SetParent(EntityHandle handle, EntityHandle parent)
+		{
+			if (!IsAlive(handle) || handle == parent) return;
+			// ʵҵԼ
+			for (uint32_t ancestor = IsAlive(parent) ? parent.index : UINT32_MAX; ancestor != UINT32_MAX; ancestor = m_records[ancestor].parent)
+			{
+				if (ancestor == handle.index) return;
+			}
+
+			EntityRecord& record = m_records[handle.index];
+			if (record.parent != UINT32_MAX)
+			{
+				UnlinkChild(record.parent, handle.index);
+			}
+			ComponentMask mask = m_archetypes[record.archetype].mask & ~MaskOf<Parent>();
+			uint32_t depth = 0;
+			if (IsAlive(parent))
+			{
+				LinkChild(parent.index, handle.index);
+				mask |= MaskOf<Parent>();
+				depth = m_archetypes[m_records[parent.index].archetype].depth + 1;
+			}
+			MoveSubtree(handle.index, mask, depth);
+		}
+
+		EntityHandle ParentOf(EntityHandle handle) const
+		{
+			if (!IsAlive(handle) || m_records[handle.index].parent == UINT32_MAX) return {};
+			uint32_t parent = m_records[handle.index].parent;
+			return {parent, m_records[parent].generation};
+		}
+
+		// ָп
+		template <typename... Components, typename Function>
+		void ForEachChunk(Function&& function)
+		{
+			const ComponentMask required = MaskOf<Components...>();
+			for (Archetype& archetype : m_archetypes)
+			{
+				if ((archetype.mask & required) != required) continue;
+				for (Chunk& chunk : archetype.chunks)
+				{
+					ChunkView view = MakeView(archetype, chunk);
+					function(view);
+				}
+			}
+		}
+
+		// 㼶ȴǳֻ򸸾ڱָ¹ʵ¼
+		// ¼ʵ
+		size_t UpdateTransforms()
+		{
+			++m_transform_version;
+			size_t updated = 0;
+			for (uint32_t archetype_index : m_transform_order)
+			{
+				Archetype& archetype = m_archetypes[archetype_index];
+				bool has_parent = (archetype.mask & MaskOf<Parent>()) != 0;
+				for (Chunk& chunk : archetype.chunks)
+				{
+					ChunkView view = MakeView(archetype, chunk);
+					const LocalTransform* locals = view.Column<LocalTransform>();
+					WorldMatrix* worlds = view.Column<WorldMatrix>();
+					uint32_t* versions = VersionColumn(archetype, chunk);
+					if (!has_parent)
+					{
+						for (uint32_t row = 0; row < view.count; ++row)
+						{
+							if (!view.dirty[row]) continue;
+							ComposeMatrix(locals[row], worlds[row]);
+							view.dirty[row] = 0;
+							versions[row] = m_transform_version;
+							++updated;
+						}
+						continue;
+					}
+
+					const Parent* parents = view.Column<Parent>();
+					const uint32_t prefetch_distance = 8;
+					for (uint32_t row = 0; row < view.count; ++row)
+					{
+						// ʵλҪʵӲңǰԤȡ漸еı
+						if (row + prefetch_distance < view.count)
+						{
+							SCENE_HELPER_PREFETCH(&m_records[parents[row + prefetch_distance].index]);
+						}
+						const EntityRecord& parent_record = m_records[parents[row].index];
+						const Archetype& parent_archetype = m_archetypes[parent_record.archetype];
+						const Chunk& parent_chunk = parent_archetype.chunks[parent_record.chunk];
+						bool parent_changed = VersionColumn(parent_archetype, parent_chunk)[parent_record.row] == m_transform_version;
+						if (!view.dirty[row] && !parent_changed) continue;
+
+						// ûĸʵ嵱λ任
+						if (parent_archetype.mask & MaskOf<WorldMatrix>())
+						{
+							const WorldMatrix& parent_world = reinterpret_cast<const WorldMatrix*>(parent_chunk.storage->bytes + parent_archetype.offsets[ComponentTraits<WorldMatrix>::id])[parent_record.row];
+							WorldMatrix local_matrix;
+							ComposeMatrix(locals[row], local_matrix);
+							MultiplyMatrix(local_matrix, parent_world, worlds[row]);
+						}
+						else
+						{
+							ComposeMatrix(locals[row], worlds[row]);
+						}
+						view.dirty[row] = 0;
+						versions[row] = m_transform_version;
+						++updated;
+					}
+				}
+			}
+			return updated;
+		}
+
+		uint32_t TransformVersion() const { return m_transform_version; }
+		size_t Count() const { return m_alive_count; }
+		size_t ArchetypeCount() const { return m_archetypes.size(); }
+
+		size_t ChunkCount() const
+		{
+			size_t count = 0;
+			for (const Archetype& archetype : m_archetypes) count += archetype.chunks.size();
+			return count;
+		}
+
+	private:
+		// ʵʵԭͿеλãԼ㼶
+		struct EntityRecord
+		{
+			uint32_t generation = 0;
+			uint32_t archetype = 0;
+			uint32_t chunk = 0;
+			uint32_t row = 0;
+			uint32_t parent = UINT32_MAX;
+			uint32_t first_child = UINT32_MAX;
+			uint32_t next_sibling = UINT32_MAX;
+			bool alive = false;
+		};
+
+		// ⣬ÿ黹оǺ汾
+		static const uint32_t m_handle_column = m_component_type_count;
+		static const uint32_t m_dirty_column = m_component_type_count + 1;
+		static const uint32_t m_version_column = m_component_type_count + 2;
+		static const uint32_t m_column_count = m_component_type_count + 3;
+
+		struct Archetype
+		{
+			ComponentMask mask = 0;
+			uint32_t depth = 0;
+			uint32_t capacity = 0;
+			uint32_t offsets[m_column_count]{};
+			std::vector<Chunk> chunks;
+		};
+
+		static uint64_t ArchetypeKey(ComponentMask mask, uint32_t depth)
+		{
+			return (uint64_t(depth) << 32) | mask;
+		}
+
+		static const EntityHandle* HandleColumn(const Archetype& archetype, const Chunk& chunk)
+		{
+			return reinterpret_cast<const EntityHandle*>(chunk.storage->bytes + archetype.offsets[m_handle_column]);
+		}
+
+		static uint8_t* DirtyColumn(const Archetype& archetype, const Chunk& chunk)
+		{
+			return chunk.storage->bytes + archetype.offsets[m_dirty_column];
+		}
+
+		static uint32_t* VersionColumn(const Archetype& archetype, const Chunk& chunk)
+		{
+			return reinterpret_cast<uint32_t*>(chunk.storage->bytes + archetype.offsets[m_version_column]);
+		}
+
+		static ChunkView MakeView(const Archetype& archetype, const Chunk& chunk)
+		{
+			return {chunk.count, archetype.depth, chunk.storage->bytes, archetype.offsets, HandleColumn(archetype, chunk), DirtyColumn(archetype, chunk), VersionColumn(archetype, chunk)};
+		}
+
+		uint32_t FindOrCreateArchetype(ComponentMask mask, uint32_t depth)
+		{
+			uint64_t key = ArchetypeKey(mask, depth);
+			auto found = m_archetype_lookup.find(key);
+			if (found != m_archetype_lookup.end()) return found->second;
+
+			Archetype archetype;
+			archetype.mask = mask;
+			archetype.depth = depth;
+			uint32_t column_sizes[m_column_count]{};
+			const uint32_t* sizes = ComponentSizes();
+			uint32_t row_bytes = 0, column_count = 0;
+			for (uint32_t component = 0; component < m_component_type_count; ++component)
+			{
+				if (mask & (ComponentMask(1) << component)) column_sizes[component] = sizes[component];
+			}
+			column_sizes[m_handle_column] = sizeof(EntityHandle);
+			column_sizes[m_dirty_column] = sizeof(uint8_t);
+			column_sizes[m_version_column] = sizeof(uint32_t);
+			for (uint32_t column = 0; column < m_column_count; ++column)
+			{
+				row_bytes += column_sizes[column];
+				column_count += column_sizes[column] ? 1 : 0;
+			}
+			// ÿʼַж룬۳ĺ
+			archetype.capacity = static_cast<uint32_t>((m_chunk_bytes - 64 * column_count) / row_bytes);
+			uint32_t offset = 0;
+			for (uint32_t column = 0; column < m_column_count; ++column)
+			{
+				if (!column_sizes[column]) continue;
+				archetype.offsets[column] = offset;
+				offset = (offset + column_sizes[column] * archetype.capacity + 63) & ~63u;
+			}
+
+			uint32_t index = static_cast<uint32_t>(m_archetypes.size());
+			m_archetypes.push_back(std::move(archetype));
+			m_archetype_lookup.emplace(key, index);
+			// Ҫ±任ԭͰ򣬱֤Ӿ
+			const ComponentMask transform_mask = MaskOf<LocalTransform, WorldMatrix>();
+			if ((mask & transform_mask) == transform_mask)
+			{
+				m_transform_order.push_back(index);
+				std::stable_sort(m_transform_order.begin(), m_transform_order.end(), [this](uint32_t a, uint32_t b)
+					{
+						return m_archetypes[a].depth < m_archetypes[b].depth;
+					});
+			}
+			return index;
+		}
+
+		// ԭһĩβ׷һ
+		void AllocateRow(uint32_t archetype_index, uint32_t entity_index)
+		{
+			Archetype& archetype = m_archetypes[archetype_index];
+			if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+			{
+				archetype.chunks.emplace_back();
+				archetype.chunks.back().storage = std::make_unique<ChunkStorage>();
+			}
+			Chunk& chunk = archetype.chunks.back();
+			EntityRecord& record = m_records[entity_index];
+			record.archetype = archetype_index;
+			record.chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+			record.row = chunk.count++;
+			const_cast<EntityHandle*>(HandleColumn(archetype, chunk))[record.row] = {entity_index, record.generation};
+			DirtyColumn(archetype, chunk)[record.row] = 1;
+			VersionColumn(archetype, chunk)[record.row] = 0;
+		}
+
+		void InitialRow(const EntityRecord& record)
+		{
+			Archetype& archetype = m_archetypes[record.archetype];
+			Chunk& chunk = archetype.chunks[record.chunk];
+			const uint32_t* sizes = ComponentSizes();
+			for (uint32_t component = 0; component < m_component_type_count; ++component)
+			{
+				if (archetype.mask & (ComponentMask(1) << component))
+				{
+					std::memset(chunk.storage->bytes + archetype.offsets[component] + size_t(sizes[component]) * record.row, 0, sizes[component]);
+				}
+			}
+			if (archetype.mask & MaskOf<LocalTransform>())
+			{
+				reinterpret_cast<LocalTransform*>(chunk.storage->bytes + archetype.offsets[ComponentTraits<LocalTransform>::id])[record.row] = {{0.0f, 0.0f, 0.0f}, 1.0f, {0.0f, 0.0f, 0.0f, 1.0f}};
+			}
+		}
+
+		// һһնп
+		void RemoveRow(uint32_t archetype_index, uint32_t chunk_index, uint32_t row)
+		{
+			Archetype& archetype = m_archetypes[archetype_index];
+			Chunk& last_chunk = archetype.chunks.back();
+			uint32_t last_row = last_chunk.count - 1;
+			Chunk& chunk = archetype.chunks[chunk_index];
+			if (&chunk != &last_chunk || row != last_row)
+			{
+				for (uint32_t column = 0; column < m_column_count; ++column)
+				{
+					uint32_t size = ColumnSize(archetype, column);
+					if (!size) continue;
+					std::memcpy(chunk.storage->bytes + archetype.offsets[column] + size_t(size) * row,
+						last_chunk.storage->bytes + archetype.offsets[column] + size_t(size) * last_row, size);
+				}
+				EntityRecord& moved = m_records[HandleColumn(archetype, chunk)[row].index];
+				moved.chunk = chunk_index;
+				moved.row = row;
+			}
+			if (--last_chunk.count == 0)
+			{
+				archetype.chunks.pop_back();
+			}
+		}
+
+		uint32_t ColumnSize(const Archetype& archetype, uint32_t column) const
+		{
+			if (column < m_component_type_count)
+			{
+				return (archetype.mask & (ComponentMask(1) << column)) ? ComponentSizes()[column] : 0;
+			}
+			if (column == m_handle_column) return sizeof(EntityHandle);
+			if (column == m_dirty_column) return sizeof(uint8_t);
+			return sizeof(uint32_t);
+		}
+
+		// ʵǨƵµԭͣ߹е
+		void MoveEntity(uint32_t entity_index, ComponentMask mask, uint32_t depth)
+		{
+			EntityRecord& record = m_records[entity_index];
+			uint32_t old_archetype = record.archetype, old_chunk = record.chunk, old_row = record.row;
+			uint32_t new_archetype = FindOrCreateArchetype(mask, depth);
+			if (new_archetype == old_archetype) return;
+
+			AllocateRow(new_archetype, entity_index);
+			InitialRow(record);
+			const Archetype& source = m_archetypes[old_archetype];
+			const Archetype& target = m_archetypes[new_archetype];
+			const uint32_t* sizes = ComponentSizes();
+			for (uint32_t component = 0; component < m_component_type_count; ++component)
+			{
+				ComponentMask bit = ComponentMask(1) << component;
+				if ((source.mask & bit) && (target.mask & bit))
+				{
+					std::memcpy(target.chunks[record.chunk].storage->bytes + target.offsets[component] + size_t(sizes[component]) * record.row,
+						source.chunks[old_chunk].storage->bytes + source.offsets[component] + size_t(sizes[component]) * old_row, sizes[component]);
+				}
+			}
+			RemoveRow(old_archetype, old_chunk, old_row);
+		}
+
+		void MoveSubtree(uint32_t entity_index, ComponentMask mask, uint32_t depth)
+		{
+			MoveEntity(entity_index, mask, depth);
+			EntityRecord& record = m_records[entity_index];
+			EntityHandle handle{entity_index, record.generation};
+			if (Parent* parent = Get<Parent>(handle))
+			{
+				parent->index = record.parent;
+			}
+			// ӹϵ仯
+			DirtyColumn(m_archetypes[record.archetype], m_archetypes[record.archetype].chunks[record.chunk])[record.row] = 1;
+			for (uint32_t child = record.first_child; child != UINT32_MAX; child = m_records[child].next_sibling)
+			{
+				MoveSubtree(child, m_archetypes[m_records[child].archetype].mask, depth + 1);
+			}
+		}
+
+		void LinkChild(uint32_t parent, uint32_t child)
+		{
+			m_records[child].parent = parent;
+			m_records[child].next_sibling = m_records[parent].first_child;
+			m_records[parent].first_child = child;
+		}
+
+		void UnlinkChild(uint32_t parent, uint32_t child)
+		{
+			uint32_t* link = &m_records[parent].first_child;
+			while (*link != UINT32_MAX && *link != child)
+			{
+				link = &m_records[*link].next_sibling;
+			}
+			if (*link == child)
+			{
+				*link = m_records[child].next_sibling;
+			}
+			m_records[child].parent = UINT32_MAX;
+			m_records[child].next_sibling = UINT32_MAX;
+		}
+
+		std::vector<EntityRecord> m_records;
+		std::vector<uint32_t> m_free_indices;
+		std::vector<Archetype> m_archetypes;
+		std::unordered_map<uint64_t, uint32_t> m_archetype_lookup;
+		std::vector<uint32_t> m_transform_order;
+		uint32_t m_transform_version = 0;
+		size_t m_alive_count = 0;
+	};
+
+	// תϵͳԱת
+	inline void UpdateSpin(SceneStore& scene, float delta_seconds)
+	{
+		scene.ForEachChunk<LocalTransform, Spin>([delta_seconds](ChunkView& view)
+			{
+				LocalTransform* locals = view.Column<LocalTransform>();
+				const Spin* spins = view.Column<Spin>();
+				for (uint32_t row = 0; row < view.count; ++row)
+				{
+					if (spins[row].radians_per_second == 0.0f) continue;
+					Quaternion delta = QuaternionFromAxisAngle(spins[row].axis, spins[row].radians_per_second * delta_seconds);
+					Quaternion rotation = QuaternionConcat(locals[row].rotation, delta);
+					float inv_length = 1.0f / std::sqrt(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z + rotation.w * rotation.w);
+					locals[row].rotation = {rotation.x * inv_length, rotation.y * inv_length, rotation.z * inv_length, rotation.w * inv_length};
+					view.dirty[row] = 1;
+				}
+			});
+	}
+}
@@ -0,0 +1,345 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ShaderHelper
+{
+	// ɫ鵵ʽļͷ + Ѱַ + ȥغֽ + ֽ
+	// ƫƶļͷӳֱʹãҪл
+	struct ArchiveHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t bucket_count;
+		uint32_t permutation_count;
+		uint32_t blob_count;
+		uint32_t reserved;
+		uint64_t buckets_offset;
+		uint64_t blobs_offset;
+	};
+
+	// Ϊ0ĲλΪ
+	struct ArchiveBucket
+	{
+		uint64_t key;
+		uint32_t blob;
+		uint32_t reserved;
+	};
+
+	struct ArchiveBlob
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint64_t content_hash;
+	};
+
+	static const char m_archive_magic[4] = {'D', 'X', 'S', 'A'};
+	static const uint32_t m_archive_version = 1;
+	// ֽ밴16ֽڶ
+	static const uint64_t m_blob_alignment = 16;
+
+	// FNV-1a 64λϣмֽȥغϣ
+	inline uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	inline uint64_t Fnv1a(const std::string& text, uint64_t hash = 14695981039346656037ull)
+	{
+		return Fnv1a(text.data(), text.size(), hash);
+	}
+
+	struct ShaderDefine
+	{
+		std::string name;
+		std::string value;
+	};
+
+	// еĹ淶ɫϰĶ壬 VertexShader|INSTANCING=1
+	inline std::string PermutationName(const std::string& shader, std::vector<ShaderDefine> defines)
+	{
+		std::sort(defines.begin(), defines.end(), [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+		std::string name = shader;
+		for (const ShaderDefine& define : defines)
+		{
+			name += '|';
+			name += define.name;
+			name += '=';
+			name += define.value;
+		}
+		return name;
+	}
+
+	// мǹ淶Ĺϣ0ղλ
+	inline uint64_t PermutationKey(const std::string& shader, const std::vector<ShaderDefine>& defines = {})
+	{
+		uint64_t key = Fnv1a(PermutationName(shader, defines));
+		return key ? key : 1;
+	}
+
+	// ڴװ鵵дļֱӳʹ
+	class ArchiveWriter
+	{
+	public:
+		// ֻֽͬһݣֽ
+		uint32_t AddBlob(const std::vector<uint8_t>& bytecode)
+		{
+			uint64_t content_hash = Fnv1a(bytecode.data(), bytecode.size());
+			auto range = m_blob_index.equal_range(content_hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (m_blobs[it->second] == bytecode) return it->second;
+			}
+			uint32_t blob = static_cast<uint32_t>(m_blobs.size());
+			m_blobs.push_back(bytecode);
+			m_blob_hashes.push_back(content_hash);
+			m_blob_index.emplace(content_hash, blob);
+			m_blob_bytes += bytecode.size();
+			return blob;
+		}
+
+		// ͬһǼʱfalse˵Ĺϣͻ
+		bool AddPermutation(uint64_t key, uint32_t blob)
+		{
+			if (!m_permutation_keys.emplace(key, blob).second) return false;
+			m_permutations.push_back({key, blob});
+			return true;
+		}
+
+		// дʱļ滻еĳӳľɹ鵵Ӱ
+		bool Write(const std::filesystem::path& path) const
+		{
+			// װʲһ룬֤̽ܶ
+			uint32_t bucket_count = 1;
+			while (bucket_count < m_permutations.size() * 2) bucket_count *= 2;
+			std::vector<ArchiveBucket> buckets(bucket_count, ArchiveBucket{0, 0, 0});
+			for (const auto& permutation : m_permutations)
+			{
+				uint32_t slot = static_cast<uint32_t>(permutation.first) & (bucket_count - 1);
+				while (buckets[slot].key != 0) slot = (slot + 1) & (bucket_count - 1);
+				buckets[slot] = {permutation.first, permutation.second, 0};
+			}
+
+			ArchiveHeader header{};
+			std::memcpy(header.magic, m_archive_magic, sizeof(header.magic));
+			header.version = m_archive_version;
+			header.bucket_count = bucket_count;
+			header.permutation_count = static_cast<uint32_t>(m_permutations.size());
+			header.blob_count = static_cast<uint32_t>(m_blobs.size());
+			header.buckets_offset = sizeof(ArchiveHeader);
+			header.blobs_offset = header.buckets_offset + bucket_count * sizeof(ArchiveBucket);
+			std::vector<ArchiveBlob> blobs(m_blobs.size());
+			uint64_t offset = AlignUp(header.blobs_offset + m_blobs.size() * sizeof(ArchiveBlob), m_blob_alignment);
+			for (size_t i = 0; i < m_blobs.size(); ++i)
+			{
+				blobs[i] = {offset, m_blobs[i].size(), m_blob_hashes[i]};
+				offset = AlignUp(offset + m_blobs[i].size(), m_blob_alignment);
+			}
+
+			std::filesystem::path temporary = path;
+			temporary += ".tmp";
+			FILE* file = std::fopen(temporary.string().c_str(), "wb");
+			if (!file) return false;
+			bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+			ok = ok && std::fwrite(buckets.data(), sizeof(ArchiveBucket), buckets.size(), file) == buckets.size();
+			ok = ok && (blobs.empty() || std::fwrite(blobs.data(), sizeof(ArchiveBlob), blobs.size(), file) == blobs.size());
+			uint64_t written = header.blobs_offset + blobs.size() * sizeof(ArchiveBlob);
+			static const uint8_t padding[m_blob_alignment] = {};
+			for (size_t i = 0; ok && i < m_blobs.size(); ++i)
+			{
+				ok = std::fwrite(padding, 1, blobs[i].offset - written, file) == blobs[i].offset - written;
+				ok = ok && std::fwrite(m_blobs[i].data(), 1, m_blobs[i].size(), file) == m_blobs[i].size();
+				written = blobs[i].offset + m_blobs[i].size();
+			}
+			ok = std::fclose(file) == 0 && ok;
+			std::error_code error;
+			if (ok) std::filesystem::rename(temporary, path, error);
+			if (!ok || error)
+			{
+				std::filesystem::remove(temporary, error);
+				return false;
+			}
+			return true;
+		}
+
+		size_t PermutationCount() const { return m_permutations.size(); }
+		size_t BlobCount() const { return m_blobs.size(); }
+		uint64_t BlobBytes() const { return m_blob_bytes; }
+
+	private:
+		static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		std::vector<std::vector<uint8_t>> m_blobs;
+		std::vector<uint64_t> m_blob_hashes;
+		std::unordered_multimap<uint64_t, uint32_t> m_blob_index;
+		std::vector<std::pair<uint64_t, uint32_t>> m_permutations;
+		std::unordered_map<uint64_t, uint32_t> m_permutation_keys;
+		uint64_t m_blob_bytes = 0;
+	};
+
+	// ָӳڴֽ룬鵵رǰЧ
+	struct ShaderBytecode
+	{
+		const void* data;
+		size_t size;
+	};
+
+	// ֻӳɫ鵵мO(1)ңֽ
+	class ShaderArchive
+	{
+	public:
+		ShaderArchive() = default;
+		ShaderArchive(const ShaderArchive&) = delete;
+		ShaderArchive& operator=(const ShaderArchive&) = delete;
+		~ShaderArchive()
+		{
+			Close();
+		}
+
+		// ļڻʽʱfalse
+		bool Open(const std::filesystem::path& path)
+		{
+			Close();
+#if defined(_WIN32)
+			m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+			LARGE_INTEGER size{};
+			if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+			{
+				Close();
+				return false;
+			}
+			m_size = static_cast<size_t>(size.QuadPart);
+			m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			m_data = m_mapping ? static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			struct stat st{};
+			if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+			{
+				if (fd >= 0) close(fd);
+				return false;
+			}
+			m_size = static_cast<size_t>(st.st_size);
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			m_data = data == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(data);
+#endif
+			if (!m_data || !Validate())
+			{
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+		void Close()
+		{
+#if defined(_WIN32)
+			if (m_data) UnmapViewOfFile(m_data);
+			if (m_mapping) CloseHandle(m_mapping);
+			if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+			m_mapping = nullptr;
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+			m_data = nullptr;
+			m_size = 0;
+			m_header = nullptr;
+			m_buckets = nullptr;
+			m_blobs = nullptr;
+		}
+
+		// Ҳʱؿֽ
+		ShaderBytecode Find(uint64_t key) const
+		{
+			if (!m_header) return {nullptr, 0};
+			uint32_t mask = m_header->bucket_count - 1;
+			for (uint32_t slot = static_cast<uint32_t>(key) & mask;; slot = (slot + 1) & mask)
+			{
+				const ArchiveBucket& bucket = m_buckets[slot];
+				if (bucket.key == 0) return {nullptr, 0};
+				if (bucket.key == key)
+				{
+					const ArchiveBlob& blob = m_blobs[bucket.blob];
+					return {m_data + blob.offset, static_cast<size_t>(blob.size)};
+				}
+			}
+		}
+
+		ShaderBytecode Find(const std::string& shader, const std::vector<ShaderDefine>& defines = {}) const
+		{
+			return Find(PermutationKey(shader, defines));
+		}
+
+		bool IsOpen() const { return m_header != nullptr; }
+		uint32_t PermutationCount() const { return m_header ? m_header->permutation_count : 0; }
+		uint32_t BlobCount() const { return m_header ? m_header->blob_count : 0; }
+
+	private:
+		// ļͷƫƶļΧڣ𻵵Ĺ鵵ᵼԽȡ
+		bool Validate()
+		{
+			if (m_size < sizeof(ArchiveHeader)) return false;
+			const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(m_data);
+			if (std::memcmp(header->magic, m_archive_magic, sizeof(header->magic)) != 0 || header->version != m_archive_version) return false;
+			if (header->bucket_count == 0 || (header->bucket_count & (header->bucket_count - 1)) != 0) return false;
+			if (header->buckets_offset + static_cast<uint64_t>(header->bucket_count) * sizeof(ArchiveBucket) > m_size) return false;
+			if (header->blobs_offset + static_cast<uint64_t>(header->blob_count) * sizeof(ArchiveBlob) > m_size) return false;
+			const ArchiveBucket* buckets = reinterpret_cast<const ArchiveBucket*>(m_data + header->buckets_offset);
+			const ArchiveBlob* blobs = reinterpret_cast<const ArchiveBlob*>(m_data + header->blobs_offset);
+			// һղλҵ̽һ
+			uint32_t used_buckets = 0;
+			for (uint32_t i = 0; i < header->bucket_count; ++i)
+			{
+				if (buckets[i].key == 0) continue;
+				if (buckets[i].blob >= header->blob_count) return false;
+				++used_buckets;
+			}
+			if (used_buckets >= header->bucket_count) return false;
+			for (uint32_t i = 0; i < header->blob_count; ++i)
+			{
+				if (blobs[i].offset > m_size || blobs[i].size > m_size - blobs[i].offset) return false;
+			}
+			m_header = header;
+			m_buckets = buckets;
+			m_blobs = blobs;
+			return true;
+		}
+
+#if defined(_WIN32)
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#endif
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+		const ArchiveHeader* m_header = nullptr;
+		const ArchiveBucket* m_buckets = nullptr;
+		const ArchiveBlob* m_blobs = nullptr;
+	};
+}
@@ -0,0 +1,839 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BVH_HELPER_SSE2 1
+#endif
+
+namespace BvhHelper
+{
+	struct Aabb
+	{
+		float min[3];
+		float max[3];
+	};
+
+	inline Aabb EmptyAabb()
+	{
+		const float inf = std::numeric_limits<float>::infinity();
+		return {{inf, inf, inf}, {-inf, -inf, -inf}};
+	}
+
+	inline void Grow(Aabb& box, const Aabb& other)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			box.min[axis] = std::min(box.min[axis], other.min[axis]);
+			box.max[axis] = std::max(box.max[axis], other.max[axis]);
+		}
+	}
+
+	inline float HalfArea(const Aabb& box)
+	{
+		float dx = box.max[0] - box.min[0], dy = box.max[1] - box.min[1], dz = box.max[2] - box.min[2];
+		return dx < 0.0f ? 0.0f : dx * dy + dy * dz + dz * dx;
+	}
+
+	// 任ΧУΧ
+	inline Aabb TransformAabb(const Aabb& box, const float matrix[4][4])
+	{
+		Aabb result;
+		for (int column = 0; column < 3; ++column)
+		{
+			result.min[column] = result.max[column] = matrix[3][column];
+			for (int row = 0; row < 3; ++row)
+			{
+				float a = matrix[row][column] * box.min[row];
+				float b = matrix[row][column] * box.max[row];
+				result.min[column] += std::min(a, b);
+				result.max[column] += std::max(a, b);
+			}
+		}
+		return result;
+	}
+
+	// ƽ淽 dot(n, p) + d >= 0 Ϊڲ
+	struct Frustum
+	{
+		float planes[6][4];
+	};
+
+	// ԼͼͶӰȡ׶ƽ棬ȷΧΪ[0, 1]
+	inline Frustum FrustumFromMatrix(const float m[4][4])
+	{
+		Frustum frustum;
+		for (int i = 0; i < 4; ++i)
+		{
+			float c0 = m[i][0], c1 = m[i][1], c2 = m[i][2], c3 = m[i][3];
+			frustum.planes[0][i] = c3 + c0;
+			frustum.planes[1][i] = c3 - c0;
+			frustum.planes[2][i] = c3 + c1;
+			frustum.planes[3][i] = c3 - c1;
+			frustum.planes[4][i] = c2;
+			frustum.planes[5][i] = c3 - c2;
+		}
+		for (auto& plane : frustum.planes)
+		{
+			float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			for (float& value : plane) value /= length;
+		}
+		return frustum;
+	}
+
+	struct RayHit
+	{
+		uint32_t object = UINT32_MAX;
+		float t = std::numeric_limits<float>::infinity();
+	};
+
+	// ---------------------------------------------------------------
+	// ·ȵ㣬SSE2ʱ˻Ϊѭ
+	// ---------------------------------------------------------------
+
+#if defined(BVH_HELPER_SSE2)
+	struct Float4
+	{
+		__m128 v;
+	};
+	inline Float4 Load4(const float* p) { return {_mm_load_ps(p)}; }
+	inline Float4 Splat4(float x) { return {_mm_set1_ps(x)}; }
+	inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+	inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+	inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+	inline Float4 Min4(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+	inline Float4 Max4(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+	inline uint32_t LessEqualMask(Float4 a, Float4 b) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(a.v, b.v))); }
+	inline uint32_t LessMask(Float4 a, Float4 b) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a.v, b.v))); }
+	inline void Store4(float* p, Float4 a) { _mm_storeu_ps(p, a.v); }
+#else
+	struct Float4
+	{
+		float v[4];
+	};
+	inline Float4 Load4(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+	inline Float4 Splat4(float x) { return {{x, x, x, x}}; }
+	inline Float4 operator+(Float4 a, Float4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+	inline Float4 operator-(Float4 a, Float4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+	inline Float4 operator*(Float4 a, Float4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+	inline Float4 Min4(Float4 a, Float4 b) { return {{std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])}}; }
+	inline Float4 Max4(Float4 a, Float4 b) { return {{std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])}}; }
+	inline uint32_t LessEqualMask(Float4 a, Float4 b)
+	{
+		return (a.v[0] <= b.v[0] ? 1u : 0u) | (a.v[1] <= b.v[1] ? 2u : 0u) | (a.v[2] <= b.v[2] ? 4u : 0u) | (a.v[3] <= b.v[3] ? 8u : 0u);
+	}
+	inline uint32_t LessMask(Float4 a, Float4 b)
+	{
+		return (a.v[0] < b.v[0] ? 1u : 0u) | (a.v[1] < b.v[1] ? 2u : 0u) | (a.v[2] < b.v[2] ? 4u : 0u) | (a.v[3] < b.v[3] ? 8u : 0u);
+	}
+	inline void Store4(float* p, Float4 a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+#endif
+
+	// ---------------------------------------------------------------
+	// ĲBVHÿڵSoAʽĸӽڵİΧУһβĸ
+	// ---------------------------------------------------------------
+
+	static const uint32_t m_leaf_size = 4;
+	static const uint32_t m_invalid = UINT32_MAX;
+
+	struct alignas(64) BvhNode
+	{
+		float min_x[4], min_y[4], min_z[4];
+		float max_x[4], max_y[4], max_z[4];
+		// ڲӽڵ㣺childΪڵcountΪ0ҶӣchildΪе㣬countΪ
+		uint32_t child[4];
+		uint32_t count[4];
+		uint32_t parent;
+		uint32_t parent_slot;
+
+		void SetBounds(uint32_t slot, const Aabb& box)
+		{
+			min_x[slot] = box.min[0]; min_y[slot] = box.min[1]; min_z[slot] = box.min[2];
+			max_x[slot] = box.max[0]; max_y[slot] = box.max[1]; max_z[slot] = box.max[2];
+		}
+
+		Aabb Bounds(uint32_t slot) const
+		{
+			return {{min_x[slot], min_y[slot], min_z[slot]}, {max_x[slot], max_y[slot], max_z[slot]}};
+		}
+
+		bool IsLeaf(uint32_t slot) const { return count[slot] != 0; }
+		bool IsEmpty(uint32_t slot) const { return child[slot] == m_invalid; }
+	};
+
+	// һùɵں̨߳ж彻
+	struct BvhTree
+	{
+		std::vector<BvhNode> nodes;
+		std::vector<uint32_t> object_order;
+		// ÿڵҶӽڵҶеλãrefit
+		std::vector<uint32_t> object_node;
+		std::vector<uint32_t> object_position;
+		Aabb root_bounds = EmptyAabb();
+		float sah_cost = 0.0f;
+	};
+
+	struct BvhStats
+	{
+		uint32_t object_count = 0;
+		uint32_t node_count = 0;
+		uint32_t rebuild_count = 0;
+		uint32_t refit_nodes = 0;
+		float build_sah_cost = 0.0f;
+		float current_sah_cost = 0.0f;
+		double build_seconds = 0.0;
+		double refit_seconds = 0.0;
+	};
+
+	// ķͰSAHڼݰ
+	class BvhBuilder
+	{
+	public:
+		static BvhTree Build(const std::vector<Aabb>& bounds)
+		{
+			BvhBuilder builder;
+			BvhTree tree;
+			uint32_t count = static_cast<uint32_t>(bounds.size());
+			tree.object_order.resize(count);
+			tree.object_node.assign(count, m_invalid);
+			tree.object_position.assign(count, 0);
+			tree.nodes.reserve(count / 2 + 1);
+			tree.root_bounds = EmptyAabb();
+			builder.m_primitives.resize(count);
+			Range root{0, count, EmptyAabb(), EmptyAabb()};
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Primitive& primitive = builder.m_primitives[i];
+				primitive.box = bounds[i];
+				primitive.object = i;
+				Aabb centroid;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					primitive.centroid[axis] = centroid.min[axis] = centroid.max[axis] = (bounds[i].min[axis] + bounds[i].max[axis]) * 0.5f;
+				}
+				Grow(root.bounds, bounds[i]);
+				Grow(root.centroid_bounds, centroid);
+			}
+			if (count == 0) return tree;
+			builder.BuildNode(tree, root, m_invalid, 0);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				tree.object_order[i] = builder.m_primitives[i].object;
+				tree.object_position[builder.m_primitives[i].object] = i;
+			}
+			tree.root_bounds = root.bounds;
+			tree.sah_cost = ComputeSahCost(tree);
+			return tree;
+		}
+
+		// ԸΧһSAHۣڵۼΪ1ÿԴۼΪ1
+		static float ComputeSahCost(const BvhTree& tree)
+		{
+			float root_area = HalfArea(tree.root_bounds);
+			if (tree.nodes.empty() || root_area <= 0.0f) return 0.0f;
+			double cost = 0.0;
+			for (const BvhNode& node : tree.nodes)
+			{
+				for (uint32_t slot = 0; slot < 4; ++slot)
+				{
+					if (node.IsEmpty(slot)) continue;
+					cost += HalfArea(node.Bounds(slot)) * (node.IsLeaf(slot) ? node.count[slot] : 1.0f);
+				}
+			}
+			return static_cast<float>(cost / root_area);
+		}
+
+	private:
+		static const uint32_t m_bin_count = 16;
+
+		struct Primitive
+		{
+			Aabb box;
+			float centroid[3];
+			uint32_t object;
+		};
+
+		struct Range
+		{
+			uint32_t begin;
+			uint32_t end;
+			Aabb bounds;
+			Aabb centroid_bounds;
+		};
+
+		struct Bin
+		{
+			Aabb bounds;
+			Aabb centroid_bounds;
+			uint32_t count;
+		};
+
+		// ķΧϷͰSAHŻֲԭطͬʱõİΧ
+		void SplitRange(const Range& range, Range& left, Range& right)
+		{
+			int axis = 0;
+			float extent = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				float axis_extent = range.centroid_bounds.max[i] - range.centroid_bounds.min[i];
+				if (axis_extent > extent)
+				{
+					extent = axis_extent;
+					axis = i;
+				}
+			}
+
+			left = {range.begin, range.begin, EmptyAabb(), EmptyAabb()};
+			right = {range.begin, range.end, EmptyAabb(), EmptyAabb()};
+			if (extent <= 0.0f)
+			{
+				// غϣ԰
+				uint32_t middle = range.begin + (range.end - range.begin) / 2;
+				left.end = right.begin = middle;
+				left.bounds = RangeBounds(range.begin, middle);
+				right.bounds = RangeBounds(middle, range.end);
+				left.centroid_bounds = right.centroid_bounds = range.centroid_bounds;
+				return;
+			}
+
+			Bin bins[m_bin_count];
+			for (Bin& bin : bins) bin = {EmptyAabb(), EmptyAabb(), 0};
+			float minimum = range.centroid_bounds.min[axis];
+			float scale = m_bin_count / extent;
+			for (uint32_t i = range.begin; i < range.end; ++i)
+			{
+				const Primitive& primitive = m_primitives[i];
+				Bin& bin = bins[BinIndex(primitive.centroid[axis], minimum, scale)];
+				++bin.count;
+				Grow(bin.bounds, primitive.box);
+				for (int c = 0; c < 3; ++c)
+				{
+					bin.centroid_bounds.min[c] = std::min(bin.centroid_bounds.min[c], primitive.centroid[c]);
+					bin.centroid_bounds.max[c] = std::max(bin.centroid_bounds.max[c], primitive.centroid[c]);
+				}
+			}
+
+			// ۼƣٴɨÿָĴ
+			float right_area[m_bin_count];
+			uint32_t right_count[m_bin_count];
+			Aabb accumulated = EmptyAabb();
+			uint32_t accumulated_count = 0;
+			for (uint32_t bin = m_bin_count - 1; bin > 0; --bin)
+			{
+				Grow(accumulated, bins[bin].bounds);
+				accumulated_count += bins[bin].count;
+				right_area[bin] = HalfArea(accumulated);
+				right_count[bin] = accumulated_count;
+			}
+			float best_cost = INFINITY;
+			uint32_t best_bin = 0;
+			accumulated = EmptyAabb();
+			accumulated_count = 0;
+			for (uint32_t bin = 0; bin < m_bin_count - 1; ++bin)
+			{
+				Grow(accumulated, bins[bin].bounds);
+				accumulated_count += bins[bin].count;
+				if (accumulated_count == 0 || right_count[bin + 1] == 0) continue;
+				float cost = HalfArea(accumulated) * accumulated_count + right_area[bin + 1] * right_count[bin + 1];
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_bin = bin;
+				}
+			}
+
+			for (uint32_t bin = 0; bin < m_bin_count; ++bin)
+			{
+				Range& side = bin <= best_bin ? left : right;
+				Grow(side.bounds, bins[bin].bounds);
+				Grow(side.centroid_bounds, bins[bin].centroid_bounds);
+			}
+			auto split = std::partition(m_primitives.begin() + range.begin, m_primitives.begin() + range.end, [&](const Primitive& primitive)
+				{
+					return BinIndex(primitive.centroid[axis], minimum, scale) <= best_bin;
+				});
+			left.end = right.begin = static_cast<uint32_t>(split - m_primitives.begin());
+		}
+
+		static uint32_t BinIndex(float value, float minimum, float scale)
+		{
+			return std::min(m_bin_count - 1, static_cast<uint32_t>((value - minimum) * scale));
+		}
+
+		Aabb RangeBounds(uint32_t begin, uint32_t end) const
+		{
+			Aabb box = EmptyAabb();
+			for (uint32_t i = begin; i < end; ++i) Grow(box, m_primitives[i].box);
+			return box;
+		}
+
+		// 䣬ֱõĸ䶼㹻С
+		uint32_t BuildNode(BvhTree& tree, const Range& range, uint32_t parent, uint32_t parent_slot)
+		{
+			uint32_t node_index = static_cast<uint32_t>(tree.nodes.size());
+			tree.nodes.emplace_back();
+
+			Range ranges[4];
+			uint32_t range_count = 1;
+			ranges[0] = range;
+			while (range_count < 4)
+			{
+				int largest = -1;
+				for (uint32_t i = 0; i < range_count; ++i)
+				{
+					uint32_t size = ranges[i].end - ranges[i].begin;
+					if (size > m_leaf_size && (largest < 0 || size > ranges[largest].end - ranges[largest].begin)) largest = static_cast<int>(i);
+				}
+				if (largest < 0) break;
+				Range left, right;
+				SplitRange(ranges[largest], left, right);
+				ranges[largest] = left;
+				ranges[range_count++] = right;
+			}
+
+			for (uint32_t slot = 0; slot < 4; ++slot)
+			{
+				BvhNode& node = tree.nodes[node_index];
+				node.parent = parent;
+				node.parent_slot = parent_slot;
+				if (slot >= range_count || ranges[slot].begin == ranges[slot].end)
+				{
+					node.SetBounds(slot, EmptyAabb());
+					node.child[slot] = m_invalid;
+					node.count[slot] = 0;
+					continue;
+				}
+				uint32_t size = ranges[slot].end - ranges[slot].begin;
+				node.SetBounds(slot, ranges[slot].bounds);
+				if (size <= m_leaf_size)
+				{
+					node.child[slot] = ranges[slot].begin;
+					node.count[slot] = size;
+					for (uint32_t i = ranges[slot].begin; i < ranges[slot].end; ++i)
+					{
+						tree.object_node[m_primitives[i].object] = node_index;
+					}
+				}
+				else
+				{
+					node.count[slot] = 0;
+					// ӽڵǴڸڵ㣬refitʱԵ
+					uint32_t child = BuildNode(tree, ranges[slot], node_index, slot);
+					tree.nodes[node_index].child[slot] = child;
+				}
+			}
+			return node_index;
+		}
+
+		std::vector<Primitive> m_primitives;
+	};
+
+	// ̬BVHƶʱrefit½ں̨߳ؽ
+	class DynamicBvh
+	{
+	public:
+		~DynamicBvh()
+		{
+			if (m_pending.valid()) m_pending.wait();
+		}
+
+		void Build(const std::vector<Aabb>& bounds)
+		{
+			if (m_pending.valid()) m_pending.wait();
+			m_pending = {};
+			m_object_dirty.assign(bounds.size(), 0);
+			m_object_changed.assign(bounds.size(), 0);
+			// бȥأԤʱ
+			m_dirty_objects.clear();
+			m_dirty_objects.reserve(bounds.size());
+			m_changed_during_rebuild.clear();
+			m_changed_during_rebuild.reserve(bounds.size());
+			auto build_begin = std::chrono::high_resolution_clock::now();
+			m_tree = BvhBuilder::Build(bounds);
+			m_stats.build_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - build_begin).count();
+			OnTreeReplaced(bounds);
+		}
+
+		// ¶ΧУ´RefitʱЧ
+		void Update(uint32_t object, const Aabb& box)
+		{
+			m_ordered_bounds[m_tree.object_position[object]] = box;
+			if (!m_object_dirty[object])
+			{
+				m_object_dirty[object] = 1;
+				m_dirty_objects.push_back(object);
+			}
+			if (m_pending.valid() && !m_object_changed[object])
+			{
+				m_object_changed[object] = 1;
+				m_changed_during_rebuild.push_back(object);
+			}
+		}
+
+		// ֻ󵽸·ڵΧУĽڵ
+		uint32_t Refit()
+		{
+			auto refit_begin = std::chrono::high_resolution_clock::now();
+			m_dirty_nodes.clear();
+			if (m_dirty_objects.size() * 4 > m_tree.nodes.size())
+			{
+				// 󲿷ֶƶʱֱнڵ㣬ʡȥ·Ǻ
+				for (uint32_t object : m_dirty_objects) m_object_dirty[object] = 0;
+				for (uint32_t node = static_cast<uint32_t>(m_tree.nodes.size()); node > 0; --node) m_dirty_nodes.push_back(node - 1);
+			}
+			else
+			{
+				for (uint32_t object : m_dirty_objects)
+				{
+					m_object_dirty[object] = 0;
+					for (uint32_t node = m_tree.object_node[object]; node != m_invalid && !m_node_dirty[node]; node = m_tree.nodes[node].parent)
+					{
+						m_node_dirty[node] = 1;
+						m_dirty_nodes.push_back(node);
+					}
+				}
+				// ӽڵڸڵ㣬ӴСɱ֤Ե
+				std::sort(m_dirty_nodes.begin(), m_dirty_nodes.end(), std::greater<uint32_t>());
+			}
+			m_dirty_objects.clear();
+
+			for (uint32_t node_index : m_dirty_nodes)
+			{
+				BvhNode& node = m_tree.nodes[node_index];
+				for (uint32_t slot = 0; slot < 4; ++slot)
+				{
+					if (node.IsEmpty(slot)) continue;
+					Aabb box = EmptyAabb();
+					if (node.IsLeaf(slot))
+					{
+						for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; ++i) Grow(box, m_ordered_bounds[i]);
+					}
+					else
+					{
+						const BvhNode& child = m_tree.nodes[node.child[slot]];
+						for (uint32_t child_slot = 0; child_slot < 4; ++child_slot)
+						{
+							if (!child.IsEmpty(child_slot)) Grow(box, child.Bounds(child_slot));
+						}
+					}
+					node.SetBounds(slot, box);
+				}
+				m_node_dirty[node_index] = 0;
+			}
+			if (!m_dirty_nodes.empty() && m_dirty_nodes.back() == 0)
+			{
+				m_tree.root_bounds = EmptyAabb();
+				for (uint32_t slot = 0; slot < 4; ++slot)
+				{
+					if (!m_tree.nodes[0].IsEmpty(slot)) Grow(m_tree.root_bounds, m_tree.nodes[0].Bounds(slot));
+				}
+			}
+
+			m_stats.refit_nodes = static_cast<uint32_t>(m_dirty_nodes.size());
+			m_stats.refit_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - refit_begin).count();
+			++m_refits_since_check;
+			return m_stats.refit_nodes;
+		}
+
+		// ÿ֡ãɵĺ̨ؽڼSAHۣ˻ֵʱ̨ؽ
+		void Maintain(uint32_t check_interval = 60, float degrade_ratio = 1.3f)
+		{
+			if (m_pending.valid())
+			{
+				if (m_pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+				std::vector<Aabb> bounds = BoundsByObject();
+				m_tree = m_pending.get();
+				m_stats.build_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_rebuild_begin).count();
+				++m_stats.rebuild_count;
+				OnTreeReplaced(bounds);
+				// ؽڼƶĶϲrefit
+				for (uint32_t object : m_changed_during_rebuild)
+				{
+					m_object_changed[object] = 0;
+					if (!m_object_dirty[object])
+					{
+						m_object_dirty[object] = 1;
+						m_dirty_objects.push_back(object);
+					}
+				}
+				m_changed_during_rebuild.clear();
+				Refit();
+				return;
+			}
+			if (m_refits_since_check < check_interval || m_tree.nodes.empty()) return;
+			m_refits_since_check = 0;
+			m_stats.current_sah_cost = BvhBuilder::ComputeSahCost(m_tree);
+			if (m_stats.current_sah_cost > m_stats.build_sah_cost * degrade_ratio)
+			{
+				StartRebuild();
+			}
+		}
+
+		// ԵǰΧеĿں̨̹߳
+		void StartRebuild()
+		{
+			if (m_pending.valid()) return;
+			m_rebuild_begin = std::chrono::high_resolution_clock::now();
+			m_pending = std::async(std::launch::async, [snapshot = BoundsByObject()]()
+				{
+					return BvhBuilder::Build(snapshot);
+				});
+		}
+
+		bool IsRebuilding() const { return m_pending.valid(); }
+
+		// ׶ѯȫ׶ڵֱռ
+		// ģȾѭԴ֡ڴϵб
+		template <typename Container>
+		void QueryFrustum(const Frustum& frustum, Container& result) const
+		{
+			result.clear();
+			if (m_tree.nodes.empty()) return;
+			uint32_t stack[m_stack_size];
+			uint32_t stack_size = 0;
+			stack[stack_size++] = 0;
+			while (stack_size)
+			{
+				const BvhNode& node = m_tree.nodes[stack[--stack_size]];
+				Float4 min_x = Load4(node.min_x), min_y = Load4(node.min_y), min_z = Load4(node.min_z);
+				Float4 max_x = Load4(node.max_x), max_y = Load4(node.max_y), max_z = Load4(node.max_z);
+				uint32_t outside = 0, intersecting = 0;
+				for (const auto& plane : frustum.planes)
+				{
+					Float4 nx = Splat4(plane[0]), ny = Splat4(plane[1]), nz = Splat4(plane[2]);
+					Float4 negative_d = Splat4(-plane[3]);
+					// ƽ⣻ƽƽཻ
+					Float4 positive = Max4(nx * min_x, nx * max_x) + Max4(ny * min_y, ny * max_y) + Max4(nz * min_z, nz * max_z);
+					Float4 negative = Min4(nx * min_x, nx * max_x) + Min4(ny * min_y, ny * max_y) + Min4(nz * min_z, nz * max_z);
+					outside |= LessMask(positive, negative_d);
+					intersecting |= LessMask(negative, negative_d);
+				}
+				for (uint32_t slot = 0; slot < 4; ++slot)
+				{
+					if (node.IsEmpty(slot) || (outside & (1u << slot))) continue;
+					if (!(intersecting & (1u << slot)))
+					{
+						CollectSlot(node, slot, result);
+					}
+					else if (node.IsLeaf(slot))
+					{
+						for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; ++i)
+						{
+							if (BoxInFrustum(m_ordered_bounds[i], frustum)) result.push_back(m_tree.object_order[i]);
+						}
+					}
+					else
+					{
+						stack[stack_size++] = node.child[slot];
+					}
+				}
+			}
+		}
+
+		// Χصѯ
+		void QueryAabb(const Aabb& box, std::vector<uint32_t>& result) const
+		{
+			result.clear();
+			if (m_tree.nodes.empty()) return;
+			Float4 query_min_x = Splat4(box.min[0]), query_min_y = Splat4(box.min[1]), query_min_z = Splat4(box.min[2]);
+			Float4 query_max_x = Splat4(box.max[0]), query_max_y = Splat4(box.max[1]), query_max_z = Splat4(box.max[2]);
+			uint32_t stack[m_stack_size];
+			uint32_t stack_size = 0;
+			stack[stack_size++] = 0;
+			while (stack_size)
+			{
+				const BvhNode& node = m_tree.nodes[stack[--stack_size]];
+				uint32_t overlap =
+					LessEqualMask(Load4(node.min_x), query_max_x) & LessEqualMask(query_min_x, Load4(node.max_x)) &
+					LessEqualMask(Load4(node.min_y), query_max_y) & LessEqualMask(query_min_y, Load4(node.max_y)) &
+					LessEqualMask(Load4(node.min_z), query_max_z) & LessEqualMask(query_min_z, Load4(node.max_z));
+				for (uint32_t slot = 0; slot < 4; ++slot)
+				{
+					if (!(overlap & (1u << slot)) || node.IsEmpty(slot)) continue;
+					if (node.IsLeaf(slot))
+					{
+						for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; ++i)
+						{
+							const Aabb& bounds = m_ordered_bounds[i];
+							if (bounds.min[0] <= box.max[0] && box.min[0] <= bounds.max[0] &&
+								bounds.min[1] <= box.max[1] && box.min[1] <= bounds.max[1] &&
+								bounds.min[2] <= box.max[2] && box.min[2] <= bounds.max[2])
+							{
+								result.push_back(m_tree.object_order[i]);
+							}
+						}
+					}
+					else
+					{
+						stack[stack_size++] = node.child[slot];
+					}
+				}
+			}
+		}
+
+		// ߲ѯཻĶΧУӽڵ㰴ɽԶ
+		RayHit Raycast(const float origin[3], const float direction[3], float max_t = INFINITY) const
+		{
+			RayHit hit;
+			hit.t = max_t;
+			RayHit none;
+			if (m_tree.nodes.empty()) return none;
+			float inverse[3];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				// 㣬Сúܴĵ
+				inverse[axis] = 1.0f / (std::fabs(direction[axis]) > 1e-20f ? direction[axis] : std::copysign(1e-20f, direction[axis]));
+			}
+			Float4 origin_x = Splat4(origin[0]), origin_y = Splat4(origin[1]), origin_z = Splat4(origin[2]);
+			Float4 inverse_x = Splat4(inverse[0]), inverse_y = Splat4(inverse[1]), inverse_z = Splat4(inverse[2]);
+
+			uint32_t stack[m_stack_size];
+			float stack_t[m_stack_size];
+			uint32_t stack_size = 0;
+			stack[stack_size] = 0;
+			stack_t[stack_size++] = 0.0f;
+			while (stack_size)
+			{
+				--stack_size;
+				if (stack_t[stack_size] > hit.t) continue;
+				const BvhNode& node = m_tree.nodes[stack[stack_size]];
+				Float4 t0x = (Load4(node.min_x) - origin_x) * inverse_x, t1x = (Load4(node.max_x) - origin_x) * inverse_x;
+				Float4 t0y = (Load4(node.min_y) - origin_y) * inverse_y, t1y = (Load4(node.max_y) - origin_y) * inverse_y;
+				Float4 t0z = (Load4(node.min_z) - origin_z) * inverse_z, t1z = (Load4(node.max_z) - origin_z) * inverse_z;
+				Float4 t_near = Max4(Max4(Min4(t0x, t1x), Min4(t0y, t1y)), Max4(Min4(t0z, t1z), Splat4(0.0f)));
+				Float4 t_far = Min4(Min4(Max4(t0x, t1x), Max4(t0y, t1y)), Min4(Max4(t0z, t1z), Splat4(hit.t)));
+				uint32_t mask = LessEqualMask(t_near, t_far);
+				alignas(16) float near_values[4];
+				Store4(near_values, t_near);
+
+				// еڲӽڵ㰴Զѹջȳջ
+				uint32_t order[4];
+				uint32_t order_count = 0;
+				for (uint32_t slot = 0; slot < 4; ++slot)
+				{
+					if (!(mask & (1u << slot)) || node.IsEmpty(slot)) continue;
+					if (node.IsLeaf(slot))
+					{
+						for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; ++i)
+						{
+							float t;
+							if (RayBox(m_ordered_bounds[i], origin, inverse, hit.t, t))
+							{
+								hit.t = t;
+								hit.object = m_tree.object_order[i];
+							}
+						}
+					}
+					else
+					{
+						order[order_count++] = slot;
+					}
+				}
+				for (uint32_t i = 1; i < order_count; ++i)
+				{
+					for (uint32_t j = i; j > 0 && near_values[order[j - 1]] < near_values[order[j]]; --j) std::swap(order[j - 1], order[j]);
+				}
+				for (uint32_t i = 0; i < order_count; ++i)
+				{
+					stack[stack_size] = node.child[order[i]];
+					stack_t[stack_size++] = near_values[order[i]];
+				}
+			}
+			return hit.object == m_invalid ? none : hit;
+		}
+
+		const Aabb& Bounds(uint32_t object) const { return m_ordered_bounds[m_tree.object_position[object]]; }
+		uint32_t ObjectCount() const { return static_cast<uint32_t>(m_ordered_bounds.size()); }
+		const BvhStats& Stats() const { return m_stats; }
+
+	private:
+		// Ĳÿѹֵܣޣ̶Сջ㹻
+		static const uint32_t m_stack_size = 256;
+
+		// ΧаҶ˳ţrefitͲѯʱ
+		void OnTreeReplaced(const std::vector<Aabb>& bounds)
+		{
+			m_ordered_bounds.resize(bounds.size());
+			for (size_t i = 0; i < bounds.size(); ++i) m_ordered_bounds[i] = bounds[m_tree.object_order[i]];
+			m_node_dirty.assign(m_tree.nodes.size(), 0);
+			m_refits_since_check = 0;
+			m_stats.object_count = static_cast<uint32_t>(bounds.size());
+			m_stats.node_count = static_cast<uint32_t>(m_tree.nodes.size());
+			m_stats.build_sah_cost = m_tree.sah_cost;
+			m_stats.current_sah_cost = m_tree.sah_cost;
+		}
+
+		std::vector<Aabb> BoundsByObject() const
+		{
+			std::vector<Aabb> bounds(m_ordered_bounds.size());
+			for (size_t i = 0; i < m_ordered_bounds.size(); ++i) bounds[m_tree.object_order[i]] = m_ordered_bounds[i];
+			return bounds;
+		}
+
+		template <typename Container>
+		void CollectSlot(const BvhNode& node, uint32_t slot, Container& result) const
+		{
+			if (node.IsLeaf(slot))
+			{
+				result.insert(result.end(), m_tree.object_order.begin() + node.child[slot], m_tree.object_order.begin() + node.child[slot] + node.count[slot]);
+				return;
+			}
+			const BvhNode& child = m_tree.nodes[node.child[slot]];
+			for (uint32_t child_slot = 0; child_slot < 4; ++child_slot)
+			{
+				if (!child.IsEmpty(child_slot)) CollectSlot(child, child_slot, result);
+			}
+		}
+
+		static bool BoxInFrustum(const Aabb& box, const Frustum& frustum)
+		{
+			for (const auto& plane : frustum.planes)
+			{
+				float distance = plane[3];
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					distance += plane[axis] * (plane[axis] > 0.0f ? box.max[axis] : box.min[axis]);
+				}
+				if (distance < 0.0f) return false;
+			}
+			return true;
+		}
+
+		static bool RayBox(const Aabb& box, const float origin[3], const float inverse[3], float max_t, float& t)
+		{
+			float t_near = 0.0f, t_far = max_t;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float t0 = (box.min[axis] - origin[axis]) * inverse[axis];
+				float t1 = (box.max[axis] - origin[axis]) * inverse[axis];
+				t_near = std::max(t_near, std::min(t0, t1));
+				t_far = std::min(t_far, std::max(t0, t1));
+			}
+			t = t_near;
+			return t_near <= t_far && t_near < max_t;
+		}
+
+		BvhTree m_tree;
+		std::vector<Aabb> m_ordered_bounds;
+		std::vector<uint8_t> m_object_dirty;
+		std::vector<uint32_t> m_dirty_objects;
+		std::vector<uint8_t> m_node_dirty;
+		std::vector<uint32_t> m_dirty_nodes;
+		uint32_t m_refits_since_check = 0;
+
+		std::future<BvhTree> m_pending;
+		std::chrono::high_resolution_clock::time_point m_rebuild_begin;
+		// ؽڼƶĶm_object_changedбеĶ
+		std::vector<uint32_t> m_changed_during_rebuild;
+		std::vector<uint8_t> m_object_changed;
+
+		BvhStats m_stats;
+	};
+}
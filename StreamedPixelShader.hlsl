@@ -0,0 +1,33 @@
+// shader: ps_6_0 main
+
+#include "MipFeedback.hlsli"
+
+struct StreamingConstants
+{
+    uint TextureId;
+    uint ResidentMip;
+};
+
+ConstantBuffer<StreamingConstants> StreamingCB : register(b0, space1);
+
+Texture2D StreamedTexture : register(t0, space1);
+SamplerState TrilinearSampler : register(s0, space1);
+
+struct PixelShaderInput
+{
+    float4 Color          : COLOR;
+    float3 ObjectPosition : TEXCOORD0;
+};
+
+static const float PI = 3.14159265f;
+
+[earlydepthstencil]
+float4 main( PixelShaderInput IN ) : SV_Target
+{
+    float3 direction = normalize(IN.ObjectPosition);
+    float2 uv = float2(atan2(direction.z, direction.x) / (2.0f * PI) + 0.5f, acos(clamp(direction.y, -1.0f, 1.0f)) / PI);
+
+    RecordMipRequest(StreamingCB.TextureId, StreamedTexture, TrilinearSampler, uv);
+    float4 texel = StreamedTexture.Sample(TrilinearSampler, uv, int2(0, 0), (float)StreamingCB.ResidentMip);
+    return texel * IN.Color;
+}
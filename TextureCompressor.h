@@ -0,0 +1,837 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXTURE_HELPER_SSE2 1
+#endif
+
+namespace TextureHelper
+{
+	// RGBA8ͼذн
+	struct Image
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	enum class BlockFormat : uint32_t
+	{
+		BC1 = 0,
+		BC3 = 1,
+		BC5 = 2,
+		BC7 = 3,
+	};
+
+	enum class MipFilter : uint32_t
+	{
+		Box = 0,
+		Kaiser = 1,
+	};
+
+	inline uint32_t BlockSize(BlockFormat format)
+	{
+		return format == BlockFormat::BC1 ? 8u : 16u;
+	}
+
+	// ---------------------------------------------------------------
+	// mipɣԿռ˲sRGBȽٱ
+	// ---------------------------------------------------------------
+
+	inline float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	inline float LinearToSrgb(float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	inline const float* SrgbToLinearTable()
+	{
+		static const std::vector<float> table = []
+		{
+			std::vector<float> values(256);
+			for (int i = 0; i < 256; ++i)
+			{
+				values[i] = SrgbToLinear(i / 255.0f);
+			}
+			return values;
+		}();
+		return table.data();
+	}
+
+	inline uint8_t ToUnorm8(float value)
+	{
+		return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	// KaisersincˣdistanceĿΪλ
+	inline float KaiserWeight(float distance, float radius, float alpha = 4.0f)
+	{
+		auto bessel_i0 = [](float x)
+		{
+			float sum = 1.0f;
+			float term = 1.0f;
+			for (int k = 1; k < 16; ++k)
+			{
+				term *= (x / (2.0f * k)) * (x / (2.0f * k));
+				sum += term;
+			}
+			return sum;
+		};
+		float ratio = distance / radius;
+		if (std::fabs(ratio) >= 1.0f) return 0.0f;
+		float x = distance * 3.14159265f;
+		float sinc = std::fabs(x) < 1e-5f ? 1.0f : std::sin(x) / x;
+		return sinc * bessel_i0(alpha * std::sqrt(1.0f - ratio * ratio)) / bessel_i0(alpha);
+	}
+
+	// һmip߸루СΪ1
+	inline Image DownsampleMip(const Image& source, MipFilter filter, bool srgb)
+	{
+		Image result;
+		result.width = std::max(1u, source.width / 2);
+		result.height = std::max(1u, source.height / 2);
+		result.pixels.resize(size_t(result.width) * result.height * 4);
+
+		// תԸռ䣬alphaʼΪ
+		const float* srgb_table = SrgbToLinearTable();
+		std::vector<float> linear(source.pixels.size());
+		for (size_t i = 0; i < source.pixels.size(); ++i)
+		{
+			linear[i] = (srgb && (i & 3) != 3) ? srgb_table[source.pixels[i]] : source.pixels[i] / 255.0f;
+		}
+
+		// ɷ˲ÿλõĲȨأÿʹõĲ
+		auto build_taps = [&](uint32_t source_size, uint32_t target_size, std::vector<int>& indices, std::vector<float>& weights)
+		{
+			float scale = static_cast<float>(source_size) / target_size;
+			// boxĿضӦԴ䣬KaiserĿ
+			float support = filter == MipFilter::Box ? scale * 0.5f : scale * 2.0f;
+			int tap_count = static_cast<int>(std::ceil(support * 2.0f)) + 1;
+			indices.resize(size_t(target_size) * tap_count);
+			weights.resize(size_t(target_size) * tap_count);
+			for (uint32_t t = 0; t < target_size; ++t)
+			{
+				float center = (t + 0.5f) * scale;
+				int first = static_cast<int>(std::floor(center - support));
+				float total = 0.0f;
+				for (int k = 0; k < tap_count; ++k)
+				{
+					int s = first + k;
+					float weight = 0.0f;
+					if (filter == MipFilter::Box)
+					{
+						// ȨΪԴص
+						weight = std::max(0.0f, std::min(s + 1.0f, center + support) - std::max(static_cast<float>(s), center - support));
+					}
+					else
+					{
+						weight = KaiserWeight((s + 0.5f - center) / scale, 2.0f);
+					}
+					indices[t * tap_count + k] = std::clamp(s, 0, static_cast<int>(source_size) - 1);
+					weights[t * tap_count + k] = weight;
+					total += weight;
+				}
+				for (int k = 0; k < tap_count; ++k)
+				{
+					weights[t * tap_count + k] = total != 0.0f ? weights[t * tap_count + k] / total : 1.0f / tap_count;
+				}
+			}
+			return tap_count;
+		};
+		std::vector<int> x_indices, y_indices;
+		std::vector<float> x_weights, y_weights;
+		const int x_tap_count = build_taps(source.width, result.width, x_indices, x_weights);
+		const int y_tap_count = build_taps(source.height, result.height, y_indices, y_weights);
+
+		// ˮƽֱ
+		std::vector<float> horizontal(size_t(result.width) * source.height * 4);
+		for (uint32_t y = 0; y < source.height; ++y)
+		{
+			for (uint32_t x = 0; x < result.width; ++x)
+			{
+				float sum[4] = {};
+				for (int k = 0; k < x_tap_count; ++k)
+				{
+					const float* p = &linear[(size_t(y) * source.width + x_indices[x * x_tap_count + k]) * 4];
+					float w = x_weights[x * x_tap_count + k];
+					for (int c = 0; c < 4; ++c) sum[c] += p[c] * w;
+				}
+				std::memcpy(&horizontal[(size_t(y) * result.width + x) * 4], sum, sizeof(sum));
+			}
+		}
+		for (uint32_t y = 0; y < result.height; ++y)
+		{
+			for (uint32_t x = 0; x < result.width; ++x)
+			{
+				float sum[4] = {};
+				for (int k = 0; k < y_tap_count; ++k)
+				{
+					const float* p = &horizontal[(size_t(y_indices[y * y_tap_count + k]) * result.width + x) * 4];
+					float w = y_weights[y * y_tap_count + k];
+					for (int c = 0; c < 4; ++c) sum[c] += p[c] * w;
+				}
+				uint8_t* out = &result.pixels[(size_t(y) * result.width + x) * 4];
+				for (int c = 0; c < 4; ++c)
+				{
+					out[c] = ToUnorm8((srgb && c != 3) ? LinearToSrgb(sum[c]) : sum[c]);
+				}
+			}
+		}
+		return result;
+	}
+
+	// ɴԭͼ1x1mip
+	inline std::vector<Image> GenerateMipChain(const Image& image, MipFilter filter, bool srgb)
+	{
+		std::vector<Image> mips;
+		mips.push_back(image);
+		while (mips.back().width > 1 || mips.back().height > 1)
+		{
+			mips.push_back(DownsampleMip(mips.back(), filter, srgb));
+		}
+		return mips;
+	}
+
+	// ---------------------------------------------------------------
+	// ѹ
+	// ---------------------------------------------------------------
+
+	inline uint16_t To565(const int color[3])
+	{
+		int r = (color[0] * 31 + 127) / 255;
+		int g = (color[1] * 63 + 127) / 255;
+		int b = (color[2] * 31 + 127) / 255;
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	inline void From565(uint16_t value, int color[3])
+	{
+		int r = (value >> 11) & 31;
+		int g = (value >> 5) & 63;
+		int b = value & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	// 16ͶӰ˵ϣõ0~1Ĳֵλ
+	inline void ProjectOntoAxis(const float* r, const float* g, const float* b, const float origin[3], const float axis[3], float* t)
+	{
+		float length_sq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+		float inv = length_sq > 0.0f ? 1.0f / length_sq : 0.0f;
+#if defined(TEXTURE_HELPER_SSE2)
+		const __m128 ax = _mm_set1_ps(axis[0] * inv), ay = _mm_set1_ps(axis[1] * inv), az = _mm_set1_ps(axis[2] * inv);
+		const __m128 ox = _mm_set1_ps(origin[0]), oy = _mm_set1_ps(origin[1]), oz = _mm_set1_ps(origin[2]);
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(r + i), ox);
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(g + i), oy);
+			__m128 dz = _mm_sub_ps(_mm_loadu_ps(b + i), oz);
+			__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, ax), _mm_mul_ps(dy, ay)), _mm_mul_ps(dz, az));
+			_mm_storeu_ps(t + i, _mm_min_ps(one, _mm_max_ps(zero, dot)));
+		}
+#else
+		for (int i = 0; i < 16; ++i)
+		{
+			float dot = ((r[i] - origin[0]) * axis[0] + (g[i] - origin[1]) * axis[1] + (b[i] - origin[2]) * axis[2]) * inv;
+			t[i] = std::clamp(dot, 0.0f, 1.0f);
+		}
+#endif
+	}
+
+	// BC1Χж˵1/16ЭѡԽߣͶӰõ
+	inline void EncodeBC1Block(const uint8_t* rgba, uint8_t* out)
+	{
+		alignas(16) float r[16], g[16], b[16], t[16];
+		int min_color[3] = {255, 255, 255};
+		int max_color[3] = {0, 0, 0};
+		float mean[3] = {};
+		for (int i = 0; i < 16; ++i)
+		{
+			r[i] = rgba[i * 4 + 0];
+			g[i] = rgba[i * 4 + 1];
+			b[i] = rgba[i * 4 + 2];
+			for (int c = 0; c < 3; ++c)
+			{
+				min_color[c] = std::min<int>(min_color[c], rgba[i * 4 + c]);
+				max_color[c] = std::max<int>(max_color[c], rgba[i * 4 + c]);
+				mean[c] += rgba[i * 4 + c] / 16.0f;
+			}
+		}
+
+		float covariance_rg = 0.0f, covariance_bg = 0.0f;
+		for (int i = 0; i < 16; ++i)
+		{
+			covariance_rg += (r[i] - mean[0]) * (g[i] - mean[1]);
+			covariance_bg += (b[i] - mean[2]) * (g[i] - mean[1]);
+		}
+		for (int c = 0; c < 3; ++c)
+		{
+			int inset = (max_color[c] - min_color[c]) >> 4;
+			min_color[c] += inset;
+			max_color[c] -= inset;
+		}
+		if (covariance_rg < 0.0f) std::swap(min_color[0], max_color[0]);
+		if (covariance_bg < 0.0f) std::swap(min_color[2], max_color[2]);
+
+		uint16_t c0 = To565(max_color);
+		uint16_t c1 = To565(min_color);
+		uint32_t indices = 0;
+		// ˵ͬʱʹ0
+		if (c0 != c1)
+		{
+			// ɫģʽҪc0c1
+			if (c0 < c1) std::swap(c0, c1);
+			int p0[3], p1[3];
+			From565(c0, p0);
+			From565(c1, p1);
+			float origin[3] = {float(p0[0]), float(p0[1]), float(p0[2])};
+			float axis[3] = {float(p1[0] - p0[0]), float(p1[1] - p0[1]), float(p1[2] - p0[2])};
+			ProjectOntoAxis(r, g, b, origin, axis, t);
+			// ֵλ0,1/3,2/3,1ֱӦ0,2,3,1
+			static const uint32_t level_to_index[4] = {0, 2, 3, 1};
+			for (int i = 0; i < 16; ++i)
+			{
+				indices |= level_to_index[static_cast<int>(t[i] * 3.0f + 0.5f)] << (i * 2);
+			}
+		}
+		out[0] = c0 & 0xff;
+		out[1] = c0 >> 8;
+		out[2] = c1 & 0xff;
+		out[3] = c1 >> 8;
+		std::memcpy(out + 4, &indices, 4);
+	}
+
+	// BC4ͨ8ֵֵģʽ
+	inline void EncodeBC4Block(const uint8_t* rgba, int channel, uint8_t* out)
+	{
+		int min_value = 255, max_value = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			min_value = std::min<int>(min_value, rgba[i * 4 + channel]);
+			max_value = std::max<int>(max_value, rgba[i * 4 + channel]);
+		}
+		out[0] = static_cast<uint8_t>(max_value);
+		out[1] = static_cast<uint8_t>(min_value);
+		uint64_t indices = 0;
+		if (max_value > min_value)
+		{
+			// λ0Ϊa0λ7Ϊa1мζӦ2~7
+			float scale = 7.0f / (max_value - min_value);
+			for (int i = 0; i < 16; ++i)
+			{
+				int level = static_cast<int>((max_value - rgba[i * 4 + channel]) * scale + 0.5f);
+				uint64_t index = level == 0 ? 0 : (level == 7 ? 1 : level + 1);
+				indices |= index << (i * 3);
+			}
+		}
+		for (int i = 0; i < 6; ++i)
+		{
+			out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+		}
+	}
+
+	inline void EncodeBC3Block(const uint8_t* rgba, uint8_t* out)
+	{
+		EncodeBC4Block(rgba, 3, out);
+		EncodeBC1Block(rgba, out + 8);
+	}
+
+	inline void EncodeBC5Block(const uint8_t* rgba, uint8_t* out)
+	{
+		EncodeBC4Block(rgba, 0, out);
+		EncodeBC4Block(rgba, 1, out + 8);
+	}
+
+	// λд128λBC7
+	struct BitWriter
+	{
+		uint8_t* data;
+		uint32_t position = 0;
+
+		void Write(uint32_t value, uint32_t bits)
+		{
+			for (uint32_t i = 0; i < bits; ++i, ++position)
+			{
+				if ((value >> i) & 1) data[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+			}
+		}
+	};
+
+	static const int m_bc7_weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	// BC7ģʽ6RGBA7λ˵Ӷpλ4λ
+	inline void EncodeBC7Block(const uint8_t* rgba, uint8_t* out)
+	{
+		int min_color[4] = {255, 255, 255, 255};
+		int max_color[4] = {0, 0, 0, 0};
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				min_color[c] = std::min<int>(min_color[c], rgba[i * 4 + c]);
+				max_color[c] = std::max<int>(max_color[c], rgba[i * 4 + c]);
+			}
+		}
+		for (int c = 0; c < 4; ++c)
+		{
+			int inset = (max_color[c] - min_color[c]) >> 5;
+			min_color[c] += inset;
+			max_color[c] -= inset;
+		}
+
+		// Ϊÿ˵ѡСpλ
+		int endpoint[2][4];
+		int stored[2][4];
+		int p_bit[2];
+		const int* targets[2] = {min_color, max_color};
+		for (int e = 0; e < 2; ++e)
+		{
+			int best_error = INT32_MAX;
+			for (int p = 0; p < 2; ++p)
+			{
+				int error = 0;
+				int candidate[4], candidate_stored[4];
+				for (int c = 0; c < 4; ++c)
+				{
+					int q = std::clamp((targets[e][c] - p + 1) >> 1, 0, 127);
+					candidate_stored[c] = q;
+					candidate[c] = (q << 1) | p;
+					error += (candidate[c] - targets[e][c]) * (candidate[c] - targets[e][c]);
+				}
+				if (error < best_error)
+				{
+					best_error = error;
+					p_bit[e] = p;
+					std::memcpy(endpoint[e], candidate, sizeof(candidate));
+					std::memcpy(stored[e], candidate_stored, sizeof(candidate_stored));
+				}
+			}
+		}
+
+		// ÿ16ֵɫѰһ
+		int palette[16][4];
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				palette[i][c] = ((64 - m_bc7_weights4[i]) * endpoint[0][c] + m_bc7_weights4[i] * endpoint[1][c] + 32) >> 6;
+			}
+		}
+		int indices[16];
+		for (int i = 0; i < 16; ++i)
+		{
+			int best_error = INT32_MAX;
+			for (int k = 0; k < 16; ++k)
+			{
+				int error = 0;
+				for (int c = 0; c < 4; ++c)
+				{
+					int d = palette[k][c] - rgba[i * 4 + c];
+					error += d * d;
+				}
+				if (error < best_error)
+				{
+					best_error = error;
+					indices[i] = k;
+				}
+			}
+		}
+
+		// һصλΪ0Ҫʱ˵
+		if (indices[0] >= 8)
+		{
+			std::swap(stored[0], stored[1]);
+			std::swap(p_bit[0], p_bit[1]);
+			for (int i = 0; i < 16; ++i)
+			{
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		std::memset(out, 0, 16);
+		BitWriter writer{out};
+		writer.Write(1u << 6, 7);
+		for (int c = 0; c < 4; ++c)
+		{
+			writer.Write(stored[0][c], 7);
+			writer.Write(stored[1][c], 7);
+		}
+		writer.Write(p_bit[0], 1);
+		writer.Write(p_bit[1], 1);
+		writer.Write(indices[0], 3);
+		for (int i = 1; i < 16; ++i)
+		{
+			writer.Write(indices[i], 4);
+		}
+	}
+
+	// ȡ4x4ؿ飬Խ粿ָƱԵ
+	inline void LoadBlock(const Image& image, uint32_t block_x, uint32_t block_y, uint8_t* rgba)
+	{
+		for (uint32_t y = 0; y < 4; ++y)
+		{
+			uint32_t sy = std::min(block_y * 4 + y, image.height - 1);
+			for (uint32_t x = 0; x < 4; ++x)
+			{
+				uint32_t sx = std::min(block_x * 4 + x, image.width - 1);
+				std::memcpy(rgba + (y * 4 + x) * 4, &image.pixels[(size_t(sy) * image.width + sx) * 4], 4);
+			}
+		}
+	}
+
+	inline void EncodeBlock(BlockFormat format, const uint8_t* rgba, uint8_t* out)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1: EncodeBC1Block(rgba, out); break;
+		case BlockFormat::BC3: EncodeBC3Block(rgba, out); break;
+		case BlockFormat::BC5: EncodeBC5Block(rgba, out); break;
+		case BlockFormat::BC7: EncodeBC7Block(rgba, out); break;
+		}
+	}
+
+	// ߳ѹͼ񣬰з̣߳ȵĿ
+	inline std::vector<uint8_t> EncodeImage(const Image& image, BlockFormat format, uint32_t thread_count = 0)
+	{
+		uint32_t blocks_x = (image.width + 3) / 4;
+		uint32_t blocks_y = (image.height + 3) / 4;
+		uint32_t block_size = BlockSize(format);
+		std::vector<uint8_t> blocks(size_t(blocks_x) * blocks_y * block_size);
+
+		if (thread_count == 0)
+		{
+			thread_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		// Сͼֵ߳
+		thread_count = std::min(thread_count, std::max(1u, blocks_y / 4));
+
+		auto encode_rows = [&](uint32_t first_row, uint32_t last_row)
+		{
+			uint8_t rgba[64];
+			for (uint32_t by = first_row; by < last_row; ++by)
+			{
+				for (uint32_t bx = 0; bx < blocks_x; ++bx)
+				{
+					LoadBlock(image, bx, by, rgba);
+					EncodeBlock(format, rgba, &blocks[(size_t(by) * blocks_x + bx) * block_size]);
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		uint32_t rows_per_thread = (blocks_y + thread_count - 1) / thread_count;
+		for (uint32_t i = 1; i < thread_count; ++i)
+		{
+			uint32_t first = std::min(blocks_y, i * rows_per_thread);
+			uint32_t last = std::min(blocks_y, first + rows_per_thread);
+			threads.emplace_back(encode_rows, first, last);
+		}
+		encode_rows(0, std::min(blocks_y, rows_per_thread));
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		return blocks;
+	}
+
+	// ---------------------------------------------------------------
+	// 룬
+	// ---------------------------------------------------------------
+
+	inline void DecodeBC1Block(const uint8_t* in, uint8_t* rgba)
+	{
+		uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+		uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+		int palette[4][4];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = 255;
+		for (int c = 0; c < 3; ++c)
+		{
+			if (c0 > c1)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = c0 > c1 ? 255 : 0;
+		uint32_t indices;
+		std::memcpy(&indices, in + 4, 4);
+		for (int i = 0; i < 16; ++i)
+		{
+			const int* color = palette[(indices >> (i * 2)) & 3];
+			for (int c = 0; c < 4; ++c) rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+		}
+	}
+
+	inline void DecodeBC4Block(const uint8_t* in, int channel, uint8_t* rgba)
+	{
+		int a0 = in[0], a1 = in[1];
+		int palette[8] = {a0, a1};
+		for (int i = 1; i < 7; ++i)
+		{
+			palette[i + 1] = a0 > a1 ? ((7 - i) * a0 + i * a1) / 7 : (i < 5 ? ((5 - i) * a0 + i * a1) / 5 : 0);
+		}
+		if (a0 <= a1)
+		{
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		uint64_t indices = 0;
+		for (int i = 0; i < 6; ++i)
+		{
+			indices |= static_cast<uint64_t>(in[2 + i]) << (i * 8);
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+		}
+	}
+
+	// ֻ뱾ģʽ6
+	inline void DecodeBC7Block(const uint8_t* in, uint8_t* rgba)
+	{
+		uint32_t position = 0;
+		auto read = [&](uint32_t bits)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bits; ++i, ++position)
+			{
+				value |= ((in[position >> 3] >> (position & 7)) & 1u) << i;
+			}
+			return value;
+		};
+		if (read(7) != (1u << 6))
+		{
+			std::memset(rgba, 0, 64);
+			return;
+		}
+		int endpoint[2][4];
+		for (int c = 0; c < 4; ++c)
+		{
+			endpoint[0][c] = read(7) << 1;
+			endpoint[1][c] = read(7) << 1;
+		}
+		uint32_t p0 = read(1), p1 = read(1);
+		for (int c = 0; c < 4; ++c)
+		{
+			endpoint[0][c] |= p0;
+			endpoint[1][c] |= p1;
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			int index = read(i == 0 ? 3 : 4);
+			for (int c = 0; c < 4; ++c)
+			{
+				rgba[i * 4 + c] = static_cast<uint8_t>(((64 - m_bc7_weights4[index]) * endpoint[0][c] + m_bc7_weights4[index] * endpoint[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	inline Image DecodeImage(const std::vector<uint8_t>& blocks, uint32_t width, uint32_t height, BlockFormat format)
+	{
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.pixels.assign(size_t(width) * height * 4, 255);
+		uint32_t blocks_x = (width + 3) / 4;
+		uint32_t block_size = BlockSize(format);
+		uint8_t rgba[64];
+		for (uint32_t by = 0; by < (height + 3) / 4; ++by)
+		{
+			for (uint32_t bx = 0; bx < blocks_x; ++bx)
+			{
+				const uint8_t* block = &blocks[(size_t(by) * blocks_x + bx) * block_size];
+				std::memset(rgba, 255, sizeof(rgba));
+				switch (format)
+				{
+				case BlockFormat::BC1: DecodeBC1Block(block, rgba); break;
+				case BlockFormat::BC3: DecodeBC1Block(block + 8, rgba); DecodeBC4Block(block, 3, rgba); break;
+				case BlockFormat::BC5: DecodeBC4Block(block, 0, rgba); DecodeBC4Block(block + 8, 1, rgba); for (int i = 0; i < 16; ++i) rgba[i * 4 + 2] = 0; break;
+				case BlockFormat::BC7: DecodeBC7Block(block, rgba); break;
+				}
+				for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+				{
+					for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+					{
+						std::memcpy(&image.pixels[((size_t(by) * 4 + y) * width + bx * 4 + x) * 4], rgba + (y * 4 + x) * 4, 4);
+					}
+				}
+			}
+		}
+		return image;
+	}
+
+	// ֻͳƸøʽͨBC1ΪRGBBC5ΪRGΪRGBA
+	inline double ComputePsnr(const Image& reference, const Image& decoded, BlockFormat format)
+	{
+		uint32_t channel_mask = format == BlockFormat::BC1 ? 0x7u : (format == BlockFormat::BC5 ? 0x3u : 0xfu);
+		double error = 0.0;
+		uint64_t count = 0;
+		for (size_t i = 0; i < reference.pixels.size(); ++i)
+		{
+			if ((channel_mask >> (i & 3)) & 1)
+			{
+				double d = double(reference.pixels[i]) - double(decoded.pixels[i]);
+				error += d * d;
+				++count;
+			}
+		}
+		if (count == 0 || error == 0.0) return 99.0;
+		return 10.0 * std::log10(255.0 * 255.0 / (error / count));
+	}
+
+	// ѹ
+	struct EncodeStats
+	{
+		double seconds = 0.0;
+		double mpixels_per_second = 0.0;
+		double psnr = 0.0;
+	};
+
+	inline std::vector<uint8_t> EncodeImage(const Image& image, BlockFormat format, EncodeStats& stats, uint32_t thread_count = 0)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		std::vector<uint8_t> blocks = EncodeImage(image, format, thread_count);
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		stats.mpixels_per_second = stats.seconds > 0.0 ? double(image.width) * image.height / stats.seconds * 1e-6 : 0.0;
+		stats.psnr = ComputePsnr(image, DecodeImage(blocks, image.width, image.height, format), format);
+		return blocks;
+	}
+
+	// ---------------------------------------------------------------
+	// ļͷ + mip + 64KBƬеĿ
+	// Сmipǰ棬ÿmipҳ룬Եӳʽȡ
+	// ---------------------------------------------------------------
+
+	struct TextureFileHeader
+	{
+		char magic[4];
+		uint32_t version;
+		BlockFormat format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mip_count;
+		uint32_t srgb;
+		uint32_t reserved;
+	};
+
+	struct TextureMipEntry
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+		// һ64KBƬǵĿ
+		uint32_t tile_blocks_x;
+		uint32_t tile_blocks_y;
+	};
+
+	static const char m_texture_file_magic[4] = {'D', 'X', 'T', 'X'};
+	static const uint32_t m_texture_file_version = 1;
+	static const uint32_t m_texture_file_alignment = 4096;
+	static const uint32_t m_tile_size_in_bytes = 64 * 1024;
+
+	// D3D12׼Ƭ״һ£8ֽڿΪ128x64飬16ֽڿΪ64x64
+	inline void TileShapeInBlocks(BlockFormat format, uint32_t& tile_blocks_x, uint32_t& tile_blocks_y)
+	{
+		tile_blocks_x = BlockSize(format) == 8 ? 128u : 64u;
+		tile_blocks_y = 64u;
+	}
+
+	// ȵĿΪƬȣƬڲȣԵƬմ洢
+	inline std::vector<uint8_t> TileBlocks(const std::vector<uint8_t>& blocks, uint32_t blocks_x, uint32_t blocks_y, uint32_t block_size, uint32_t tile_blocks_x, uint32_t tile_blocks_y)
+	{
+		std::vector<uint8_t> tiled(blocks.size());
+		size_t offset = 0;
+		for (uint32_t ty = 0; ty < blocks_y; ty += tile_blocks_y)
+		{
+			for (uint32_t tx = 0; tx < blocks_x; tx += tile_blocks_x)
+			{
+				uint32_t width = std::min(tile_blocks_x, blocks_x - tx);
+				uint32_t height = std::min(tile_blocks_y, blocks_y - ty);
+				for (uint32_t y = 0; y < height; ++y)
+				{
+					std::memcpy(&tiled[offset], &blocks[(size_t(ty + y) * blocks_x + tx) * block_size], size_t(width) * block_size);
+					offset += size_t(width) * block_size;
+				}
+			}
+		}
+		return tiled;
+	}
+
+	// ļݣmips[0]Ϊ߷ֱ
+	inline std::vector<uint8_t> BuildTextureFile(const std::vector<Image>& mips, BlockFormat format, bool srgb, uint32_t thread_count = 0)
+	{
+		uint32_t mip_count = static_cast<uint32_t>(mips.size());
+		TextureFileHeader header{{'D', 'X', 'T', 'X'}, m_texture_file_version, format, mips[0].width, mips[0].height, mip_count, srgb ? 1u : 0u, 0};
+		std::vector<TextureMipEntry> entries(mip_count);
+		std::vector<std::vector<uint8_t>> mip_data(mip_count);
+
+		uint32_t block_size = BlockSize(format);
+		for (uint32_t i = 0; i < mip_count; ++i)
+		{
+			uint32_t blocks_x = (mips[i].width + 3) / 4;
+			uint32_t blocks_y = (mips[i].height + 3) / 4;
+			TextureMipEntry& entry = entries[i];
+			entry.width = mips[i].width;
+			entry.height = mips[i].height;
+			TileShapeInBlocks(format, entry.tile_blocks_x, entry.tile_blocks_y);
+			mip_data[i] = TileBlocks(EncodeImage(mips[i], format, thread_count), blocks_x, blocks_y, block_size, entry.tile_blocks_x, entry.tile_blocks_y);
+			entry.size = mip_data[i].size();
+		}
+
+		auto align = [](uint64_t value) { return (value + m_texture_file_alignment - 1) & ~uint64_t(m_texture_file_alignment - 1); };
+		uint64_t offset = align(sizeof(header) + sizeof(TextureMipEntry) * mip_count);
+		// СmipʼУȶݿʾ
+		for (uint32_t i = mip_count; i-- > 0;)
+		{
+			entries[i].offset = offset;
+			offset = align(offset + entries[i].size);
+		}
+
+		std::vector<uint8_t> file(offset, 0);
+		std::memcpy(file.data(), &header, sizeof(header));
+		std::memcpy(file.data() + sizeof(header), entries.data(), sizeof(TextureMipEntry) * mip_count);
+		for (uint32_t i = 0; i < mip_count; ++i)
+		{
+			std::memcpy(file.data() + entries[i].offset, mip_data[i].data(), mip_data[i].size());
+		}
+		return file;
+	}
+
+	// ڴ棨ӳļ
+	inline bool ParseTextureFile(const uint8_t* data, size_t size, TextureFileHeader& header, std::vector<TextureMipEntry>& entries)
+	{
+		if (size < sizeof(TextureFileHeader)) return false;
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.magic, m_texture_file_magic, 4) != 0 || header.version != m_texture_file_version) return false;
+		if (size < sizeof(header) + sizeof(TextureMipEntry) * size_t(header.mip_count)) return false;
+		entries.resize(header.mip_count);
+		std::memcpy(entries.data(), data + sizeof(header), sizeof(TextureMipEntry) * entries.size());
+		for (const TextureMipEntry& entry : entries)
+		{
+			if (entry.offset + entry.size > size) return false;
+		}
+		return true;
+	}
+}
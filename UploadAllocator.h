@@ -0,0 +1,181 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace BufferHelper
+{
+	// һγĽCPUַд룬GPUַڰ󶨸CBV
+	// Դƫڸ
+	struct ConstantAllocation
+	{
+		void* cpu_address;
+		D3D12_GPU_VIRTUAL_ADDRESS gpu_address;
+		size_t size;
+		ID3D12Resource* resource;
+		size_t offset;
+	};
+
+	// ÿ֡Էĳڳ־ӳϴҳ棬֡ҳ
+	class LinearConstantAllocator
+	{
+	public:
+		static const size_t m_default_page_size = 2 * 1024 * 1024;
+
+		// ÿηãǼ֮Żᱻдĳ
+		using AllocationCallback = std::function<void(const ConstantAllocation&)>;
+
+		void Initial(Microsoft::WRL::ComPtr<ID3D12Device10> device, size_t page_size = m_default_page_size)
+		{
+			m_device = device;
+			m_page_size = AlignUp(page_size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+		}
+
+		void SetAllocationCallback(AllocationCallback callback)
+		{
+			m_allocation_callback = std::move(callback);
+		}
+
+		// ֡ʼʱGPUѾʹϵҳ
+		void BeginFrame(uint64_t completed_fence_value)
+		{
+			while (!m_retired_pages.empty() && m_retired_pages.front().fence_value <= completed_fence_value)
+			{
+				Page& page = m_retired_pages.front();
+				// ҳ治ٸãֱͷ
+				if (page.size == m_page_size)
+				{
+					m_free_pages.push_back(std::move(page));
+				}
+				m_retired_pages.pop_front();
+			}
+		}
+
+		// 256ֽڶָ䣬ҳþʱŽ·
+		ConstantAllocation Allocate(size_t size)
+		{
+			size_t aligned_size = AlignUp(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+			if (m_current_offset + aligned_size > m_current_size)
+			{
+				NewPage(aligned_size);
+			}
+
+			ConstantAllocation allocation{m_current_cpu + m_current_offset, m_current_gpu + m_current_offset, aligned_size, m_current_resource, m_current_offset};
+			m_current_offset += aligned_size;
+			if (m_allocation_callback) m_allocation_callback(allocation);
+			return allocation;
+		}
+
+		// 䲢дһݳ
+		template <typename T>
+		ConstantAllocation Allocate(const T& data)
+		{
+			ConstantAllocation allocation = Allocate(sizeof(T));
+			std::memcpy(allocation.cpu_address, &data, sizeof(T));
+			return allocation;
+		}
+
+		// ֡ʱ֡ùҳ뱾֡ĸֵһ
+		void EndFrame(uint64_t fence_value)
+		{
+			for (Page& page : m_pages_in_use)
+			{
+				page.fence_value = fence_value;
+				m_retired_pages.push_back(std::move(page));
+			}
+			m_pages_in_use.clear();
+			m_current_resource = nullptr;
+			m_current_cpu = nullptr;
+			m_current_gpu = 0;
+			m_current_offset = 0;
+			m_current_size = 0;
+		}
+
+		size_t PageCount() const { return m_free_pages.size() + m_pages_in_use.size() + m_retired_pages.size(); }
+
+	private:
+		struct Page
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			uint8_t* cpu_address;
+			D3D12_GPU_VIRTUAL_ADDRESS gpu_address;
+			size_t size;
+			uint64_t fence_value;
+		};
+
+		static size_t AlignUp(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		void NewPage(size_t min_size)
+		{
+			// ȸÿҳ棬ҳС󵥶רҳ
+			if (min_size <= m_page_size && !m_free_pages.empty())
+			{
+				m_pages_in_use.push_back(std::move(m_free_pages.back()));
+				m_free_pages.pop_back();
+			}
+			else
+			{
+				m_pages_in_use.push_back(CreatePage(min_size > m_page_size ? min_size : m_page_size));
+			}
+
+			Page& page = m_pages_in_use.back();
+			m_current_resource = page.resource.Get();
+			m_current_cpu = page.cpu_address;
+			m_current_gpu = page.gpu_address;
+			m_current_offset = 0;
+			m_current_size = page.size;
+		}
+
+		Page CreatePage(size_t size)
+		{
+			// дϴ
+			D3D12_HEAP_PROPERTIES upload_heap_prop = {
+			D3D12_HEAP_TYPE_UPLOAD,
+			D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+			D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+			// дԴ
+			D3D12_RESOURCE_DESC upload_buffer_desc = {
+			D3D12_RESOURCE_DIMENSION_BUFFER,
+			0,
+			size,
+			1,
+			1,
+			1,
+			DXGI_FORMAT_UNKNOWN,
+			{1u,0u},
+			D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+			D3D12_RESOURCE_FLAG_NONE};
+
+			Page page{};
+			page.size = size;
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&upload_heap_prop, D3D12_HEAP_FLAG_NONE, &upload_buffer_desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(page.resource.GetAddressOf())));
+			// ϴѿһֱӳ䣬CPUֻд
+			D3D12_RANGE read_range{0, 0};
+			DxDebug::ThrowIfFailed(page.resource->Map(0, &read_range, reinterpret_cast<void**>(&page.cpu_address)));
+			page.gpu_address = page.resource->GetGPUVirtualAddress();
+			return page;
+		}
+
+		Microsoft::WRL::ComPtr<ID3D12Device10> m_device;
+		size_t m_page_size = m_default_page_size;
+
+		// ǰҳķα
+		ID3D12Resource* m_current_resource = nullptr;
+		uint8_t* m_current_cpu = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS m_current_gpu = 0;
+		size_t m_current_offset = 0;
+		size_t m_current_size = 0;
+
+		std::vector<Page> m_pages_in_use;
+		std::vector<Page> m_free_pages;
+		std::deque<Page> m_retired_pages;
+		AllocationCallback m_allocation_callback;
+	};
+}
@@ -1,3 +1,6 @@
+// shader: vs_6_0 main
+// permutation: INSTANCING 0 1
+
 struct ModelViewProjection
 {
     matrix MVP;
@@ -6,15 +9,41 @@ struct ModelViewProjection
 
 ConstantBuffer<ModelViewProjection> ModelViewProjectionCB : register(b0);
 
+struct ObjectConstants
+{
+    matrix Model;
+    float4 Color;
+};
+
+ConstantBuffer<ObjectConstants> ObjectConstantsCB : register(b1);
+
+#if INSTANCING
+struct InstanceData
+{
+    matrix MVP;
+    float4 Color;
+};
+
+struct InstanceRange
+{
+    uint Base;
+};
+
+StructuredBuffer<InstanceData> Instances : register(t0);
+ConstantBuffer<InstanceRange> InstanceRangeCB : register(b2);
+#endif
+
 struct Vertex
 {
     float3 Position : POSITION;
     float3 Color    : COLOR;
+    uint InstanceID : SV_InstanceID;
 };
 
 struct VertexShaderOutput
 {
 	float4 Color    : COLOR;
+    float3 ObjectPosition : TEXCOORD0;
     float4 Position : SV_Position;
 };
 
@@ -22,8 +51,15 @@ VertexShaderOutput main(Vertex IN)
 {
     VertexShaderOutput OUT;
 
+#if INSTANCING
+    InstanceData instance = Instances[InstanceRangeCB.Base + IN.InstanceID];
+    OUT.Position = mul(instance.MVP, float4(IN.Position, 1.0f));
+    OUT.Color = float4(IN.Color, 1.0f) * instance.Color;
+#else
     OUT.Position = mul(ModelViewProjectionCB.MVP, float4(IN.Position, 1.0f));
-    OUT.Color = float4(IN.Color, 1.0f);
+    OUT.Color = float4(IN.Color, 1.0f) * ObjectConstantsCB.Color;
+#endif
+    OUT.ObjectPosition = IN.Position;
 
     return OUT;
 }
@@ -0,0 +1,103 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ThreadHelper
+{
+	// ---------------------------------------------------------------
+	// פ̣߳߳ҲִУÿֻ֡һλѺһεȴ߳Ҳڴ
+	// ---------------------------------------------------------------
+
+	class WorkerPool
+	{
+	public:
+		using Job = void (*)(void* context, uint32_t worker);
+
+		~WorkerPool()
+		{
+			Stop();
+		}
+
+		// worker_countΪ0ʱʹӲ߳һϵ߳ռ
+		void Start(uint32_t worker_count = 0)
+		{
+			Stop();
+			if (worker_count == 0) worker_count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+			m_stop = false;
+			for (uint32_t worker = 0; worker < worker_count; ++worker)
+			{
+				m_workers.emplace_back([this, worker]() { WorkerLoop(worker + 1); });
+			}
+		}
+
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_start.notify_all();
+			for (std::thread& worker : m_workers) worker.join();
+			m_workers.clear();
+		}
+
+		uint32_t ThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+		// ִ߳job̵߳ıΪ0ʱȫ
+		void Run(Job job, void* context)
+		{
+			if (m_workers.empty())
+			{
+				job(context, 0);
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_job = job;
+				m_context = context;
+				m_running = static_cast<uint32_t>(m_workers.size());
+				++m_generation;
+			}
+			m_start.notify_all();
+			job(context, 0);
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [this]() { return m_running == 0; });
+		}
+
+	private:
+		void WorkerLoop(uint32_t worker)
+		{
+			uint64_t generation = 0;
+			for (;;)
+			{
+				Job job;
+				void* context;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_start.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+					if (m_stop) return;
+					generation = m_generation;
+					job = m_job;
+					context = m_context;
+				}
+				job(context, worker);
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_running == 0) m_done.notify_one();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_start;
+		std::condition_variable m_done;
+		Job m_job = nullptr;
+		void* m_context = nullptr;
+		uint32_t m_running = 0;
+		uint64_t m_generation = 0;
+		bool m_stop = false;
+	};
+}
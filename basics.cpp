@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <d3dx12/d3dx12.h>
 
 #if defined(CreateWindow)
@@ -99,6 +100,55 @@ namespace DxHelper
 	}
 }
 
+#include "BundleCache.h"
+#include "UploadAllocator.h"
+#include "AssetStreamer.h"
+#include "TextureCompressor.h"
+#include "ResidencyManager.h"
+#include "FramePacing.h"
+#include "SceneStore.h"
+#include "SpatialBvh.h"
+#include "DrawQueue.h"
+#include "MeshLod.h"
+#include "QueueScheduler.h"
+#include "ShaderArchive.h"
+#include "CommandTrace.h"
+#include "OcclusionCulling.h"
+#include "FrameMemory.h"
+
+// 滻ȫַ亯ͨöѷ䶼ӣǰ̵߳ıǩۼ
+void* operator new(size_t size)
+{
+	if (void* pointer = MemoryHelper::TrackedAllocate(size)) return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = MemoryHelper::TrackedAllocateAligned(size, static_cast<size_t>(alignment))) return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	MemoryHelper::TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	MemoryHelper::TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	MemoryHelper::TrackedFreeAligned(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+	MemoryHelper::TrackedFreeAligned(pointer);
+}
+
 bool m_use_warp = false;
 
 uint32_t m_client_width = 1280;
@@ -108,9 +158,10 @@ bool m_initialized = false;
 static const uint8_t m_back_buffer_count = 3;
 
 float m_fov;
+float m_near_plane = 0.1f;
+float m_far_plane = 100.0f;
 
-// ڹMVP
-XMMATRIX m_model_matrix;
+// ڹMVPģ;ɳеʵṩ
 XMMATRIX m_view_matrix;
 XMMATRIX m_projection_matrix;
 
@@ -120,6 +171,7 @@ bool m_content_loaded;
 D3D12_VIEWPORT m_viewport;
 D3D12_RECT m_scissor_rect;
 ComPtr<IDXGISwapChain4> m_swap_chain;
+ComPtr<IDXGIAdapter4> m_adapter;
 ComPtr<ID3D12Device10> m_device;
 ComPtr<ID3D12Resource2> m_back_buffers[m_back_buffer_count];
 ComPtr<ID3D12CommandAllocator> m_command_allocators[m_back_buffer_count];
@@ -132,9 +184,9 @@ UINT m_rtv_descriptor_size;
 
 // ӦԴ
 ComPtr<ID3D12Resource2> m_vertex_buffer;
-D3D12_VERTEX_BUFFER_VIEW m_vertex_buffer_view;
 ComPtr<ID3D12Resource2> m_index_buffer;
-D3D12_INDEX_BUFFER_VIEW m_index_buffer_view;
+ComPtr<ID3D12Resource2> m_sphere_vertex_buffer;
+ComPtr<ID3D12Resource2> m_sphere_index_buffer;
 ComPtr<ID3D12Resource2> m_depth_buffer;
 ComPtr<ID3D12DescriptorHeap> m_dsv_heap;
 
@@ -147,15 +199,178 @@ UINT64 m_fence_value;
 UINT64 m_frame_fence_values[m_back_buffer_count]{};
 
 // 
-bool m_vsync = true;
+PresentHelper::PresentMode m_present_mode = PresentHelper::PresentMode::VSync;
 bool m_tearing_supported = false;
 bool m_fullscreen = false;
-BOOL m_allow_tearing = false;
+// ֡Ŀ֡Ϊ0ʱʹʾˢ
+double m_fps_cap = 0.0;
+double m_refresh_rate = 60.0;
+PresentHelper::SystemClock m_pacing_clock;
+PresentHelper::FrameLimiter<PresentHelper::SystemClock> m_frame_limiter(m_pacing_clock);
 
 // Դ
 HWND m_hwnd;
 RECT m_window_rect;
 
+// ̬ƻ
+uint32_t m_object_count = 1;
+bool m_use_bundles = true;
+BundleHelper::BundleCache m_bundle_cache;
+// ʹbundleʱÿʵʵݵĵη䲻ᳬϴҳ
+const uint32_t m_bundle_instance_chunk = 4096;
+
+// mesh_idʵ屣ڰԭͷֿĳ洢
+std::vector<BundleHelper::StaticMesh> m_meshes;
+SceneHelper::SceneStore m_scene;
+SceneHelper::EntityHandle m_scene_root;
+
+// ĿռŶӦm_bvh_entitiesеʵ
+BvhHelper::DynamicBvh m_bvh;
+std::vector<SceneHelper::EntityHandle> m_bvh_entities;
+
+// ƶУɼ尴ύ߱m_pipelines
+std::vector<DrawHelper::PipelineBinding> m_pipelines;
+DrawHelper::DrawQueue m_draw_queue;
+DrawHelper::DrawStateStats m_draw_stats;
+
+// LODÿĸεǼУĻֵΪλ
+std::vector<LodHelper::LodChain> m_lod_chains;
+float m_lod_error_pixels = 1.0f;
+float m_lod_hysteresis = 0.25f;
+LodHelper::LodStats m_lod_stats;
+
+// CPUڵ޳õդڵ壬׶ڵٲΧУLOD
+struct OccluderProxy
+{
+	uint32_t mesh;
+	// İ߳ڰͶӰߴѡڵ
+	float extent;
+};
+OcclusionHelper::OcclusionCuller m_occlusion_culler;
+std::vector<OccluderProxy> m_occluder_proxies;
+uint32_t m_max_occluders = 32;
+bool m_use_occlusion = true;
+
+// ֡ڴ棺ÿ֡ʱб֡ڴԷ䣬֡ɺգ乳Ӱǩͳÿ֡ͨöѷ
+MemoryHelper::AllocationTracker m_allocation_tracker;
+MemoryHelper::FrameArena m_frame_arena;
+const uint32_t m_frame_tag = MemoryHelper::RegisterTag("Frame");
+const uint32_t m_bvh_rebuild_tag = MemoryHelper::RegisterTag("BvhRebuild", false);
+const uint32_t m_resize_tag = MemoryHelper::RegisterTag("Resize", false);
+bool m_check_allocations = false;
+uint64_t m_allocation_warmup_frames = 120;
+uint64_t m_allocation_violations = 0;
+
+// 첽жӣжӵ֡Ƶĸȴ֤
+ComPtr<ID3D12CommandQueue> m_compute_queue;
+ComPtr<ID3D12Fence1> m_compute_fence;
+UINT64 m_compute_fence_value = 0;
+bool m_use_async_compute = true;
+QueueHelper::FrameSchedule m_frame_schedule;
+std::vector<QueueHelper::Submission> m_submissions;
+QueueHelper::QueueTimer m_scene_timer;
+// ֡ͼеpass
+enum FramePass : uint32_t
+{
+	CullingPass,
+	ScenePass,
+	FrameEndPass,
+	FramePassCount,
+};
+
+// GPU׶޳ֻGPUʱ¼ƣڼжһ֡ĳƲУɼض
+QueueHelper::CommandContext m_culling_context;
+QueueHelper::QueueTimer m_culling_timer;
+ComPtr<ID3D12RootSignature> m_culling_root_signature;
+ComPtr<ID3D12PipelineState> m_culling_pipeline_state;
+ComPtr<ID3D12Resource2> m_culling_counter;
+ComPtr<ID3D12Resource2> m_culling_readback;
+uint32_t* m_culling_results = nullptr;
+uint32_t m_gpu_visible_count = 0;
+// ΧкͻݳפĬ϶ѣ任LOD仯ʱ壬ÿֻֿ֡ϴ
+ComPtr<ID3D12Resource2> m_culling_bounds;
+ComPtr<ID3D12Resource2> m_culling_objects;
+std::vector<uint8_t> m_culling_dirty;
+uint32_t m_culling_dirty_first = UINT32_MAX;
+uint32_t m_culling_dirty_last = 0;
+uint64_t m_culling_upload_bytes = 0;
+// ÿϴ֤ÿη䶼ڳͨҳ
+const uint32_t m_culling_upload_chunk = 4096;
+// GPUƣ޳passдʵݺͼӲpassȴ޳ÿLODһExecuteIndirect
+// پCPU׶ѯڵ޳ͻƶУÿʵ䰴UpdateLodsͳƵ
+bool m_use_gpu_driven = false;
+ComPtr<ID3D12RootSignature> m_instanced_root_signature;
+ComPtr<ID3D12PipelineState> m_instanced_pipeline_state;
+ComPtr<ID3D12CommandSignature> m_draw_signature;
+std::vector<uint32_t> m_mesh_object_counts;
+// ʵݺͼӲ֡ʹݣ޳ֻȴ֮֡ǰĳpassһ֡Ļص
+static const uint32_t m_culling_output_count = 2;
+ComPtr<ID3D12Resource2> m_draw_arguments[m_culling_output_count];
+ComPtr<ID3D12Resource2> m_culled_instances[m_culling_output_count];
+uint32_t m_culling_output = 0;
+
+// ÿ֡
+BufferHelper::LinearConstantAllocator m_constant_allocator;
+bool m_bench_constants = false;
+
+// 첽Դ
+StreamHelper::AssetStreamer m_asset_streamer;
+
+// Ԥɫй鵵tools/ShaderBuilder
+ShaderHelper::ShaderArchive m_shader_archive;
+
+// ȴӹ鵵ӳֽ룬鵵ȱʧʱ˵ȡcsoļ
+struct ShaderLoad
+{
+	ShaderHelper::ShaderBytecode archived{};
+	std::vector<uint8_t> bytecode;
+	std::future<size_t> request;
+
+	void Request(const std::string& shader, const std::vector<ShaderHelper::ShaderDefine>& defines, const wchar_t* fallback_cso)
+	{
+		archived = m_shader_archive.Find(shader, defines);
+		if (!archived.data)
+		{
+			request = m_asset_streamer.Request(fallback_cso, 1, bytecode);
+		}
+	}
+
+	D3D12_SHADER_BYTECODE Get()
+	{
+		if (archived.data)
+		{
+			return {archived.data, archived.size};
+		}
+		request.get();
+		return {bytecode.data(), bytecode.size()};
+	}
+};
+
+// ʽԴפ
+ResidencyHelper::ResidencyManager m_residency_manager;
+// ʽڼ䱣--textureָļtools/TextureBench --outʱ決
+// ٸʽԤԴʱ
+std::wstring m_streamed_texture_path;
+std::vector<uint8_t> m_streamed_texture_file;
+uint32_t m_streamed_texture = UINT32_MAX;
+uint32_t m_streamed_pipeline = UINT32_MAX;
+uint32_t m_streamed_chain = UINT32_MAX;
+ComPtr<ID3D12PipelineState> m_streamed_pipeline_state;
+// ɫɼѣ0ΪʽSRV1ΪmipUAV
+ComPtr<ID3D12DescriptorHeap> m_streaming_heap;
+// ɫдСmipÿ֡Ϊ0xffffffffƺƵ֡Ļضλ
+ComPtr<ID3D12Resource2> m_mip_feedback;
+ComPtr<ID3D12Resource2> m_mip_feedback_readback;
+uint32_t* m_mip_feedback_results = nullptr;
+bool m_mip_feedback_pending[m_back_buffer_count]{};
+
+// ͻطţļӦ豸ϻطţҲtools/TraceReplay߻ط
+TraceHelper::CommandCapture m_command_capture;
+std::wstring m_capture_path;
+uint32_t m_capture_frames = 300;
+std::wstring m_replay_path;
+uint32_t m_replay_loops = 1;
+
 
 // ṹ
 struct Vertex
@@ -187,11 +402,237 @@ static WORD g_Indicies[36] =
     4, 0, 3, 4, 3, 7
 };
 
+// ɵλһ㣬߷βӣûظ㣬ǷյΣɫȡλ
+void GenerateSphere(uint32_t slices, uint32_t stacks, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	auto add_vertex = [&vertices](float x, float y, float z)
+	{
+		vertices.push_back({XMFLOAT3(x, y, z), XMFLOAT3(x * 0.5f + 0.5f, y * 0.5f + 0.5f, z * 0.5f + 0.5f)});
+	};
+	add_vertex(0.0f, 1.0f, 0.0f);
+	for (uint32_t stack = 1; stack < stacks; ++stack)
+	{
+		float theta = XM_PI * stack / stacks;
+		for (uint32_t slice = 0; slice < slices; ++slice)
+		{
+			float phi = XM_2PI * slice / slices;
+			add_vertex(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+		}
+	}
+	add_vertex(0.0f, -1.0f, 0.0f);
+	uint32_t south_pole = static_cast<uint32_t>(vertices.size() - 1);
+
+	// ˳ʱΪ
+	auto ring = [slices](uint32_t stack, uint32_t slice) { return 1 + (stack - 1) * slices + slice % slices; };
+	for (uint32_t slice = 0; slice < slices; ++slice)
+	{
+		indices.insert(indices.end(), {0u, ring(1, slice + 1), ring(1, slice)});
+	}
+	for (uint32_t stack = 1; stack + 1 < stacks; ++stack)
+	{
+		for (uint32_t slice = 0; slice < slices; ++slice)
+		{
+			uint32_t a = ring(stack, slice), b = ring(stack, slice + 1), c = ring(stack + 1, slice), d = ring(stack + 1, slice + 1);
+			indices.insert(indices.end(), {a, b, c, b, d, c});
+		}
+	}
+	for (uint32_t slice = 0; slice < slices; ++slice)
+	{
+		indices.insert(indices.end(), {south_pole, ring(stacks - 1, slice), ring(stacks - 1, slice + 1)});
+	}
+}
+
+// ÿƵĳݣͨCBV󶨣ܸС
+struct ObjectConstants
+{
+	XMMATRIX model_matrix;
+	XMFLOAT4 color;
+};
+
+// GPU޳ĸ׶ƽ
+struct CullingConstants
+{
+	float view_projection[4][4];
+	float planes[6][4];
+	uint32_t object_count;
+};
+
+// ޳ʹõݣObjectCulling.hlslеĽṹһ
+struct CullingBounds
+{
+	XMFLOAT4 min;
+	XMFLOAT4 max;
+};
+
+struct CullingObject
+{
+	XMFLOAT4X4 world;
+	XMFLOAT4 color;
+	uint32_t mesh;
+	uint32_t padding[3];
+};
+
+// ޳дʵVertexShader.hlslINSTANCINGеInstanceDataһ
+struct CulledInstance
+{
+	XMFLOAT4X4 mvp;
+	XMFLOAT4 color;
+};
+
+// ÿһӻƣʵĸٻ
+struct IndirectDraw
+{
+	uint32_t instance_base;
+	D3D12_DRAW_INDEXED_ARGUMENTS draw;
+};
+
 const XMVECTOR rotation_axis = XMVectorSet(0, 1, 1, 0);
 const XMVECTOR eye_position = XMVectorSet(0, 0, -10, 1);
 const XMVECTOR focus_point = XMVectorSet(0, 0, 0, 1);
 const XMVECTOR up_direction = XMVectorSet(0, 1, 0, 0);
 
+// ʵ壺һڵ㣬Ϊӽڵ㰴Уֻһʱλԭ
+// żŵʹ÷壬ŵʹ壬ΪԵLOD
+void CreateSceneEntities(uint32_t cube_chain, uint32_t sphere_chain)
+{
+	using namespace SceneHelper;
+	m_scene_root = m_scene.Create(MaskOf<LocalTransform, WorldMatrix>());
+
+	uint32_t grid_size = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(m_object_count))));
+	float grid_offset = (grid_size - 1) * 1.5f;
+	for (uint32_t i = 0; i < m_object_count; ++i)
+	{
+		EntityHandle entity = m_scene.Create(MaskOf<LocalTransform, WorldMatrix, MeshInstance, Spin, SpatialProxy, MeshLod>(), m_scene_root);
+		LocalTransform local{};
+		local.position = {(i % grid_size) * 3.0f - grid_offset, ((i / grid_size) % grid_size) * 3.0f - grid_offset, (i / (grid_size * grid_size)) * 3.0f - grid_offset};
+		local.scale = 1.0f;
+		local.rotation = {0.0f, 0.0f, 0.0f, 1.0f};
+		m_scene.SetLocalTransform(entity, local);
+		// ϸһʼ֮ÿ֡Ļѡ
+		uint32_t chain = i % 2 ? sphere_chain : cube_chain;
+		*m_scene.Get<MeshLod>(entity) = {chain, 0};
+		*m_scene.Get<MeshInstance>(entity) = {m_lod_chains[chain].first_mesh_id, {1.0f, 1.0f, 1.0f, 1.0f}};
+		// ÿתתһȦ
+		*m_scene.Get<Spin>(entity) = {{XMVectorGetX(rotation_axis), XMVectorGetY(rotation_axis), XMVectorGetZ(rotation_axis)}, XM_2PI};
+		// ͵λĶ㷶Χ[-1, 1]
+		*m_scene.Get<SpatialProxy>(entity) = {{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}, static_cast<uint32_t>(m_bvh_entities.size())};
+		m_bvh_entities.push_back(entity);
+	}
+	m_scene.UpdateTransforms();
+
+	// óʼΧйռ
+	std::vector<BvhHelper::Aabb> bounds(m_bvh_entities.size());
+	m_scene.ForEachChunk<WorldMatrix, SpatialProxy>([&](ChunkView& view)
+		{
+			const WorldMatrix* worlds = view.Column<WorldMatrix>();
+			const SpatialProxy* proxies = view.Column<SpatialProxy>();
+			for (uint32_t row = 0; row < view.count; ++row)
+			{
+				BvhHelper::Aabb local{{proxies[row].local_min.x, proxies[row].local_min.y, proxies[row].local_min.z}, {proxies[row].local_max.x, proxies[row].local_max.y, proxies[row].local_max.z}};
+				bounds[proxies[row].object] = BvhHelper::TransformAabb(local, worlds[row].m);
+			}
+		});
+	m_bvh.Build(bounds);
+
+	// һ֡ϴȫ
+	m_culling_dirty.assign(m_bvh_entities.size(), 1);
+	m_culling_dirty_first = 0;
+	m_culling_dirty_last = static_cast<uint32_t>(m_bvh_entities.size() - 1);
+}
+
+// GPU޳Ҫϴ
+void MarkCullingDirty(uint32_t object)
+{
+	if (!m_use_gpu_driven) return;
+	m_culling_dirty[object] = 1;
+	m_culling_dirty_first = std::min(m_culling_dirty_first, object);
+	m_culling_dirty_last = std::max(m_culling_dirty_last, object);
+}
+
+// ѱб仯ʵͬռrefit̨ؽ
+void UpdateSpatialIndex()
+{
+	using namespace SceneHelper;
+	uint32_t version = m_scene.TransformVersion();
+	m_scene.ForEachChunk<WorldMatrix, SpatialProxy>([&](ChunkView& view)
+		{
+			const WorldMatrix* worlds = view.Column<WorldMatrix>();
+			const SpatialProxy* proxies = view.Column<SpatialProxy>();
+			for (uint32_t row = 0; row < view.count; ++row)
+			{
+				if (view.versions[row] != version) continue;
+				BvhHelper::Aabb local{{proxies[row].local_min.x, proxies[row].local_min.y, proxies[row].local_min.z}, {proxies[row].local_max.x, proxies[row].local_max.y, proxies[row].local_max.z}};
+				m_bvh.Update(proxies[row].object, BvhHelper::TransformAabb(local, worlds[row].m));
+				MarkCullingDirty(proxies[row].object);
+			}
+		});
+	m_bvh.Refit();
+	// պ̨ؽḴưΧУżķ
+	MemoryHelper::AllocationScope rebuild_scope(m_bvh_rebuild_tag);
+	m_bvh.Maintain();
+}
+
+// ͶӰĻļΪÿʵѡLODдMeshInstance
+void UpdateLods()
+{
+	using namespace SceneHelper;
+	// λ봦һλȶӦ
+	float pixel_scale = XMVectorGetY(m_projection_matrix.r[1]) * m_client_height * 0.5f;
+	XMFLOAT3 eye;
+	XMStoreFloat3(&eye, eye_position);
+	m_lod_stats = {};
+	std::fill(m_mesh_object_counts.begin(), m_mesh_object_counts.end(), 0u);
+	m_scene.ForEachChunk<WorldMatrix, MeshInstance, MeshLod, SpatialProxy>([&](ChunkView& view)
+		{
+			const WorldMatrix* worlds = view.Column<WorldMatrix>();
+			MeshInstance* instances = view.Column<MeshInstance>();
+			MeshLod* lods = view.Column<MeshLod>();
+			const SpatialProxy* proxies = view.Column<SpatialProxy>();
+			for (uint32_t row = 0; row < view.count; ++row)
+			{
+				const LodHelper::LodChain& chain = m_lod_chains[lods[row].chain];
+				const float (*m)[4] = worlds[row].m;
+				float dx = m[3][0] - eye.x, dy = m[3][1] - eye.y, dz = m[3][2] - eye.z;
+				float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+				// ȱţȡһеĳ
+				float scale = std::sqrt(m[0][0] * m[0][0] + m[0][1] * m[0][1] + m[0][2] * m[0][2]);
+				uint32_t level = LodHelper::SelectLod(chain, scale, distance, pixel_scale, lods[row].level, m_lod_error_pixels, m_lod_hysteresis);
+				if (level != lods[row].level)
+				{
+					++m_lod_stats.switches;
+					// GPUưеŷ
+					MarkCullingDirty(proxies[row].object);
+				}
+				lods[row].level = level;
+				instances[row].mesh_id = chain.first_mesh_id + level;
+				++m_mesh_object_counts[instances[row].mesh_id];
+				m_lod_stats.triangles += chain.levels[level].index_count / 3;
+				m_lod_stats.full_triangles += chain.levels[0].index_count / 3;
+			}
+		});
+}
+
+
+// ֡ȣ޳볡ûֵжӺԲУ֡ǰͼжӵȴ֡޳
+// ͼжӵ֡жӵĹϴҳĻշʽҪı
+void BuildFrameSchedule()
+{
+	using namespace QueueHelper;
+	std::vector<PassDesc> passes(FramePassCount);
+	passes[CullingPass] = {L"Culling", m_use_async_compute ? QueueType::Compute : QueueType::Graphics, {}};
+	passes[ScenePass] = {L"Scene", QueueType::Graphics, {}};
+	if (m_use_gpu_driven)
+	{
+		// passƱ֡޳޳дǷ֡ǰpassȡ
+		passes[ScenePass].dependencies.push_back({CullingPass, 0});
+		passes[CullingPass].dependencies.push_back({ScenePass, m_culling_output_count});
+	}
+	passes[FrameEndPass] = {L"FrameEnd", QueueType::Graphics, {{CullingPass, 0}}};
+	bool built = m_frame_schedule.Build(passes);
+	assert(built && "frame schedule has a dependency cycle.");
+}
 
 namespace BufferHelper
 {
@@ -253,27 +694,142 @@ namespace BufferHelper
 
 			// d3dx12⣬ʹϴем仺CPUϴĬ϶еGPUԴ
 			UpdateSubresources(command_list.Get(), *p_destination_resource, *p_intermediate_resource, 0, 0, 1, &subresource_data);
+			// UpdateSubresourcesֱ¼бϣѵȼ۵д͸Ʋǽ
+			m_command_capture.WriteBuffer(*p_intermediate_resource, 0, buffer_data, buffer_size);
+			m_command_capture.Describe(command_list.Get()).CopyBufferRegion(*p_destination_resource, 0, *p_intermediate_resource, 0, buffer_size);
 		}
 	}
 
+	// LODϴö㻺ƴһ16λУÿһǼΪеһ
+	uint32_t CreateLodMesh(ComPtr<ID3D12GraphicsCommandList9> command_list, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+		ComPtr<ID3D12Resource2>& vertex_buffer, ComPtr<ID3D12Resource2>& index_buffer, std::vector<ComPtr<ID3D12Resource2>>& intermediate_buffers)
+	{
+		LodHelper::LodChain chain = LodHelper::BuildLodChain(&vertices[0].position.x, vertices.size(), sizeof(Vertex), indices);
+		chain.first_mesh_id = static_cast<uint32_t>(m_meshes.size());
+		std::vector<WORD> index_data(chain.indices.begin(), chain.indices.end());
+
+		// ϴԴм仺Ҫбִ
+		intermediate_buffers.emplace_back();
+		UpdateBufferResource(command_list, &vertex_buffer, &intermediate_buffers.back(), vertices.size(), sizeof(Vertex), vertices.data());
+		intermediate_buffers.emplace_back();
+		UpdateBufferResource(command_list, &index_buffer, &intermediate_buffers.back(), index_data.size(), sizeof(WORD), index_data.data());
+
+		// ͼмͼֻͬ䲻ͬ
+		BundleHelper::StaticMesh mesh{};
+		mesh.vertex_buffer = vertex_buffer.Get();
+		mesh.index_buffer = index_buffer.Get();
+		mesh.vertex_buffer_view.BufferLocation = vertex_buffer->GetGPUVirtualAddress();
+		mesh.vertex_buffer_view.SizeInBytes = static_cast<UINT>(vertices.size() * sizeof(Vertex));
+		mesh.vertex_buffer_view.StrideInBytes = sizeof(Vertex);
+		mesh.index_buffer_view.BufferLocation = index_buffer->GetGPUVirtualAddress();
+		mesh.index_buffer_view.Format = DXGI_FORMAT_R16_UINT;
+		mesh.index_buffer_view.SizeInBytes = static_cast<UINT>(index_data.size() * sizeof(WORD));
+		mesh.topology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+		for (const LodHelper::LodLevel& level : chain.levels)
+		{
+			mesh.mesh_id = static_cast<uint32_t>(m_meshes.size());
+			mesh.start_index = level.index_offset;
+			mesh.index_count = level.index_count;
+			m_meshes.push_back(mesh);
+		}
+
+		// ͼ
+		wchar_t buffer[256];
+		for (size_t level = 0; level < chain.levels.size(); ++level)
+		{
+			swprintf_s(buffer, L"Lod chain %zu level %zu: %u triangles (%.1f%%), error %.5f\n", m_lod_chains.size(), level,
+				chain.levels[level].index_count / 3, 100.0 * chain.levels[level].index_count / chain.levels[0].index_count, chain.levels[level].error);
+			OutputDebugString(buffer);
+		}
+		swprintf_s(buffer, L"Lod chain %zu: built in %.2f ms\n", m_lod_chains.size(), chain.build_seconds * 1e3);
+		OutputDebugString(buffer);
+
+		m_lod_chains.push_back(std::move(chain));
+		return static_cast<uint32_t>(m_lod_chains.size() - 1);
+	}
+
+	// 決̸ϸбƣϸһֱ쵽mip 0gammaȷKaiser mipѹΪBC1
+	std::vector<uint8_t> BakeStreamedTexture(uint32_t size)
+	{
+		TextureHelper::Image image;
+		image.width = size;
+		image.height = size;
+		image.pixels.resize(size_t(size) * size * 4);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				uint8_t* pixel = &image.pixels[(size_t(y) * size + x) * 4];
+				bool checker = ((x / 128) ^ (y / 128)) & 1;
+				uint8_t stripe = ((x + y) / 4) % 2 ? 40 : 0;
+				pixel[0] = static_cast<uint8_t>(checker ? 230 - stripe : 60 + stripe);
+				pixel[1] = static_cast<uint8_t>(checker ? 200 - stripe : 90 + stripe);
+				pixel[2] = static_cast<uint8_t>(checker ? 120 : 160);
+				pixel[3] = 255;
+			}
+		}
+		std::vector<TextureHelper::Image> mips = TextureHelper::GenerateMipChain(image, TextureHelper::MipFilter::Kaiser, true);
+		return TextureHelper::BuildTextureFile(mips, TextureHelper::BlockFormat::BC1, true);
+	}
+
 	// ȾԴ
 	bool LoadContent()
 	{
-		// ϴ㻺Դ
-		ComPtr<ID3D12Resource2> intermediate_vertex_buffer;
-		UpdateBufferResource(m_command_list.Get(), &m_vertex_buffer, &intermediate_vertex_buffer, _countof(g_Vertices), sizeof(Vertex), g_Vertices);
-		// 㻺ͼ
-		m_vertex_buffer_view.BufferLocation = m_vertex_buffer->GetGPUVirtualAddress();
-		m_vertex_buffer_view.SizeInBytes = sizeof(g_Vertices);
-		m_vertex_buffer_view.StrideInBytes = sizeof(Vertex);
-
-		// ϴԴ
-		ComPtr<ID3D12Resource2> intermediate_index_buffer;
-		UpdateBufferResource(m_command_list.Get(), &m_index_buffer, &intermediate_index_buffer, _countof(g_Indicies), sizeof(WORD), g_Indicies);
-		// ͼ
-		m_index_buffer_view.BufferLocation = m_index_buffer->GetGPUVirtualAddress();
-		m_index_buffer_view.Format = DXGI_FORMAT_R16_UINT;
-		m_index_buffer_view.SizeInBytes = sizeof(g_Indicies);
+		// ӳshader鵵鵵ûезȡ뻺ϴн
+		bool archive_opened = m_shader_archive.Open(L"Shaders.dxsa");
+		ShaderLoad vertex_shader;
+		ShaderLoad pixel_shader;
+		vertex_shader.Request("VertexShader", {{"INSTANCING", "0"}}, L"VertexShader.cso");
+		pixel_shader.Request("PixelShader", {}, L"PixelShader.cso");
+		// GPU޳ֻGPUƣʵGPUƺbundle
+		ShaderLoad culling_shader;
+		ShaderLoad instanced_vertex_shader;
+		if (m_use_gpu_driven)
+		{
+			culling_shader.Request("ObjectCulling", {}, L"ObjectCulling.cso");
+		}
+		if (m_use_gpu_driven || m_use_bundles)
+		{
+			instanced_vertex_shader.Request("VertexShader", {{"INSTANCING", "1"}}, L"VertexShaderInstanced.cso");
+		}
+		// ʽҪԤԴʱ
+		D3D12_FEATURE_DATA_D3D12_OPTIONS options{};
+		bool use_streaming = m_capture_path.empty() && SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) &&
+			options.TiledResourcesTier != D3D12_TILED_RESOURCES_TIER_NOT_SUPPORTED;
+		ShaderLoad streamed_pixel_shader;
+		std::future<size_t> texture_request;
+		if (use_streaming)
+		{
+			streamed_pixel_shader.Request("StreamedPixelShader", {}, L"StreamedPixelShader.cso");
+			if (!m_streamed_texture_path.empty())
+			{
+				texture_request = m_asset_streamer.Request(m_streamed_texture_path, 1, m_streamed_texture_file);
+			}
+		}
+
+		// ɷLODϴ仯ʱbundleԶ¼
+		std::vector<ComPtr<ID3D12Resource2>> intermediate_buffers;
+		std::vector<Vertex> cube_vertices(g_Vertices, g_Vertices + _countof(g_Vertices));
+		std::vector<uint32_t> cube_indices(g_Indicies, g_Indicies + _countof(g_Indicies));
+		uint32_t cube_chain = CreateLodMesh(m_command_list, cube_vertices, cube_indices, m_vertex_buffer, m_index_buffer, intermediate_buffers);
+		std::vector<Vertex> sphere_vertices;
+		std::vector<uint32_t> sphere_indices;
+		GenerateSphere(64, 32, sphere_vertices, sphere_indices);
+		uint32_t sphere_chain = CreateLodMesh(m_command_list, sphere_vertices, sphere_indices, m_sphere_vertex_buffer, m_sphere_index_buffer, intermediate_buffers);
+		CreateSceneEntities(cube_chain, sphere_chain);
+
+		// ڵģڲС0.9ڽӷ壬ϸֺLOD
+		m_occlusion_culler.Initial();
+		auto add_occluder_proxy = [](float extent)
+		{
+			std::vector<XMFLOAT3> positions;
+			for (const Vertex& vertex : g_Vertices) positions.push_back(XMFLOAT3(vertex.position.x * extent, vertex.position.y * extent, vertex.position.z * extent));
+			std::vector<uint32_t> indices(g_Indicies, g_Indicies + _countof(g_Indicies));
+			return OccluderProxy{m_occlusion_culler.AddMesh(&positions[0].x, sizeof(XMFLOAT3), positions.size(), indices.data(), indices.size()), extent};
+		};
+		m_occluder_proxies.resize(m_lod_chains.size());
+		m_occluder_proxies[cube_chain] = add_occluder_proxy(1.0f);
+		m_occluder_proxies[sphere_chain] = add_occluder_proxy(0.9f / std::sqrt(3.0f));
 
 		// дdsvdsv
 		D3D12_DESCRIPTOR_HEAP_DESC dsv_heap_desc{};
@@ -281,12 +837,11 @@ namespace BufferHelper
 		dsv_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
 		dsv_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 		DxDebug::ThrowIfFailed(m_device->CreateDescriptorHeap(&dsv_heap_desc, IID_PPV_ARGS(m_dsv_heap.GetAddressOf())));
+		m_command_capture.DescriptorHeap(m_dsv_heap.Get());
 
-		// õshader
-		ComPtr<ID3DBlob> vertex_blob;
-		DxDebug::ThrowIfFailed(D3DReadFileToBlob(L"VertexShader.cso", &vertex_blob));
-		ComPtr<ID3DBlob> pixel_blob;
-		DxDebug::ThrowIfFailed(D3DReadFileToBlob(L"PixelShader.cso", &pixel_blob));
+		// ȴõshaderȡ
+		D3D12_SHADER_BYTECODE vertex_shader_bytecode = vertex_shader.Get();
+		D3D12_SHADER_BYTECODE pixel_shader_bytecode = pixel_shader.Get();
 		
 		// 벼
 		D3D12_INPUT_ELEMENT_DESC input_layout[] = {
@@ -302,13 +857,12 @@ namespace BufferHelper
 			feature_data.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
 		}
 
-		// 벼ֲܾҪķ
+		// 벼ֲܾҪķʣɫҪʽ
 		D3D12_ROOT_SIGNATURE_FLAGS root_signature_flags =
 			D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
 			D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
 			D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
-			D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS |
-			D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS;
+			D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
 
 		// 
 		D3D12_ROOT_CONSTANTS root_constants{};
@@ -316,19 +870,47 @@ namespace BufferHelper
 		root_constants.ShaderRegister = 0;
 		root_constants.RegisterSpace = 0;
 		// ʼΪ32س
-		D3D12_ROOT_PARAMETER1 root_parameters[1];
+		D3D12_ROOT_PARAMETER1 root_parameters[4];
 		root_parameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
 		root_parameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 		root_parameters[0].DescriptorTable.NumDescriptorRanges = 1;
 		root_parameters[0].Constants = root_constants;
+		// ÿƵĳʹøCBVֱӰGPUַ
+		root_parameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+		root_parameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+		root_parameters[1].Descriptor.ShaderRegister = 1;
+		root_parameters[1].Descriptor.RegisterSpace = 0;
+		root_parameters[1].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+		// ʽSRVmipUAVͬһУλspace1ӰֻǰĹ
+		D3D12_DESCRIPTOR_RANGE1 streaming_ranges[2] = {
+			{D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE, 0},
+			{D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 1},
+		};
+		root_parameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+		root_parameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+		root_parameters[2].DescriptorTable = {_countof(streaming_ranges), streaming_ranges};
+		// źפϸmip
+		root_parameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+		root_parameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+		root_parameters[3].Constants = {0, 1, 2};
+		// ʽԲ
+		D3D12_STATIC_SAMPLER_DESC streaming_sampler{};
+		streaming_sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+		streaming_sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+		streaming_sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+		streaming_sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+		streaming_sampler.MaxLOD = D3D12_FLOAT32_MAX;
+		streaming_sampler.ShaderRegister = 0;
+		streaming_sampler.RegisterSpace = 1;
+		streaming_sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
 
 		// дǩ
 		D3D12_ROOT_SIGNATURE_DESC1 root_signature_desc{};
 		root_signature_desc.Flags = root_signature_flags;
 		root_signature_desc.NumParameters = _countof(root_parameters);
 		root_signature_desc.pParameters = root_parameters;
-		root_signature_desc.NumStaticSamplers = 0;
-		root_signature_desc.pStaticSamplers = nullptr;
+		root_signature_desc.NumStaticSamplers = 1;
+		root_signature_desc.pStaticSamplers = &streaming_sampler;
 		// ȷ汾
 		D3D12_VERSIONED_ROOT_SIGNATURE_DESC versioned_desc{};
 		versioned_desc.Version = D3D_ROOT_SIGNATURE_VERSION_1_1;
@@ -342,6 +924,7 @@ namespace BufferHelper
 			DxDebug::ThrowIfFailed(D3D12SerializeVersionedRootSignature(&versioned_desc, root_signature_blob.GetAddressOf(), error_blob.GetAddressOf()));
 		// ǩ
 			DxDebug::ThrowIfFailed(m_device->CreateRootSignature(0, root_signature_blob->GetBufferPointer(), root_signature_blob->GetBufferSize(), IID_PPV_ARGS(m_root_signature.GetAddressOf())));
+			m_command_capture.RootSignature(m_root_signature.Get(), root_signature_blob->GetBufferPointer(), root_signature_blob->GetBufferSize());
 		}
 		catch (std::exception e)
 		{
@@ -369,25 +952,187 @@ namespace BufferHelper
 		pipeline_state_stream.p_root_signature = m_root_signature.Get();
 		pipeline_state_stream.input_layout = {input_layout, _countof(input_layout)};
 		pipeline_state_stream.primitive_topology_type = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-		pipeline_state_stream.VS = CD3DX12_SHADER_BYTECODE(vertex_blob.Get());
-		pipeline_state_stream.PS = CD3DX12_SHADER_BYTECODE(pixel_blob.Get());
+		pipeline_state_stream.VS = CD3DX12_SHADER_BYTECODE(vertex_shader_bytecode);
+		pipeline_state_stream.PS = CD3DX12_SHADER_BYTECODE(pixel_shader_bytecode);
 		pipeline_state_stream.dsv_format = DXGI_FORMAT_D32_FLOAT;
 		pipeline_state_stream.rtv_formats = rtv_format;
 		// ߶
 		D3D12_PIPELINE_STATE_STREAM_DESC pipeline_state_stream_desc{sizeof(PipelineStateStream), &pipeline_state_stream};
 		DxDebug::ThrowIfFailed(m_device->CreatePipelineState(&pipeline_state_stream_desc, IID_PPV_ARGS(m_pipeline_state.GetAddressOf())));
+		m_command_capture.GraphicsPipeline(m_pipeline_state.Get(), m_root_signature.Get(), input_layout, _countof(input_layout), D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+			vertex_shader_bytecode, pixel_shader_bytecode, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_D32_FLOAT);
+		// Ǽǵ߱ưеĹ߱żе
+		m_pipelines.push_back({m_pipeline_state.Get(), m_root_signature.Get()});
 
-		DxDebug::ThrowIfFailed(m_command_list->Close());
+		if (use_streaming)
+		{
+			// òʽдmipɫ
+			pipeline_state_stream.PS = CD3DX12_SHADER_BYTECODE(streamed_pixel_shader.Get());
+			DxDebug::ThrowIfFailed(m_device->CreatePipelineState(&pipeline_state_stream_desc, IID_PPV_ARGS(m_streamed_pipeline_state.GetAddressOf())));
+			m_streamed_pipeline = static_cast<uint32_t>(m_pipelines.size());
+			m_pipelines.push_back({m_streamed_pipeline_state.Get(), m_root_signature.Get()});
+			m_streamed_chain = sphere_chain;
+
+			// Ԥpacked mip¼ڴ򿪵бһϴ
+			if (texture_request.valid())
+			{
+				texture_request.get();
+			}
+			if (m_streamed_texture_file.empty())
+			{
+				m_streamed_texture_file = BakeStreamedTexture(2048);
+			}
+			m_streamed_texture = m_residency_manager.RegisterTexture(m_streamed_texture_file.data(), m_streamed_texture_file.size(), m_command_list.Get(), m_constant_allocator);
+
+			// mip󻺳ÿһuintضÿ֡һλ
+			uint32_t texture_count = m_residency_manager.Policy().TextureCount();
+			D3D12_HEAP_PROPERTIES feedback_heap_prop = {D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+			D3D12_RESOURCE_DESC feedback_desc = {D3D12_RESOURCE_DIMENSION_BUFFER, 0, texture_count * sizeof(uint32_t), 1, 1, 1, DXGI_FORMAT_UNKNOWN, {1u, 0u}, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS};
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&feedback_heap_prop, D3D12_HEAP_FLAG_NONE, &feedback_desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(m_mip_feedback.GetAddressOf())));
+			D3D12_HEAP_PROPERTIES feedback_readback_heap_prop = {D3D12_HEAP_TYPE_READBACK, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+			D3D12_RESOURCE_DESC feedback_readback_desc = {D3D12_RESOURCE_DIMENSION_BUFFER, 0, m_back_buffer_count * texture_count * sizeof(uint32_t), 1, 1, 1, DXGI_FORMAT_UNKNOWN, {1u, 0u}, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, D3D12_RESOURCE_FLAG_NONE};
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&feedback_readback_heap_prop, D3D12_HEAP_FLAG_NONE, &feedback_readback_desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_mip_feedback_readback.GetAddressOf())));
+			DxDebug::ThrowIfFailed(m_mip_feedback_readback->Map(0, nullptr, reinterpret_cast<void**>(&m_mip_feedback_results)));
+
+			// ɫɼѣǩеһ
+			D3D12_DESCRIPTOR_HEAP_DESC streaming_heap_desc{};
+			streaming_heap_desc.NumDescriptors = 2;
+			streaming_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+			streaming_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+			DxDebug::ThrowIfFailed(m_device->CreateDescriptorHeap(&streaming_heap_desc, IID_PPV_ARGS(m_streaming_heap.GetAddressOf())));
+			D3D12_CPU_DESCRIPTOR_HANDLE streaming_handle = m_streaming_heap->GetCPUDescriptorHandleForHeapStart();
+			m_device->CreateShaderResourceView(m_residency_manager.Resource(m_streamed_texture), nullptr, streaming_handle);
+			streaming_handle.ptr += m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+			D3D12_UNORDERED_ACCESS_VIEW_DESC feedback_view{};
+			feedback_view.Format = DXGI_FORMAT_UNKNOWN;
+			feedback_view.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+			feedback_view.Buffer.NumElements = texture_count;
+			feedback_view.Buffer.StructureByteStride = sizeof(uint32_t);
+			m_device->CreateUnorderedAccessView(m_mip_feedback.Get(), nullptr, &feedback_view, streaming_handle);
+		}
+
+		// ÿÿ֡ѡLODʱͳ
+		m_mesh_object_counts.assign(m_meshes.size(), 0u);
+		// ʵƵĸǩʵΪʵͨSRV󶨣
+		// GPUƵʵ޳passдbundleʵCPUдϴ
+		if (m_use_gpu_driven || m_use_bundles)
+		{
+			D3D12_ROOT_PARAMETER1 instanced_parameters[2]{};
+			instanced_parameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+			instanced_parameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+			instanced_parameters[0].Constants = {2, 0, 1};
+			instanced_parameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+			instanced_parameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+			instanced_parameters[1].Descriptor = {0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE};
+			versioned_desc.Desc_1_1 = {_countof(instanced_parameters), instanced_parameters, 0, nullptr, root_signature_flags | D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS};
+			DxDebug::ThrowIfFailed(D3D12SerializeVersionedRootSignature(&versioned_desc, root_signature_blob.ReleaseAndGetAddressOf(), error_blob.ReleaseAndGetAddressOf()));
+			DxDebug::ThrowIfFailed(m_device->CreateRootSignature(0, root_signature_blob->GetBufferPointer(), root_signature_blob->GetBufferSize(), IID_PPV_ARGS(m_instanced_root_signature.GetAddressOf())));
+			m_command_capture.RootSignature(m_instanced_root_signature.Get(), root_signature_blob->GetBufferPointer(), root_signature_blob->GetBufferSize());
+
+			D3D12_SHADER_BYTECODE instanced_vertex_shader_bytecode = instanced_vertex_shader.Get();
+			pipeline_state_stream.p_root_signature = m_instanced_root_signature.Get();
+			pipeline_state_stream.VS = CD3DX12_SHADER_BYTECODE(instanced_vertex_shader_bytecode);
+			pipeline_state_stream.PS = CD3DX12_SHADER_BYTECODE(pixel_shader_bytecode);
+			DxDebug::ThrowIfFailed(m_device->CreatePipelineState(&pipeline_state_stream_desc, IID_PPV_ARGS(m_instanced_pipeline_state.GetAddressOf())));
+			m_command_capture.GraphicsPipeline(m_instanced_pipeline_state.Get(), m_instanced_root_signature.Get(), input_layout, _countof(input_layout), D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE,
+				instanced_vertex_shader_bytecode, pixel_shader_bytecode, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_D32_FLOAT);
+		}
+		if (m_use_gpu_driven)
+		{
+			// GPU޳ĸǩ׶ƽΪΧкͨSRVɼӲʵͨUAVֱӰ󶨵ַ
+			D3D12_ROOT_PARAMETER1 culling_parameters[6]{};
+			culling_parameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+			culling_parameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			culling_parameters[0].Constants = {0, 0, sizeof(CullingConstants) / 4};
+			culling_parameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+			culling_parameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			culling_parameters[1].Descriptor = {0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE};
+			culling_parameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+			culling_parameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			culling_parameters[2].Descriptor = {0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE};
+			culling_parameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+			culling_parameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			culling_parameters[3].Descriptor = {1, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE};
+			culling_parameters[4].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+			culling_parameters[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			culling_parameters[4].Descriptor = {1, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE};
+			culling_parameters[5].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+			culling_parameters[5].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+			culling_parameters[5].Descriptor = {2, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE};
+			versioned_desc.Desc_1_1 = {_countof(culling_parameters), culling_parameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE};
+			DxDebug::ThrowIfFailed(D3D12SerializeVersionedRootSignature(&versioned_desc, root_signature_blob.ReleaseAndGetAddressOf(), error_blob.ReleaseAndGetAddressOf()));
+			DxDebug::ThrowIfFailed(m_device->CreateRootSignature(0, root_signature_blob->GetBufferPointer(), root_signature_blob->GetBufferSize(), IID_PPV_ARGS(m_culling_root_signature.GetAddressOf())));
+
+			// 
+			struct ComputePipelineStateStream
+			{
+			    CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE p_root_signature;
+			    CD3DX12_PIPELINE_STATE_STREAM_CS CS;
+			} compute_pipeline_state_stream;
+			compute_pipeline_state_stream.p_root_signature = m_culling_root_signature.Get();
+			compute_pipeline_state_stream.CS = CD3DX12_SHADER_BYTECODE(culling_shader.Get());
+			D3D12_PIPELINE_STATE_STREAM_DESC compute_pipeline_state_stream_desc{sizeof(ComputePipelineStateStream), &compute_pipeline_state_stream};
+			DxDebug::ThrowIfFailed(m_device->CreatePipelineState(&compute_pipeline_state_stream_desc, IID_PPV_ARGS(m_culling_pipeline_state.GetAddressOf())));
+
+			// ɼԼÿ֡һλĻض
+			D3D12_HEAP_PROPERTIES counter_heap_prop = {D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+			D3D12_RESOURCE_DESC counter_desc = {D3D12_RESOURCE_DIMENSION_BUFFER, 0, sizeof(uint32_t), 1, 1, 1, DXGI_FORMAT_UNKNOWN, {1u, 0u}, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS};
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&counter_heap_prop, D3D12_HEAP_FLAG_NONE, &counter_desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(m_culling_counter.GetAddressOf())));
+			D3D12_HEAP_PROPERTIES readback_heap_prop = {D3D12_HEAP_TYPE_READBACK, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+			D3D12_RESOURCE_DESC readback_desc = {D3D12_RESOURCE_DIMENSION_BUFFER, 0, m_back_buffer_count * sizeof(uint32_t), 1, 1, 1, DXGI_FORMAT_UNKNOWN, {1u, 0u}, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, D3D12_RESOURCE_FLAG_NONE};
+			DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&readback_heap_prop, D3D12_HEAP_FLAG_NONE, &readback_desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(m_culling_readback.GetAddressOf())));
+			DxDebug::ThrowIfFailed(m_culling_readback->Map(0, nullptr, reinterpret_cast<void**>(&m_culling_results)));
+
+			// פΧкͻݣֻ֮ϴ仯
+			auto create_buffer = [](uint64_t size, D3D12_RESOURCE_FLAGS flags, ComPtr<ID3D12Resource2>& buffer)
+			{
+				D3D12_HEAP_PROPERTIES heap_prop = {D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u};
+				D3D12_RESOURCE_DESC desc = {D3D12_RESOURCE_DIMENSION_BUFFER, 0, size, 1, 1, 1, DXGI_FORMAT_UNKNOWN, {1u, 0u}, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, flags};
+				DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&heap_prop, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(buffer.GetAddressOf())));
+			};
+			uint64_t object_count = std::max<uint64_t>(m_bvh_entities.size(), 1);
+			create_buffer(object_count * sizeof(CullingBounds), D3D12_RESOURCE_FLAG_NONE, m_culling_bounds);
+			create_buffer(object_count * sizeof(CullingObject), D3D12_RESOURCE_FLAG_NONE, m_culling_objects);
+
+			// ӲʵдDrawIndexedInstancedĲ
+			D3D12_INDIRECT_ARGUMENT_DESC indirect_arguments[2]{};
+			indirect_arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+			indirect_arguments[0].Constant = {0, 0, 1};
+			indirect_arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+			D3D12_COMMAND_SIGNATURE_DESC signature_desc{sizeof(IndirectDraw), _countof(indirect_arguments), indirect_arguments, 0};
+			DxDebug::ThrowIfFailed(m_device->CreateCommandSignature(&signature_desc, m_instanced_root_signature.Get(), IID_PPV_ARGS(m_draw_signature.GetAddressOf())));
+
+			// ʵΪ
+			for (uint32_t i = 0; i < m_culling_output_count; ++i)
+			{
+				create_buffer(m_meshes.size() * sizeof(IndirectDraw), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, m_draw_arguments[i]);
+				create_buffer(object_count * sizeof(CulledInstance), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, m_culled_instances[i]);
+			}
+		}
+
+		DxDebug::ThrowIfFailed(m_command_capture.Wrap(m_command_list.Get()).Close());
 		// ֻһбĳ
 		ID3D12CommandList* const pp_command_lists[]{m_command_list.Get()};
-		// ִбøֵ
-		m_command_queue->ExecuteCommandLists(1, pp_command_lists);
-		uint64_t fence_value = DxHelper::Signal(m_command_queue, m_fence, m_fence_value);
+		// ִбøֵתԱ¼
+		m_command_capture.ExecuteCommandLists(m_command_queue.Get(), 1, pp_command_lists);
+		uint64_t fence_value = ++m_fence_value;
+		DxDebug::ThrowIfFailed(m_command_capture.Signal(m_command_queue.Get(), m_fence.Get(), fence_value));
 
+		m_command_capture.WaitForFence(m_fence.Get(), fence_value);
 		DxHelper::WaitForTheFrame(m_fence, fence_value, m_fence_event);
 
 		m_content_loaded = true;
 
+		// ԴĴӳ
+		StreamHelper::StreamStats stream_stats = m_asset_streamer.Stats();
+		wchar_t buffer[256];
+		swprintf_s(buffer, L"Streaming: %llu bytes, %.1f MB/s, latency avg %.3f ms max %.3f ms\n",
+			static_cast<unsigned long long>(stream_stats.bytes_read), stream_stats.ReadBandwidthMBps(), stream_stats.AverageLatencyMs(), stream_stats.max_latency_ms);
+		OutputDebugString(buffer);
+		swprintf_s(buffer, L"Shaders: archive %s, %u permutations, %u unique blobs\n",
+			archive_opened ? L"mapped" : L"missing (using .cso)", m_shader_archive.PermutationCount(), m_shader_archive.BlobCount());
+		OutputDebugString(buffer);
+
 		// ɫ
 		D3D12_CLEAR_VALUE optimized_clear_value{};
 		optimized_clear_value.Format = DXGI_FORMAT_D32_FLOAT;
@@ -411,7 +1156,9 @@ namespace BufferHelper
 			D3D12_TEXTURE_LAYOUT_UNKNOWN,
 			D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL};
 		// Ȼ(ԺŻCreateCommittedResource3)
+		m_command_capture.Release(m_depth_buffer.Get());
 		DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&depth_heap_prop, D3D12_HEAP_FLAG_NONE, &depth_buffer_desc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &optimized_clear_value, IID_PPV_ARGS(m_depth_buffer.GetAddressOf())));
+		m_command_capture.Resource(m_depth_buffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
 		// дͼ
 		D3D12_DEPTH_STENCIL_VIEW_DESC dsv_desc{};
@@ -421,6 +1168,7 @@ namespace BufferHelper
 		dsv_desc.Flags = D3D12_DSV_FLAG_NONE;
 		// ͼ
 		m_device->CreateDepthStencilView(m_depth_buffer.Get(), &dsv_desc, m_dsv_heap->GetCPUDescriptorHandleForHeapStart());
+		m_command_capture.DepthStencilView(m_depth_buffer.Get(), DXGI_FORMAT_D32_FLOAT, m_dsv_heap->GetCPUDescriptorHandleForHeapStart());
 
 		return true;
 	}
@@ -451,6 +1199,93 @@ void ParseCommandLineArguments()
 		{
 			m_use_warp = true;
 		}
+		// ָƵ
+		if (::wcscmp(argv[i], L"-n") == 0 || ::wcscmp(argv[i], L"--objects") == 0)
+		{
+			m_object_count = std::max<uint32_t>(1u, ::wcstol(argv[++i], nullptr, 10));
+		}
+		// رbundle棬ÿֱ֡¼л
+		if (::wcscmp(argv[i], L"--no-bundles") == 0)
+		{
+			m_use_bundles = false;
+		}
+		// гCPU׼Ժ˳
+		if (::wcscmp(argv[i], L"--bench-constants") == 0)
+		{
+			m_bench_constants = true;
+		}
+		// ָ֡
+		if (::wcscmp(argv[i], L"--fps-cap") == 0)
+		{
+			m_fps_cap = std::max(0.0, ::wcstod(argv[++i], nullptr));
+		}
+		// ָģʽvsynctearingvrr
+		if (::wcscmp(argv[i], L"--present") == 0)
+		{
+			++i;
+			if (::wcscmp(argv[i], L"tearing") == 0) m_present_mode = PresentHelper::PresentMode::Tearing;
+			else if (::wcscmp(argv[i], L"vrr") == 0) m_present_mode = PresentHelper::PresentMode::Vrr;
+			else m_present_mode = PresentHelper::PresentMode::VSync;
+		}
+		// ָLODĻλΪ
+		if (::wcscmp(argv[i], L"--lod-error") == 0)
+		{
+			m_lod_error_pixels = std::max(0.0f, static_cast<float>(::wcstod(argv[++i], nullptr)));
+		}
+		// ޳ҲͼжִУں첽Ա
+		if (::wcscmp(argv[i], L"--no-async-compute") == 0)
+		{
+			m_use_async_compute = false;
+		}
+		// GPU޳Ľͨӻύ
+		if (::wcscmp(argv[i], L"--gpu-driven") == 0)
+		{
+			m_use_gpu_driven = true;
+		}
+		// رCPUڵ޳׶ڵȫ
+		if (::wcscmp(argv[i], L"--no-occlusion") == 0)
+		{
+			m_use_occlusion = false;
+		}
+		// ָÿ֡դڵ
+		if (::wcscmp(argv[i], L"--occluders") == 0)
+		{
+			m_max_occluders = ::wcstol(argv[++i], nullptr, 10);
+		}
+		// Ԥָ֮֡ÿ֡ûͨöѷ䣬з֡ǩĴ˳Ϊ1
+		if (::wcscmp(argv[i], L"--check-allocations") == 0)
+		{
+			m_check_allocations = true;
+			if (i + 1 < argc && ::iswdigit(argv[i + 1][0]))
+			{
+				m_allocation_warmup_frames = ::wcstoull(argv[++i], nullptr, 10);
+			}
+		}
+		// ָʽļ
+		if (::wcscmp(argv[i], L"--texture") == 0)
+		{
+			m_streamed_texture_path = argv[++i];
+		}
+		// дָĸļ
+		if (::wcscmp(argv[i], L"--capture") == 0)
+		{
+			m_capture_path = argv[++i];
+		}
+		// ָ֡
+		if (::wcscmp(argv[i], L"--capture-frames") == 0)
+		{
+			m_capture_frames = std::max<uint32_t>(1u, ::wcstol(argv[++i], nullptr, 10));
+		}
+		// 豸ϻطŸļ˳--warpWARPϻط
+		if (::wcscmp(argv[i], L"--replay") == 0)
+		{
+			m_replay_path = argv[++i];
+		}
+		// ָطŵѭ
+		if (::wcscmp(argv[i], L"--replay-loops") == 0)
+		{
+			m_replay_loops = std::max<uint32_t>(1u, ::wcstol(argv[++i], nullptr, 10));
+		}
 	}
 	// ͷCommandLineToArgvWڴ
 	::LocalFree(argv);
@@ -525,6 +1360,13 @@ void Update();
 void Render();
 void Resize(uint32_t width, uint32_t height);
 void SetFullScreen(bool fullscreen);
+void BenchConstantAllocator();
+void ApplyPresentMode();
+void CyclePresentMode();
+void CheckFrameAllocations();
+void CaptureBundle(ID3D12GraphicsCommandList* bundle, const BundleHelper::StaticMesh& mesh, ID3D12PipelineState* pipeline_state, ID3D12RootSignature* root_signature);
+void FinishCapture();
+void ReplayTrace();
 
 
 
@@ -578,11 +1420,29 @@ void Initial(HWND hwnd)
 	}
 	// 豸
 	DxDebug::ThrowIfFailed(D3D12CreateDevice(hardware_adapter.Get(), feature_Level, IID_PPV_ARGS(m_device.GetAddressOf())));
+	m_adapter = hardware_adapter;
+	m_bundle_cache.Initial(m_device);
+	m_constant_allocator.Initial(m_device);
+	// 豸ʼ񣬼ؽ׶εԴϴҲ
+	if (!m_capture_path.empty())
+	{
+		m_command_capture.Begin(m_device, m_capture_frames);
+		m_constant_allocator.SetAllocationCallback([](const BufferHelper::ConstantAllocation& allocation)
+			{
+				m_command_capture.TrackUpload(allocation.resource, allocation.offset, allocation.cpu_address, allocation.size);
+			});
+		m_bundle_cache.SetRecordCallback(CaptureBundle);
+	}
 
-	// Ƿ֧vrrɱˢ
-	if (SUCCEEDED(p_factory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &m_allow_tearing, sizeof(m_allow_tearing))))
+	// Ƿ֧˺ѣ֡vrrɱˢʶ
+	BOOL allow_tearing = FALSE;
+	if (SUCCEEDED(p_factory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allow_tearing, sizeof(allow_tearing))))
 	{
-		m_allow_tearing = true;
+		m_tearing_supported = allow_tearing == TRUE;
+	}
+	if (!m_tearing_supported)
+	{
+		m_present_mode = PresentHelper::PresentMode::VSync;
 	}
 
 	ComPtr<ID3D12DebugDevice2> debug_device;
@@ -615,6 +1475,29 @@ void Initial(HWND hwnd)
 	queue_desc.NodeMask = 0;
 	// ж
 	DxDebug::ThrowIfFailed(m_device->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(m_command_queue.GetAddressOf())));
+	// ƬӳȾʹͬһж
+	m_residency_manager.Initial(m_device, m_adapter, m_command_queue);
+	// жӺΧȼͼж
+	D3D12_COMMAND_QUEUE_DESC compute_queue_desc = queue_desc;
+	compute_queue_desc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+	compute_queue_desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+	DxDebug::ThrowIfFailed(m_device->CreateCommandQueue(&compute_queue_desc, IID_PPV_ARGS(m_compute_queue.GetAddressOf())));
+	DxDebug::ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_compute_fence.GetAddressOf())));
+	// ٸʽӻƣʱʹCPU
+	if (!m_capture_path.empty())
+	{
+		m_use_gpu_driven = false;
+	}
+	// ޳passֻGPUʱ¼ƣжûй
+	if (!m_use_gpu_driven)
+	{
+		m_use_async_compute = false;
+	}
+	// ޳passбͺͼʱʹõжȡȵĸж
+	BuildFrameSchedule();
+	m_culling_context.Initial(m_device, m_use_async_compute ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT, m_back_buffer_count);
+	m_culling_timer.Initial(m_device, m_use_async_compute ? m_compute_queue.Get() : m_command_queue.Get(), m_back_buffer_count);
+	m_scene_timer.Initial(m_device, m_command_queue.Get(), m_back_buffer_count);
 
 	// д
 	DXGI_SWAP_CHAIN_DESC1 swap_chain_desc{};
@@ -628,7 +1511,7 @@ void Initial(HWND hwnd)
 	swap_chain_desc.Scaling = DXGI_SCALING_STRETCH;
 	swap_chain_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
 	swap_chain_desc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
-	swap_chain_desc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH | (m_allow_tearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+	swap_chain_desc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH | (m_tearing_supported ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
 	// 
 	ComPtr<IDXGISwapChain1> swap_chain;
 	DxDebug::ThrowIfFailed(p_factory->CreateSwapChainForHwnd(m_command_queue.Get(), m_hwnd, &swap_chain_desc, nullptr, nullptr, swap_chain.GetAddressOf()));
@@ -644,6 +1527,7 @@ void Initial(HWND hwnd)
 	heap_desc.NumDescriptors = m_back_buffer_count;
 	// rtv
 	DxDebug::ThrowIfFailed(m_device->CreateDescriptorHeap(&heap_desc, IID_PPV_ARGS(m_rtv_heap.GetAddressOf())));
+	m_command_capture.DescriptorHeap(m_rtv_heap.Get());
 	// öС
 	m_rtv_descriptor_size = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
@@ -664,6 +1548,7 @@ void Initial(HWND hwnd)
 		DxDebug::ThrowIfFailed(m_swap_chain->GetBuffer(i, IID_PPV_ARGS(m_back_buffers[i].GetAddressOf())));
 		// Ϊrtv
 		m_device->CreateRenderTargetView(m_back_buffers[i].Get(), nullptr, rtv_handle);
+		m_command_capture.RenderTargetView(m_back_buffers[i].Get(), rtv_handle);
 		// handleָƫһrtvλ
 		rtv_handle.ptr += m_rtv_descriptor_size;
 	}
@@ -671,8 +1556,9 @@ void Initial(HWND hwnd)
 	// رյб
 	DxDebug::ThrowIfFailed(m_device->CreateCommandList1(0, D3D12_COMMAND_LIST_TYPE_DIRECT, D3D12_COMMAND_LIST_FLAG_NONE, IID_PPV_ARGS(m_command_list.GetAddressOf())));
 	// ʼб
-	DxDebug::ThrowIfFailed(m_command_list->Reset(m_command_allocators[m_current_back_buffer_index].Get(), nullptr));
-	// Դ
+	DxDebug::ThrowIfFailed(m_command_capture.Wrap(m_command_list.Get()).Reset(m_command_allocators[m_current_back_buffer_index].Get(), nullptr));
+	// Դ̲߳Դ
+	m_asset_streamer.Initial();
 	BufferHelper::LoadContent();
 
 	// Χ
@@ -691,49 +1577,309 @@ void Update()
 	// ÿupdateһ֡ʼʱͼʱ
 	++frame_counter;
 	auto time_now = clock.now();
+	// ֡ģ״̬￪ʼ
+	m_frame_limiter.MarkInputSampled();
 	auto delta_time = time_now - time_begin;
 	time_begin = time_now;
+	float delta_seconds = static_cast<float>(delta_time.count() * 1e-9);
 	// updateÿŵʱ䵽1sͨ֡fps
 	elapsed_seconds += delta_time.count() * 1e-9;
 	if (elapsed_seconds > 1.0)
 	{
 		wchar_t buffer[256];
 		auto fps = frame_counter / elapsed_seconds;
-		wsprintfW(buffer, L"256", "FPS: %f/n", fps);
+		swprintf_s(buffer, L"FPS: %f\n", fps);
 		OutputDebugString(buffer);
 
 		frame_counter = 0;
 		elapsed_seconds = 0.0;
 	}
 
-	// ÿ֡תǶ
-	float angle = static_cast<float>(elapsed_seconds * 360.0);
-	m_model_matrix = XMMatrixRotationAxis(rotation_axis, XMConvertToRadians(angle));
+	// ʵתٰ㼶
+	SceneHelper::UpdateSpin(m_scene, delta_seconds);
+	m_scene.UpdateTransforms();
+	UpdateSpatialIndex();
 	m_view_matrix = XMMatrixLookAtLH(eye_position, focus_point, up_direction);
 	// ͶӰ
 	float aspect_ratio = m_client_width / static_cast<float>(m_client_height);
-	m_projection_matrix = XMMatrixPerspectiveFovLH(XMConvertToRadians(m_fov), aspect_ratio, 0.1f, 100.0f);
+	m_projection_matrix = XMMatrixPerspectiveFovLH(XMConvertToRadians(m_fov), aspect_ratio, m_near_plane, m_far_plane);
+	// ͶӰȷѡLOD
+	UpdateLods();
+}
+
+// ѱ仯ϴפ޳ϲΪһθ
+void UploadCullingObjects(TraceHelper::CaptureList& command_list)
+{
+	using namespace SceneHelper;
+	bool copied = false;
+	uint32_t object = m_culling_dirty_first;
+	while (object <= m_culling_dirty_last)
+	{
+		if (!m_culling_dirty[object])
+		{
+			++object;
+			continue;
+		}
+		// ÿθm_culling_upload_chunk壬η䲻ᳬϴҳ
+		uint32_t first = object;
+		while (object <= m_culling_dirty_last && m_culling_dirty[object] && object - first < m_culling_upload_chunk)
+		{
+			m_culling_dirty[object++] = 0;
+		}
+		uint32_t count = object - first;
+		BufferHelper::ConstantAllocation bounds = m_constant_allocator.Allocate(count * sizeof(CullingBounds));
+		CullingBounds* bounds_data = static_cast<CullingBounds*>(bounds.cpu_address);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const BvhHelper::Aabb& box = m_bvh.Bounds(first + i);
+			bounds_data[i] = {XMFLOAT4(box.min[0], box.min[1], box.min[2], 0.0f), XMFLOAT4(box.max[0], box.max[1], box.max[2], 0.0f)};
+		}
+		command_list.CopyBufferRegion(m_culling_bounds.Get(), first * sizeof(CullingBounds), bounds.resource, bounds.offset, count * sizeof(CullingBounds));
+		m_culling_upload_bytes += count * sizeof(CullingBounds);
+		BufferHelper::ConstantAllocation objects = m_constant_allocator.Allocate(count * sizeof(CullingObject));
+		CullingObject* object_data = static_cast<CullingObject*>(objects.cpu_address);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			EntityHandle entity = m_bvh_entities[first + i];
+			const MeshInstance* instance = m_scene.Get<MeshInstance>(entity);
+			std::memcpy(&object_data[i].world, m_scene.Get<WorldMatrix>(entity)->m, sizeof(XMFLOAT4X4));
+			object_data[i].color = XMFLOAT4(instance->color);
+			object_data[i].mesh = instance->mesh_id;
+		}
+		command_list.CopyBufferRegion(m_culling_objects.Get(), first * sizeof(CullingObject), objects.resource, objects.offset, count * sizeof(CullingObject));
+		m_culling_upload_bytes += count * sizeof(CullingObject);
+		copied = true;
+	}
+	m_culling_dirty_first = UINT32_MAX;
+	m_culling_dirty_last = 0;
+
+	// ûиʱcommonʽΪɫԴ
+	if (copied)
+	{
+		D3D12_RESOURCE_BARRIER barriers[2]{};
+		UINT barrier_count = 0;
+		for (ID3D12Resource2* buffer : {m_culling_bounds.Get(), m_culling_objects.Get()})
+		{
+			barriers[barrier_count].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			barriers[barrier_count].Transition.pResource = buffer;
+			barriers[barrier_count].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+			barriers[barrier_count].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+			barriers[barrier_count].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+			++barrier_count;
+		}
+		command_list.ResourceBarrier(barrier_count, barriers);
+	}
+}
+
+// ¼GPU׶޳дɼʵݺͼӻƲɳpassͨExecuteIndirectƣ
+// ɼƵ֡ĻضλֻGPUʱ¼
+ID3D12CommandList* RecordCulling(const BvhHelper::Frustum& frustum, const XMFLOAT4X4& view_projection)
+{
+	ID3D12GraphicsCommandList* culling_list = m_culling_context.Begin(m_current_back_buffer_index);
+	// бѾãֻڸвã֮װ¼
+	m_command_capture.Describe(culling_list).Reset(nullptr, nullptr);
+	TraceHelper::CaptureList command_list = m_command_capture.Wrap(culling_list);
+	m_culling_timer.Begin(culling_list, m_current_back_buffer_index);
+
+	uint32_t object_count = m_bvh.ObjectCount();
+	UploadCullingObjects(command_list);
+	CullingConstants constants{};
+	std::memcpy(constants.view_projection, view_projection.m, sizeof(constants.view_projection));
+	std::memcpy(constants.planes, frustum.planes, sizeof(constants.planes));
+	constants.object_count = object_count;
+
+	// ϴύʱ˥ΪcommonʱʽΪcopy dest
+	BufferHelper::ConstantAllocation zero = m_constant_allocator.Allocate(uint32_t(0));
+	command_list.CopyBufferRegion(m_culling_counter.Get(), 0, zero.resource, zero.offset, sizeof(uint32_t));
+	D3D12_RESOURCE_BARRIER barriers[3]{};
+	UINT barrier_count = 0;
+	auto transition = [&](ID3D12Resource2* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+	{
+		barriers[barrier_count].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		barriers[barrier_count].Transition.pResource = resource;
+		barriers[barrier_count].Transition.StateBefore = before;
+		barriers[barrier_count].Transition.StateAfter = after;
+		barriers[barrier_count].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		++barrier_count;
+	};
+	transition(m_culling_counter.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	// ʹãpassȡһʱһ֡޳дһ
+	m_culling_output = (m_culling_output + 1) % m_culling_output_count;
+	ID3D12Resource2* draw_arguments = m_draw_arguments[m_culling_output].Get();
+	ID3D12Resource2* culled_instances = m_culled_instances[m_culling_output].Get();
+	// Ӳģ壺ʵ㣬ʵ䰴һLODѡÿ
+	BufferHelper::ConstantAllocation arguments = m_constant_allocator.Allocate(m_meshes.size() * sizeof(IndirectDraw));
+	IndirectDraw* argument_data = static_cast<IndirectDraw*>(arguments.cpu_address);
+	uint32_t instance_base = 0;
+	for (size_t mesh_id = 0; mesh_id < m_meshes.size(); ++mesh_id)
+	{
+		const BundleHelper::StaticMesh& mesh = m_meshes[mesh_id];
+		argument_data[mesh_id] = {instance_base, {mesh.index_count, 0, mesh.start_index, 0, 0}};
+		instance_base += m_mesh_object_counts[mesh_id];
+	}
+	command_list.CopyBufferRegion(draw_arguments, 0, arguments.resource, arguments.offset, m_meshes.size() * sizeof(IndirectDraw));
+	transition(draw_arguments, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	transition(culled_instances, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	command_list.ResourceBarrier(barrier_count, barriers);
+
+	command_list.SetComputeRootSignature(m_culling_root_signature.Get());
+	command_list.SetPipelineState(m_culling_pipeline_state.Get());
+	command_list.SetComputeRoot32BitConstants(0, sizeof(CullingConstants) / 4, &constants, 0);
+	command_list.SetComputeRootShaderResourceView(1, m_culling_bounds->GetGPUVirtualAddress());
+	command_list.SetComputeRootUnorderedAccessView(2, m_culling_counter->GetGPUVirtualAddress());
+	command_list.SetComputeRootShaderResourceView(3, m_culling_objects->GetGPUVirtualAddress());
+	command_list.SetComputeRootUnorderedAccessView(4, draw_arguments->GetGPUVirtualAddress());
+	command_list.SetComputeRootUnorderedAccessView(5, culled_instances->GetGPUVirtualAddress());
+	command_list.Dispatch((object_count + 63) / 64, 1, 1);
+
+	// ʽصcommon۳passǷ޳ͬһύУcommonʼת
+	barrier_count = 0;
+	transition(m_culling_counter.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	transition(draw_arguments, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COMMON);
+	transition(culled_instances, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COMMON);
+	command_list.ResourceBarrier(barrier_count, barriers);
+	command_list.CopyBufferRegion(m_culling_readback.Get(), m_current_back_buffer_index * sizeof(uint32_t), m_culling_counter.Get(), 0, sizeof(uint32_t));
+
+	m_culling_timer.End(culling_list, m_current_back_buffer_index);
+	DxDebug::ThrowIfFailed(command_list.Close());
+	return culling_list;
+}
+
+// CPUڵ޳ͶӰߴѡڵդڹ߳ϲвԿɼİΧУסĴvisible_objectsƳ
+void CullOccludedObjects(const XMFLOAT4X4& view_projection, MemoryHelper::FrameVector<uint32_t>& visible_objects)
+{
+	using namespace SceneHelper;
+	XMFLOAT3 eye;
+	XMStoreFloat3(&eye, eye_position);
+	auto bounds = [](uint32_t object, float* box_min, float* box_max)
+	{
+		const BvhHelper::Aabb& box = m_bvh.Bounds(object);
+		std::memcpy(box_min, box.min, sizeof(box.min));
+		std::memcpy(box_max, box.max, sizeof(box.max));
+	};
+
+	// ʹͬһͼͶӰڵMVPΪ
+	m_occlusion_culler.BeginFrame(view_projection.m);
+	// ÷Ϊİ߳Եӵľ룬Ĵ
+	const std::vector<uint32_t>& occluders = m_occlusion_culler.SelectOccluders(visible_objects, m_max_occluders, [&eye](uint32_t object)
+		{
+			EntityHandle entity = m_bvh_entities[object];
+			const float (*m)[4] = m_scene.Get<WorldMatrix>(entity)->m;
+			float dx = m[3][0] - eye.x, dy = m[3][1] - eye.y, dz = m[3][2] - eye.z;
+			// ȱţȡһеĳ
+			float scale = std::sqrt(m[0][0] * m[0][0] + m[0][1] * m[0][1] + m[0][2] * m[0][2]);
+			return m_occluder_proxies[m_scene.Get<MeshLod>(entity)->chain].extent * scale / std::sqrt(dx * dx + dy * dy + dz * dz);
+		}, bounds);
+	for (uint32_t object : occluders)
+	{
+		EntityHandle entity = m_bvh_entities[object];
+		m_occlusion_culler.RenderOccluder(m_occluder_proxies[m_scene.Get<MeshLod>(entity)->chain].mesh, m_scene.Get<WorldMatrix>(entity)->m);
+	}
+	m_occlusion_culler.CullOccluded(visible_objects, bounds);
+}
+
+// ֡ύpassбύǰжϵȴжӵĸֵ
+void ExecuteFrame(ID3D12CommandList* const (&pass_lists)[FramePassCount])
+{
+	ID3D12CommandQueue* queues[] = {m_command_queue.Get(), m_compute_queue.Get()};
+	ID3D12Fence* fences[] = {m_fence.Get(), m_compute_fence.Get()};
+	uint64_t* fence_values[] = {&m_fence_value, &m_compute_fence_value};
+	m_frame_schedule.Instantiate(fence_values, m_submissions);
+	for (const QueueHelper::Submission& submission : m_submissions)
+	{
+		uint32_t queue = static_cast<uint32_t>(submission.queue);
+		for (uint32_t i = 0; i < submission.wait_count; ++i)
+		{
+			DxDebug::ThrowIfFailed(m_command_capture.Wait(queues[queue], fences[static_cast<uint32_t>(submission.waits[i].queue)], submission.waits[i].value));
+		}
+		ID3D12CommandList* command_lists[FramePassCount];
+		UINT command_list_count = 0;
+		for (uint32_t i = 0; i < submission.pass_count; ++i)
+		{
+			if (pass_lists[submission.passes[i]]) command_lists[command_list_count++] = pass_lists[submission.passes[i]];
+		}
+		if (command_list_count)
+		{
+			m_command_capture.ExecuteCommandLists(queues[queue], command_list_count, command_lists);
+		}
+		DxDebug::ThrowIfFailed(m_command_capture.Signal(queues[queue], fences[queue], submission.signal_value));
+	}
 }
 
 void Render()
 {
-	// ݵǰ֡󻺳õǰͺ󻺳
-	ComPtr<ID3D12CommandAllocator> command_allocator = m_command_allocators[m_current_back_buffer_index];
-	ComPtr<ID3D12Resource2> back_buffer = m_back_buffers[m_current_back_buffer_index];
+	// ݵǰ֡󻺳õǰͺ󻺳ָֻ룬ü
+	ID3D12CommandAllocator* command_allocator = m_command_allocators[m_current_back_buffer_index].Get();
+	ID3D12Resource2* back_buffer = m_back_buffers[m_current_back_buffer_index].Get();
+	// ͳ¼ƺʱ
+	auto record_begin = std::chrono::high_resolution_clock::now();
+	m_command_capture.FrameBegin();
+	// ֡ϴύĹѾɣȡжӵGPUʱGPU޳Ľ
+	static double queue_busy_seconds[QueueHelper::m_queue_type_count]{};
+	static double queue_overlap_seconds = 0.0;
+	static uint64_t timed_frames = 0;
+	double scene_begin, scene_end, culling_begin, culling_end;
+	bool scene_timed = m_scene_timer.Read(m_current_back_buffer_index, scene_begin, scene_end);
+	bool culling_timed = m_culling_timer.Read(m_current_back_buffer_index, culling_begin, culling_end);
+	if (scene_timed)
+	{
+		queue_busy_seconds[static_cast<uint32_t>(QueueHelper::QueueType::Graphics)] += scene_end - scene_begin;
+		// ûGPUʱ¼޳passʱн
+		if (culling_timed)
+		{
+			queue_busy_seconds[static_cast<uint32_t>(m_use_async_compute ? QueueHelper::QueueType::Compute : QueueHelper::QueueType::Graphics)] += culling_end - culling_begin;
+			queue_overlap_seconds += std::max(0.0, std::min(scene_end, culling_end) - std::max(scene_begin, culling_begin));
+			m_gpu_visible_count = m_culling_results[m_current_back_buffer_index];
+		}
+		++timed_frames;
+	}
+	// GPUѾʹϵĳҳ
+	m_constant_allocator.BeginFrame(m_fence->GetCompletedValue());
+	// GPUѾԽ֡õ֡ڴ
+	m_frame_arena.BeginFrame(m_fence->GetCompletedValue());
 	// б
 	command_allocator->Reset();
-	m_command_list->Reset(command_allocator.Get(), nullptr);
+	// װ¼ƣûвʱֻת
+	TraceHelper::CaptureList scene_list = m_command_capture.Wrap(m_command_list.Get());
+	scene_list.Reset(command_allocator, nullptr);
+	// ֡ϴλдmipѾضȽפٽ
+	uint32_t streamed_texture_count = m_residency_manager.Policy().TextureCount();
+	if (m_mip_feedback && m_mip_feedback_pending[m_current_back_buffer_index])
+	{
+		m_residency_manager.ReadMipFeedback(m_mip_feedback_results + m_current_back_buffer_index * streamed_texture_count, streamed_texture_count);
+	}
+	// ԴԤmipʽƬϺƬ¼ڸõб
+	m_residency_manager.Update(m_command_list.Get(), m_constant_allocator, m_fence->GetCompletedValue(), m_fence_value + 1);
+	if (m_mip_feedback)
+	{
+		// 0xffffffffmip󣬻ӹ״̬ʽΪĿ֮꣬תΪUAVɫд
+		size_t feedback_size = streamed_texture_count * sizeof(uint32_t);
+		BufferHelper::ConstantAllocation feedback_clear = m_constant_allocator.Allocate(feedback_size);
+		std::memset(feedback_clear.cpu_address, 0xff, feedback_size);
+		m_command_list->CopyBufferRegion(m_mip_feedback.Get(), 0, feedback_clear.resource, feedback_clear.offset, feedback_size);
+		D3D12_RESOURCE_BARRIER feedback_barrier{};
+		feedback_barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		feedback_barrier.Transition.pResource = m_mip_feedback.Get();
+		feedback_barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+		feedback_barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+		feedback_barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		m_command_list->ResourceBarrier(1, &feedback_barrier);
+		ID3D12DescriptorHeap* descriptor_heaps[] = {m_streaming_heap.Get()};
+		m_command_list->SetDescriptorHeaps(_countof(descriptor_heaps), descriptor_heaps);
+	}
+	m_scene_timer.Begin(m_command_list.Get(), m_current_back_buffer_index);
 
 	// ͨԴϽǰתȾĿ׶Σڴдת˵
 	D3D12_RESOURCE_BARRIER barrier{};
 	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = back_buffer.Get();
+	barrier.Transition.pResource = back_buffer;
 	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
 	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
 	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 	// ͨбת
-	m_command_list->ResourceBarrier(1, &barrier);
+	scene_list.ResourceBarrier(1, &barrier);
 
 	// 󻺳clear color
 	FLOAT clear_color[] = {0.4f, 0.6f, 0.9f, 1.0f};
@@ -741,58 +1887,457 @@ void Render()
 	D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_rtv_heap->GetCPUDescriptorHandleForHeapStart();
 	rtv.ptr = SIZE_T(INT64(rtv.ptr) + INT64(m_rtv_descriptor_size) * INT64(m_current_back_buffer_index));
 	// ͨбrtvָ
-	m_command_list->ClearRenderTargetView(rtv, clear_color, 0, nullptr);
+	scene_list.ClearRenderTargetView(rtv, clear_color, 0, nullptr);
 
 	// dsvͼ
 	D3D12_CPU_DESCRIPTOR_HANDLE dsv = m_dsv_heap->GetCPUDescriptorHandleForHeapStart();
-	m_command_list->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1, 0, 0, nullptr);
-	// ù״̬
-	m_command_list->SetPipelineState(m_pipeline_state.Get());
-	// ͼθǩ
-	m_command_list->SetGraphicsRootSignature(m_root_signature.Get());
-	// ƬԪʽ
-	m_command_list->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	m_command_list->IASetVertexBuffers(0, 1, &m_vertex_buffer_view);
-	m_command_list->IASetIndexBuffer(&m_index_buffer_view);
+	scene_list.ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1, 0, 0, nullptr);
 	// ӿںͲо
-	m_command_list->RSSetViewports(1, &m_viewport);
-	m_command_list->RSSetScissorRects(1, &m_scissor_rect);
+	scene_list.RSSetViewports(1, &m_viewport);
+	scene_list.RSSetScissorRects(1, &m_scissor_rect);
 	// ȾĿ
-	m_command_list->OMSetRenderTargets(1, &rtv, false, &dsv);
-	// MVP󲢱ø
-	XMMATRIX mvp_matrix = XMMatrixMultiply(m_model_matrix, m_view_matrix);
-	mvp_matrix = XMMatrixMultiply(mvp_matrix, m_projection_matrix);
-	m_command_list->SetGraphicsRoot32BitConstants(0, sizeof(XMMATRIX) / 4, &mvp_matrix, 0);
-	// 
-	m_command_list->DrawIndexedInstanced(_countof(g_Indicies), 1, 0, 0, 0);
+	scene_list.OMSetRenderTargets(1, &rtv, false, &dsv);
+
+	// ׶ѯռõɼ
+	XMMATRIX view_projection = XMMatrixMultiply(m_view_matrix, m_projection_matrix);
+	XMFLOAT4X4 view_projection_values;
+	XMStoreFloat4x4(&view_projection_values, view_projection);
+	BvhHelper::Frustum frustum = BvhHelper::FrustumFromMatrix(view_projection_values.m);
+	// ɼб֡ڴϣԤѯ޳в
+	MemoryHelper::FrameVector<uint32_t> visible_objects{MemoryHelper::ArenaAllocator<uint32_t>(&m_frame_arena)};
+	visible_objects.reserve(m_bvh.ObjectCount());
+	// GPUʱɼȫ޳passCPUٲѯƶбΪ
+	if (!m_use_gpu_driven)
+	{
+		m_bvh.QueryFrustum(frustum, visible_objects);
+	}
+	size_t frustum_visible = visible_objects.size();
+	// GPUʱGPU޳¼޳passԼбϣ޳passû
+	ID3D12CommandList* culling_list = m_use_gpu_driven ? RecordCulling(frustum, view_projection_values) : nullptr;
+	// ׶ڵڵ޳ֱӽƶ
+	if (m_use_occlusion && !m_use_gpu_driven)
+	{
+		CullOccludedObjects(view_projection_values, visible_objects);
+	}
+
+	// ÿɼһưͨߡԼ״̬лͬһɽԶearly-z
+	m_draw_queue.Reset();
+	for (uint32_t object : visible_objects)
+	{
+		SceneHelper::EntityHandle entity = m_bvh_entities[object];
+		const SceneHelper::WorldMatrix* world = m_scene.Get<SceneHelper::WorldMatrix>(entity);
+		const SceneHelper::MeshInstance* instance = m_scene.Get<SceneHelper::MeshInstance>(entity);
+		// ԭͼռȣһԶƽ֮
+		XMVECTOR view_position = XMVector3TransformCoord(XMVectorSet(world->m[3][0], world->m[3][1], world->m[3][2], 1.0f), m_view_matrix);
+		float depth = (XMVectorGetZ(view_position) - m_near_plane) / (m_far_plane - m_near_plane);
+		// ʹòʽĹߣʹöɫߣżʱ
+		uint32_t pipeline = m_scene.Get<SceneHelper::MeshLod>(entity)->chain == m_streamed_chain ? m_streamed_pipeline : 0;
+		uint64_t key = DrawHelper::MakeSortKey(DrawHelper::DrawPass::Opaque, pipeline, instance->mesh_id, DrawHelper::QuantizeDepth(depth));
+		m_draw_queue.Submit(key, {pipeline, instance->mesh_id, instance->mesh_id, object});
+	}
+	m_draw_queue.Sort();
+
+	// ͨ״̬¼ƣͬĹߡǩװ״̬ظ
+	DrawHelper::StateFilter<TraceHelper::CaptureList> state_filter(&scene_list);
+	const std::vector<DrawHelper::DrawPacket>& packets = m_draw_queue.Packets();
+	for (size_t i = 0; i < packets.size();)
+	{
+		const DrawHelper::DrawCommand& command = m_draw_queue.Command(packets[i]);
+		const DrawHelper::PipelineBinding& binding = m_pipelines[command.pipeline];
+		const BundleHelper::StaticMesh& mesh = m_meshes[command.mesh_id];
+		// ɫͬһΪһbundleֻùߺÿʵдϴѺһʵ
+		if (m_use_bundles && command.pipeline != m_streamed_pipeline)
+		{
+			size_t end = i + 1;
+			while (end < packets.size() && end - i < m_bundle_instance_chunk)
+			{
+				const DrawHelper::DrawCommand& next = m_draw_queue.Command(packets[end]);
+				if (next.pipeline != command.pipeline || next.mesh_id != command.mesh_id) break;
+				++end;
+			}
+			// ʵƶе˳д룬ɽԶ
+			uint32_t instance_count = static_cast<uint32_t>(end - i);
+			BufferHelper::ConstantAllocation instances = m_constant_allocator.Allocate(instance_count * sizeof(CulledInstance));
+			CulledInstance* instance_data = static_cast<CulledInstance*>(instances.cpu_address);
+			for (uint32_t j = 0; j < instance_count; ++j)
+			{
+				SceneHelper::EntityHandle entity = m_bvh_entities[m_draw_queue.Command(packets[i + j]).object];
+				XMMATRIX model_matrix = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(m_scene.Get<SceneHelper::WorldMatrix>(entity)));
+				XMStoreFloat4x4(&instance_data[j].mvp, XMMatrixMultiply(model_matrix, view_projection));
+				instance_data[j].color = XMFLOAT4(m_scene.Get<SceneHelper::MeshInstance>(entity)->color);
+			}
+			// ֱбòbundle̳УbundleִкĹߺװ״̬֮Ļ
+			ID3D12GraphicsCommandList* bundle = m_bundle_cache.GetBundle(mesh, m_instanced_pipeline_state.Get(), m_instanced_root_signature.Get(), m_fence_value + 1);
+			state_filter.SetGraphicsRootSignature(m_instanced_root_signature.Get());
+			uint32_t instance_base = 0;
+			scene_list.SetGraphicsRoot32BitConstants(0, 1, &instance_base, 0);
+			scene_list.SetGraphicsRootShaderResourceView(1, instances.gpu_address);
+			state_filter.ExecuteBundle(bundle, m_instanced_pipeline_state.Get(), mesh.topology, mesh.vertex_buffer_view, mesh.index_buffer_view);
+			state_filter.DrawIndexedInstanced(mesh.index_count, instance_count, mesh.start_index, 0, 0);
+			i = end;
+			continue;
+		}
+
+		SceneHelper::EntityHandle entity = m_bvh_entities[command.object];
+		const SceneHelper::WorldMatrix* world = m_scene.Get<SceneHelper::WorldMatrix>(entity);
+		const SceneHelper::MeshInstance* instance = m_scene.Get<SceneHelper::MeshInstance>(entity);
+		// ͼθǩҪֱб
+		state_filter.SetGraphicsRootSignature(binding.root_signature);
+		// MVPø
+		XMMATRIX model_matrix = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(world));
+		XMMATRIX mvp_matrix = XMMatrixMultiply(model_matrix, view_projection);
+		scene_list.SetGraphicsRoot32BitConstants(0, sizeof(XMMATRIX) / 4, &mvp_matrix, 0);
+		// ÿƵĳ󶨵CBV
+		ObjectConstants object_constants{model_matrix, XMFLOAT4(instance->color)};
+		scene_list.SetGraphicsRootConstantBufferView(1, m_constant_allocator.Allocate(object_constants).gpu_address);
+		// ʽֻڲʱãֱб
+		if (command.pipeline == m_streamed_pipeline)
+		{
+			uint32_t streaming_constants[2] = {m_streamed_texture, m_residency_manager.Policy().ResidentMip(m_streamed_texture)};
+			m_command_list->SetGraphicsRootDescriptorTable(2, m_streaming_heap->GetGPUDescriptorHandleForHeapStart());
+			m_command_list->SetGraphicsRoot32BitConstants(3, _countof(streaming_constants), streaming_constants, 0);
+		}
+		// 
+		state_filter.SetPipelineState(binding.pipeline_state);
+		state_filter.IASetPrimitiveTopology(mesh.topology);
+		state_filter.IASetVertexBuffer(mesh.vertex_buffer_view);
+		state_filter.IASetIndexBuffer(mesh.index_buffer_view);
+		state_filter.DrawIndexedInstanced(mesh.index_count, 1, mesh.start_index, 0, 0);
+		++i;
+	}
+	m_draw_stats = state_filter.Stats();
+	if (m_use_gpu_driven)
+	{
+		// ޳passдʵͼӲÿLODöÿLODһӻ
+		ID3D12Resource2* draw_arguments = m_draw_arguments[m_culling_output].Get();
+		ID3D12Resource2* culled_instances = m_culled_instances[m_culling_output].Get();
+		D3D12_RESOURCE_BARRIER output_barriers[2]{};
+		for (D3D12_RESOURCE_BARRIER& output_barrier : output_barriers)
+		{
+			output_barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			output_barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+			output_barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		}
+		output_barriers[0].Transition.pResource = draw_arguments;
+		output_barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+		output_barriers[1].Transition.pResource = culled_instances;
+		output_barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+		m_command_list->ResourceBarrier(_countof(output_barriers), output_barriers);
+
+		m_command_list->SetGraphicsRootSignature(m_instanced_root_signature.Get());
+		m_command_list->SetPipelineState(m_instanced_pipeline_state.Get());
+		m_command_list->SetGraphicsRootShaderResourceView(1, culled_instances->GetGPUVirtualAddress());
+		for (const LodHelper::LodChain& chain : m_lod_chains)
+		{
+			const BundleHelper::StaticMesh& mesh = m_meshes[chain.first_mesh_id];
+			m_command_list->IASetPrimitiveTopology(mesh.topology);
+			m_command_list->IASetVertexBuffers(0, 1, &mesh.vertex_buffer_view);
+			m_command_list->IASetIndexBuffer(&mesh.index_buffer_view);
+			m_command_list->ExecuteIndirect(m_draw_signature.Get(), static_cast<UINT>(chain.levels.size()), draw_arguments, chain.first_mesh_id * sizeof(IndirectDraw), nullptr, 0);
+		}
+
+		// صcommon֡޳passٴд
+		for (D3D12_RESOURCE_BARRIER& output_barrier : output_barriers)
+		{
+			std::swap(output_barrier.Transition.StateBefore, output_barrier.Transition.StateAfter);
+		}
+		m_command_list->ResourceBarrier(_countof(output_barriers), output_barriers);
+	}
+	if (m_mip_feedback)
+	{
+		// mipƵ֡Ļضλһʹø֡ʱѾ
+		D3D12_RESOURCE_BARRIER feedback_barrier{};
+		feedback_barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		feedback_barrier.Transition.pResource = m_mip_feedback.Get();
+		feedback_barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+		feedback_barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+		feedback_barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		m_command_list->ResourceBarrier(1, &feedback_barrier);
+		size_t feedback_size = streamed_texture_count * sizeof(uint32_t);
+		m_command_list->CopyBufferRegion(m_mip_feedback_readback.Get(), m_current_back_buffer_index * feedback_size, m_mip_feedback.Get(), 0, feedback_size);
+		m_mip_feedback_pending[m_current_back_buffer_index] = true;
+	}
 
 
 	// ٽǰתpresentֽ׶
 	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
 	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
 
-	m_command_list->ResourceBarrier(1, &barrier);
+	scene_list.ResourceBarrier(1, &barrier);
+	m_scene_timer.End(m_command_list.Get(), m_current_back_buffer_index);
 	// رбжִб֮ǰ
-	DxDebug::ThrowIfFailed(m_command_list->Close());
-	// жִб
-	ID3D12CommandList* const command_list[] = {m_command_list.Get()};
-	m_command_queue->ExecuteCommandLists(_countof(command_list), command_list);
-	// ȷǷֱֶ֧̬ʺ˺ѣflags
-	UINT sync_interval = m_vsync ? 1 : 0;
-	UINT present_flags = m_tearing_supported && !m_vsync ? DXGI_PRESENT_ALLOW_TEARING : 0;
+	DxDebug::ThrowIfFailed(scene_list.Close());
+
+	// ÿһƽ¼ƺʱڶԱbundleֱ¼
+	static double record_seconds = 0.0;
+	static double sort_seconds = 0.0;
+	static uint64_t record_frames = 0;
+	static auto report_begin = record_begin;
+	auto record_end = std::chrono::high_resolution_clock::now();
+	record_seconds += std::chrono::duration<double>(record_end - record_begin).count();
+	sort_seconds += m_draw_queue.SortSeconds();
+	++record_frames;
+	if (std::chrono::duration<double>(record_end - report_begin).count() > 1.0)
+	{
+		wchar_t buffer[256];
+		swprintf_s(buffer, L"Record(%s, %u objects): %.3f ms/frame\n", m_use_bundles ? L"bundles" : L"direct", m_object_count, record_seconds * 1e3 / record_frames);
+		OutputDebugString(buffer);
+		swprintf_s(buffer, L"Draw: %zu packets, sort %.3f ms/frame, %u draws (%u bundles), %u PSO, %u root signature, %u IA changes, %u redundant skipped\n",
+			m_draw_queue.Size(), sort_seconds * 1e3 / record_frames, m_draw_stats.draws, m_draw_stats.bundles, m_draw_stats.pipeline_changes,
+			m_draw_stats.root_signature_changes, m_draw_stats.input_assembler_changes, m_draw_stats.redundant_skipped);
+		OutputDebugString(buffer);
+		swprintf_s(buffer, L"Lod: %llu triangles (%.1f%% of full detail), %u switches last frame\n",
+			static_cast<unsigned long long>(m_lod_stats.triangles), m_lod_stats.full_triangles ? 100.0 * m_lod_stats.triangles / m_lod_stats.full_triangles : 0.0, m_lod_stats.switches);
+		OutputDebugString(buffer);
+		const double frames = static_cast<double>(std::max<uint64_t>(timed_frames, 1));
+		swprintf_s(buffer, L"Queues(%s): graphics %.3f ms, compute %.3f ms, overlap %.3f ms/frame\n",
+			m_use_async_compute ? L"async compute" : L"graphics only", queue_busy_seconds[0] * 1e3 / frames, queue_busy_seconds[1] * 1e3 / frames,
+			queue_overlap_seconds * 1e3 / frames);
+		OutputDebugString(buffer);
+		if (m_use_gpu_driven)
+		{
+			swprintf_s(buffer, L"GPU culling: %u/%u visible, upload %.1f KB/frame\n",
+				m_gpu_visible_count, m_bvh.ObjectCount(), m_culling_upload_bytes / 1024.0 / record_frames);
+			OutputDebugString(buffer);
+			m_culling_upload_bytes = 0;
+		}
+		std::fill(std::begin(queue_busy_seconds), std::end(queue_busy_seconds), 0.0);
+		queue_overlap_seconds = 0.0;
+		timed_frames = 0;
+		// GPUCPUʱӻƯƣÿУ׼
+		m_scene_timer.Calibrate();
+		m_culling_timer.Calibrate();
+		const BvhHelper::BvhStats& bvh_stats = m_bvh.Stats();
+		swprintf_s(buffer, L"Bvh: %zu/%u visible, refit %u nodes %.3f ms, SAH %.2f (built %.2f), %u rebuilds\n",
+			frustum_visible, bvh_stats.object_count, bvh_stats.refit_nodes, bvh_stats.refit_seconds * 1e3,
+			bvh_stats.current_sah_cost, bvh_stats.build_sah_cost, bvh_stats.rebuild_count);
+		OutputDebugString(buffer);
+		if (m_use_occlusion && !m_use_gpu_driven)
+		{
+			const OcclusionHelper::OcclusionStats& occlusion_stats = m_occlusion_culler.Stats();
+			swprintf_s(buffer, L"Occlusion(%S, %u threads): %u occluders, %u/%u triangles, culled %u/%u, select %.3f ms, raster %.3f ms, test %.3f ms last frame\n",
+				OcclusionHelper::SimdPathName(), m_occlusion_culler.ThreadCount(), occlusion_stats.occluders, occlusion_stats.rasterized, occlusion_stats.triangles,
+				occlusion_stats.culled, occlusion_stats.tested, occlusion_stats.select_ms, occlusion_stats.raster_ms, occlusion_stats.test_ms);
+			OutputDebugString(buffer);
+		}
+		const ResidencyHelper::ResidencyStats& residency_stats = m_residency_manager.Policy().Stats();
+		swprintf_s(buffer, L"Residency: budget %.1f MB, resident %.1f MB, loaded %llu, evicted %llu tiles\n",
+			residency_stats.budget_bytes / (1024.0 * 1024.0), residency_stats.resident_bytes / (1024.0 * 1024.0),
+			static_cast<unsigned long long>(residency_stats.loaded_tiles), static_cast<unsigned long long>(residency_stats.evicted_tiles));
+		OutputDebugString(buffer);
+		PresentHelper::FramePacingStats pacing_stats = m_frame_limiter.Stats();
+		swprintf_s(buffer, L"Pacing(%s): mean %.3f ms, jitter %.3f ms, min %.3f ms, max %.3f ms, p99 %.3f ms, input latency %.3f ms (max %.3f ms)\n",
+			PresentHelper::PresentModeName(m_present_mode), pacing_stats.mean_interval_ms, pacing_stats.stddev_interval_ms,
+			pacing_stats.min_interval_ms, pacing_stats.max_interval_ms, pacing_stats.p99_interval_ms,
+			pacing_stats.mean_input_latency_ms, pacing_stats.max_input_latency_ms);
+		OutputDebugString(buffer);
+		const MemoryHelper::FrameAllocationStats& allocation_stats = m_allocation_tracker.LastFrame();
+		const MemoryHelper::FrameArenaStats& arena_stats = m_frame_arena.Stats();
+		swprintf_s(buffer, L"Memory: %llu heap allocations last frame (%llu steady-state, %llu bytes), arena peak %.1f KB, %.1f KB in %u blocks, %u pool pages\n",
+			static_cast<unsigned long long>(allocation_stats.allocations), static_cast<unsigned long long>(allocation_stats.steady_allocations),
+			static_cast<unsigned long long>(allocation_stats.bytes), arena_stats.peak_bytes / 1024.0, arena_stats.reserved_bytes / 1024.0,
+			arena_stats.block_count, MemoryHelper::SizeClassPool::ForThread()->PageCount());
+		OutputDebugString(buffer);
+
+		record_seconds = 0.0;
+		sort_seconds = 0.0;
+		record_frames = 0;
+		report_begin = record_end;
+	}
+	// ֡ύ޳ͳƣ֡passûֻͼжӵȴ֡޳
+	ID3D12CommandList* const pass_lists[FramePassCount] = {culling_list, m_command_list.Get(), nullptr};
+	ExecuteFrame(pass_lists);
+	// ֻдֱͬȴvblank֡vrr˺ѷʽ
+	bool vsync = m_present_mode == PresentHelper::PresentMode::VSync;
+	UINT sync_interval = vsync ? 1 : 0;
+	UINT present_flags = m_tearing_supported && !vsync ? DXGI_PRESENT_ALLOW_TEARING : 0;
 	// 󻺳ֵĻ
 	DXGI_PRESENT_PARAMETERS present_parameter{0, nullptr, nullptr, nullptr};
+	m_frame_limiter.WaitForPresent();
 	DxDebug::ThrowIfFailed(m_swap_chain->Present1(sync_interval, present_flags, &present_parameter));
+	m_frame_limiter.EndFrame();
 	// µǰжӵfence
-	m_frame_fence_values[m_current_back_buffer_index] = DxHelper::Signal(m_command_queue, m_fence, m_fence_value);
+	m_frame_fence_values[m_current_back_buffer_index] = ++m_fence_value;
+	DxDebug::ThrowIfFailed(m_command_capture.Signal(m_command_queue.Get(), m_fence.Get(), m_fence_value));
+	// ֡ʹõĳҳڸøɺܸ
+	m_constant_allocator.EndFrame(m_frame_fence_values[m_current_back_buffer_index]);
+	m_frame_arena.EndFrame(m_frame_fence_values[m_current_back_buffer_index]);
 	// ֡
 	m_current_back_buffer_index = m_swap_chain->GetCurrentBackBufferIndex();
-	// CPUȴGPU
+	// CPUȴGPUɣȴĸֵҲ٣طʱͬ֡ӳ
+	m_command_capture.WaitForFence(m_fence.Get(), m_frame_fence_values[m_current_back_buffer_index]);
 	DxHelper::WaitForTheFrame(m_fence, m_frame_fence_values[m_current_back_buffer_index], m_fence_event);
+	// ͷִϵĹbundle
+	m_bundle_cache.ReleaseRetired(m_fence->GetCompletedValue());
+	// ָ֡д
+	if (m_command_capture.FrameEnd())
+	{
+		FinishCapture();
+	}
+}
+
+// 㱾֡ͨöѷ䣬Ԥ̬֮ǩз֡ΪΥǰ10֡ǩĴ
+void CheckFrameAllocations()
+{
+	const MemoryHelper::FrameAllocationStats& stats = m_allocation_tracker.EndFrame();
+	if (!m_check_allocations || m_allocation_tracker.FrameCount() <= m_allocation_warmup_frames || stats.steady_allocations == 0) return;
+	if (++m_allocation_violations > 10) return;
+	wchar_t buffer[256];
+	swprintf_s(buffer, L"Allocations: frame %llu made %llu steady-state heap allocations (%llu bytes)\n",
+		static_cast<unsigned long long>(m_allocation_tracker.FrameCount()), static_cast<unsigned long long>(stats.steady_allocations), static_cast<unsigned long long>(stats.bytes));
+	OutputDebugString(buffer);
+	for (uint32_t tag = 0; tag < MemoryHelper::TagCount(); ++tag)
+	{
+		if (stats.tag_allocations[tag] == 0) continue;
+		swprintf_s(buffer, L"  %S%s: %llu\n", MemoryHelper::TagName(tag), MemoryHelper::IsSteadyTag(tag) ? L"" : L" (ignored)",
+			static_cast<unsigned long long>(stats.tag_allocations[tag]));
+		OutputDebugString(buffer);
+	}
+}
+
+// CPU׼ԣͳÿηƽʱ
+void BenchConstantAllocator()
+{
+	const uint32_t frame_count = 1000;
+	const uint32_t allocations_per_frame = 4096;
+	ObjectConstants object_constants{XMMatrixIdentity(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)};
+
+	BufferHelper::LinearConstantAllocator allocator;
+	allocator.Initial(m_device);
+	// GPUȡЩҳ棬ֱӰ֡ŵɵĸֵ
+	D3D12_GPU_VIRTUAL_ADDRESS checksum = 0;
+	auto bench_begin = std::chrono::high_resolution_clock::now();
+	for (uint32_t frame = 1; frame <= frame_count; ++frame)
+	{
+		allocator.BeginFrame(frame - 1);
+		for (uint32_t i = 0; i < allocations_per_frame; ++i)
+		{
+			checksum ^= allocator.Allocate(object_constants).gpu_address;
+		}
+		allocator.EndFrame(frame);
+	}
+	auto bench_end = std::chrono::high_resolution_clock::now();
+
+	double nanoseconds = std::chrono::duration<double, std::nano>(bench_end - bench_begin).count();
+	wchar_t buffer[256];
+	swprintf_s(buffer, L"ConstantAllocator: %.2f ns/allocation (%zu pages, checksum %llx)\n",
+		nanoseconds / (static_cast<double>(frame_count) * allocations_per_frame), allocator.PageCount(), static_cast<unsigned long long>(checksum));
+	OutputDebugString(buffer);
+}
+
+// ݳģʽʹʾˢ֡
+void ApplyPresentMode()
+{
+	MONITORINFOEXW monitor_info = {};
+	monitor_info.cbSize = sizeof(monitor_info);
+	DEVMODEW dev_mode = {};
+	dev_mode.dmSize = sizeof(dev_mode);
+	if (::GetMonitorInfoW(::MonitorFromWindow(m_hwnd, MONITOR_DEFAULTTONEAREST), &monitor_info) &&
+		::EnumDisplaySettingsW(monitor_info.szDevice, ENUM_CURRENT_SETTINGS, &dev_mode) && dev_mode.dmDisplayFrequency > 1)
+	{
+		m_refresh_rate = static_cast<double>(dev_mode.dmDisplayFrequency);
+	}
+
+	double target_fps = 0.0;
+	switch (m_present_mode)
+	{
+	// ֱͬPresent
+	case PresentHelper::PresentMode::VSync:
+		target_fps = 0.0;
+		break;
+	// ָ֡
+	case PresentHelper::PresentMode::Tearing:
+		target_fps = m_fps_cap;
+		break;
+	// Եˢʣ֤֡ʼvrrΧڶ˻شֱͬ
+	case PresentHelper::PresentMode::Vrr:
+		target_fps = m_refresh_rate * 0.97;
+		if (m_fps_cap > 0.0) target_fps = std::min(target_fps, m_fps_cap);
+		break;
+	}
+	m_frame_limiter.SetTargetFps(target_fps);
+	m_frame_limiter.Reset();
+
+	wchar_t buffer[256];
+	swprintf_s(buffer, L"Present mode: %s, refresh %.2f Hz, limit %.2f fps\n", PresentHelper::PresentModeName(m_present_mode), m_refresh_rate, target_fps);
+	OutputDebugString(buffer);
+}
+
+// лģʽ֧˺ʱֱִͬ
+void CyclePresentMode()
+{
+	if (!m_tearing_supported)
+	{
+		m_present_mode = PresentHelper::PresentMode::VSync;
+	}
+	else
+	{
+		m_present_mode = static_cast<PresentHelper::PresentMode>((static_cast<int>(m_present_mode) + 1) % 3);
+	}
+	ApplyPresentMode();
+}
+
+// bundleɻֱ¼ƣ¼ƺͬǽ
+void CaptureBundle(ID3D12GraphicsCommandList* bundle, const BundleHelper::StaticMesh& mesh, ID3D12PipelineState* pipeline_state, ID3D12RootSignature* root_signature)
+{
+	TraceHelper::CaptureList bundle_list = m_command_capture.Describe(bundle);
+	bundle_list.Reset(nullptr, pipeline_state);
+	BundleHelper::BundleCache::RecordCommands(&bundle_list, mesh, root_signature);
+	bundle_list.Close();
+}
+
+// ֹͣд٣unknown references˵жûеǼǣطʱЩΪ
+void FinishCapture()
+{
+	TraceHelper::CaptureStats stats = m_command_capture.Stats();
+	m_command_capture.End();
+	m_constant_allocator.SetAllocationCallback(nullptr);
+	m_bundle_cache.SetRecordCallback(nullptr);
+	bool saved = m_command_capture.Save(m_capture_path);
+	wchar_t buffer[512];
+	swprintf_s(buffer, L"Capture: %s %s, %u frames, %llu records, %zu bytes (%.0f bytes/frame), %llu unknown references\n",
+		saved ? L"wrote" : L"failed to write", m_capture_path.c_str(), stats.frames, static_cast<unsigned long long>(stats.records),
+		stats.bytes, stats.frames ? static_cast<double>(stats.bytes) / stats.frames : 0.0, static_cast<unsigned long long>(stats.unknown_references));
+	OutputDebugString(buffer);
+}
+
+// ڵǰ豸ϰٶȻطŸ٣֣ÿ֡CPUύʱ
+void ReplayTrace()
+{
+	wchar_t buffer[512];
+	TraceHelper::TraceReader trace;
+	if (!trace.Open(m_replay_path))
+	{
+		swprintf_s(buffer, L"Replay: cannot read %s\n", m_replay_path.c_str());
+		OutputDebugString(buffer);
+		return;
+	}
+
+	TraceHelper::ReplayStats stats;
+	bool replayed = false;
+	auto replay_begin = std::chrono::high_resolution_clock::now();
+	{
+		TraceHelper::DeviceBackend backend(m_device);
+		replayed = TraceHelper::Replay(trace, backend, m_replay_loops, stats);
+		backend.Finish();
+	}
+	double total_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - replay_begin).count();
+
+	uint32_t frames = std::max(stats.Frames(), 1u);
+	swprintf_s(buffer, L"Replay(%s): %s, %zu bytes, %u frames x %u loops%s, load %.3f ms, total %.3f ms\n",
+		m_use_warp ? L"WARP" : L"device", m_replay_path.c_str(), trace.Size(), stats.Frames() / m_replay_loops, m_replay_loops,
+		replayed ? L"" : L" (truncated or corrupt)", stats.load_ms, total_ms);
+	OutputDebugString(buffer);
+	swprintf_s(buffer, L"Replay CPU per frame: mean %.4f ms, p50 %.4f ms, p99 %.4f ms, max %.4f ms, %.1f records, %.0f bytes\n",
+		stats.MeanMs(), stats.PercentileMs(0.5), stats.PercentileMs(0.99), stats.MaxMs(),
+		static_cast<double>(stats.frame_records) / frames, static_cast<double>(stats.frame_bytes) / frames);
+	OutputDebugString(buffer);
 }
 
 void Resize(uint32_t width, uint32_t height)
 {
+	// ؽᴴCOM󣬲̬
+	MemoryHelper::AllocationScope resize_scope(m_resize_tag);
 	// µĳǰĲһ
 	if (m_client_width != width || m_client_height != height)
 	{
@@ -808,6 +2353,7 @@ void Resize(uint32_t width, uint32_t height)
 		// ÿ󻺳
 		for (int i = 0; i < m_back_buffer_count; ++i)
 		{
+			m_command_capture.Release(m_back_buffers[i].Get());
 			m_back_buffers[i].Reset();
 			m_frame_fence_values[i] = m_frame_fence_values[m_current_back_buffer_index];
 		}
@@ -828,6 +2374,7 @@ void Resize(uint32_t width, uint32_t height)
 			DxDebug::ThrowIfFailed(m_swap_chain->GetBuffer(i, IID_PPV_ARGS(m_back_buffers[i].GetAddressOf())));
 			// Ϊrtv
 			m_device->CreateRenderTargetView(m_back_buffers[i].Get(), nullptr, rtv_handle);
+			m_command_capture.RenderTargetView(m_back_buffers[i].Get(), rtv_handle);
 			// handleָƫһrtvλ
 			rtv_handle.ptr += m_rtv_descriptor_size;
 		}
@@ -855,7 +2402,9 @@ void Resize(uint32_t width, uint32_t height)
 			D3D12_TEXTURE_LAYOUT_UNKNOWN,
 			D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL};
 		// Ȼ(ԺŻCreateCommittedResource3)
+		m_command_capture.Release(m_depth_buffer.Get());
 		DxDebug::ThrowIfFailed(m_device->CreateCommittedResource(&depth_heap_prop, D3D12_HEAP_FLAG_NONE, &depth_buffer_desc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &optimized_clear_value, IID_PPV_ARGS(m_depth_buffer.GetAddressOf())));
+		m_command_capture.Resource(m_depth_buffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
 		// дͼ
 		D3D12_DEPTH_STENCIL_VIEW_DESC dsv_desc{};
@@ -865,6 +2414,7 @@ void Resize(uint32_t width, uint32_t height)
 		dsv_desc.Flags = D3D12_DSV_FLAG_NONE;
 		// ͼ
 		m_device->CreateDepthStencilView(m_depth_buffer.Get(), &dsv_desc, m_dsv_heap->GetCPUDescriptorHandleForHeapStart());
+		m_command_capture.DepthStencilView(m_depth_buffer.Get(), DXGI_FORMAT_D32_FLOAT, m_dsv_heap->GetCPUDescriptorHandleForHeapStart());
 	}
 }
 
@@ -922,8 +2472,16 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 		{
         // 
 		case WM_PAINT:
-            Update();
-            Render();
+            // Ԥĳʱ̶֡ʼȻٲ
+            m_frame_limiter.BeginFrame();
+            m_allocation_tracker.BeginFrame();
+            {
+                // ֡ѭ̵߳ķ䶼Frameǩ£̬ʱӦΪ0
+                MemoryHelper::AllocationScope frame_scope(m_frame_tag);
+                Update();
+                Render();
+            }
+            CheckFrameAllocations();
             break;
         // ¸
 		case WM_SYSKEYDOWN:
@@ -935,7 +2493,7 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 				{
                 // V-Sync
 				case 'V':
-                    m_vsync = !m_vsync;
+                    CyclePresentMode();
                     break;
                 // رմ
 				case VK_ESCAPE:
@@ -996,6 +2554,23 @@ int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdL
 	Initial(m_hwnd);
 	m_initialized = true;
 
+	ApplyPresentMode();
+
+	if (m_bench_constants)
+	{
+		BenchConstantAllocator();
+	}
+	if (!m_replay_path.empty())
+	{
+		ReplayTrace();
+	}
+	if (m_bench_constants || !m_replay_path.empty())
+	{
+		DxHelper::FlushGPU(m_command_queue, m_fence, m_fence_value, m_fence_event);
+		CloseHandle(m_fence_event);
+		return m_allocation_violations ? 1 : 0;
+	}
+
     ShowWindow(m_hwnd, nCmdShow); // ʾ
 
     // Ϣѭ
@@ -1007,8 +2582,26 @@ int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdL
     }
 
     DxHelper::FlushGPU(m_command_queue, m_fence, m_fence_value, m_fence_event);
+    // ڲ֡ǰرʱдѾĲ
+    if (m_command_capture.Active())
+    {
+        FinishCapture();
+    }
+    m_bundle_cache.Clear();
+    m_asset_streamer.Shutdown();
+    m_occlusion_culler.Shutdown();
 
     CloseHandle(m_fence_event);
 
-    return 0;
+    // ̬֡ѭгͨöѷʱԷֵ˳ڽű
+    if (m_check_allocations)
+    {
+        wchar_t buffer[256];
+        swprintf_s(buffer, L"Allocations: %llu frames after %llu warm-up frames, %llu with steady-state heap allocations\n",
+            static_cast<unsigned long long>(m_allocation_tracker.FrameCount() > m_allocation_warmup_frames ? m_allocation_tracker.FrameCount() - m_allocation_warmup_frames : 0),
+            static_cast<unsigned long long>(m_allocation_warmup_frames), static_cast<unsigned long long>(m_allocation_violations));
+        OutputDebugString(buffer);
+    }
+
+    return m_allocation_violations ? 1 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+// ռ׼ֲһʮһΧУܶȲ䣬߳
+// ȫƶrefit׶ѯ߲ѯͰΧصѯ
+//
+// g++ -std=c++17 -O2 -pthread tools/BvhBench.cpp -o BvhBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷BvhBench [--objects N] [--checks N]
+//
+// --objects ֻһֹģÿֹģ--checksѯĬ64ͱȽϽ
+// ֵ0 1 2 ѯ뱩һ
+#include "../SpatialBvh.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedSeconds(Clock::time_point begin)
+	{
+		return std::chrono::duration<double>(Clock::now() - begin).count();
+	}
+
+	struct Random
+	{
+		uint32_t seed = 1;
+		float operator()()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return (seed >> 8) * (1.0f / 16777216.0f);
+		}
+	};
+
+	// (0, 0, -distance)ԭ㣬ԼLookAtLH  PerspectiveFovLH
+	BvhHelper::Frustum CameraFrustum(float distance, float far_z)
+	{
+		const float near_z = 0.1f;
+		float h = 1.0f / std::tan(30.0f * 3.14159265f / 180.0f * 0.5f);
+		float w = h / (16.0f / 9.0f);
+		float r = far_z / (far_z - near_z);
+		float view_projection[4][4] = {
+			{w, 0.0f, 0.0f, 0.0f},
+			{0.0f, h, 0.0f, 0.0f},
+			{0.0f, 0.0f, r, 1.0f},
+			{0.0f, 0.0f, r * (distance - near_z), distance}};
+		return BvhHelper::FrustumFromMatrix(view_projection);
+	}
+
+	// QueryFrustumͬ
+	bool BoxOutside(const BvhHelper::Aabb& box, const BvhHelper::Frustum& frustum)
+	{
+		for (const auto& plane : frustum.planes)
+		{
+			float positive = std::max(plane[0] * box.min[0], plane[0] * box.max[0]) + std::max(plane[1] * box.min[1], plane[1] * box.max[1]) + std::max(plane[2] * box.min[2], plane[2] * box.max[2]);
+			if (positive < -plane[3]) return true;
+		}
+		return false;
+	}
+
+	bool Overlaps(const BvhHelper::Aabb& a, const BvhHelper::Aabb& b)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (a.max[axis] < b.min[axis] || b.max[axis] < a.min[axis]) return false;
+		}
+		return true;
+	}
+
+	float NearestHit(const std::vector<BvhHelper::Aabb>& bounds, const float origin[3], const float direction[3])
+	{
+		float nearest = INFINITY;
+		for (const BvhHelper::Aabb& box : bounds)
+		{
+			float t_near = 0.0f, t_far = nearest;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float inverse = 1.0f / direction[axis];
+				float t0 = (box.min[axis] - origin[axis]) * inverse, t1 = (box.max[axis] - origin[axis]) * inverse;
+				t_near = std::max(t_near, std::min(t0, t1));
+				t_far = std::min(t_far, std::max(t0, t1));
+			}
+			if (t_near <= t_far) nearest = t_near;
+		}
+		return nearest;
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: BvhBench [--objects N] [--checks N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32_t> object_counts = {10000u, 100000u, 1000000u};
+	uint32_t checks = 64;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--objects" && has_value) object_counts = {static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])))};
+		else if (argument == "--checks" && has_value) checks = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+
+	int result = 0;
+	for (uint32_t object_count : object_counts)
+	{
+		Random random;
+		float extent = std::cbrt(static_cast<float>(object_count)) * 4.0f;
+		std::vector<BvhHelper::Aabb> bounds(object_count);
+		for (BvhHelper::Aabb& box : bounds)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float center = (random() * 2.0f - 1.0f) * extent;
+				float half = 0.2f + random() * 1.3f;
+				box.min[axis] = center - half;
+				box.max[axis] = center + half;
+			}
+		}
+
+		BvhHelper::DynamicBvh bvh;
+		bvh.Build(bounds);
+		double build_seconds = bvh.Stats().build_seconds;
+		float build_sah = bvh.Stats().build_sah_cost;
+
+		// ƶrefit
+		for (uint32_t object = 0; object < object_count; ++object)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				bounds[object].min[axis] += 0.3f;
+				bounds[object].max[axis] += 0.3f;
+			}
+			bvh.Update(object, bounds[object]);
+		}
+		bvh.Refit();
+		std::printf("Bvh(%u): build %.2f ms, %u nodes, SAH %.2f, refit %.2f ms\n",
+			object_count, build_seconds * 1e3, bvh.Stats().node_count, build_sah, bvh.Stats().refit_seconds * 1e3);
+
+		BvhHelper::Frustum frustum = CameraFrustum(extent * 1.5f, extent * 3.0f);
+		std::vector<uint32_t> found;
+		const uint32_t frustum_queries = 100;
+		auto begin = Clock::now();
+		for (uint32_t i = 0; i < frustum_queries; ++i)
+		{
+			bvh.QueryFrustum(frustum, found);
+		}
+		double frustum_seconds = ElapsedSeconds(begin) / frustum_queries;
+		size_t visible = found.size();
+
+		const uint32_t ray_queries = 100000;
+		uint32_t ray_hits = 0;
+		begin = Clock::now();
+		for (uint32_t i = 0; i < ray_queries; ++i)
+		{
+			float origin[3] = {(random() * 2.0f - 1.0f) * extent, (random() * 2.0f - 1.0f) * extent, -extent * 1.5f};
+			float direction[3] = {(random() - 0.5f) * 0.2f, (random() - 0.5f) * 0.2f, 1.0f};
+			ray_hits += bvh.Raycast(origin, direction).object != UINT32_MAX ? 1 : 0;
+		}
+		double ray_seconds = ElapsedSeconds(begin);
+
+		const uint32_t box_queries = 100000;
+		size_t box_results = 0;
+		begin = Clock::now();
+		for (uint32_t i = 0; i < box_queries; ++i)
+		{
+			BvhHelper::Aabb query;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float center = (random() * 2.0f - 1.0f) * extent;
+				query.min[axis] = center - 2.0f;
+				query.max[axis] = center + 2.0f;
+			}
+			bvh.QueryAabb(query, found);
+			box_results += found.size();
+		}
+		double box_seconds = ElapsedSeconds(begin);
+		std::printf("Bvh(%u): frustum %.3f ms (%zu visible), rays %.2f M/s (%u hits), boxes %.2f M/s (%zu results)\n",
+			object_count, frustum_seconds * 1e3, visible, ray_queries / ray_seconds * 1e-6, ray_hits, box_queries / box_seconds * 1e-6, box_results);
+
+		// refit֮뱩Ƚ
+		if (!checks) continue;
+		uint32_t mismatches = 0;
+		size_t expected_visible = 0;
+		for (const BvhHelper::Aabb& box : bounds) expected_visible += BoxOutside(box, frustum) ? 0 : 1;
+		mismatches += expected_visible != visible ? 1 : 0;
+		for (uint32_t i = 0; i < checks; ++i)
+		{
+			float origin[3] = {(random() * 2.0f - 1.0f) * extent, (random() * 2.0f - 1.0f) * extent, -extent * 1.5f};
+			float direction[3] = {(random() - 0.5f) * 0.2f, (random() - 0.5f) * 0.2f, 1.0f};
+			BvhHelper::RayHit hit = bvh.Raycast(origin, direction);
+			float expected_t = NearestHit(bounds, origin, direction);
+			bool same = hit.object == UINT32_MAX ? std::isinf(expected_t) : std::fabs(hit.t - expected_t) <= 1e-4f * std::max(1.0f, expected_t);
+			mismatches += same ? 0 : 1;
+
+			BvhHelper::Aabb query;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				float center = (random() * 2.0f - 1.0f) * extent;
+				query.min[axis] = center - 2.0f;
+				query.max[axis] = center + 2.0f;
+			}
+			bvh.QueryAabb(query, found);
+			std::vector<uint32_t> expected;
+			for (uint32_t object = 0; object < object_count; ++object)
+			{
+				if (Overlaps(bounds[object], query)) expected.push_back(object);
+			}
+			std::sort(found.begin(), found.end());
+			mismatches += found != expected ? 1 : 0;
+		}
+		std::printf("Bvh(%u): brute-force check of %u rays, %u boxes and the frustum: %s\n", object_count, checks, checks, mismatches ? "FAILED" : "ok");
+		if (mismatches) result = 2;
+	}
+	return result;
+}
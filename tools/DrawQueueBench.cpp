@@ -0,0 +1,111 @@
+// ƶл׼ͨߡʺһʮһư
+// ԱȻ򣨲к͵̣߳std::stable_sortĺʱͳǰڻ֮״̬仯
+//
+// g++ -std=c++17 -O2 -pthread tools/DrawQueueBench.cpp -o DrawQueueBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷DrawQueueBench [--packets N] [--threads N] [--iterations N]
+//
+// --packets ֻһֹģʱȡ--iterationsΣĬ5Сֵÿǰָδ˳
+// ĳפ߳ڵһʱ֮ٴ߳
+// ֵ0 1 2 ȶһ
+#include "../DrawQueue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+	}
+
+	bool SamePackets(const std::vector<DrawHelper::DrawPacket>& a, const std::vector<DrawHelper::DrawPacket>& b)
+	{
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+			[](const DrawHelper::DrawPacket& x, const DrawHelper::DrawPacket& y) { return x.key == y.key && x.command == y.command; });
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: DrawQueueBench [--packets N] [--threads N] [--iterations N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32_t> packet_counts = {10000u, 100000u, 1000000u};
+	uint32_t threads = 0;
+	uint32_t iterations = 5;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--packets" && has_value) packet_counts = {static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])))};
+		else if (argument == "--threads" && has_value) threads = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--iterations" && has_value) iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+
+	const uint32_t pipeline_count = 16;
+	const uint32_t material_count = 256;
+	int result = 0;
+	for (uint32_t packet_count : packet_counts)
+	{
+		uint32_t seed = 1;
+		auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return seed >> 8;
+		};
+		DrawHelper::DrawQueue queue;
+		for (uint32_t i = 0; i < packet_count; ++i)
+		{
+			DrawHelper::DrawPass pass = static_cast<DrawHelper::DrawPass>(random() % 3);
+			uint32_t pipeline = random() % pipeline_count;
+			uint32_t material = random() % material_count;
+			float depth = (random() & 0xffff) / 65535.0f;
+			uint64_t key = DrawHelper::MakeSortKey(pass, pipeline, material, DrawHelper::QuantizeDepth(depth, pass == DrawHelper::DrawPass::Transparent));
+			queue.Submit(key, {pipeline, material, material, i});
+		}
+		const std::vector<DrawHelper::DrawPacket> unsorted = queue.Packets();
+
+		// ÿ򶼴ͬһδĸʼȡһ
+		std::vector<DrawHelper::DrawPacket> reference;
+		std::vector<DrawHelper::DrawPacket> packets;
+		DrawHelper::RadixSorter parallel_sorter, single_sorter;
+		double std_ms = 1e30, parallel_ms = 1e30, single_ms = 1e30;
+		bool matches = true;
+		for (uint32_t i = 0; i < iterations; ++i)
+		{
+			reference = unsorted;
+			auto begin = Clock::now();
+			std::stable_sort(reference.begin(), reference.end(), [](const DrawHelper::DrawPacket& a, const DrawHelper::DrawPacket& b) { return a.key < b.key; });
+			std_ms = std::min(std_ms, ElapsedMs(begin));
+
+			packets = unsorted;
+			begin = Clock::now();
+			single_sorter.Sort(packets, 1);
+			single_ms = std::min(single_ms, ElapsedMs(begin));
+			matches = matches && SamePackets(packets, reference);
+
+			packets = unsorted;
+			begin = Clock::now();
+			parallel_sorter.Sort(packets, threads);
+			parallel_ms = std::min(parallel_ms, ElapsedMs(begin));
+			matches = matches && SamePackets(packets, reference);
+		}
+		std::printf("Draws(%u): radix %.3f ms (1 thread %.3f ms, %u passes), std::stable_sort %.3f ms, %s\n",
+			packet_count, parallel_ms, single_ms, parallel_sorter.PassCount(), std_ms, matches ? "match" : "MISMATCH");
+		if (!matches) result = 2;
+
+		DrawHelper::DrawOrderStats unsorted_stats = DrawHelper::MeasureDrawOrder(queue, unsorted);
+		DrawHelper::DrawOrderStats sorted_stats = DrawHelper::MeasureDrawOrder(queue, packets);
+		std::printf("Draws(%u): unsorted %u pipeline, %u material changes; sorted %u pipeline, %u material changes\n",
+			packet_count, unsorted_stats.pipeline_changes, unsorted_stats.material_changes, sorted_stats.pipeline_changes, sorted_stats.material_changes);
+	}
+	return result;
+}
@@ -0,0 +1,134 @@
+// LOD׼64256512εĵλʱ
+// ھ20ƶСͳ޳ʱLODл
+//
+// g++ -std=c++17 -O2 tools/LodBench.cpp -o LodBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷LodBench [--slices N] [--levels N]
+//
+// --slices ֻһ־ȣÿLODԽ硢û˻Ρݼ
+// ֵ0 1 2 LODʧ
+#include "../MeshLod.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	const float m_pi = 3.14159265358979f;
+
+	// ӦеGenerateSphereͬһ㣬߷βӣǷյΣֻλ
+	void GenerateSphere(uint32_t slices, uint32_t stacks, std::vector<float>& positions, std::vector<uint32_t>& indices)
+	{
+		positions.clear();
+		indices.clear();
+		auto add_vertex = [&positions](float x, float y, float z) { positions.insert(positions.end(), {x, y, z}); };
+		add_vertex(0.0f, 1.0f, 0.0f);
+		for (uint32_t stack = 1; stack < stacks; ++stack)
+		{
+			float theta = m_pi * stack / stacks;
+			for (uint32_t slice = 0; slice < slices; ++slice)
+			{
+				float phi = 2.0f * m_pi * slice / slices;
+				add_vertex(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			}
+		}
+		add_vertex(0.0f, -1.0f, 0.0f);
+		uint32_t south_pole = static_cast<uint32_t>(positions.size() / 3 - 1);
+
+		auto ring = [slices](uint32_t stack, uint32_t slice) { return 1 + (stack - 1) * slices + slice % slices; };
+		for (uint32_t slice = 0; slice < slices; ++slice)
+		{
+			indices.insert(indices.end(), {0u, ring(1, slice + 1), ring(1, slice)});
+		}
+		for (uint32_t stack = 1; stack + 1 < stacks; ++stack)
+		{
+			for (uint32_t slice = 0; slice < slices; ++slice)
+			{
+				uint32_t a = ring(stack, slice), b = ring(stack, slice + 1), c = ring(stack + 1, slice), d = ring(stack + 1, slice + 1);
+				indices.insert(indices.end(), {a, b, c, b, d, c});
+			}
+		}
+		for (uint32_t slice = 0; slice < slices; ++slice)
+		{
+			indices.insert(indices.end(), {south_pole, ring(stacks - 1, slice), ring(stacks - 1, slice + 1)});
+		}
+	}
+
+	// صһûʱnullptr
+	const char* CheckChain(const LodHelper::LodChain& chain, size_t vertex_count)
+	{
+		for (size_t level = 0; level < chain.levels.size(); ++level)
+		{
+			const LodHelper::LodLevel& lod = chain.levels[level];
+			if (lod.index_count % 3 || size_t(lod.index_offset) + lod.index_count > chain.indices.size()) return "level range outside the index list";
+			for (uint32_t i = lod.index_offset; i < lod.index_offset + lod.index_count; i += 3)
+			{
+				uint32_t a = chain.indices[i], b = chain.indices[i + 1], c = chain.indices[i + 2];
+				if (a >= vertex_count || b >= vertex_count || c >= vertex_count) return "index outside the vertex buffer";
+				if (a == b || b == c || a == c) return "degenerate triangle";
+			}
+			if (level > 0 && lod.index_count >= chain.levels[level - 1].index_count) return "triangle count did not drop";
+			if (level > 0 && lod.error < chain.levels[level - 1].error) return "error decreased";
+		}
+		return nullptr;
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: LodBench [--slices N] [--levels N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32_t> slice_counts = {64u, 256u, 512u};
+	uint32_t max_levels = 8;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--slices" && has_value) slice_counts = {static_cast<uint32_t>(std::max(4, std::atoi(argv[++i])))};
+		else if (argument == "--levels" && has_value) max_levels = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+
+	int result = 0;
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	for (uint32_t slices : slice_counts)
+	{
+		GenerateSphere(slices, slices / 2, positions, indices);
+		LodHelper::LodChain chain = LodHelper::BuildLodChain(positions.data(), positions.size() / 3, sizeof(float) * 3, indices, max_levels);
+		std::printf("Lod(sphere %u): %zu triangles, %zu levels, built in %.2f ms\n", slices, indices.size() / 3, chain.levels.size(), chain.build_seconds * 1e3);
+		for (size_t level = 1; level < chain.levels.size(); ++level)
+		{
+			std::printf("Lod(sphere %u) level %zu: %u triangles (%.1f%%), error %.5f\n", slices, level,
+				chain.levels[level].index_count / 3, 100.0 * chain.levels[level].index_count / chain.levels[0].index_count, chain.levels[level].error);
+		}
+		if (const char* problem = CheckChain(chain, positions.size() / 3))
+		{
+			std::printf("Lod(sphere %u): check FAILED, %s\n", slices, problem);
+			result = 2;
+		}
+	}
+
+	// ھ20ƶС720ظߡ45ӳ
+	GenerateSphere(64, 32, positions, indices);
+	LodHelper::LodChain chain = LodHelper::BuildLodChain(positions.data(), positions.size() / 3, sizeof(float) * 3, indices);
+	float pixel_scale = 1.0f / std::tan(45.0f * m_pi / 180.0f * 0.5f) * 720.0f * 0.5f;
+	for (float hysteresis : {0.0f, 0.25f})
+	{
+		uint32_t level = 0;
+		uint32_t switches = 0;
+		for (uint32_t frame = 0; frame < 10000; ++frame)
+		{
+			float distance = 20.0f + 15.0f * std::sin(frame * 0.002f) + 0.3f * std::sin(frame * 1.7f);
+			uint32_t next = LodHelper::SelectLod(chain, 1.0f, distance, pixel_scale, level, 1.0f, hysteresis);
+			switches += next != level ? 1 : 0;
+			level = next;
+		}
+		std::printf("Lod selection(hysteresis %.2f): %u switches in 10000 frames\n", hysteresis, switches);
+	}
+	return result;
+}
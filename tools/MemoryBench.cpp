@@ -0,0 +1,317 @@
+// ֡ڴԣ֡ڴڸɺŸÿ顢ּصı̺߳Ϳ߳ͷš߳˳ؽ߳̽ӹܣ
+// Ӧͬ֡Ƚ֡ڴӷּغstd::allocator̬֡ûͨöѷ
+//
+// g++ -std=c++17 -O2 -pthread tools/MemoryBench.cpp -o MemoryBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷MemoryBench [--frames N] [--warmup N]
+//
+// Ӧһ滻ȫoperator new/deleteFrameMemory.hļӣģ֡ӳΪ3֡
+// ֵ0 1 2 ʧ
+#include "../FrameMemory.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// 滻ȫַ亯Ӧͬ
+void* operator new(size_t size)
+{
+	if (void* pointer = MemoryHelper::TrackedAllocate(size)) return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = MemoryHelper::TrackedAllocateAligned(size, static_cast<size_t>(alignment))) return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	MemoryHelper::TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	MemoryHelper::TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	MemoryHelper::TrackedFreeAligned(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+	MemoryHelper::TrackedFreeAligned(pointer);
+}
+
+namespace
+{
+	using namespace MemoryHelper;
+	using Clock = std::chrono::steady_clock;
+
+	const uint32_t frame_latency = 3;
+
+	uint32_t failures = 0;
+
+	void Check(bool passed, const char* what)
+	{
+		if (passed) return;
+		std::printf("  FAILED: %s\n", what);
+		++failures;
+	}
+
+	// ǰͨöѷбǩ
+	uint64_t HeapAllocations()
+	{
+		uint64_t allocations = 0;
+		for (uint32_t tag = 0; tag < m_max_tags; ++tag) allocations += Tags().allocations[tag].load(std::memory_order_relaxed);
+		return allocations;
+	}
+
+	uintptr_t PageOf(void* pointer)
+	{
+		return reinterpret_cast<uintptr_t>(pointer) & ~uintptr_t(SizeClassPool::m_page_size - 1);
+	}
+
+	// ֡ڴ棺ύ֮֡ǰܸã֮ͬһ飬С󰴴С
+	void CheckArena()
+	{
+		FrameArena arena(4096);
+		arena.BeginFrame(0);
+		void* first = arena.Allocate(256);
+		arena.EndFrame(1);
+		// 1δɣڶ֡ʹµĿ
+		arena.BeginFrame(0);
+		void* second = arena.Allocate(256);
+		arena.EndFrame(2);
+		Check(second != first && arena.Stats().block_count == 2, "arena reused a block before its fence completed");
+		// 1ɺ󣬵֡õһ֡Ŀ
+		arena.BeginFrame(1);
+		void* third = arena.Allocate(256);
+		arena.EndFrame(3);
+		Check(third == first && arena.Stats().block_count == 2, "arena did not reuse the retired block");
+		// ڿС2ȡΪĴ飬պСĴ
+		arena.BeginFrame(3);
+		void* large = arena.Allocate(10000);
+		arena.EndFrame(4);
+		arena.BeginFrame(4);
+		void* reused = arena.Allocate(9000);
+		arena.EndFrame(5);
+		Check(reused == large && arena.Stats().block_count == 3, "arena did not reuse the large block");
+
+		// ֡ӳٻʱ֮֡
+		uint32_t warm_blocks = 0;
+		for (uint32_t frame = 5; frame < 200; ++frame)
+		{
+			arena.BeginFrame(frame + 1 - frame_latency);
+			for (uint32_t i = 0; i < 8; ++i) arena.Allocate(1000 + frame % 7 * 300);
+			arena.EndFrame(frame + 1);
+			if (frame == 20) warm_blocks = arena.Stats().block_count;
+		}
+		Check(arena.Stats().block_count == warm_blocks, "arena kept allocating blocks after warm-up");
+		std::printf("Arena: %u blocks, %.1f KB reserved, peak %.1f KB/frame\n",
+			arena.Stats().block_count, arena.Stats().reserved_bytes / 1024.0, arena.Stats().peak_bytes / 1024.0);
+	}
+
+	// ּأ߳ͷŵĿã߳ͷŵĿѹԶ߳ڸüûппʱ
+	void CheckPoolReuse()
+	{
+		// ߳Уشӿտʼ֮߳ǰӰ
+		std::thread owner([]
+			{
+				SizeClassPool* pool = SizeClassPool::ForThread();
+				void* block = pool->Allocate(40);
+				SizeClassPool::Free(block);
+				Check(pool->Allocate(48) == block, "pool did not reuse a block freed on its own thread");
+
+				// 䵽һҳΪֹڵڶҳĿͷţڶҳΪҳ棬üûпп
+				std::vector<void*> first_page;
+				first_page.push_back(block);
+				for (;;)
+				{
+					void* next = pool->Allocate(64);
+					if (PageOf(next) != PageOf(block))
+					{
+						SizeClassPool::Free(next);
+						break;
+					}
+					first_page.push_back(next);
+				}
+				uint32_t pages = pool->PageCount();
+
+				// ߳ͷŵһҳϳһȫ飬ǽ뱾صԶ
+				void* kept = first_page.back();
+				first_page.pop_back();
+				std::thread other([&first_page]
+					{
+						for (void* pointer : first_page) SizeClassPool::Free(pointer);
+					});
+				other.join();
+
+				// һηԶر߳ͷŵĿ飬ҳ棬Ҳûͨöѷ
+				uint64_t heap_before = HeapAllocations();
+				void* collected = pool->Allocate(64);
+				Check(std::find(first_page.begin(), first_page.end(), collected) != first_page.end(),
+					"pool did not reuse a block freed on another thread");
+				Check(pool->PageCount() == pages, "pool allocated a page instead of collecting remote frees");
+				Check(HeapAllocations() == heap_before, "collecting remote frees touched the heap");
+				std::printf("Pool: %zu blocks freed on another thread, %u pages\n", first_page.size(), pool->PageCount());
+				SizeClassPool::Free(collected);
+				SizeClassPool::Free(kept);
+			});
+		owner.join();
+	}
+
+	// ߳˳ĳر֮һʹóص߳̽ӹܣֱ߳̿ӻվ̷߳Ŀ
+	void CheckPoolHandOff()
+	{
+		SizeClassPool* exited_pool = nullptr;
+		uint32_t exited_pages = 0;
+		void* blocks[2] = {};
+		std::thread first([&]
+			{
+				exited_pool = SizeClassPool::ForThread();
+				blocks[0] = exited_pool->Allocate(100);
+				blocks[1] = exited_pool->Allocate(100);
+				exited_pages = exited_pool->PageCount();
+			});
+		first.join();
+
+		std::thread second([&]
+			{
+				SizeClassPool* pool = SizeClassPool::ForThread();
+				Check(pool == exited_pool, "a new thread did not adopt the exited thread's pool");
+				if (pool != exited_pool) return;
+				Check(pool->PageCount() == exited_pages, "the adopted pool lost its pages");
+				// ӹܺڱ̣߳ͷֱӻصһη
+				SizeClassPool::Free(blocks[0]);
+				Check(pool->Allocate(100) == blocks[0], "the adopted pool did not reuse a block from the exited thread");
+				SizeClassPool::Free(blocks[0]);
+				SizeClassPool::Free(blocks[1]);
+			});
+		second.join();
+	}
+
+	// ģһ֡ʱɼбÿ֡ؽ͹ϣĽڵ̭֡У
+	template <typename Vector, typename List, typename Map>
+	uint64_t SimulateFrameWork(Vector& visible, List& recent, Map& lookup, uint32_t frame)
+	{
+		uint32_t count = 2000 + (frame * 7919u) % 6000;
+		visible.reserve(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			visible.push_back(i * 2654435761u);
+		}
+		uint64_t checksum = 0;
+		for (uint32_t value : visible)
+		{
+			checksum += value;
+		}
+		for (uint32_t i = 0; i < 64; ++i)
+		{
+			recent.push_front(frame * 64 + i);
+			lookup[frame * 64 + i] = frame;
+		}
+		while (recent.size() > 1024)
+		{
+			lookup.erase(recent.back());
+			recent.pop_back();
+		}
+		return checksum + recent.size() + lookup.size();
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: MemoryBench [--frames N] [--warmup N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t frames = 2000;
+	uint32_t warmup_frames = 60;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--frames" && has_value) frames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--warmup" && has_value) warmup_frames = static_cast<uint32_t>(std::max(frame_latency, static_cast<uint32_t>(std::atoi(argv[++i]))));
+		else return PrintUsage();
+	}
+
+	CheckArena();
+	CheckPoolReuse();
+	CheckPoolHandOff();
+
+	// ̬֡֡ڴӷּԤ֮ͨöѷ
+	uint32_t tag = RegisterTag("BenchFrame");
+	AllocationTracker tracker;
+	FrameArena arena;
+	std::list<uint32_t, PoolAllocator<uint32_t>> pool_recent;
+	std::unordered_map<uint32_t, uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>, PoolAllocator<std::pair<const uint32_t, uint32_t>>> pool_lookup;
+	uint64_t arena_checksum = 0, steady_allocations = 0, steady_frames = 0;
+	auto begin = Clock::now();
+	for (uint32_t frame = 0; frame < warmup_frames + frames; ++frame)
+	{
+		if (frame == warmup_frames) begin = Clock::now();
+		tracker.BeginFrame();
+		{
+			AllocationScope scope(tag);
+			arena.BeginFrame(frame >= frame_latency ? frame + 1 - frame_latency : 0);
+			FrameVector<uint32_t> visible{ArenaAllocator<uint32_t>(&arena)};
+			uint64_t checksum = SimulateFrameWork(visible, pool_recent, pool_lookup, frame);
+			if (frame >= warmup_frames) arena_checksum += checksum;
+			arena.EndFrame(frame + 1);
+		}
+		const FrameAllocationStats& stats = tracker.EndFrame();
+		if (frame >= warmup_frames)
+		{
+			steady_allocations += stats.steady_allocations;
+			steady_frames += stats.steady_allocations ? 1 : 0;
+		}
+	}
+	double arena_ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / frames;
+	const FrameArenaStats& arena_stats = arena.Stats();
+	std::printf("Memory(arena + pool): %.4f ms/frame, %.2f heap allocations/frame, arena peak %.1f KB in %u blocks, %u pool pages\n",
+		arena_ms, static_cast<double>(steady_allocations) / frames, arena_stats.peak_bytes / 1024.0, arena_stats.block_count, SizeClassPool::ForThread()->PageCount());
+
+	// ͬĹʹstd::allocatorӱ뿴䣬0û
+	std::list<uint32_t> heap_recent;
+	std::unordered_map<uint32_t, uint32_t> heap_lookup;
+	uint64_t heap_checksum = 0, heap_allocations = 0;
+	for (uint32_t frame = 0; frame < warmup_frames + frames; ++frame)
+	{
+		if (frame == warmup_frames) begin = Clock::now();
+		tracker.BeginFrame();
+		{
+			AllocationScope scope(tag);
+			std::vector<uint32_t> visible;
+			uint64_t checksum = SimulateFrameWork(visible, heap_recent, heap_lookup, frame);
+			if (frame >= warmup_frames) heap_checksum += checksum;
+		}
+		const FrameAllocationStats& stats = tracker.EndFrame();
+		if (frame >= warmup_frames) heap_allocations += stats.steady_allocations;
+	}
+	double heap_ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / frames;
+	std::printf("Memory(std::allocator): %.4f ms/frame, %.2f heap allocations/frame\n", heap_ms, static_cast<double>(heap_allocations) / frames);
+
+	std::printf("Steady state: %llu of %u frames allocated, results %s\n",
+		static_cast<unsigned long long>(steady_frames), frames, arena_checksum == heap_checksum ? "match" : "differ");
+	Check(steady_allocations == 0, "steady-state frames allocated from the heap");
+	Check(heap_allocations > 0, "the allocation hooks did not count std::allocator allocations");
+	Check(arena_checksum == heap_checksum, "arena and std::allocator results differ");
+
+	std::printf("Checks: %s", failures ? "FAILED, " : "ok\n");
+	if (failures)
+	{
+		std::printf("%u problems\n", failures);
+		return 2;
+	}
+	return 0;
+}
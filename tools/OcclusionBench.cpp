@@ -0,0 +1,409 @@
+// ڵ޳׼Ӧͬ񳡾--objects壬(0, 0, -10)ԭ㣩
+// ÿ֡׶޳ѡڵդȻڹ߳ϲв԰ΧУ޳͸׶κʱ
+//
+// g++ -std=c++17 -O2 -pthread tools/OcclusionBench.cpp -o OcclusionBench -mavx2  -mavx512f ѡSIMD·
+// Windowscl /std:c++17 /O2 /EHsc /arch:AVX2
+// ÷OcclusionBench [--objects N] [--frames N] [--occluders N] [--threads N] [--resolution WxH] [--validate]
+//
+// --validate ȫֱʵʵz-bufferΪգͳƱ޳ʵʿɼ壨ֻڵͷֱص
+// ֵ0 1 
+#include "../OcclusionCulling.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	const float pi = 3.14159265358979f;
+
+	struct Vec3
+	{
+		float x, y, z;
+	};
+
+	Vec3 Sub(Vec3 a, Vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+	float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	Vec3 Cross(Vec3 a, Vec3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+	Vec3 Normalize(Vec3 a)
+	{
+		float length = std::sqrt(Dot(a, a));
+		return {a.x / length, a.y / length, a.z / length};
+	}
+
+	void Multiply(const float a[4][4], const float b[4][4], float result[4][4])
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column] + a[row][3] * b[3][column];
+			}
+		}
+	}
+
+	// XMMatrixLookAtLHXMMatrixPerspectiveFovLHͬ
+	void LookAtLH(Vec3 eye, Vec3 focus, Vec3 up, float m[4][4])
+	{
+		Vec3 z = Normalize(Sub(focus, eye));
+		Vec3 x = Normalize(Cross(up, z));
+		Vec3 y = Cross(z, x);
+		float result[4][4] = {{x.x, y.x, z.x, 0.0f}, {x.y, y.y, z.y, 0.0f}, {x.z, y.z, z.z, 0.0f}, {-Dot(x, eye), -Dot(y, eye), -Dot(z, eye), 1.0f}};
+		std::memcpy(m, result, sizeof(result));
+	}
+
+	void PerspectiveFovLH(float fov, float aspect, float near_plane, float far_plane, float m[4][4])
+	{
+		float h = 1.0f / std::tan(fov * 0.5f), w = h / aspect, q = far_plane / (far_plane - near_plane);
+		float result[4][4] = {{w, 0.0f, 0.0f, 0.0f}, {0.0f, h, 0.0f, 0.0f}, {0.0f, 0.0f, q, 1.0f}, {0.0f, 0.0f, -q * near_plane, 0.0f}};
+		std::memcpy(m, result, sizeof(result));
+	}
+
+	// ƵλתƽƵ
+	void RotationTranslation(Vec3 axis, float angle, Vec3 position, float m[4][4])
+	{
+		float c = std::cos(angle), s = std::sin(angle), t = 1.0f - c;
+		float result[4][4] = {
+			{t * axis.x * axis.x + c, t * axis.x * axis.y + s * axis.z, t * axis.x * axis.z - s * axis.y, 0.0f},
+			{t * axis.x * axis.y - s * axis.z, t * axis.y * axis.y + c, t * axis.y * axis.z + s * axis.x, 0.0f},
+			{t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x, t * axis.z * axis.z + c, 0.0f},
+			{position.x, position.y, position.z, 1.0f}};
+		std::memcpy(m, result, sizeof(result));
+	}
+
+	struct Mesh
+	{
+		std::vector<float> positions;
+		std::vector<uint32_t> indices;
+	};
+
+	// Ӧͬķ壬˳ʱΪ
+	Mesh CubeMesh(float extent)
+	{
+		Mesh mesh;
+		const float corners[8][3] = {{-1, -1, -1}, {-1, 1, -1}, {1, 1, -1}, {1, -1, -1}, {-1, -1, 1}, {-1, 1, 1}, {1, 1, 1}, {1, -1, 1}};
+		for (const float* corner : corners)
+		{
+			for (int axis = 0; axis < 3; ++axis) mesh.positions.push_back(corner[axis] * extent);
+		}
+		mesh.indices = {0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6, 4, 5, 1, 4, 1, 0, 3, 2, 6, 3, 6, 7, 1, 5, 6, 1, 6, 2, 4, 0, 3, 4, 3, 7};
+		return mesh;
+	}
+
+	// ӦõGenerateSphereͬĵλ
+	Mesh SphereMesh(uint32_t slices, uint32_t stacks)
+	{
+		Mesh mesh;
+		auto add_vertex = [&mesh](float x, float y, float z) { mesh.positions.insert(mesh.positions.end(), {x, y, z}); };
+		add_vertex(0.0f, 1.0f, 0.0f);
+		for (uint32_t stack = 1; stack < stacks; ++stack)
+		{
+			float theta = pi * stack / stacks;
+			for (uint32_t slice = 0; slice < slices; ++slice)
+			{
+				float phi = 2.0f * pi * slice / slices;
+				add_vertex(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			}
+		}
+		add_vertex(0.0f, -1.0f, 0.0f);
+		uint32_t south_pole = static_cast<uint32_t>(mesh.positions.size() / 3 - 1);
+		auto ring = [slices](uint32_t stack, uint32_t slice) { return 1 + (stack - 1) * slices + slice % slices; };
+		for (uint32_t slice = 0; slice < slices; ++slice) mesh.indices.insert(mesh.indices.end(), {0u, ring(1, slice + 1), ring(1, slice)});
+		for (uint32_t stack = 1; stack + 1 < stacks; ++stack)
+		{
+			for (uint32_t slice = 0; slice < slices; ++slice)
+			{
+				uint32_t a = ring(stack, slice), b = ring(stack, slice + 1), c = ring(stack + 1, slice), d = ring(stack + 1, slice + 1);
+				mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+			}
+		}
+		for (uint32_t slice = 0; slice < slices; ++slice) mesh.indices.insert(mesh.indices.end(), {south_pole, ring(stacks - 1, slice), ring(stacks - 1, slice + 1)});
+		return mesh;
+	}
+
+	struct Object
+	{
+		float world[4][4];
+		float box_min[3];
+		float box_max[3];
+	};
+
+	// Χȫĳ׶ƽʱɼƽͼͶӰȡȷΧ[0, 1]
+	bool InFrustum(const float m[4][4], const Object& object)
+	{
+		float planes[6][4];
+		for (int i = 0; i < 4; ++i)
+		{
+			planes[0][i] = m[i][3] + m[i][0];
+			planes[1][i] = m[i][3] - m[i][0];
+			planes[2][i] = m[i][3] + m[i][1];
+			planes[3][i] = m[i][3] - m[i][1];
+			planes[4][i] = m[i][2];
+			planes[5][i] = m[i][3] - m[i][2];
+		}
+		for (const float* plane : planes)
+		{
+			float d = plane[3];
+			for (int axis = 0; axis < 3; ++axis) d += plane[axis] * (plane[axis] > 0.0f ? object.box_max[axis] : object.box_min[axis]);
+			if (d < 0.0f) return false;
+		}
+		return true;
+	}
+
+	// ȫֱʲգʵz-bufferţµɼ
+	class ReferenceRasterizer
+	{
+	public:
+		void Resize(uint32_t width, uint32_t height)
+		{
+			m_width = width;
+			m_height = height;
+			m_depth.assign(static_cast<size_t>(width) * height, 1.0f);
+			m_ids.assign(static_cast<size_t>(width) * height, ~0u);
+		}
+
+		void Clear()
+		{
+			std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+			std::fill(m_ids.begin(), m_ids.end(), ~0u);
+		}
+
+		void Draw(const Mesh& mesh, const float mvp[4][4], uint32_t id)
+		{
+			size_t vertex_count = mesh.positions.size() / 3;
+			m_clip.resize(vertex_count * 4);
+			for (size_t i = 0; i < vertex_count; ++i)
+			{
+				const float* p = &mesh.positions[i * 3];
+				for (int column = 0; column < 4; ++column) m_clip[i * 4 + column] = p[0] * mvp[0][column] + p[1] * mvp[1][column] + p[2] * mvp[2][column] + mvp[3][column];
+			}
+			for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				// GPUһƽz >= 0üõ4Ķٰβ
+				const float* triangle[3] = {&m_clip[mesh.indices[i] * 4], &m_clip[mesh.indices[i + 1] * 4], &m_clip[mesh.indices[i + 2] * 4]};
+				float polygon[4][4];
+				int count = 0;
+				for (int edge = 0; edge < 3; ++edge)
+				{
+					const float* from = triangle[edge];
+					const float* to = triangle[(edge + 1) % 3];
+					if (from[2] >= 0.0f) std::memcpy(polygon[count++], from, sizeof(float) * 4);
+					if ((from[2] >= 0.0f) != (to[2] >= 0.0f))
+					{
+						float t = from[2] / (from[2] - to[2]);
+						for (int k = 0; k < 4; ++k) polygon[count][k] = from[k] + (to[k] - from[k]) * t;
+						polygon[count++][2] = 0.0f;
+					}
+				}
+				float screen[4][3];
+				for (int k = 0; k < count; ++k)
+				{
+					screen[k][0] = (polygon[k][0] / polygon[k][3] * 0.5f + 0.5f) * m_width;
+					screen[k][1] = (0.5f - polygon[k][1] / polygon[k][3] * 0.5f) * m_height;
+					screen[k][2] = polygon[k][2] / polygon[k][3];
+				}
+				for (int k = 1; k + 1 < count; ++k) DrawTriangle(screen[0], screen[k], screen[k + 1], id);
+			}
+		}
+
+		void MarkVisible(std::vector<uint8_t>& visible) const
+		{
+			for (uint32_t id : m_ids)
+			{
+				if (id != ~0u) visible[id] = 1;
+			}
+		}
+
+	private:
+		void DrawTriangle(const float* a, const float* b, const float* c, uint32_t id)
+		{
+			float area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+			if (!(area > 0.0f)) return;
+			int x0 = std::max(0, static_cast<int>(std::floor(std::min({a[0], b[0], c[0]}))));
+			int x1 = std::min(static_cast<int>(m_width) - 1, static_cast<int>(std::ceil(std::max({a[0], b[0], c[0]}))));
+			int y0 = std::max(0, static_cast<int>(std::floor(std::min({a[1], b[1], c[1]}))));
+			int y1 = std::min(static_cast<int>(m_height) - 1, static_cast<int>(std::ceil(std::max({a[1], b[1], c[1]}))));
+			for (int y = y0; y <= y1; ++y)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					float px = x + 0.5f, py = y + 0.5f;
+					float w0 = (c[0] - b[0]) * (py - b[1]) - (px - b[0]) * (c[1] - b[1]);
+					float w1 = (a[0] - c[0]) * (py - c[1]) - (px - c[0]) * (a[1] - c[1]);
+					float w2 = (b[0] - a[0]) * (py - a[1]) - (px - a[0]) * (b[1] - a[1]);
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+					float z = (w0 * a[2] + w1 * b[2] + w2 * c[2]) / area;
+					size_t pixel = static_cast<size_t>(y) * m_width + x;
+					if (z < m_depth[pixel])
+					{
+						m_depth[pixel] = z;
+						m_ids[pixel] = id;
+					}
+				}
+			}
+		}
+
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		std::vector<float> m_depth;
+		std::vector<uint32_t> m_ids;
+		std::vector<float> m_clip;
+	};
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: OcclusionBench [--objects N] [--frames N] [--occluders N] [--threads N] [--resolution WxH] [--validate]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t object_count = 4096;
+	uint32_t frames = 120;
+	uint32_t max_occluders = 32;
+	uint32_t threads = 0;
+	uint32_t width = OcclusionHelper::OcclusionCuller::m_default_width;
+	uint32_t height = OcclusionHelper::OcclusionCuller::m_default_height;
+	bool validate = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--objects" && has_value) object_count = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--frames" && has_value) frames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--occluders" && has_value) max_occluders = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+		else if (argument == "--threads" && has_value) threads = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--resolution" && has_value)
+		{
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || !width || !height) return PrintUsage();
+		}
+		else if (argument == "--validate") validate = true;
+		else return PrintUsage();
+	}
+
+	// Ӧͬ1280x720ڣ45ӳԶƽ0.1100
+	const uint32_t client_width = 1280, client_height = 720;
+	float view[4][4], projection[4][4], view_projection[4][4];
+	Vec3 eye{0.0f, 0.0f, -10.0f};
+	LookAtLH(eye, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, view);
+	PerspectiveFovLH(45.0f * pi / 180.0f, static_cast<float>(client_width) / client_height, 0.1f, 100.0f, projection);
+	Multiply(view, projection, view_projection);
+
+	// ڵ壺С0.9ڽӷ壬ϸֺLOD֤ԭģڲ
+	const float sphere_proxy_extent = 0.9f / std::sqrt(3.0f);
+	OcclusionHelper::OcclusionCuller culler;
+	culler.Initial(width, height, threads == 0 ? 0 : threads - 1);
+	Mesh cube = CubeMesh(1.0f);
+	Mesh sphere_proxy = CubeMesh(sphere_proxy_extent);
+	Mesh sphere = SphereMesh(64, 32);
+	uint32_t cube_occluder = culler.AddMesh(cube.positions.data(), sizeof(float) * 3, cube.positions.size() / 3, cube.indices.data(), cube.indices.size());
+	uint32_t sphere_occluder = culler.AddMesh(sphere_proxy.positions.data(), sizeof(float) * 3, sphere_proxy.positions.size() / 3, sphere_proxy.indices.data(), sphere_proxy.indices.size());
+
+	// ӦõCreateSceneEntitiesͬУÿ(0, 1, 1)תһȦ
+	uint32_t grid_size = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(object_count))));
+	float grid_offset = (grid_size - 1) * 1.5f;
+	std::vector<Vec3> positions(object_count);
+	for (uint32_t i = 0; i < object_count; ++i)
+	{
+		positions[i] = {(i % grid_size) * 3.0f - grid_offset, ((i / grid_size) % grid_size) * 3.0f - grid_offset, (i / (grid_size * grid_size)) * 3.0f - grid_offset};
+	}
+	std::vector<Object> objects(object_count);
+	Vec3 axis = Normalize({0.0f, 1.0f, 1.0f});
+
+	ReferenceRasterizer reference;
+	if (validate) reference.Resize(client_width, client_height);
+	std::vector<uint8_t> truly_visible(object_count);
+	std::vector<uint8_t> kept(object_count);
+
+	std::vector<uint32_t> visible;
+	uint64_t frustum_visible = 0, occluders = 0, triangles = 0, rasterized = 0, tested = 0, culled = 0;
+	uint64_t reference_visible = 0, false_culls = 0;
+	double select_ms = 0.0, raster_ms = 0.0, test_ms = 0.0, max_total_ms = 0.0;
+	for (uint32_t frame = 0; frame < frames; ++frame)
+	{
+		float angle = 2.0f * pi * frame / 60.0f;
+		for (uint32_t i = 0; i < object_count; ++i)
+		{
+			Object& object = objects[i];
+			RotationTranslation(axis, angle, positions[i], object.world);
+			// ת[-1, 1]Χ
+			for (int column = 0; column < 3; ++column)
+			{
+				float extent = std::fabs(object.world[0][column]) + std::fabs(object.world[1][column]) + std::fabs(object.world[2][column]);
+				object.box_min[column] = object.world[3][column] - extent;
+				object.box_max[column] = object.world[3][column] + extent;
+			}
+		}
+
+		visible.clear();
+		for (uint32_t i = 0; i < object_count; ++i)
+		{
+			if (InFrustum(view_projection, objects[i])) visible.push_back(i);
+		}
+		frustum_visible += visible.size();
+		std::vector<uint32_t> before = visible;
+
+		auto bounds = [&](uint32_t object, float* box_min, float* box_max)
+		{
+			std::memcpy(box_min, objects[object].box_min, sizeof(float) * 3);
+			std::memcpy(box_max, objects[object].box_max, sizeof(float) * 3);
+		};
+		culler.BeginFrame(view_projection);
+		const std::vector<uint32_t>& selected = culler.SelectOccluders(visible, max_occluders, [&](uint32_t object)
+			{
+				const float (*m)[4] = objects[object].world;
+				Vec3 offset = Sub({m[3][0], m[3][1], m[3][2]}, eye);
+				float extent = object % 2 ? sphere_proxy_extent : 1.0f;
+				return extent / std::sqrt(Dot(offset, offset));
+			}, bounds);
+		for (uint32_t object : selected) culler.RenderOccluder(object % 2 ? sphere_occluder : cube_occluder, objects[object].world);
+		culler.CullOccluded(visible, bounds);
+
+		const OcclusionHelper::OcclusionStats& stats = culler.Stats();
+		occluders += stats.occluders;
+		triangles += stats.triangles;
+		rasterized += stats.rasterized;
+		tested += stats.tested;
+		culled += stats.culled;
+		select_ms += stats.select_ms;
+		raster_ms += stats.raster_ms;
+		test_ms += stats.test_ms;
+		max_total_ms = std::max(max_total_ms, stats.select_ms + stats.raster_ms + stats.test_ms);
+
+		if (validate)
+		{
+			reference.Clear();
+			for (uint32_t object : before)
+			{
+				float mvp[4][4];
+				Multiply(objects[object].world, view_projection, mvp);
+				reference.Draw(object % 2 ? sphere : cube, mvp, object);
+			}
+			std::fill(truly_visible.begin(), truly_visible.end(), 0);
+			std::fill(kept.begin(), kept.end(), 0);
+			reference.MarkVisible(truly_visible);
+			for (uint32_t object : visible) kept[object] = 1;
+			for (uint32_t object : before)
+			{
+				reference_visible += truly_visible[object];
+				false_culls += truly_visible[object] && !kept[object] ? 1 : 0;
+			}
+		}
+	}
+
+	double n = frames;
+	const OcclusionHelper::MaskedDepthBuffer& depth = culler.DepthBuffer();
+	std::printf("OcclusionBench: %s path, %u threads, %ux%u depth buffer (%ux%u tiles), %u objects, %u frames\n",
+		OcclusionHelper::SimdPathName(), culler.ThreadCount(), depth.Width(), depth.Height(), depth.TilesX(), depth.TilesY(), object_count, frames);
+	std::printf("Per frame: %.1f in frustum, %.1f occluders, %.1f/%.1f triangles rasterized, %.1f tested, %.1f culled (%.1f%%)\n",
+		frustum_visible / n, occluders / n, rasterized / n, triangles / n, tested / n, culled / n, tested ? 100.0 * culled / tested : 0.0);
+	std::printf("Timings per frame: select %.4f ms, raster %.4f ms, test %.4f ms, total %.4f ms (max %.4f ms)\n",
+		select_ms / n, raster_ms / n, test_ms / n, (select_ms + raster_ms + test_ms) / n, max_total_ms);
+	if (validate)
+	{
+		std::printf("Reference %ux%u: %.1f truly visible per frame, %.1f occluded (%.1f%% of them culled), %llu false culls\n",
+			client_width, client_height, reference_visible / n, (frustum_visible - reference_visible) / n,
+			frustum_visible > reference_visible ? 100.0 * culled / (frustum_visible - reference_visible) : 0.0, static_cast<unsigned long long>(false_culls));
+	}
+	return 0;
+}
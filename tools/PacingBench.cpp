@@ -0,0 +1,131 @@
+// ֡ĲԣģʱӦͬ֡֡ʱ3ms6ms֮仯ÿ--spike-period֡һ12msļ壬
+// ֡¼ּӳ٣֡ƽӳ
+//
+// g++ -std=c++17 -O2 tools/PacingBench.cpp -o PacingBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷PacingBench [--fps N] [--frames N] [--spike-period N]
+//
+// 飺֡ûж1/fpsļԤ֡ͼ֡֡⣬ƽ1/fps1%
+// ƫ1/fpsp990.5msӳٶһ֡ʱ1/fpsʱ--fps 240Ȼʧ
+// ֵ0 1 2 ʧ
+#include "../FramePacing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	using namespace PresentHelper;
+
+	// Ԥ֡֡ʱĻƽδ
+	const uint32_t warmup_frames = 60;
+	// ֮֡¶ĵ֡
+	const uint32_t recovery_frames = 2;
+	const uint32_t spike_us = 12000;
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: PacingBench [--fps N] [--frames N] [--spike-period N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	double target_fps = 144.0;
+	uint32_t frame_count = 2000;
+	uint32_t spike_period = 500;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--fps" && has_value) target_fps = std::max(1.0, std::atof(argv[++i]));
+		else if (argument == "--frames" && has_value) frame_count = static_cast<uint32_t>(std::max(static_cast<int>(warmup_frames) + 1, std::atoi(argv[++i])));
+		else if (argument == "--spike-period" && has_value) spike_period = static_cast<uint32_t>(std::max(static_cast<int>(recovery_frames) + 2, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+
+	SimulatedClock clock;
+	FrameLimiter<SimulatedClock> limiter(clock);
+	limiter.SetTargetFps(target_fps);
+	const double interval_ms = std::chrono::duration<double, std::milli>(limiter.Interval()).count();
+	// ģʱûֻȡ
+	const double tolerance_ms = 1e-5;
+
+	std::vector<double> intervals, deviations, latencies;
+	SimulatedClock::time_point last_present{};
+	uint32_t short_intervals = 0;
+	double min_interval_ms = 1e30, max_latency_ms = 0.0;
+	uint32_t seed = 1;
+	for (uint32_t frame = 0; frame < frame_count; ++frame)
+	{
+		limiter.BeginFrame();
+		seed = seed * 1664525u + 1013904223u;
+		uint32_t work_us = 3000 + (seed >> 8) % 3000;
+		bool spike = frame % spike_period == spike_period - 1;
+		if (spike) work_us = spike_us;
+		clock.Advance(std::chrono::microseconds(200));
+		limiter.MarkInputSampled();
+		SimulatedClock::time_point input = clock.Now();
+		clock.Advance(std::chrono::microseconds(work_us));
+		limiter.WaitForPresent();
+		SimulatedClock::time_point present = clock.Now();
+		limiter.EndFrame();
+
+		// ֮֡¶ļ֡ͳƣȻ֡
+		if (frame > 0)
+		{
+			double interval = std::chrono::duration<double, std::milli>(present - last_present).count();
+			if (interval < interval_ms - tolerance_ms) ++short_intervals;
+			min_interval_ms = std::min(min_interval_ms, interval);
+			uint32_t since_spike = (frame + 1) % spike_period;
+			if (frame >= warmup_frames && !spike && since_spike > recovery_frames)
+			{
+				double latency = std::chrono::duration<double, std::milli>(present - input).count();
+				intervals.push_back(interval);
+				deviations.push_back(std::abs(interval - interval_ms));
+				latencies.push_back(latency);
+				max_latency_ms = std::max(max_latency_ms, latency);
+			}
+		}
+		last_present = present;
+	}
+
+	double interval_sum = 0.0, latency_sum = 0.0;
+	for (size_t i = 0; i < intervals.size(); ++i)
+	{
+		interval_sum += intervals[i];
+		latency_sum += latencies[i];
+	}
+	double mean_interval_ms = intervals.empty() ? 0.0 : interval_sum / intervals.size();
+	double mean_latency_ms = latencies.empty() ? 0.0 : latency_sum / latencies.size();
+	std::sort(deviations.begin(), deviations.end());
+	double p99_jitter_ms = deviations.empty() ? 0.0 : deviations[std::min(deviations.size() - 1, static_cast<size_t>(deviations.size() * 0.99))];
+
+	FramePacingStats stats = limiter.Stats();
+	std::printf("Pacing(%.0f fps, interval %.3f ms): %u frames, limiter history mean %.3f ms, jitter %.3f ms, max %.3f ms, p99 %.3f ms\n",
+		target_fps, interval_ms, frame_count, stats.mean_interval_ms, stats.stddev_interval_ms, stats.max_interval_ms, stats.p99_interval_ms);
+	std::printf("Steady frames (%zu): interval min %.3f ms, mean %.3f ms, p99 jitter %.3f ms; input latency mean %.3f ms, max %.3f ms\n",
+		intervals.size(), min_interval_ms, mean_interval_ms, p99_jitter_ms, mean_latency_ms, max_latency_ms);
+
+	uint32_t failures = 0;
+	auto check = [&failures](bool passed, const char* what)
+	{
+		if (passed) return;
+		std::printf("  FAILED: %s\n", what);
+		++failures;
+	};
+	check(!intervals.empty(), "no steady frames to measure");
+	check(short_intervals == 0, "present interval shorter than 1/fps");
+	check(std::abs(mean_interval_ms - interval_ms) <= interval_ms * 0.01, "mean interval is not within 1% of 1/fps");
+	check(p99_jitter_ms <= 0.5, "p99 jitter exceeds 0.5 ms");
+	check(max_latency_ms < interval_ms, "input latency is not below one interval");
+
+	std::printf("Checks: %s", failures ? "FAILED, " : "ok\n");
+	if (failures)
+	{
+		std::printf("%u problems\n", failures);
+		return 2;
+	}
+	return 0;
+}
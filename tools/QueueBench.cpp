@@ -0,0 +1,181 @@
+// ֡ȲԣӦõ֡ȣGPUƣ޳ڼжϣһ7passӳȾ֡
+// ˶λ֣Լǰ֡ÿύĿжӵȴ͸ֵʱģȽֻͼж첽֡ʱ
+//
+// g++ -std=c++17 -O2 tools/QueueBench.cpp -o QueueBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷QueueBench [--frames N]
+//
+// --frames Ϊʱģ֡Ĭ64һͳƣ첽֡ʱֻͼж
+// ֵ0 1 2 ʧ
+#include "../QueueScheduler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	using namespace QueueHelper;
+
+	const QueueType G = QueueType::Graphics;
+	const QueueType C = QueueType::Compute;
+
+	// һύжӡpassȴжӺ͸ֵͷĸֵ
+	struct ExpectedSubmission
+	{
+		QueueType queue;
+		std::vector<uint32_t> passes;
+		std::vector<FenceWait> waits;
+		uint64_t signal;
+	};
+
+	using ExpectedFrame = std::vector<ExpectedSubmission>;
+
+	char QueueLetter(QueueType queue)
+	{
+		return queue == QueueType::Graphics ? 'G' : 'C';
+	}
+
+	std::string Describe(const Submission& submission)
+	{
+		std::string text(1, QueueLetter(submission.queue));
+		text += " passes";
+		for (uint32_t i = 0; i < submission.pass_count; ++i) text += " " + std::to_string(submission.passes[i]);
+		for (uint32_t i = 0; i < submission.wait_count; ++i)
+		{
+			text += std::string(", wait ") + QueueLetter(submission.waits[i].queue) + " " + std::to_string(submission.waits[i].value);
+		}
+		return text + ", signal " + std::to_string(submission.signal_value);
+	}
+
+	bool Matches(const Submission& submission, const ExpectedSubmission& expected)
+	{
+		if (submission.queue != expected.queue || submission.pass_count != expected.passes.size() ||
+			submission.wait_count != expected.waits.size() || submission.signal_value != expected.signal) return false;
+		for (uint32_t i = 0; i < submission.pass_count; ++i)
+		{
+			if (submission.passes[i] != expected.passes[i]) return false;
+		}
+		for (uint32_t i = 0; i < submission.wait_count; ++i)
+		{
+			if (submission.waits[i].queue != expected.waits[i].queue || submission.waits[i].value != expected.waits[i].value) return false;
+		}
+		return true;
+	}
+
+	// ֡ʵȲύȽϣزһµ֡
+	uint32_t CheckSchedule(const char* label, const std::vector<PassDesc>& passes, const std::vector<ExpectedFrame>& frames)
+	{
+		FrameSchedule schedule;
+		if (!schedule.Build(passes))
+		{
+			std::printf("Schedule(%s): FAILED to build\n", label);
+			return 1;
+		}
+		std::printf("Schedule(%s): %zu batches\n", label, schedule.BatchCount());
+		uint64_t fence_values[m_queue_type_count]{};
+		uint64_t* fence_pointers[m_queue_type_count] = {&fence_values[0], &fence_values[1]};
+		std::vector<Submission> submissions;
+		uint32_t failures = 0;
+		for (size_t frame = 0; frame < frames.size(); ++frame)
+		{
+			schedule.Instantiate(fence_pointers, submissions);
+			bool matches = submissions.size() == frames[frame].size();
+			for (size_t i = 0; matches && i < submissions.size(); ++i) matches = Matches(submissions[i], frames[frame][i]);
+			for (const Submission& submission : submissions)
+			{
+				std::printf("  frame %zu: %s\n", frame, Describe(submission).c_str());
+			}
+			if (!matches)
+			{
+				std::printf("Schedule(%s): frame %zu differs from the expected submissions\n", label, frame);
+				++failures;
+			}
+		}
+		return failures;
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: QueueBench [--frames N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t timeline_frames = 64;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--frames" && has_value) timeline_frames = static_cast<uint32_t>(std::max(4, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+	uint32_t failures = 0;
+
+	// ӦеBuildFrameScheduleͬpassƱ֡޳޳дǷ֡ǰpassȡ
+	// FrameEndĸǱ֡ȫ޳δӵ֡ŵȴ֡ǰĳ
+	std::vector<PassDesc> app_passes = {
+		{L"Culling", C, {{1, 2}}},
+		{L"Scene", G, {{0, 0}}},
+		{L"FrameEnd", G, {{0, 0}}},
+	};
+	failures += CheckSchedule("app", app_passes, {
+		{{C, {0}, {}, 1}, {G, {1}, {{C, 1}}, 1}, {G, {2}, {}, 2}},
+		{{C, {0}, {}, 2}, {G, {1}, {{C, 2}}, 3}, {G, {2}, {}, 4}},
+		{{C, {0}, {{G, 1}}, 3}, {G, {1}, {{C, 3}}, 5}, {G, {2}, {}, 6}},
+	});
+
+	// ͵ӳȾ֡ڼжϴһ֡Ľ뱾֡ȺӰص
+	std::vector<PassDesc> deferred_passes = {
+		{L"Culling", C, {}},
+		{L"DepthPrepass", G, {{0, 0}}},
+		{L"PostProcess", C, {{5, 1}}},
+		{L"LightBinning", C, {{1, 0}}},
+		{L"Shadows", G, {}},
+		{L"Lighting", G, {{3, 0}}},
+		{L"Present", G, {{2, 0}}},
+	};
+	// жpass֮ضΣ7Σһ֡յĵȴڵ0֡
+	// PresentԺĵȴѱնԹԴֿĵȴ
+	failures += CheckSchedule("deferred, async compute", deferred_passes, {
+		{{C, {0}, {}, 1}, {G, {1}, {{C, 1}}, 1}, {C, {2}, {}, 2}, {C, {3}, {{G, 1}}, 3}, {G, {4}, {}, 2}, {G, {5}, {{C, 3}}, 3}, {G, {6}, {}, 4}},
+		{{C, {0}, {}, 4}, {G, {1}, {{C, 4}}, 5}, {C, {2}, {{G, 3}}, 5}, {C, {3}, {{G, 5}}, 6}, {G, {4}, {}, 6}, {G, {5}, {{C, 6}}, 7}, {G, {6}, {}, 8}},
+		{{C, {0}, {}, 7}, {G, {1}, {{C, 7}}, 9}, {C, {2}, {{G, 7}}, 8}, {C, {3}, {{G, 9}}, 9}, {G, {4}, {}, 10}, {G, {5}, {{C, 9}}, 11}, {G, {6}, {}, 12}},
+	});
+	// ȫͼжʱֻһΣûпжӵȴ
+	std::vector<PassDesc> graphics_passes = deferred_passes;
+	for (PassDesc& pass : graphics_passes) pass.queue = G;
+	failures += CheckSchedule("deferred, graphics only", graphics_passes, {
+		{{G, {0, 1, 2, 3, 4, 5, 6}, {}, 1}},
+		{{G, {0, 1, 2, 3, 4, 5, 6}, {}, 2}},
+		{{G, {0, 1, 2, 3, 4, 5, 6}, {}, 3}},
+	});
+
+	// ʱģ⣺͹ԴֿȡӰص첽֡ʱ
+	std::vector<double> pass_ms = {0.4, 1.0, 1.5, 0.8, 1.5, 3.0, 0.1};
+	TimelineStats stats[2];
+	for (bool async_compute : {false, true})
+	{
+		FrameSchedule schedule;
+		schedule.Build(async_compute ? deferred_passes : graphics_passes);
+		TimelineStats& result = stats[async_compute ? 1 : 0];
+		result = SimulateTimeline(schedule, pass_ms, timeline_frames);
+		std::printf("Timeline(%s): frame %.2f ms (serialized %.2f ms), graphics busy %.2f idle %.2f ms, compute busy %.2f idle %.2f ms\n",
+			async_compute ? "async compute" : "graphics only", result.frame_ms, result.serialized_ms,
+			result.queue_busy_ms[0], result.queue_idle_ms[0], result.queue_busy_ms[1], result.queue_idle_ms[1]);
+	}
+	if (!(stats[1].frame_ms < stats[0].frame_ms))
+	{
+		std::printf("Timeline: async compute is not faster than graphics only\n");
+		++failures;
+	}
+
+	std::printf("Checks: %s", failures ? "FAILED, " : "ok\n");
+	if (failures)
+	{
+		std::printf("%u problems\n", failures);
+		return 2;
+	}
+	return 0;
+}
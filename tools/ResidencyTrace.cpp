@@ -0,0 +1,198 @@
+// ʽפԵĺϳɷУ--textures4096x4096BC1һֱУƶ
+// mipһֻɼһԴԤΪԣСָ׶Σ
+// ÿ׶ء̭ƳٵƬƽפפmipÿ֡ʱ
+//
+// g++ -std=c++17 -O2 -pthread tools/ResidencyTrace.cpp -o ResidencyTrace
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷ResidencyTrace [--textures N] [--frames N] [--max-loads N]
+//
+// ÿ֡飺פԤ㣻ذȴֺϸУͬһƬһ֡ڼȼ̭
+// ļغ̭άפһ£פmipֵmipȫפ
+// ֵ0 1 2 ʧ
+#include "../ResidencyManager.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// BC164KB׼ƬΪ512x256أĳһάСһƬmippacked mipβ
+	std::vector<std::pair<uint32_t, uint32_t>> MipTiles(uint32_t size)
+	{
+		std::vector<std::pair<uint32_t, uint32_t>> mips;
+		for (uint32_t width = size; width >= 512; width /= 2)
+		{
+			mips.push_back({width / 512, width / 256});
+		}
+		return mips;
+	}
+
+	struct Phase
+	{
+		const char* name;
+		uint64_t budget_bytes;
+		uint64_t loads = 0;
+		uint64_t evictions = 0;
+		uint64_t deferred = 0;
+		double resident_bytes = 0.0;
+		double nearest_mip = 0.0;
+		double update_seconds = 0.0;
+		uint32_t frames = 0;
+	};
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: ResidencyTrace [--textures N] [--frames N] [--max-loads N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t texture_count = 16;
+	uint32_t frame_count = 900;
+	uint32_t max_loads = 64;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--textures" && has_value) texture_count = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--frames" && has_value) frame_count = static_cast<uint32_t>(std::max(3, std::atoi(argv[++i])));
+		else if (argument == "--max-loads" && has_value) max_loads = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+
+	ResidencyHelper::ResidencyPolicy policy;
+	policy.SetMaxLoadsPerFrame(max_loads);
+	const std::vector<std::pair<uint32_t, uint32_t>> mip_tiles = MipTiles(4096);
+	const uint32_t mip_count = static_cast<uint32_t>(mip_tiles.size());
+	std::vector<uint32_t> first_tile(mip_count);
+	uint32_t tiles_per_texture = 0;
+	for (uint32_t mip = 0; mip < mip_count; ++mip)
+	{
+		first_tile[mip] = tiles_per_texture;
+		tiles_per_texture += mip_tiles[mip].first * mip_tiles[mip].second;
+	}
+	for (uint32_t texture = 0; texture < texture_count; ++texture)
+	{
+		policy.RegisterTexture(mip_tiles);
+	}
+	// ļغ̭άפϣ˶Բڲ״̬
+	std::vector<uint8_t> resident(size_t(texture_count) * tiles_per_texture, 0);
+	auto tile_index = [&](const ResidencyHelper::TileCoordinate& tile)
+	{
+		return size_t(tile.texture) * tiles_per_texture + first_tile[tile.mip] + tile.y * mip_tiles[tile.mip].first + tile.x;
+	};
+
+	// Ĭϵ16Լ170MBԣʱȫŵ£Сֻţָһ
+	const uint64_t mb = 1024 * 1024;
+	Phase phases[] = {{"ample", 256 * mb}, {"shrunk", 48 * mb}, {"restored", 128 * mb}};
+	std::printf("ResidencyTrace: %u textures, %u standard mips, %u tiles each (%.1f MB), %u frames, %u loads per frame\n",
+		texture_count, mip_count, tiles_per_texture, tiles_per_texture * ResidencyHelper::m_tile_size_in_bytes / double(mb), frame_count, max_loads);
+
+	// 10֮20ķΧƶ40ɼ
+	const float spacing = 10.0f;
+	const float track = spacing * (texture_count - 1) + 40.0f;
+	const uint32_t round_trip_frames = 600;
+	uint32_t failures = 0;
+	const char* first_failure = nullptr;
+	auto fail = [&](const char* problem)
+	{
+		if (!first_failure) first_failure = problem;
+		++failures;
+	};
+
+	for (uint32_t frame = 0; frame < frame_count; ++frame)
+	{
+		Phase& phase = phases[std::min<uint32_t>(2, frame * 3 / frame_count)];
+		float t = float(frame % round_trip_frames) / round_trip_frames;
+		float camera = (t < 0.5f ? t * 2.0f : 2.0f - t * 2.0f) * track - 20.0f;
+
+		uint32_t nearest = 0;
+		for (uint32_t texture = 0; texture < texture_count; ++texture)
+		{
+			float offset = texture * spacing - camera;
+			if (std::fabs(offset) < std::fabs(nearest * spacing - camera)) nearest = texture;
+			float distance = std::max(1.0f, std::fabs(offset));
+			if (distance > 40.0f) continue;
+			uint32_t mip = static_cast<uint32_t>(std::max(0.0f, std::floor(std::log2(distance * 0.5f))));
+			if (distance < 4.0f)
+			{
+				// ʱֻһ
+				float u0 = offset > 0.0f ? 0.0f : 0.5f;
+				policy.RequestRegion(texture, mip, u0, 0.0f, u0 + 0.5f, 1.0f);
+			}
+			else
+			{
+				policy.RequestMip(texture, mip);
+			}
+		}
+
+		uint64_t deferred_before = policy.Stats().deferred_tiles;
+		auto begin = Clock::now();
+		const ResidencyHelper::ResidencyUpdate& update = policy.Update(phase.budget_bytes);
+		phase.update_seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+
+		if (policy.ResidentTiles() * ResidencyHelper::m_tile_size_in_bytes > phase.budget_bytes) fail("resident tiles exceed the budget");
+		for (size_t i = 1; i < update.loads.size(); ++i)
+		{
+			if (update.loads[i].mip > update.loads[i - 1].mip) fail("finer mip loaded before a coarser one");
+		}
+		for (const ResidencyHelper::TileCoordinate& tile : update.evictions)
+		{
+			if (!resident[tile_index(tile)]) fail("evicted a tile that was not resident");
+			resident[tile_index(tile)] = 0;
+		}
+		for (const ResidencyHelper::TileCoordinate& tile : update.loads)
+		{
+			if (resident[tile_index(tile)]) fail("loaded a tile that was already resident");
+			resident[tile_index(tile)] = 1;
+		}
+		for (const ResidencyHelper::TileCoordinate& tile : update.evictions)
+		{
+			if (resident[tile_index(tile)]) fail("tile loaded and evicted in the same frame");
+		}
+		for (uint32_t texture = 0; texture < texture_count; ++texture)
+		{
+			uint32_t resident_mip = policy.ResidentMip(texture);
+			for (uint32_t mip = 0; mip < mip_count; ++mip)
+			{
+				for (uint32_t y = 0; y < mip_tiles[mip].second; ++y)
+				{
+					for (uint32_t x = 0; x < mip_tiles[mip].first; ++x)
+					{
+						bool expected = resident[tile_index({texture, mip, x, y})] != 0;
+						if (policy.IsResident(texture, mip, x, y) != expected) fail("policy state differs from its load and eviction output");
+						if (mip >= resident_mip && !expected) fail("resident mip has a missing tile");
+					}
+				}
+			}
+		}
+
+		phase.loads += update.loads.size();
+		phase.evictions += update.evictions.size();
+		phase.deferred += policy.Stats().deferred_tiles - deferred_before;
+		phase.resident_bytes += double(policy.Stats().resident_bytes);
+		phase.nearest_mip += policy.ResidentMip(nearest);
+		++phase.frames;
+	}
+
+	for (const Phase& phase : phases)
+	{
+		if (!phase.frames) continue;
+		std::printf("%-8s budget %4llu MB: %6llu loads, %6llu evictions, %7llu deferred, resident avg %6.1f MB, nearest mip avg %.2f, update %.1f us/frame\n",
+			phase.name, static_cast<unsigned long long>(phase.budget_bytes / mb), static_cast<unsigned long long>(phase.loads), static_cast<unsigned long long>(phase.evictions),
+			static_cast<unsigned long long>(phase.deferred), phase.resident_bytes / phase.frames / mb, phase.nearest_mip / phase.frames, phase.update_seconds / phase.frames * 1e6);
+	}
+	std::printf("Checks: %s", failures ? "FAILED, " : "ok\n");
+	if (failures)
+	{
+		std::printf("%u problems, first: %s\n", failures, first_failure);
+		return 2;
+	}
+	return 0;
+}
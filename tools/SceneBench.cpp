@@ -0,0 +1,131 @@
+// 洢׼--entitiesʵ壬ʮ֮һתĸڵ㣬ڸڵ£
+// ֱȫĸºֻаٷ֮һڵ仯
+//
+// g++ -std=c++17 -O2 tools/SceneBench.cpp -o SceneBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷SceneBench [--entities N] [--iterations N]
+//
+// һʵǷ ֲ  󣬲˶µʵ
+// ֵ0 1 2 Уʧ
+#include "../SceneStore.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedSeconds(Clock::time_point begin)
+	{
+		return std::chrono::duration<double>(Clock::now() - begin).count();
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: SceneBench [--entities N] [--iterations N]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace SceneHelper;
+	uint32_t entity_count = 1000000;
+	uint32_t iterations = 10;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--entities" && has_value) entity_count = static_cast<uint32_t>(std::max(1600, std::atoi(argv[++i])));
+		else if (argument == "--iterations" && has_value) iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else return PrintUsage();
+	}
+	const uint32_t root_count = entity_count / 16;
+
+	SceneStore scene;
+	std::vector<EntityHandle> roots;
+	std::vector<EntityHandle> children;
+	roots.reserve(root_count);
+	children.reserve(entity_count - root_count);
+	auto begin = Clock::now();
+	for (uint32_t i = 0; i < root_count; ++i)
+	{
+		EntityHandle root = scene.Create(MaskOf<LocalTransform, WorldMatrix, Spin>());
+		*scene.Get<Spin>(root) = {{0.0f, 1.0f, 1.0f}, 1.0f};
+		roots.push_back(root);
+	}
+	for (uint32_t i = root_count; i < entity_count; ++i)
+	{
+		EntityHandle child = scene.Create(MaskOf<LocalTransform, WorldMatrix, MeshInstance>(), roots[i % root_count]);
+		scene.SetLocalTransform(child, {{float(i % 7), 1.0f, 0.0f}, 1.0f, {0.0f, 0.0f, 0.0f, 1.0f}});
+		children.push_back(child);
+	}
+	double create_seconds = ElapsedSeconds(begin);
+	scene.UpdateTransforms();
+	std::printf("SceneBench: %zu entities, %zu archetypes, %zu chunks, create %.3f s\n", scene.Count(), scene.ArchetypeCount(), scene.ChunkCount(), create_seconds);
+
+	// ȫࣺиڵתӽڵ游
+	size_t updated = 0;
+	begin = Clock::now();
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		UpdateSpin(scene, 1.0f / 60.0f);
+		updated = scene.UpdateTransforms();
+	}
+	double full_seconds = ElapsedSeconds(begin) / iterations;
+	std::printf("Full update: %.2f ms, %.1f M entities/s (%zu updated)\n", full_seconds * 1e3, updated / full_seconds * 1e-6, updated);
+
+	// ֻаٷ֮һĸڵ仯ÿڵͬӽڵһ
+	const uint32_t dirty_roots = root_count / 100;
+	size_t partial_updated = 0;
+	begin = Clock::now();
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		for (uint32_t j = 0; j < dirty_roots; ++j)
+		{
+			EntityHandle root = roots[(j * 97 + i) % root_count];
+			LocalTransform local = *scene.Get<LocalTransform>(root);
+			local.position.x += 0.01f;
+			scene.SetLocalTransform(root, local);
+		}
+		partial_updated = scene.UpdateTransforms();
+	}
+	double partial_seconds = ElapsedSeconds(begin) / iterations;
+	std::printf("Incremental update: %.2f ms (%zu updated)\n", partial_seconds * 1e3, partial_updated);
+
+	int result = 0;
+	size_t expected = 0;
+	for (uint32_t j = 0; j < dirty_roots; ++j)
+	{
+		uint32_t root = (j * 97 + iterations - 1) % root_count;
+		expected += 1 + (entity_count - root_count) / root_count + (root < (entity_count - root_count) % root_count ? 1 : 0);
+	}
+	if (partial_updated != expected)
+	{
+		std::printf("Check incremental count: FAILED (%zu updated, expected %zu)\n", partial_updated, expected);
+		result = 2;
+	}
+
+	// ʵ
+	float max_error = 0.0f;
+	for (size_t i = 0; i < children.size(); i += 997)
+	{
+		WorldMatrix local_matrix, expected_world;
+		ComposeMatrix(*scene.Get<LocalTransform>(children[i]), local_matrix);
+		MultiplyMatrix(local_matrix, *scene.Get<WorldMatrix>(scene.ParentOf(children[i])), expected_world);
+		const WorldMatrix& world = *scene.Get<WorldMatrix>(children[i]);
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				max_error = std::max(max_error, std::fabs(world.m[row][column] - expected_world.m[row][column]));
+			}
+		}
+	}
+	std::printf("Check world matrices: max error %g%s\n", max_error, max_error > 1e-4f ? ", FAILED" : "");
+	if (max_error > 1e-4f) result = 2;
+	return result;
+}
@@ -0,0 +1,409 @@
+// ɫйߣHLSLԴļıעչУDXCб룬ȥغдֱӳɫ鵵
+//
+// g++ -std=c++17 -O2 -pthread tools/ShaderBuilder.cpp -o ShaderBuilderWindowscl /std:c++17 /O2 /EHsc
+// ÷ShaderBuilder [--dxc dxc] [--cache .shader_cache] [--jobs N] [-I dir]... [-o Shaders.dxsa] source.hlsl...
+//
+// Դļеıע
+//   // shader: vs_6_0 main              ĿúڣûעļֻΪļ
+//   // permutation: INSTANCING 0 1      һȡֵעȡѿ
+//
+// ÿеϣԴļݹļݡ궨塢Ŀúͱ
+// ϣΪڻĿ¼Уֻаͼеļ仯˵вŻ±
+#include "../ShaderArchive.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+namespace
+{
+	namespace fs = std::filesystem;
+	using ShaderHelper::ShaderDefine;
+
+	// ϣĸʽ汾ıƴʱʹɻȫʧЧ
+	const uint64_t m_builder_version = 1;
+
+	struct ShaderSource
+	{
+		fs::path path;
+		std::string name;
+		std::string profile;
+		std::string entry;
+		std::vector<std::pair<std::string, std::vector<std::string>>> permutations;
+	};
+
+	struct Job
+	{
+		const ShaderSource* source;
+		std::vector<ShaderDefine> defines;
+		uint64_t input_hash;
+		std::vector<uint8_t> bytecode;
+		bool cached;
+		bool ok;
+	};
+
+	bool ReadBinary(const fs::path& path, std::vector<uint8_t>& data)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file) return false;
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	bool ReadText(const fs::path& path, std::string& text)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file) return false;
+		std::ostringstream stream;
+		stream << file.rdbuf();
+		text = stream.str();
+		return true;
+	}
+
+	std::string Trim(const std::string& text)
+	{
+		size_t begin = text.find_first_not_of(" \t\r\n");
+		if (begin == std::string::npos) return {};
+		size_t end = text.find_last_not_of(" \t\r\n");
+		return text.substr(begin, end - begin + 1);
+	}
+
+	std::string Hex(uint64_t value)
+	{
+		char buffer[17];
+		std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+		return buffer;
+	}
+
+	// "// shader:""// permutation:"עûshaderעʱfalse
+	bool ParseSource(const fs::path& path, const std::string& text, ShaderSource& source)
+	{
+		source.path = path;
+		source.name = path.stem().string();
+		std::istringstream lines(text);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			line = Trim(line);
+			if (line.compare(0, 2, "//") != 0) continue;
+			std::istringstream words(line.substr(2));
+			std::string tag;
+			words >> tag;
+			if (tag == "shader:")
+			{
+				words >> source.profile >> source.entry;
+			}
+			else if (tag == "permutation:")
+			{
+				std::pair<std::string, std::vector<std::string>> permutation;
+				words >> permutation.first;
+				std::string value;
+				while (words >> value) permutation.second.push_back(value);
+				if (!permutation.first.empty() && !permutation.second.empty()) source.permutations.push_back(std::move(permutation));
+			}
+		}
+		return !source.profile.empty() && !source.entry.empty();
+	}
+
+	// ͼ¼ÿļݹϣֱӰļеϣΪհ
+	// ıɨ費չ룬#ifصİҲɶ벻©
+	class IncludeGraph
+	{
+	public:
+		explicit IncludeGraph(std::vector<fs::path> include_directories) : m_include_directories(std::move(include_directories)) {}
+
+		uint64_t ClosureHash(const fs::path& path)
+		{
+			std::set<std::string> visited;
+			std::vector<fs::path> stack{path};
+			while (!stack.empty())
+			{
+				fs::path current = stack.back();
+				stack.pop_back();
+				if (!visited.insert(current.string()).second) continue;
+				const Node& node = Load(current);
+				for (const fs::path& include : node.includes) stack.push_back(include);
+			}
+			// ·ϣ˳޹
+			uint64_t hash = ShaderHelper::Fnv1a("includes");
+			for (const std::string& file : visited)
+			{
+				hash = ShaderHelper::Fnv1a(file, hash);
+				uint64_t content_hash = m_nodes[file].content_hash;
+				hash = ShaderHelper::Fnv1a(&content_hash, sizeof(content_hash), hash);
+			}
+			return hash;
+		}
+
+		size_t FileCount() const { return m_nodes.size(); }
+
+	private:
+		struct Node
+		{
+			uint64_t content_hash = 0;
+			std::vector<fs::path> includes;
+		};
+
+		const Node& Load(const fs::path& path)
+		{
+			auto it = m_nodes.find(path.string());
+			if (it != m_nodes.end()) return it->second;
+			Node node;
+			std::string text;
+			// ȱʧļԹ̶ϣ¼֮ʱϣ仯
+			node.content_hash = ReadText(path, text) ? ShaderHelper::Fnv1a(text) : 0;
+			std::istringstream lines(text);
+			std::string line;
+			while (std::getline(lines, line))
+			{
+				line = Trim(line);
+				if (line.empty() || line[0] != '#') continue;
+				line = Trim(line.substr(1));
+				if (line.compare(0, 7, "include") != 0) continue;
+				size_t open = line.find_first_of("\"<", 7);
+				if (open == std::string::npos) continue;
+				size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+				if (close == std::string::npos) continue;
+				node.includes.push_back(Resolve(path, line.substr(open + 1, close - open - 1)));
+			}
+			return m_nodes.emplace(path.string(), std::move(node)).first->second;
+		}
+
+		// ԰Ŀ¼ңβ-IĿ¼Ҳʱ·¼
+		fs::path Resolve(const fs::path& includer, const std::string& name) const
+		{
+			fs::path candidate = (includer.parent_path() / name).lexically_normal();
+			if (fs::exists(candidate)) return candidate;
+			for (const fs::path& directory : m_include_directories)
+			{
+				fs::path in_directory = (directory / name).lexically_normal();
+				if (fs::exists(in_directory)) return in_directory;
+			}
+			return candidate;
+		}
+
+		std::vector<fs::path> m_include_directories;
+		std::unordered_map<std::string, Node> m_nodes;
+	};
+
+	// PATHвұļΪݣDXC󻺴ԶʧЧ
+	uint64_t CompilerHash(const std::string& compiler)
+	{
+		std::vector<fs::path> candidates{compiler};
+		if (fs::path(compiler).parent_path().empty())
+		{
+			const char* path_variable = std::getenv("PATH");
+#if defined(_WIN32)
+			const char separator = ';';
+			const char* suffixes[] = {".exe", ""};
+#else
+			const char separator = ':';
+			const char* suffixes[] = {""};
+#endif
+			std::istringstream directories(path_variable ? path_variable : "");
+			std::string directory;
+			while (std::getline(directories, directory, separator))
+			{
+				for (const char* suffix : suffixes) candidates.push_back(fs::path(directory) / (compiler + suffix));
+			}
+		}
+		std::vector<uint8_t> binary;
+		for (const fs::path& candidate : candidates)
+		{
+			std::error_code error;
+			if (fs::is_regular_file(candidate, error) && ReadBinary(candidate, binary)) return ShaderHelper::Fnv1a(binary.data(), binary.size());
+		}
+		return ShaderHelper::Fnv1a(compiler);
+	}
+
+	// ֱӴ̶shellеĿոҪת
+	int RunProcess(const std::vector<std::string>& arguments)
+	{
+		std::vector<const char*> argv;
+		for (const std::string& argument : arguments) argv.push_back(argument.c_str());
+		argv.push_back(nullptr);
+#if defined(_WIN32)
+		// _spawnvpոƴУոĲҪ
+		std::vector<std::string> quoted;
+		for (const std::string& argument : arguments) quoted.push_back(argument.find(' ') == std::string::npos ? argument : "\"" + argument + "\"");
+		for (size_t i = 0; i < quoted.size(); ++i) argv[i] = quoted[i].c_str();
+		return static_cast<int>(_spawnvp(_P_WAIT, argv[0], argv.data()));
+#else
+		pid_t pid;
+		if (posix_spawnp(&pid, argv[0], nullptr, nullptr, const_cast<char* const*>(argv.data()), environ) != 0) return -1;
+		int status = 0;
+		if (waitpid(pid, &status, 0) != pid) return -1;
+		return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+	}
+
+	// չкȡֵĵѿ
+	std::vector<std::vector<ShaderDefine>> ExpandPermutations(const ShaderSource& source)
+	{
+		std::vector<std::vector<ShaderDefine>> result{{}};
+		for (const auto& permutation : source.permutations)
+		{
+			std::vector<std::vector<ShaderDefine>> expanded;
+			for (const std::vector<ShaderDefine>& defines : result)
+			{
+				for (const std::string& value : permutation.second)
+				{
+					expanded.push_back(defines);
+					expanded.back().push_back({permutation.first, value});
+				}
+			}
+			result.swap(expanded);
+		}
+		return result;
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: ShaderBuilder [--dxc dxc] [--cache .shader_cache] [--jobs N] [-I dir]... [-o Shaders.dxsa] source.hlsl...\n");
+		return 2;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	auto build_begin = std::chrono::steady_clock::now();
+	std::string compiler = "dxc";
+	fs::path cache_directory = ".shader_cache";
+	fs::path output = "Shaders.dxsa";
+	uint32_t job_count = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<fs::path> include_directories;
+	std::vector<fs::path> inputs;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--dxc" && has_value) compiler = argv[++i];
+		else if (argument == "--cache" && has_value) cache_directory = argv[++i];
+		else if (argument == "--jobs" && has_value) job_count = std::max(1, std::atoi(argv[++i]));
+		else if (argument == "-I" && has_value) include_directories.push_back(argv[++i]);
+		else if (argument == "-o" && has_value) output = argv[++i];
+		else if (!argument.empty() && argument[0] == '-') return PrintUsage();
+		else inputs.push_back(argument);
+	}
+	if (inputs.empty()) return PrintUsage();
+
+	// ԴļչУûshaderעļ
+	std::vector<ShaderSource> sources;
+	sources.reserve(inputs.size());
+	for (const fs::path& input : inputs)
+	{
+		std::string text;
+		if (!ReadText(input, text))
+		{
+			std::fprintf(stderr, "ShaderBuilder: cannot read %s\n", input.string().c_str());
+			return 1;
+		}
+		ShaderSource source;
+		if (ParseSource(input.lexically_normal(), text, source)) sources.push_back(std::move(source));
+	}
+
+	IncludeGraph include_graph(include_directories);
+	uint64_t compiler_hash = CompilerHash(compiler);
+	std::vector<Job> jobs;
+	for (const ShaderSource& source : sources)
+	{
+		uint64_t closure_hash = include_graph.ClosureHash(source.path);
+		for (std::vector<ShaderDefine>& defines : ExpandPermutations(source))
+		{
+			uint64_t hash = ShaderHelper::Fnv1a(&m_builder_version, sizeof(m_builder_version));
+			hash = ShaderHelper::Fnv1a(&compiler_hash, sizeof(compiler_hash), hash);
+			hash = ShaderHelper::Fnv1a(&closure_hash, sizeof(closure_hash), hash);
+			hash = ShaderHelper::Fnv1a(source.profile + ' ' + source.entry + ' ' + ShaderHelper::PermutationName(source.path.string(), defines), hash);
+			for (const fs::path& directory : include_directories) hash = ShaderHelper::Fnv1a(directory.string(), hash);
+			jobs.push_back({&source, std::move(defines), hash, {}, false, false});
+		}
+	}
+
+	// ߳ȡУʱֱӶȡDXC뵽ʱļŽ
+	std::error_code error;
+	fs::create_directories(cache_directory, error);
+	std::atomic<size_t> next_job{0};
+	std::mutex output_mutex;
+	auto worker = [&](uint32_t thread_index)
+	{
+		for (size_t index = next_job++; index < jobs.size(); index = next_job++)
+		{
+			Job& job = jobs[index];
+			fs::path cached = cache_directory / (Hex(job.input_hash) + ".dxil");
+			if (ReadBinary(cached, job.bytecode) && !job.bytecode.empty())
+			{
+				job.cached = true;
+				job.ok = true;
+				continue;
+			}
+			fs::path temporary = cache_directory / (Hex(job.input_hash) + ".tmp" + std::to_string(thread_index));
+			std::vector<std::string> arguments{compiler, "-nologo", "-T", job.source->profile, "-E", job.source->entry};
+			for (const ShaderDefine& define : job.defines)
+			{
+				arguments.push_back("-D");
+				arguments.push_back(define.name + "=" + define.value);
+			}
+			for (const fs::path& directory : include_directories)
+			{
+				arguments.push_back("-I");
+				arguments.push_back(directory.string());
+			}
+			arguments.push_back("-Fo");
+			arguments.push_back(temporary.string());
+			arguments.push_back(job.source->path.string());
+			int exit_code = RunProcess(arguments);
+			std::error_code rename_error;
+			if (exit_code == 0 && ReadBinary(temporary, job.bytecode) && !job.bytecode.empty())
+			{
+				fs::rename(temporary, cached, rename_error);
+				job.ok = true;
+			}
+			else
+			{
+				fs::remove(temporary, rename_error);
+				std::lock_guard<std::mutex> lock(output_mutex);
+				std::fprintf(stderr, "ShaderBuilder: failed to compile %s (exit code %d)\n", ShaderHelper::PermutationName(job.source->path.string(), job.defines).c_str(), exit_code);
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < std::min<size_t>(job_count, jobs.size()); ++i) threads.emplace_back(worker, i);
+	for (std::thread& thread : threads) thread.join();
+
+	// ȥغд鵵κʧʱǾɹ鵵
+	ShaderHelper::ArchiveWriter writer;
+	size_t compiled = 0;
+	size_t cached = 0;
+	for (const Job& job : jobs)
+	{
+		if (!job.ok) return 1;
+		(job.cached ? cached : compiled) += 1;
+		if (!writer.AddPermutation(ShaderHelper::PermutationKey(job.source->name, job.defines), writer.AddBlob(job.bytecode)))
+		{
+			std::fprintf(stderr, "ShaderBuilder: duplicate permutation %s\n", ShaderHelper::PermutationName(job.source->name, job.defines).c_str());
+			return 1;
+		}
+	}
+	if (!writer.Write(output))
+	{
+		std::fprintf(stderr, "ShaderBuilder: cannot write %s\n", output.string().c_str());
+		return 1;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - build_begin).count();
+	std::printf("ShaderBuilder: %zu permutations from %zu shaders (%zu files in include graph), %zu compiled, %zu cached, %zu unique blobs (%llu bytes), %s written in %.2f s\n",
+		jobs.size(), sources.size(), include_graph.FileCount(), compiled, cached, writer.BlobCount(), static_cast<unsigned long long>(writer.BlobBytes()), output.string().c_str(), seconds);
+	return 0;
+}
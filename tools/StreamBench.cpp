@@ -0,0 +1,250 @@
+// Դ׼--dirĿ¼--filesֿԴļÿ--size MBLZ4ѹĿδѹĿϣ
+// һ߳ͬȡѹΪߣAssetStreamerύȫ󣬶Աܺʱӳ
+//
+// g++ -std=c++17 -O2 -pthread tools/StreamBench.cpp -o StreamBenchglibc 2.34֮ǰҪټ -lrt
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷StreamBench [--dir PATH] [--files N] [--size MB] [--chunk KB] [--workers N] [--in-flight N] [--cold] [--keep]
+//
+// --cold ÿһ֮ǰϵͳЩļҳ棨posix_fadviseֻLinuxЧʵĴ̶ȡ
+// ȡʱѹʱ֮ʹǽʱ䣬˵I/O̵߳Ķȡ빤̵߳Ľѹصе
+// Shutdown֮ͿԽļfuture쳣һֱȴ
+// ֵ0 1 2 Уʧܣ3 쳣·ʧ
+#include "../AssetStreamer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ElapsedMs(Clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+	}
+
+	// ԴݵݣһСʡƴɵĶѹӵ޷ѹ
+	std::vector<uint8_t> GenerateAsset(size_t size, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<std::vector<uint8_t>> words(64);
+		for (std::vector<uint8_t>& word : words)
+		{
+			word.resize(4 + random() % 12);
+			for (uint8_t& byte : word) byte = static_cast<uint8_t>(random());
+		}
+		std::vector<uint8_t> data;
+		data.reserve(size);
+		while (data.size() < size)
+		{
+			if (random() % 64 == 0)
+			{
+				for (int i = 0; i < 256; ++i) data.push_back(static_cast<uint8_t>(random()));
+			}
+			else
+			{
+				const std::vector<uint8_t>& word = words[random() % words.size()];
+				data.insert(data.end(), word.begin(), word.end());
+			}
+		}
+		data.resize(size);
+		return data;
+	}
+
+	bool WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+	{
+		std::FILE* file = std::fopen(path.string().c_str(), "wb");
+		if (!file) return false;
+		bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+#if !defined(_WIN32)
+		// дش֮ҳܱ
+		ok = ok && fsync(fileno(file)) == 0;
+#endif
+		return std::fclose(file) == 0 && ok;
+	}
+
+	void DropPageCache(const std::filesystem::path& path)
+	{
+#if !defined(_WIN32)
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) return;
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+#else
+		(void)path;
+#endif
+	}
+
+	// ߣļͬڴ棬ͬһ߳ѹ
+	bool ReadSynchronously(const std::filesystem::path& path, std::vector<uint8_t>& file_data, std::vector<uint8_t>& output)
+	{
+		std::FILE* file = std::fopen(path.string().c_str(), "rb");
+		if (!file) return false;
+		file_data.resize(static_cast<size_t>(std::filesystem::file_size(path)));
+		bool ok = std::fread(file_data.data(), 1, file_data.size(), file) == file_data.size();
+		std::fclose(file);
+		if (!ok || file_data.size() < sizeof(StreamHelper::ChunkFileHeader)) return false;
+
+		StreamHelper::ChunkFileHeader header;
+		std::memcpy(&header, file_data.data(), sizeof(header));
+		output.resize(static_cast<size_t>(header.raw_size));
+		size_t raw_offset = 0;
+		for (uint32_t i = 0; i < header.chunk_count; ++i)
+		{
+			StreamHelper::ChunkEntry chunk;
+			std::memcpy(&chunk, file_data.data() + sizeof(header) + sizeof(chunk) * i, sizeof(chunk));
+			const uint8_t* stored = file_data.data() + chunk.offset;
+			if (chunk.codec == StreamHelper::ChunkCodec::Raw) std::memcpy(output.data() + raw_offset, stored, chunk.raw_size);
+			else if (StreamHelper::Lz4Decompress(stored, chunk.stored_size, output.data() + raw_offset, chunk.raw_size) != chunk.raw_size) return false;
+			raw_offset += chunk.raw_size;
+		}
+		return true;
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: StreamBench [--dir PATH] [--files N] [--size MB] [--chunk KB] [--workers N] [--in-flight N] [--cold] [--keep]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "StreamBench";
+	uint32_t file_count = 32;
+	uint32_t file_size_mb = 8;
+	uint32_t chunk_kb = 256;
+	uint32_t workers = 0;
+	uint32_t in_flight = 8;
+	bool cold = false;
+	bool keep = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--dir" && has_value) directory = argv[++i];
+		else if (argument == "--files" && has_value) file_count = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--size" && has_value) file_size_mb = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--chunk" && has_value) chunk_kb = static_cast<uint32_t>(std::max(4, std::atoi(argv[++i])));
+		else if (argument == "--workers" && has_value) workers = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--in-flight" && has_value) in_flight = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--cold") cold = true;
+		else if (argument == "--keep") keep = true;
+		else return PrintUsage();
+	}
+
+	// ɲļݱڴУ
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::vector<std::filesystem::path> paths(file_count);
+	std::vector<std::vector<uint8_t>> contents(file_count);
+	uint64_t raw_bytes = 0, stored_bytes = 0;
+	for (uint32_t i = 0; i < file_count; ++i)
+	{
+		contents[i] = GenerateAsset(size_t(file_size_mb) << 20, i + 1);
+		std::vector<uint8_t> file = StreamHelper::BuildChunkFile(contents[i].data(), contents[i].size(), size_t(chunk_kb) << 10);
+		paths[i] = directory / ("asset" + std::to_string(i) + ".dxsc");
+		if (!WriteFile(paths[i], file))
+		{
+			std::fprintf(stderr, "cannot write %s\n", paths[i].string().c_str());
+			return 1;
+		}
+		raw_bytes += contents[i].size();
+		stored_bytes += file.size();
+	}
+	double raw_mb = raw_bytes / (1024.0 * 1024.0), stored_mb = stored_bytes / (1024.0 * 1024.0);
+
+	StreamHelper::AssetStreamer streamer;
+	streamer.Initial(workers, size_t(chunk_kb) << 10, in_flight);
+	uint32_t worker_count = workers ? workers : std::max(1u, std::thread::hardware_concurrency() - 1);
+	std::printf("StreamBench: %u files, %.1f MB raw, %.1f MB stored (ratio %.2f), %u KB chunks, %u workers, %u reads in flight, %s cache\n",
+		file_count, raw_mb, stored_mb, raw_mb / stored_mb, chunk_kb, worker_count, in_flight, cold ? "cold" : "warm");
+
+	// ߣһ߳ζȡͽѹ
+	int result = 0;
+	if (cold) for (const auto& path : paths) DropPageCache(path);
+	std::vector<uint8_t> file_data, output;
+	auto begin = Clock::now();
+	for (uint32_t i = 0; i < file_count; ++i)
+	{
+		if (!ReadSynchronously(paths[i], file_data, output) || output != contents[i]) result = 2;
+	}
+	double sync_ms = ElapsedMs(begin);
+	std::printf("Synchronous: %.1f ms, %.1f MB/s of raw data\n", sync_ms, raw_mb / (sync_ms / 1e3));
+
+	// Դȫһύȼļ෴I/O̰߳ȼ
+	if (cold) for (const auto& path : paths) DropPageCache(path);
+	std::vector<std::vector<uint8_t>> destinations(file_count);
+	std::vector<std::future<size_t>> futures;
+	begin = Clock::now();
+	for (uint32_t i = 0; i < file_count; ++i)
+	{
+		futures.push_back(streamer.Request(paths[i], static_cast<int>(file_count - i), destinations[i]));
+	}
+	for (uint32_t i = 0; i < file_count; ++i)
+	{
+		try
+		{
+			if (futures[i].get() != contents[i].size() || destinations[i] != contents[i]) result = 2;
+		}
+		catch (const std::exception& exception)
+		{
+			std::fprintf(stderr, "%s\n", exception.what());
+			result = 2;
+		}
+	}
+	double stream_ms = ElapsedMs(begin);
+	StreamHelper::StreamStats stats = streamer.Stats();
+	double io_ms = stats.io_seconds * 1e3, decompress_ms = stats.decompress_seconds * 1e3;
+	std::printf("AssetStreamer: %.1f ms, %.1f MB/s of raw data (%.2fx), read %.1f MB/s, latency avg %.1f ms max %.1f ms\n",
+		stream_ms, raw_mb / (stream_ms / 1e3), sync_ms / stream_ms, stats.ReadBandwidthMBps(), stats.AverageLatencyMs(), stats.max_latency_ms);
+	std::printf("Overlap: I/O thread %.1f ms + decompression %.1f ms (summed over workers) in %.1f ms wall, %.2fx\n",
+		io_ms, decompress_ms, stream_ms, (io_ms + decompress_ms) / stream_ms);
+	if (result == 2) std::printf("Data check: FAILED\n");
+
+	// ָļ֮⣨offset + stored_sizeļʧ
+	std::vector<uint8_t> corrupt = StreamHelper::BuildChunkFile(contents[0].data(), 4096, 4096);
+	StreamHelper::ChunkEntry chunk;
+	std::memcpy(&chunk, corrupt.data() + sizeof(StreamHelper::ChunkFileHeader), sizeof(chunk));
+	chunk.offset = UINT64_MAX - 16;
+	std::memcpy(corrupt.data() + sizeof(StreamHelper::ChunkFileHeader), &chunk, sizeof(chunk));
+	std::filesystem::path corrupt_path = directory / "corrupt.dxsc";
+	WriteFile(corrupt_path, corrupt);
+	std::vector<uint8_t> ignored;
+	auto expect_failure = [&](std::future<size_t> future, const char* name)
+	{
+		if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready)
+		{
+			std::printf("Check %s: FAILED (future never became ready)\n", name);
+			result = result ? result : 3;
+			return;
+		}
+		try
+		{
+			future.get();
+			std::printf("Check %s: FAILED (request succeeded)\n", name);
+			result = result ? result : 3;
+		}
+		catch (const std::exception&)
+		{
+			std::printf("Check %s: rejected\n", name);
+		}
+	};
+	expect_failure(streamer.Request(corrupt_path, 0, ignored), "chunk outside file");
+	streamer.Shutdown();
+	expect_failure(streamer.Request(paths[0], 0, ignored), "request after Shutdown");
+
+	if (!keep)
+	{
+		for (const auto& path : paths) std::filesystem::remove(path, error);
+		std::filesystem::remove(corrupt_path, error);
+		std::filesystem::remove(directory, error);
+	}
+	return result;
+}
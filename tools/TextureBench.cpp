@@ -0,0 +1,95 @@
+// ѹ׼ɴ䡢ƵϸںalphaĲͼ񣬰BC1/BC3/BC5/BC7һ飬
+// ԴͼȽϵPSNRһ̣gammaȷKaiser mip + BC7
+//
+// g++ -std=c++17 -O2 -pthread tools/TextureBench.cpp -o TextureBench
+// Windowscl /std:c++17 /O2 /EHsc
+// ÷TextureBench [--size WxH] [--threads N] [--out PATH]
+//
+// --out Ѻ決õBC7дļֱӽӦõʽ
+// ֵ0 1 2 ʧ
+#include "../TextureCompressor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	TextureHelper::Image TestImage(uint32_t width, uint32_t height)
+	{
+		TextureHelper::Image image;
+		image.width = width;
+		image.height = height;
+		image.pixels.resize(size_t(width) * height * 4);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint8_t* pixel = &image.pixels[(size_t(y) * width + x) * 4];
+				pixel[0] = static_cast<uint8_t>(x * 255 / width);
+				pixel[1] = static_cast<uint8_t>(y * 255 / height);
+				pixel[2] = static_cast<uint8_t>(128 + 100 * std::sin(x * 0.05) * std::cos(y * 0.03));
+				pixel[3] = static_cast<uint8_t>((x ^ y) & 0xff);
+			}
+		}
+		return image;
+	}
+
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: TextureBench [--size WxH] [--threads N] [--out PATH]\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t width = 2048;
+	uint32_t height = 2048;
+	uint32_t threads = 0;
+	std::string out_path;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--size" && has_value)
+		{
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || !width || !height) return PrintUsage();
+		}
+		else if (argument == "--threads" && has_value) threads = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--out" && has_value) out_path = argv[++i];
+		else return PrintUsage();
+	}
+
+	TextureHelper::Image image = TestImage(width, height);
+	std::printf("TextureBench: %ux%u image, %u threads\n", width, height, threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+	const char* format_names[] = {"BC1", "BC3", "BC5", "BC7"};
+	for (uint32_t format = 0; format < 4; ++format)
+	{
+		TextureHelper::EncodeStats stats;
+		TextureHelper::EncodeImage(image, static_cast<TextureHelper::BlockFormat>(format), stats, threads);
+		std::printf("%s: %.1f Mpixels/s, PSNR %.2f dB\n", format_names[format], stats.mpixels_per_second, stats.psnr);
+	}
+
+	// ̣決ٽһ飬ȷmipһ
+	auto bake_begin = std::chrono::steady_clock::now();
+	std::vector<TextureHelper::Image> mips = TextureHelper::GenerateMipChain(image, TextureHelper::MipFilter::Kaiser, true);
+	std::vector<uint8_t> texture_file = TextureHelper::BuildTextureFile(mips, TextureHelper::BlockFormat::BC7, true, threads);
+	double bake_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - bake_begin).count();
+	std::printf("Bake: %zu mips, %zu bytes, %.3f s\n", mips.size(), texture_file.size(), bake_seconds);
+
+	TextureHelper::TextureFileHeader header;
+	std::vector<TextureHelper::TextureMipEntry> entries;
+	if (!TextureHelper::ParseTextureFile(texture_file.data(), texture_file.size(), header, entries) || entries.size() != mips.size())
+	{
+		std::printf("Container: FAILED to parse\n");
+		return 2;
+	}
+	if (!out_path.empty())
+	{
+		std::FILE* file = std::fopen(out_path.c_str(), "wb");
+		bool written = file && std::fwrite(texture_file.data(), 1, texture_file.size(), file) == texture_file.size();
+		if (file) std::fclose(file);
+		std::printf("Container: %s %s\n", written ? "wrote" : "failed to write", out_path.c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,77 @@
+// طŹߣCPU˰ٶȻطӦòĸ٣--captureÿ֡CPUʱڷύ·ܻ
+//
+// g++ -std=c++17 -O2 tools/TraceReplay.cpp -o TraceReplayWindowscl /std:c++17 /O2 /EHsc
+// ÷TraceReplay [--loops N] [--budget-ms X] trace.dxtr
+//
+// ֵ0 1 𻵣2 ΥԴ״̬󶨹3 ƽÿ֡ʱ--budget-ms
+// 豸ϵĻطţWARPӦ --replay trace.dxtr [--warp] 
+#include "../CommandTrace.h"
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+	int PrintUsage()
+	{
+		std::fprintf(stderr, "usage: TraceReplay [--loops N] [--budget-ms X] trace.dxtr\n");
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t loops = 1;
+	double budget_ms = 0.0;
+	const char* path = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = i + 1 < argc;
+		if (argument == "--loops" && has_value) loops = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+		else if (argument == "--budget-ms" && has_value) budget_ms = std::atof(argv[++i]);
+		else if (!argument.empty() && argument[0] == '-') return PrintUsage();
+		else path = argv[i];
+	}
+	if (!path) return PrintUsage();
+
+	TraceHelper::TraceReader trace;
+	if (!trace.Open(path))
+	{
+		std::fprintf(stderr, "TraceReplay: %s is not a readable trace\n", path);
+		return 1;
+	}
+
+	TraceHelper::CpuBackend backend;
+	TraceHelper::ReplayStats stats;
+	if (!TraceHelper::Replay(trace, backend, loops, stats))
+	{
+		std::fprintf(stderr, "TraceReplay: %s is truncated or corrupt\n", path);
+		return 1;
+	}
+
+	const TraceHelper::CpuReplayStats& replay = backend.Stats();
+	uint32_t frames = std::max(stats.Frames(), 1u);
+	std::printf("TraceReplay: %s, %zu bytes, %u frames x %u loops, %.0f bytes/frame, load %.3f ms\n",
+		path, trace.Size(), stats.Frames() / loops, loops, static_cast<double>(stats.frame_bytes) / frames, stats.load_ms);
+	std::printf("CPU per frame: mean %.4f ms, p50 %.4f ms, p99 %.4f ms, max %.4f ms (%.0f frames/s)\n",
+		stats.MeanMs(), stats.PercentileMs(0.5), stats.PercentileMs(0.99), stats.MaxMs(), stats.MeanMs() > 0.0 ? 1e3 / stats.MeanMs() : 0.0);
+	std::printf("Per frame: %.1f records, %.1f commands, %.1f submissions, %.1f draws (%.0f indices), %.1f dispatches, %.1f barriers, %.1f copies, %.0f bytes uploaded\n",
+		static_cast<double>(stats.frame_records) / frames, static_cast<double>(replay.commands) / frames, static_cast<double>(replay.submissions) / frames,
+		static_cast<double>(replay.draws) / frames, static_cast<double>(replay.indices) / frames, static_cast<double>(replay.dispatches) / frames,
+		static_cast<double>(replay.barriers) / frames, static_cast<double>(replay.copies) / frames, static_cast<double>(replay.bytes_written) / frames);
+	std::printf("Checksum: %016llx", static_cast<unsigned long long>(backend.Checksum()));
+	if (stats.skipped_records) std::printf(", %llu unknown records skipped", static_cast<unsigned long long>(stats.skipped_records));
+	std::printf("\n");
+
+	if (replay.validation_errors)
+	{
+		std::fprintf(stderr, "TraceReplay: %llu validation errors, first: %s\n", static_cast<unsigned long long>(replay.validation_errors), backend.FirstError().c_str());
+		return 2;
+	}
+	if (budget_ms > 0.0 && stats.MeanMs() > budget_ms)
+	{
+		std::fprintf(stderr, "TraceReplay: mean %.4f ms/frame exceeds the budget of %.4f ms\n", stats.MeanMs(), budget_ms);
+		return 3;
+	}
+	return 0;
+}